@@ -31,6 +31,7 @@
 #include <QGraphicsPathItem>
 #include <QGraphicsPolygonItem>
 #include <QGraphicsRectItem>
+#include <QGraphicsSimpleTextItem>
 #include <QGraphicsTextItem>
 #include <QPainter>
 #include <QPainterPath>
@@ -47,6 +48,7 @@ const QSizeF Event::m_size = {16, 11};
 const double Event::m_baseHeight = 6.5;
 const double Event::m_idBoxLength = 10;
 const double Event::m_labelBoxHeight = 4;
+const double Event::m_textDetail = 0.3;
 
 Event::Event(model::Element *event, QGraphicsItem *parent)
     : QGraphicsItem(parent), m_event(event), m_typeGraphics(nullptr)
@@ -100,22 +102,31 @@ void Event::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     double w = units().width();
     double h = units().height();
     double labelBoxWidth = m_size.width() * w;
+    double idBoxWidth = m_idBoxLength * w;
     QRectF rect(-labelBoxWidth / 2, 0, labelBoxWidth, m_labelBoxHeight * h);
+    QRectF nameRect(-idBoxWidth / 2, (m_labelBoxHeight + 1) * h, idBoxWidth, h);
+    // The text is unreadable and expensive to lay out at small scales.
+    bool withText =
+        option->levelOfDetailFromTransform(painter->worldTransform())
+        >= m_textDetail;
+
     painter->drawRect(rect);
-    painter->drawText(rect, Qt::AlignCenter | Qt::TextWordWrap,
-                      painter->fontMetrics().elidedText(
-                          m_event->label(), Qt::ElideRight,
-                          labelBoxWidth * (m_labelBoxHeight - 0.5)));
+    if (withText) {
+        painter->drawText(rect, Qt::AlignCenter | Qt::TextWordWrap,
+                          painter->fontMetrics().elidedText(
+                              m_event->label(), Qt::ElideRight,
+                              labelBoxWidth * (m_labelBoxHeight - 0.5)));
+    }
 
     painter->drawLine(QPointF(0, m_labelBoxHeight * h),
                       QPointF(0, (m_labelBoxHeight + 1) * h));
 
-    double idBoxWidth = m_idBoxLength * w;
-    QRectF nameRect(-idBoxWidth / 2, (m_labelBoxHeight + 1) * h, idBoxWidth, h);
     painter->drawRect(nameRect);
-    painter->drawText(nameRect, Qt::AlignCenter,
-                      painter->fontMetrics().elidedText(
-                          m_event->id(), Qt::ElideRight, idBoxWidth));
+    if (withText) {
+        painter->drawText(nameRect, Qt::AlignCenter,
+                          painter->fontMetrics().elidedText(
+                              m_event->id(), Qt::ElideRight, idBoxWidth));
+    }
 
     painter->drawLine(QPointF(0, (m_labelBoxHeight + 2) * h),
                       QPointF(0, (m_labelBoxHeight + 2.5) * h));
@@ -159,18 +170,56 @@ TransferIn::TransferIn(model::Gate *event, QGraphicsItem *parent)
 
 const QSizeF Gate::m_maxSize = {6, 3};
 const double Gate::m_space = 1;
+const int Gate::m_expansionDepth = 4;
 
 Gate::Gate(model::Gate *event, model::Model *model,
            std::unordered_map<const mef::Gate *, Gate *> *transfer,
+           const std::unordered_set<const mef::Gate *> &expanded, int depth,
            QGraphicsItem *parent)
     : Event(event, parent)
 {
+    GUI_ASSERT(depth >= 0, );
     double availableHeight =
         m_size.height() - m_baseHeight - m_maxSize.height();
     auto *pathItem = new QGraphicsLineItem(
         0, 0, 0, (availableHeight - 1) * units().height(), this);
     pathItem->setPos(0, (m_baseHeight + m_maxSize.height()) * units().height());
     Event::setTypeGraphics(getGateGraphicsType(event->type()).release());
+    if (depth == 0) { // Only the placeholder for the sub-tree.
+        m_width = Event::width();
+        double side = units().height();
+        m_placeholder = new QGraphicsRectItem(-side, 0, 2 * side, side, this);
+        m_placeholder->setPos(0, (m_size.height() - 1) * units().height());
+        auto *text = new QGraphicsSimpleTextItem(
+            QStringLiteral("+%1").arg(event->numArgs()), m_placeholder);
+        text->setPos(-text->boundingRect().width() / 2,
+                     (side - text->boundingRect().height()) / 2);
+        return;
+    }
+    addArgs(model, transfer, expanded, depth);
+}
+
+void Gate::expand(model::Model *model,
+                  std::unordered_map<const mef::Gate *, Gate *> *transfer,
+                  const std::unordered_set<const mef::Gate *> &expanded)
+{
+    GUI_ASSERT(collapsed(), );
+    delete m_placeholder;
+    m_placeholder = nullptr;
+    addArgs(model, transfer, expanded, m_expansionDepth);
+    // Only the ancestors change their layout for the new sub-tree width.
+    for (QGraphicsItem *item = parentItem(); item; item = item->parentItem()) {
+        auto *gate = dynamic_cast<Gate *>(item);
+        GUI_ASSERT(gate, );
+        gate->arrange();
+    }
+}
+
+void Gate::addArgs(model::Model *model,
+                   std::unordered_map<const mef::Gate *, Gate *> *transfer,
+                   const std::unordered_set<const mef::Gate *> &expanded,
+                   int depth)
+{
     struct
     {
         Event *operator()(const mef::BasicEvent *arg)
@@ -197,8 +246,10 @@ Gate::Gate(model::Gate *event, model::Model *model,
                 it->second->addTransferOut();
                 return new TransferIn(proxyEvent, m_parent);
             }
-            auto *arg_gate =
-                new Gate(proxyEvent, m_model, m_transfer, m_parent);
+            auto *arg_gate = new Gate(
+                proxyEvent, m_model, m_transfer, m_expanded,
+                m_expanded.count(arg) ? Gate::m_expansionDepth : m_depth - 1,
+                m_parent);
             m_transfer->emplace(arg, arg_gate);
             return arg_gate;
         }
@@ -206,30 +257,40 @@ Gate::Gate(model::Gate *event, model::Model *model,
         QGraphicsItem *m_parent;
         decltype(model) m_model;
         decltype(transfer) m_transfer;
-    } formula_visitor{this, model, transfer};
-    double linkY = (m_size.height() - 1) * units().height();
-    std::vector<std::pair<Event *, QGraphicsLineItem *>> children;
-    for (const mef::Formula::Arg &arg : event->args()) {
+        decltype(expanded) m_expanded;
+        int m_depth;
+    } formula_visitor{this, model, transfer, expanded, depth};
+    for (const mef::Formula::Arg &arg :
+         static_cast<model::Gate *>(m_event)->args()) {
         GUI_ASSERT(!arg.complement, );
         auto *child = std::visit(formula_visitor, arg.event);
         auto *link = new QGraphicsLineItem(0, 0, 0, units().height(), this);
-        if (!children.empty())
-            m_width += m_space * units().height();
-        child->moveBy(m_width + child->width() / 2,
-                      m_size.height() * units().height());
-        link->moveBy(m_width + child->width() / 2, linkY);
-        m_width += child->width();
-        children.emplace_back(child, link);
-    }
-    // Shift the children left.
-    for (auto &child : children) {
-        child.first->moveBy(-m_width / 2, 0);
-        child.second->moveBy(-m_width / 2, 0);
+        m_args.emplace_back(child, link);
     }
     // Add the planar line to complete the connection.
-    if (children.size() > 1)
-        new QGraphicsLineItem(children.front().first->pos().x(), linkY,
-                              children.back().first->pos().x(), linkY, this);
+    if (m_args.size() > 1)
+        m_planarLink = new QGraphicsLineItem(this);
+    arrange();
+}
+
+void Gate::arrange()
+{
+    m_width = 0;
+    for (const auto &arg : m_args)
+        m_width += arg.first->width();
+    if (!m_args.empty())
+        m_width += (m_args.size() - 1) * m_space * units().height();
+    double linkY = (m_size.height() - 1) * units().height();
+    double x = -m_width / 2; // The children are centered under the gate.
+    for (const auto &arg : m_args) {
+        double center = x + arg.first->width() / 2;
+        arg.first->setPos(center, m_size.height() * units().height());
+        arg.second->setPos(center, linkY);
+        x += arg.first->width() + m_space * units().height();
+    }
+    if (m_planarLink)
+        m_planarLink->setLine(m_args.front().first->pos().x(), linkY,
+                              m_args.back().first->pos().x(), linkY);
 }
 
 std::unique_ptr<QGraphicsItem> Gate::getGateGraphicsType(mef::Connective type)
@@ -363,11 +424,33 @@ DiagramScene::DiagramScene(model::Gate *event, model::Model *model,
             [this](model::Gate *gate) {
                 if (gate == m_root) {
                     clear();
+                    m_transfer.clear();
                     m_root = nullptr; ///< @todo Remove the implicit delete.
                 }
             });
 }
 
+const double DiagramScene::m_expansionDetail = 0.5;
+
+void DiagramScene::expand(const QRectF &area, double levelOfDetail)
+{
+    if (m_root == nullptr || levelOfDetail < m_expansionDetail)
+        return;
+    std::vector<Gate *> collapsed; // Expansion deletes the placeholder items.
+    for (QGraphicsItem *item : items(area)) {
+        auto *gate = dynamic_cast<Gate *>(item);
+        if (gate && gate->collapsed())
+            collapsed.push_back(gate);
+    }
+    if (collapsed.empty())
+        return;
+    for (Gate *gate : collapsed) {
+        m_expanded.insert(static_cast<model::Gate *>(gate->data())->data());
+        gate->expand(m_model, &m_transfer, m_expanded);
+    }
+    link();
+}
+
 void DiagramScene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *mouseEvent)
 {
     QGraphicsScene::mouseDoubleClickEvent(mouseEvent);
@@ -386,9 +469,13 @@ void DiagramScene::redraw()
         return;
 
     clear();
-    std::unordered_map<const mef::Gate *, Gate *> transfer;
-    addItem(new Gate(m_root, m_model, &transfer));
+    m_transfer.clear();
+    addItem(new Gate(m_root, m_model, &m_transfer, m_expanded));
+    link();
+}
 
+void DiagramScene::link()
+{
     struct
     {
         void operator()(mef::Event *) const {}
@@ -412,7 +499,7 @@ void DiagramScene::redraw()
 
     /// @todo Finer signal tracking.
     link(m_root);
-    for (const auto &entry : transfer)
+    for (const auto &entry : m_transfer)
         link(m_model->gates().find(entry.first)->get());
 }
 
@@ -22,6 +22,9 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <QGraphicsItem>
 #include <QGraphicsScene>
@@ -73,6 +76,9 @@ protected:
     static const double m_idBoxLength;
     /// The height of the Label box in characters.
     static const double m_labelBoxHeight;
+    /// The minimum level of detail (scale) to draw the text of events.
+    /// Smaller events are drawn only as boxes.
+    static const double m_textDetail;
 
     /// Assigns an event to a presentation view.
     ///
@@ -135,34 +141,77 @@ public:
 };
 
 /// Fault tree intermediate events or gates.
+///
+/// Only a limited number of gate levels is constructed at once.
+/// The gates beyond the depth limit are shown collapsed
+/// until they are explicitly expanded.
 class Gate : public Event
 {
 public:
+    /// The number of gate levels constructed at once.
+    static const int m_expansionDepth;
+
     /// Constructs the graph with the transfer symbols for gates.
     ///
     /// @param event  The event to be converted into a graphics item.
     /// @param model  The model with wrapper object with signals.
     /// @param transfer  The set of already processed gates
     ///                  to be shown as transfer event.
+    /// @param expanded  The gates to construct beyond the depth limit.
+    /// @param depth  The number of gate levels to construct,
+    ///               including this gate.
     /// @param parent  The optional parent graphics item.
     Gate(model::Gate *event, model::Model *model,
          std::unordered_map<const mef::Gate *, Gate *> *transfer,
-         QGraphicsItem *parent = nullptr);
+         const std::unordered_set<const mef::Gate *> &expanded,
+         int depth = m_expansionDepth, QGraphicsItem *parent = nullptr);
 
     /// Constructs graphics object representing the given gate type.
     std::unique_ptr<QGraphicsItem> getGateGraphicsType(mef::Connective type);
 
     double width() const override;
 
+    /// @returns true if the arguments of the gate are not constructed.
+    bool collapsed() const { return m_placeholder != nullptr; }
+
+    /// Constructs the arguments of the collapsed gate
+    /// and rearranges only the ancestor gates for the new width.
+    ///
+    /// @param model  The model with wrapper object with signals.
+    /// @param transfer  The gates already shown in the diagram.
+    /// @param expanded  The gates to construct beyond the depth limit.
+    void expand(model::Model *model,
+                std::unordered_map<const mef::Gate *, Gate *> *transfer,
+                const std::unordered_set<const mef::Gate *> &expanded);
+
     /// Adds the transfer-out symbol besides the gate shape.
     void addTransferOut();
 
 private:
+    /// Constructs the graphics of the gate arguments.
+    ///
+    /// @param depth  The number of gate levels to construct,
+    ///               including this gate.
+    ///
+    /// @pre The gate has no argument graphics.
+    void addArgs(model::Model *model,
+                 std::unordered_map<const mef::Gate *, Gate *> *transfer,
+                 const std::unordered_set<const mef::Gate *> &expanded,
+                 int depth);
+
+    /// Positions the arguments side by side under the gate
+    /// and updates the width of the gate.
+    void arrange();
+
     static const QSizeF m_maxSize; ///< The constraints on type graphics.
     static const double m_space;   ///< The space between children in chars.
 
-    double m_width = 0;         ///< Assume the graph does not change its width.
+    double m_width = 0;         ///< The width of the whole sub-tree.
     bool m_transferOut = false; ///< The indication of the transfer-out.
+    /// The argument graphics with their links to the gate.
+    std::vector<std::pair<Event *, QGraphicsLineItem *>> m_args;
+    QGraphicsLineItem *m_planarLink = nullptr; ///< The link of the arguments.
+    QGraphicsItem *m_placeholder = nullptr; ///< The collapsed sub-tree.
 };
 
 /// The scene for the fault tree diagram.
@@ -178,6 +227,14 @@ public:
     /// @param[in,out] parent  The optional owner of this object.
     DiagramScene(model::Gate *event, model::Model *model,
                  QObject *parent = nullptr);
+
+    /// Expands the collapsed gates in the given area
+    /// if the diagram is shown in enough detail.
+    ///
+    /// @param[in] area  The visible area of the scene.
+    /// @param[in] levelOfDetail  The scale of the view.
+    void expand(const QRectF &area, double levelOfDetail);
+
 signals:
     /// @param[in] event  The event which graphics received activation.
     void activated(model::Element *event);
@@ -191,8 +248,18 @@ private:
     /// @todo Track changes more accurately.
     void redraw();
 
+    /// Connects the change signals of the shown gates for redrawing.
+    void link();
+
+    /// The minimum level of detail (scale) to expand the collapsed gates.
+    static const double m_expansionDetail;
+
     model::Gate *m_root;   ///< The root gate for signals and redrawing.
     model::Model *m_model; ///< The proxy model providing change signals.
+    /// The gates expanded beyond the depth limit.
+    std::unordered_set<const mef::Gate *> m_expanded;
+    /// The gates shown in the diagram for the transfer symbols.
+    std::unordered_map<const mef::Gate *, Gate *> m_transfer;
 };
 
 } // namespace scram::gui::diagram
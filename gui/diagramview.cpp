@@ -21,11 +21,45 @@
 
 #include <QFileDialog>
 #include <QSvgGenerator>
+#include <QTimer>
 
+#include "diagram.h"
 #include "translate.h"
 
 namespace scram::gui {
 
+DiagramView::DiagramView(QWidget *parent) : ZoomableView(parent)
+{
+    connect(this, &ZoomableView::zoomChanged, this,
+            [this] { scheduleExpansion(); });
+}
+
+void DiagramView::scrollContentsBy(int dx, int dy)
+{
+    ZoomableView::scrollContentsBy(dx, dy);
+    scheduleExpansion();
+}
+
+void DiagramView::resizeEvent(QResizeEvent *event)
+{
+    ZoomableView::resizeEvent(event);
+    scheduleExpansion();
+}
+
+void DiagramView::scheduleExpansion()
+{
+    if (m_expansionPending)
+        return;
+    m_expansionPending = true;
+    QTimer::singleShot(100, this, [this] {
+        m_expansionPending = false;
+        if (auto *diagram = dynamic_cast<diagram::DiagramScene *>(scene())) {
+            diagram->expand(mapToScene(viewport()->rect()).boundingRect(),
+                            transform().m11());
+        }
+    });
+}
+
 void DiagramView::exportAs()
 {
     QString filename =
@@ -28,15 +28,30 @@
 namespace scram::gui {
 
 /// The default view for graphics views (e.g., fault tree diagram).
+///
+/// The collapsed parts of fault tree diagrams
+/// are expanded as they become visible upon scrolling or zooming.
 class DiagramView : public ZoomableView, public Printable
 {
 public:
-    using ZoomableView::ZoomableView;
+    /// @param[in,out] parent  The optional owner of this object.
+    explicit DiagramView(QWidget *parent = nullptr);
 
     /// Exports the image of the diagram.
     void exportAs();
 
 protected:
+    /// Schedules the expansion of the newly visible parts of the diagram.
+    ///
+    /// @param[in] dx  The horizontal scroll distance.
+    /// @param[in] dy  The vertical scroll distance.
+    void scrollContentsBy(int dx, int dy) override;
+
+    /// Schedules the expansion of the newly visible parts of the diagram.
+    ///
+    /// @param[in] event  The resize event.
+    void resizeEvent(QResizeEvent *event) override;
+
     /// Provides support for starting the panning of the window
     /// using the left mouse button.
     ///
@@ -51,6 +66,12 @@ protected:
 
 private:
     void doPrint(QPrinter *printer) override;
+
+    /// Expands the visible collapsed parts of the fault tree diagram
+    /// once the view settles down.
+    void scheduleExpansion();
+
+    bool m_expansionPending = false; ///< The expansion is already scheduled.
 };
 
 } // namespace scram::gui
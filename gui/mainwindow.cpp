@@ -28,6 +28,7 @@
 
 #include <QApplication>
 #include <QCoreApplication>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QPrinter>
@@ -46,6 +47,7 @@
 #include "src/ext/find_iterator.h"
 #include "src/ext/variant.h"
 #include "src/initializer.h"
+#include "src/progress.h"
 #include "src/project.h"
 #include "src/reporter.h"
 #include "src/serialization.h"
@@ -95,12 +97,19 @@ class WaitDialog : public QProgressDialog
 {
 public:
     /// @param[in,out] parent  The owner widget.
-    explicit WaitDialog(QWidget *parent) : QProgressDialog(parent)
+    /// @param[in] cancellable  The flag to provide the Cancel button.
+    explicit WaitDialog(QWidget *parent, bool cancellable = false)
+        : QProgressDialog(parent)
     {
+        if (cancellable) {
+            setCancelButtonText(_("Cancel"));
+        } else {
+            setCancelButton(nullptr);
+        }
         setFixedSize(size());
         setWindowFlags(windowFlags() | Qt::MSWindowsFixedSizeDialogHint
                        | Qt::FramelessWindowHint);
-        setCancelButton(nullptr);
+        setWindowModality(Qt::WindowModal);
         setRange(0, 0);
         setMinimumDuration(0);
     }
@@ -777,18 +786,59 @@ void MainWindow::runAnalysis()
                                 "for probability analysis."));
         return;
     }
-    WaitDialog progress(this);
+    WaitDialog progress(this, /*cancellable=*/true);
     //: This is a message shown during the analysis run.
     progress.setLabelText(_("Running analysis..."));
+    progress.setRange(0, 1000);
+    // The analysis keeps the progress observer in its settings,
+    // so the observer must live as long as the analysis results.
+    auto analysisProgress = std::make_unique<core::Progress>();
+    core::Settings settings = m_settings;
+    settings.progress(analysisProgress.get());
     auto analysis =
-        std::make_unique<core::RiskAnalysis>(m_model.get(), m_settings);
+        std::make_unique<core::RiskAnalysis>(m_model.get(), settings);
+    // The dialog stays until the analysis thread actually stops.
+    disconnect(&progress, &QProgressDialog::canceled, &progress,
+               &QProgressDialog::cancel);
+    connect(&progress, &QProgressDialog::canceled,
+            [&progress, observer = analysisProgress.get()] {
+                observer->Cancel();
+                //: The message shown while the analysis is stopping.
+                progress.setLabelText(_("Cancelling analysis..."));
+            });
+    QTimer progressTimer;
+    connect(&progressTimer, &QTimer::timeout,
+            [&progress, observer = analysisProgress.get()] {
+                progress.setValue(
+                    std::min(static_cast<int>(1000 * observer->fraction()),
+                             progress.maximum() - 1));
+                std::string target = observer->target();
+                if (!target.empty() && !observer->cancelled()) {
+                    //: The analysis target being analyzed during the run.
+                    progress.setLabelText(_("Analyzing %1...")
+                                              .arg(QString::fromStdString(
+                                                  target)));
+                }
+            });
+    progressTimer.start(100);
+    // The local event loop keeps the GUI responsive
+    // until the analysis thread is finished.
+    QEventLoop loop;
     QFutureWatcher<void> futureWatcher;
-    connect(&futureWatcher, SIGNAL(finished()), &progress, SLOT(reset()));
+    connect(&futureWatcher, &QFutureWatcherBase::finished, &loop,
+            &QEventLoop::quit);
     futureWatcher.setFuture(
         QtConcurrent::run([&analysis] { analysis->Analyze(); }));
-    progress.exec();
-    futureWatcher.waitForFinished();
+    progress.show();
+    loop.exec();
+    progressTimer.stop();
+    progress.reset();
     resetReportTree(std::move(analysis));
+    m_analysisProgress = std::move(analysisProgress);
+    if (m_analysisProgress->cancelled()) {
+        ui->statusBar->showMessage(
+            _("The analysis is cancelled; the results are partial."));
+    }
 }
 
 void MainWindow::exportReportAs()
@@ -1548,8 +1598,15 @@ void MainWindow::activateReportTree(const QModelIndex &index)
     switch (static_cast<ReportTree::Row>(index.row())) {
     case ReportTree::Row::Products: {
         bool withProbability = result.probability_analysis != nullptr;
-        auto *table = constructTableView<model::ProductTableModel>(
-            this, result.fault_tree_analysis->products(), withProbability);
+        auto *table = new QTableView(this);
+        auto *tableModel = new model::ProductTableModel(
+            result.fault_tree_analysis->products(), withProbability, table);
+        table->setModel(tableModel); // Sorts and filters without proxies.
+        table->setWordWrap(false);
+        table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        table->horizontalHeader()->setSortIndicatorShown(true);
+        table->resizeColumnsToContents();
+        setupSearchable(table, tableModel);
         ui->tabWidget->addTab(table, _("Products: %1").arg(name));
         table->sortByColumn(withProbability ? 2 : 1, withProbability
                                                          ? Qt::DescendingOrder
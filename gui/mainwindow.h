@@ -307,6 +307,8 @@ private:
     core::Settings m_settings;                ///< The analysis settings.
     std::unique_ptr<mef::Model> m_model;      ///< The analysis model.
     std::unique_ptr<model::Model> m_guiModel; ///< The GUI Model wrapper.
+    /// The progress observer referenced by the analysis settings.
+    std::unique_ptr<core::Progress> m_analysisProgress;
     std::unique_ptr<core::RiskAnalysis> m_analysis; ///< Report container.
 };
 
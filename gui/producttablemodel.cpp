@@ -19,6 +19,15 @@
 
 #include "producttablemodel.h"
 
+#include <cstdlib>
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+#include <QtConcurrent>
+
 #include "src/event.h"
 
 #include "align.h"
@@ -31,34 +40,150 @@ ProductTableModel::ProductTableModel(const core::ProductContainer &products,
                                      bool withProbability, QObject *parent)
     : QAbstractTableModel(parent), m_withProbability(withProbability)
 {
+    std::unordered_map<const mef::BasicEvent *, int> eventIndices;
     m_products.reserve(products.size());
-    double sum = 0;
     for (const core::Product &product : products) {
-        QString members;
-        for (auto it = product.begin(), it_end = product.end(); it != it_end;) {
-            const core::Literal &literal = *it;
-            if (literal.complement)
-                members.append(QStringLiteral("\u00AC"));
-            members.append(QString::fromStdString(literal.event.id()));
-            if (++it != it_end)
-                members.append(QStringLiteral(" \u22C5 "));
+        int offset = m_literals.size();
+        for (const core::Literal &literal : product) {
+            auto it = eventIndices.emplace(&literal.event, m_events.size() + 1);
+            if (it.second)
+                m_events.push_back(&literal.event);
+            m_literals.push_back(literal.complement ? -it.first->second
+                                                    : it.first->second);
         }
         double probability = m_withProbability ? product.p() : 0;
-        sum += probability;
+        m_sum += probability;
         m_products.push_back(
-            {std::move(members), product.order(), probability});
+            {offset, static_cast<int>(m_literals.size()) - offset,
+             probability});
     }
+    m_rows.resize(m_products.size());
+    std::iota(m_rows.begin(), m_rows.end(), 0);
 
-    if (sum == 0)
-        return;
+    connect(&m_filterWatcher, &QFutureWatcherBase::finished, this, [this] {
+        std::optional<std::vector<int>> rows = m_filterWatcher.result();
+        if (!rows)
+            return; // The stopped stale filtering.
+        sortRows(&*rows);
+        beginResetModel();
+        m_rows = std::move(*rows);
+        endResetModel();
+    });
+}
+
+ProductTableModel::~ProductTableModel()
+{
+    ++m_filterGeneration;
+    m_filterWatcher.waitForFinished();
+}
 
-    for (Product &product : m_products)
-        product.contribution = product.probability / sum;
+QString ProductTableModel::toString(const Product &product) const
+{
+    QString members;
+    for (int i = product.offset, end = i + product.size; i < end;) {
+        int literal = m_literals[i];
+        if (literal < 0)
+            members.append(QStringLiteral("\u00AC"));
+        members.append(
+            QString::fromStdString(m_events[std::abs(literal) - 1]->id()));
+        if (++i != end)
+            members.append(QStringLiteral(" \u22C5 "));
+    }
+    return members;
+}
+
+void ProductTableModel::sortRows(std::vector<int> *rows) const
+{
+    auto sortBy = [this, rows](auto less) {
+        if (m_sortOrder == Qt::AscendingOrder) {
+            std::stable_sort(rows->begin(), rows->end(), less);
+        } else {
+            std::stable_sort(rows->begin(), rows->end(),
+                             [&less](int lhs, int rhs) {
+                                 return less(rhs, lhs);
+                             });
+        }
+    };
+    switch (m_sortColumn) {
+    case 0:
+        return sortBy([this](int lhs, int rhs) {
+            auto literals = [this](int index) {
+                auto it = m_literals.begin() + m_products[index].offset;
+                return std::make_pair(it, it + m_products[index].size);
+            };
+            auto [lhsFirst, lhsLast] = literals(lhs);
+            auto [rhsFirst, rhsLast] = literals(rhs);
+            return std::lexicographical_compare(
+                lhsFirst, lhsLast, rhsFirst, rhsLast,
+                [this](int lhsLiteral, int rhsLiteral) {
+                    const std::string &lhsId =
+                        m_events[std::abs(lhsLiteral) - 1]->id();
+                    const std::string &rhsId =
+                        m_events[std::abs(rhsLiteral) - 1]->id();
+                    if (lhsId != rhsId)
+                        return lhsId < rhsId;
+                    return lhsLiteral > rhsLiteral; // Complements last.
+                });
+        });
+    case 1:
+        return sortBy([this](int lhs, int rhs) {
+            return std::max(m_products[lhs].size, 1)
+                   < std::max(m_products[rhs].size, 1);
+        });
+    case 2:
+    case 3:
+        return sortBy([this](int lhs, int rhs) {
+            return m_products[lhs].probability < m_products[rhs].probability;
+        });
+    }
+}
+
+void ProductTableModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    QModelIndexList oldIndices = persistentIndexList();
+    std::vector<int> oldProducts;
+    for (const QModelIndex &index : oldIndices)
+        oldProducts.push_back(m_rows[index.row()]);
+    sortRows(&m_rows);
+    if (!oldIndices.empty()) {
+        std::vector<int> productRows(m_products.size(), -1);
+        for (int row = 0; row < m_rows.size(); ++row)
+            productRows[m_rows[row]] = row;
+        QModelIndexList newIndices;
+        for (int i = 0; i < oldIndices.size(); ++i)
+            newIndices.push_back(index(productRows[oldProducts[i]],
+                                       oldIndices[i].column()));
+        changePersistentIndexList(oldIndices, newIndices);
+    }
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void ProductTableModel::setFilterRegExp(const QString &pattern)
+{
+    int generation = ++m_filterGeneration; // Stop the stale filtering.
+    m_filterWatcher.waitForFinished();
+    m_filter = QRegExp(pattern);
+    m_filterWatcher.setFuture(
+        QtConcurrent::run([this, generation, filter = m_filter]()
+                              -> std::optional<std::vector<int>> {
+            std::vector<int> rows;
+            for (int i = 0; i < m_products.size(); ++i) {
+                if (i % 1024 == 0 && generation != m_filterGeneration)
+                    return {};
+                if (filter.isEmpty()
+                    || filter.indexIn(toString(m_products[i])) != -1)
+                    rows.push_back(i);
+            }
+            return rows;
+        }));
 }
 
 int ProductTableModel::rowCount(const QModelIndex &parent) const
 {
-    return parent.isValid() ? 0 : m_products.size();
+    return parent.isValid() ? 0 : m_rows.size();
 }
 
 int ProductTableModel::columnCount(const QModelIndex &parent) const
@@ -96,17 +221,17 @@ QVariant ProductTableModel::data(const QModelIndex &index, int role) const
     if (role != Qt::DisplayRole)
         return {};
 
-    GUI_ASSERT(index.row() < m_products.size(), {});
-    const Product &product = m_products[index.row()];
+    GUI_ASSERT(index.row() < m_rows.size(), {});
+    const Product &product = m_products[m_rows[index.row()]];
     switch (index.column()) {
     case 0:
-        return product.toString;
+        return toString(product);
     case 1:
-        return product.order;
+        return std::max(product.size, 1);
     case 2:
         return product.probability;
     case 3:
-        return product.contribution;
+        return m_sum == 0 ? 0 : product.probability / m_sum;
     }
     GUI_ASSERT(false && "unexpected column", {});
 }
@@ -20,15 +20,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <optional>
 #include <vector>
 
 #include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QRegExp>
 
 #include "src/fault_tree_analysis.h"
 
 namespace scram::gui::model {
 
 /// The table model for immutable analysis products.
+///
+/// The products are kept in a compact numeric form,
+/// and the text of a row is formatted only upon request.
+/// The model sorts and filters its rows by itself
+/// without an intermediate proxy model;
+/// the filtering runs in a background thread.
 class ProductTableModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -43,6 +53,9 @@ public:
     ProductTableModel(const core::ProductContainer &products,
                       bool withProbability, QObject *parent = nullptr);
 
+    /// Waits for the background filtering to stop.
+    ~ProductTableModel() override;
+
     /// Required standard member functions of QAbstractItemModel interface.
     /// @{
     int rowCount(const QModelIndex &parent) const override;
@@ -50,22 +63,49 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation,
                         int role) const override;
     QVariant data(const QModelIndex &index, int role) const override;
+    void sort(int column, Qt::SortOrder order) override;
     /// @}
 
-private:
-    /// Proxy wrapper/cache for a product in the container.
+    /// @returns The current filter of products.
+    const QRegExp &filterRegExp() const { return m_filter; }
+
+    /// Starts filtering the products in the background.
+    /// The rows are updated once the filtering is done.
     ///
-    /// @note The products are converted into strings
-    ///       to simplify search & filter w/ Regex.
+    /// @param[in] pattern  The regular expression to match the product text.
+    void setFilterRegExp(const QString &pattern);
+
+private:
+    /// Compact numeric record of a product in the container.
     struct Product
     {
-        QString toString;    ///< Specially formatted/encoded list of literals.
-        int order;           ///< The order of the product.
-        double probability;  ///< The optional probability.
-        double contribution; ///< The optional contribution.
+        int offset;         ///< The start of the literals.
+        int size;           ///< The number of literals.
+        double probability; ///< The optional probability.
     };
-    std::vector<Product> m_products; ///< The proxy list of the products.
+
+    /// @returns The formatted text of the product.
+    QString toString(const Product &product) const;
+
+    /// Sorts the visible rows with the current sort column and order.
+    ///
+    /// @param[in,out] rows  The indices of products.
+    void sortRows(std::vector<int> *rows) const;
+
+    /// Signed 1-based indices into the events (negative for complements).
+    std::vector<int> m_literals;
+    std::vector<const mef::BasicEvent *> m_events; ///< Events in products.
+    std::vector<Product> m_products; ///< The records of the products.
+    std::vector<int> m_rows; ///< The visible products in the display order.
+    double m_sum = 0; ///< The total probability for contributions.
     bool m_withProbability; ///< The flag for probability data inclusion.
+    int m_sortColumn = -1; ///< The current sort column.
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder; ///< The current order.
+    QRegExp m_filter; ///< The current filter.
+    /// The generation of the filtering request to stop stale requests.
+    std::atomic<int> m_filterGeneration = 0;
+    /// The filtered rows or none if the filtering is stopped.
+    QFutureWatcher<std::optional<std::vector<int>>> m_filterWatcher;
 };
 
 } // namespace scram::gui::model
@@ -89,6 +89,9 @@ void SettingsDialog::setupState(const core::Settings &initSettings)
     case core::Algorithm::kMocus:
         ui->mocus->setChecked(true);
         break;
+    case core::Algorithm::kAuto: // Not offered in the dialog.
+        ui->bdd->setChecked(true);
+        break;
     }
 
     ui->approximationsBox->setChecked(true);
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2017-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui/diagram.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "gui/model.h"
+
+#include "src/event.h"
+#include "src/model.h"
+
+#include "help.h"
+
+using namespace scram;
+
+class TestDiagram : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void testCollapsed();
+    void testExpandLowDetail();
+    void testExpand();
+
+private:
+    /// The number of gates in the chain of the fault tree.
+    /// The chain is deeper than the levels constructed at once.
+    static constexpr int m_numGates = 12;
+
+    /// @returns The gate graphics in the scene.
+    std::vector<gui::diagram::Gate *> gates() const
+    {
+        std::vector<gui::diagram::Gate *> result;
+        for (QGraphicsItem *item : m_scene->items()) {
+            if (auto *gate = dynamic_cast<gui::diagram::Gate *>(item))
+                result.push_back(gate);
+        }
+        return result;
+    }
+
+    /// @returns The number of collapsed gate graphics in the scene.
+    int numCollapsed() const
+    {
+        int count = 0;
+        for (gui::diagram::Gate *gate : gates())
+            count += gate->collapsed();
+        return count;
+    }
+
+    std::unique_ptr<mef::Model> m_model;
+    std::unique_ptr<gui::model::Model> m_proxy;
+    std::unique_ptr<gui::diagram::DiagramScene> m_scene;
+};
+
+void TestDiagram::init()
+{
+    // The chain of gates: G[i] = G[i + 1] & E[i].
+    m_model = std::make_unique<mef::Model>();
+    mef::Gate *next = nullptr;
+    mef::Gate *root = nullptr;
+    for (int i = m_numGates - 1; i >= 0; --i) {
+        auto event =
+            std::make_unique<mef::BasicEvent>("E" + std::to_string(i));
+        auto gate = std::make_unique<mef::Gate>("G" + std::to_string(i));
+        if (i == m_numGates - 1) {
+            gate->formula(std::make_unique<mef::Formula>(
+                mef::kNull, mef::Formula::ArgSet{event.get()}));
+        } else {
+            gate->formula(std::make_unique<mef::Formula>(
+                mef::kAnd, mef::Formula::ArgSet{next, event.get()}));
+        }
+        next = gate.get();
+        root = gate.get();
+        m_model->Add(std::move(event));
+        m_model->Add(std::move(gate));
+    }
+    m_proxy = std::make_unique<gui::model::Model>(m_model.get());
+    m_scene = std::make_unique<gui::diagram::DiagramScene>(
+        m_proxy->gates().find(root)->get(), m_proxy.get());
+}
+
+void TestDiagram::cleanup()
+{
+    m_scene.reset();
+    m_proxy.reset();
+    m_model.reset();
+}
+
+void TestDiagram::testCollapsed()
+{
+    // The last gate level is only a placeholder.
+    TEST_EQ(gates().size(), gui::diagram::Gate::m_expansionDepth + 1);
+    TEST_EQ(numCollapsed(), 1);
+}
+
+void TestDiagram::testExpandLowDetail()
+{
+    m_scene->expand(m_scene->itemsBoundingRect(), 0.1);
+    TEST_EQ(gates().size(), gui::diagram::Gate::m_expansionDepth + 1);
+    TEST_EQ(numCollapsed(), 1);
+}
+
+void TestDiagram::testExpand()
+{
+    std::vector<gui::diagram::Gate *> shown = gates();
+    int expected = shown.size();
+    for (int i = 0; numCollapsed() && i < m_numGates; ++i) {
+        m_scene->expand(m_scene->itemsBoundingRect(), 1);
+        expected = std::min(expected + gui::diagram::Gate::m_expansionDepth,
+                            m_numGates);
+        TEST_EQ(gates().size(), expected);
+    }
+    TEST_EQ(gates().size(), m_numGates);
+    TEST_EQ(numCollapsed(), 0);
+    // The shown gates are kept instead of rebuilding the scene.
+    std::vector<gui::diagram::Gate *> expanded = gates();
+    for (gui::diagram::Gate *gate : shown)
+        QVERIFY(std::find(expanded.begin(), expanded.end(), gate)
+                != expanded.end());
+}
+
+QTEST_MAIN(TestDiagram)
+
+#include "testdiagram.moc"
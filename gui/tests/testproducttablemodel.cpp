@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2017-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui/producttablemodel.h"
+
+#include <memory>
+
+#include <QPersistentModelIndex>
+#include <QtTest>
+
+#include "src/bdd.h"
+#include "src/event.h"
+#include "src/expression/constant.h"
+#include "src/fault_tree_analysis.h"
+#include "src/settings.h"
+
+#include "help.h"
+
+using namespace scram;
+
+class TestProductTableModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testRows();
+    void testSortByProduct();
+    void testSortByOrder();
+    void testSortByProbability();
+    void testSortPersistentIndex();
+    void testFilter();
+    void testFilterSorted();
+    void testFilterStale();
+
+private:
+    /// @returns The product text in the row.
+    QString product(int row) const
+    {
+        return m_model->index(row, 0).data().toString();
+    }
+
+    /// @returns The product probability in the row.
+    double probability(int row) const
+    {
+        return m_model->index(row, 2).data().toDouble();
+    }
+
+    /// The fault tree: PumpOne | ValveOne & ValveTwo | ValveOne & PumpTwo.
+    /// @{
+    mef::ConstantExpression m_valveOneProb{0.4};
+    mef::ConstantExpression m_valveTwoProb{0.5};
+    mef::ConstantExpression m_pumpOneProb{0.6};
+    mef::ConstantExpression m_pumpTwoProb{0.7};
+    mef::BasicEvent m_valveOne{"ValveOne"};
+    mef::BasicEvent m_valveTwo{"ValveTwo"};
+    mef::BasicEvent m_pumpOne{"PumpOne"};
+    mef::BasicEvent m_pumpTwo{"PumpTwo"};
+    mef::Gate m_valves{"Valves"};
+    mef::Gate m_mixed{"Mixed"};
+    mef::Gate m_top{"Top"};
+    /// @}
+    std::unique_ptr<core::FaultTreeAnalyzer<core::Bdd>> m_analysis;
+    std::unique_ptr<gui::model::ProductTableModel> m_model;
+};
+
+void TestProductTableModel::initTestCase()
+{
+    m_valveOne.expression(&m_valveOneProb);
+    m_valveTwo.expression(&m_valveTwoProb);
+    m_pumpOne.expression(&m_pumpOneProb);
+    m_pumpTwo.expression(&m_pumpTwoProb);
+    m_valves.formula(std::make_unique<mef::Formula>(
+        mef::kAnd, mef::Formula::ArgSet{&m_valveOne, &m_valveTwo}));
+    m_mixed.formula(std::make_unique<mef::Formula>(
+        mef::kAnd, mef::Formula::ArgSet{&m_valveOne, &m_pumpTwo}));
+    m_top.formula(std::make_unique<mef::Formula>(
+        mef::kOr, mef::Formula::ArgSet{&m_pumpOne, &m_valves, &m_mixed}));
+}
+
+void TestProductTableModel::init()
+{
+    core::Settings settings;
+    settings.probability_analysis(true);
+    m_analysis =
+        std::make_unique<core::FaultTreeAnalyzer<core::Bdd>>(m_top, settings);
+    m_analysis->Analyze();
+    m_model = std::make_unique<gui::model::ProductTableModel>(
+        m_analysis->products(), /*withProbability=*/true);
+}
+
+void TestProductTableModel::cleanup()
+{
+    m_model.reset();
+    m_analysis.reset();
+}
+
+void TestProductTableModel::testRows()
+{
+    TEST_EQ(m_model->rowCount({}), 3);
+    TEST_EQ(m_model->columnCount({}), 4);
+    double sum = 0;
+    for (int row = 0; row < 3; ++row) {
+        sum += probability(row);
+        TEST_EQ(m_model->index(row, 1).data().toInt(),
+                product(row) == "PumpOne" ? 1 : 2);
+    }
+    QCOMPARE(sum, 0.6 + 0.4 * 0.5 + 0.4 * 0.7);
+    for (int row = 0; row < 3; ++row)
+        QCOMPARE(m_model->index(row, 3).data().toDouble(),
+                 probability(row) / sum);
+}
+
+void TestProductTableModel::testSortByProduct()
+{
+    m_model->sort(0, Qt::AscendingOrder);
+    TEST_EQ(product(0), "PumpOne");
+    m_model->sort(0, Qt::DescendingOrder);
+    TEST_EQ(product(2), "PumpOne");
+}
+
+void TestProductTableModel::testSortByOrder()
+{
+    m_model->sort(1, Qt::AscendingOrder);
+    TEST_EQ(m_model->index(0, 1).data().toInt(), 1);
+    m_model->sort(1, Qt::DescendingOrder);
+    TEST_EQ(m_model->index(2, 1).data().toInt(), 1);
+}
+
+void TestProductTableModel::testSortByProbability()
+{
+    m_model->sort(2, Qt::DescendingOrder);
+    QCOMPARE(probability(0), 0.6);
+    QCOMPARE(probability(1), 0.28);
+    QCOMPARE(probability(2), 0.2);
+    m_model->sort(3, Qt::AscendingOrder);
+    QCOMPARE(probability(0), 0.2);
+    QCOMPARE(probability(2), 0.6);
+}
+
+void TestProductTableModel::testSortPersistentIndex()
+{
+    m_model->sort(2, Qt::DescendingOrder);
+    QPersistentModelIndex pump(m_model->index(0, 0));
+    TEST_EQ(pump.data().toString(), "PumpOne");
+    m_model->sort(2, Qt::AscendingOrder);
+    TEST_EQ(pump.row(), 2);
+    TEST_EQ(pump.data().toString(), "PumpOne");
+}
+
+void TestProductTableModel::testFilter()
+{
+    QSignalSpy spy(m_model.get(), &QAbstractItemModel::modelReset);
+    m_model->setFilterRegExp("Valve");
+    TEST_EQ(m_model->filterRegExp().pattern(), "Valve");
+    QVERIFY(spy.wait());
+    TEST_EQ(m_model->rowCount({}), 2);
+    for (int row = 0; row < 2; ++row)
+        QVERIFY(product(row).contains("ValveOne"));
+
+    m_model->setFilterRegExp("");
+    QTRY_COMPARE(m_model->rowCount({}), 3);
+}
+
+void TestProductTableModel::testFilterSorted()
+{
+    m_model->sort(2, Qt::DescendingOrder);
+    m_model->setFilterRegExp("Valve");
+    QTRY_COMPARE(m_model->rowCount({}), 2);
+    QCOMPARE(probability(0), 0.28);
+    QCOMPARE(probability(1), 0.2);
+}
+
+void TestProductTableModel::testFilterStale()
+{
+    m_model->setFilterRegExp("Pump");
+    m_model->setFilterRegExp("ValveTwo");
+    QTRY_COMPARE(m_model->rowCount({}), 1);
+    QVERIFY(product(0).contains("ValveTwo"));
+    QTest::qWait(100); // The stale filtering must not reset the rows.
+    TEST_EQ(m_model->rowCount({}), 1);
+}
+
+QTEST_GUILESS_MAIN(TestProductTableModel)
+
+#include "testproducttablemodel.moc"
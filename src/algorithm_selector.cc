@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the automatic algorithm selection.
+
+#include "algorithm_selector.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <unordered_set>
+
+#include "fault_tree_analysis.h"
+#include "logger.h"
+#include "preprocessor.h"
+#include "trace.h"
+
+namespace scram::core {
+
+namespace {
+
+/// Collects the features of the graph before preprocessing.
+///
+/// @param[in,out] graph  The freshly constructed PDAG.
+/// @param[out] features  The destination for the features.
+void GatherRawFeatures(Pdag* graph, GraphFeatures* features) noexcept {
+  features->coherent = graph->coherent();
+  TraverseGates(graph->root(), [features](const GatePtr& gate) {
+    features->num_atleast_gates += gate->type() == kAtleast;
+  });
+  graph->Clear<Pdag::kGateMark>();
+  for (const mef::BasicEvent* basic_event : graph->basic_events()) {
+    if (basic_event->HasExpression())
+      features->max_probability =
+          std::max(features->max_probability, basic_event->p());
+  }
+}
+
+/// Collects the features of the preprocessed graph.
+///
+/// @param[in,out] graph  The PDAG after preprocessing.
+/// @param[out] features  The destination for the features.
+void GatherFeatures(Pdag* graph, GraphFeatures* features) noexcept {
+  std::unordered_set<int> variables;
+  TraverseGates(graph->root(), [features, &variables](const GatePtr& gate) {
+    ++features->num_gates;
+    features->num_modules += gate->module();
+    for (const auto& arg : gate->args<Variable>())
+      variables.insert(std::abs(arg.first));
+  });
+  graph->Clear<Pdag::kGateMark>();
+  features->num_variables = variables.size();
+}
+
+/// Constructs the BDD of the graph within the trial vertex budget.
+///
+/// @param[in] graph  The graph preprocessed for BDD.
+/// @param[in] settings  The analysis settings.
+///
+/// @returns The BDD if the construction has succeeded.
+/// @returns nullptr if the budget is exceeded or the analysis is cancelled.
+std::unique_ptr<Bdd> TryBdd(const Pdag* graph,
+                            const Settings& settings) noexcept {
+  Settings bdd_settings = settings;
+  bdd_settings.algorithm(Algorithm::kBdd);
+  auto bdd = std::make_unique<Bdd>(graph, bdd_settings, kBddTrialVertices);
+  if (bdd->exhausted() || settings.cancelled())
+    return nullptr;
+  return bdd;
+}
+
+}  // namespace
+
+AlgorithmChoice SelectAlgorithm(const mef::Gate& target,
+                                const Settings& settings,
+                                const mef::Model* model) noexcept {
+  TRACE("Algorithm selection");
+  AlgorithmChoice choice{Algorithm::kBdd, settings.approximation(), {}, {}};
+  std::ostringstream rationale;
+  if (settings.prime_implicants()) {
+    rationale << "prime implicants require BDD";
+    choice.rationale = rationale.str();
+    return choice;
+  }
+
+  auto graph = std::make_shared<Pdag>(
+      target, settings.ccf_analysis(), model,
+      std::vector<const mef::HouseEvent*>(), GetCcfCutOff(settings));
+  GatherRawFeatures(graph.get(), &choice.features);
+  CustomPreprocessor<Bdd>{graph.get()}();
+  GatherFeatures(graph.get(), &choice.features);
+  const GraphFeatures& features = choice.features;
+  rationale << features.num_gates << " gates, " << features.num_modules
+            << " modules, " << features.num_variables << " variables, "
+            << features.num_atleast_gates << " K/N gates, "
+            << (features.coherent ? "coherent" : "non-coherent") << "; ";
+
+  if (std::unique_ptr<Bdd> bdd = TryBdd(graph.get(), settings)) {
+    rationale << "BDD with " << bdd->statistics().counter("bdd-vertices")
+              << " vertices";
+    choice.graph = std::move(graph);
+    choice.bdd = std::move(bdd);
+  } else {
+    choice.algorithm = Algorithm::kZbdd;
+    rationale << "BDD exceeded the trial budget of " << kBddTrialVertices
+              << " vertices";
+    if (choice.approximation == Approximation::kNone) {
+      if (features.max_probability > kRareEventLimit) {
+        choice.approximation = Approximation::kMcub;
+        rationale << "; MCUB for basic event probabilities up to "
+                  << features.max_probability;
+      } else {
+        choice.approximation = Approximation::kRareEvent;
+        rationale << "; rare-event for basic event probabilities up to "
+                  << features.max_probability;
+      }
+    }
+  }
+  choice.rationale = rationale.str();
+  LOG(DEBUG2) << "Selected " << kAlgorithmToString[static_cast<int>(
+                                    choice.algorithm)]
+              << " for " << target.id() << ": " << choice.rationale;
+  return choice;
+}
+
+}  // namespace scram::core
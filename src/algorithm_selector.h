@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Automatic selection of the analysis algorithm per analysis target.
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+
+#include "bdd.h"
+#include "event.h"
+#include "model.h"
+#include "pdag.h"
+#include "settings.h"
+
+namespace scram::core {
+
+/// The structural features of an analysis target
+/// relevant to the choice of the algorithm.
+struct GraphFeatures {
+  int num_gates = 0;  ///< The gates after preprocessing.
+  int num_modules = 0;  ///< The modules after preprocessing.
+  int num_variables = 0;  ///< The variables after preprocessing.
+  int num_atleast_gates = 0;  ///< The K/N gates before preprocessing.
+  bool coherent = true;  ///< The absence of negations.
+  double max_probability = 0;  ///< The most probable basic event.
+};
+
+/// The algorithm and approximation chosen for an analysis target.
+struct AlgorithmChoice {
+  Algorithm algorithm;  ///< The concrete qualitative analysis algorithm.
+  Approximation approximation;  ///< The quantitative analysis approximation.
+  GraphFeatures features;  ///< The features behind the choice.
+  std::string rationale;  ///< The human-readable reason for the choice.
+  /// The preprocessed graph and its BDD from the successful trial
+  /// to be taken over by the analysis instead of the reconstruction.
+  /// @{
+  std::shared_ptr<Pdag> graph;
+  std::unique_ptr<Bdd> bdd;
+  /// @}
+};
+
+/// The budget of vertices for the trial BDD construction.
+/// Unlike a time limit, the budget makes the choice reproducible.
+const std::int64_t kBddTrialVertices = 1 << 20;
+
+/// The basic event probability
+/// beyond which the Rare-Event approximation is considered inaccurate.
+const double kRareEventLimit = 0.1;
+
+/// Chooses the analysis algorithm and approximation for a target.
+///
+/// BDD is chosen if prime implicants are requested,
+/// or if the BDD of the preprocessed target is constructed
+/// within the trial vertex budget.
+/// Otherwise, ZBDD is chosen with the Rare-Event approximation
+/// or with the MCUB approximation for probable basic events.
+/// Explicitly requested approximations are kept.
+///
+/// @param[in] target  The top gate of the analysis.
+/// @param[in] settings  The analysis settings with the automatic algorithm.
+/// @param[in] model  The model containing substitutions if any.
+///
+/// @returns The algorithm choice with its rationale.
+AlgorithmChoice SelectAlgorithm(const mef::Gate& target,
+                                const Settings& settings,
+                                const mef::Model* model = nullptr) noexcept;
+
+}  // namespace scram::core
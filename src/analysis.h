@@ -27,6 +27,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "settings.h"
+#include "statistics.h"
 
 namespace scram::core {
 
@@ -47,10 +48,16 @@ class Analysis : private boost::noncopyable {
   /// @returns Time taken by the analysis.
   double analysis_time() const { return analysis_time_; }
 
+  /// @returns Resource usage and data structure counters of the analysis.
+  const Statistics& statistics() const { return statistics_; }
+
  protected:
   /// @returns Modifiable analysis settings.
   Settings& settings() { return settings_; }
 
+  /// @returns Modifiable analysis statistics.
+  Statistics& statistics() { return statistics_; }
+
   /// Appends a warning message to the analysis warnings.
   /// Warnings are separated by spaces.
   ///
@@ -71,6 +78,7 @@ class Analysis : private boost::noncopyable {
  private:
   Settings settings_;  ///< All settings for analysis.
   double analysis_time_;  ///< Time taken by the analysis.
+  Statistics statistics_;  ///< Counters collected upon analysis.
   std::string warnings_;  ///< Generated warnings in analysis.
 };
 
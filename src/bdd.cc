@@ -20,6 +20,10 @@
 
 #include "bdd.h"
 
+#include <cstdlib>
+
+#include <optional>
+
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/range/algorithm.hpp>
 
@@ -38,12 +42,14 @@ int GetPrimeNumber(int n) {
   return n;
 }
 
-Bdd::Bdd(const Pdag* graph, const Settings& settings)
+Bdd::Bdd(const Pdag* graph, const Settings& settings,
+         std::int64_t max_vertices)
     : kSettings_(settings),
       coherent_(graph->coherent()),
       kOne_(new Terminal<Ite>(true)),
-      function_id_(2) {
-  TIMER(DEBUG3, "Converting PDAG into BDD");
+      function_id_(2),
+      max_vertices_(max_vertices) {
+  Timer<DEBUG3> timer("Converting PDAG into BDD");
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
     assert(top_gate.args().size() == 1);
@@ -59,8 +65,9 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
       index_to_order_.emplace(var.index(), var.order());
     }
   } else {
+    CompactPdag compact_graph(*graph);
     std::unordered_map<int, std::pair<Function, int>> gates;
-    root_ = ConvertGraph(graph->root(), &gates);
+    root_ = ConvertGraph(compact_graph, compact_graph.root(), &gates);
     root_.complement ^= graph->complement();
   }
   ClearMarks(false);
@@ -72,18 +79,56 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
   ClearMarks(false);
   LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
   ClearMarks(false);
+  statistics_.Add("bdd-vertices", function_id_ - 1);
+  statistics_.Add("bdd-unique-table", unique_table_.size());
   if (coherent_) {  // Clear tables if no more calculations are expected.
     Freeze();
   } else {  // To be used by ZBDD for prime implicant calculations.
     ClearTables();
   }
+  LOG(DEBUG4) << "# of computed results: " << num_results_;
+  LOG(DEBUG4) << "# of computed table hits: " << num_hits_;
+  statistics_.Add("bdd-computed-results", num_results_);
+  statistics_.Add("bdd-cache-hits", num_hits_);
+  statistics_.Add("bdd-modules", modules_.size());
+  for (const Statistics::Counter& counter : statistics_.counters())
+    timer.Add(counter.first, counter.second);
+}
+
+Bdd::Bdd(const Bdd& source, const std::unordered_map<int, bool>& constants,
+         const Settings& settings)
+    : kSettings_(settings),
+      coherent_(source.coherent_),
+      index_to_order_(source.index_to_order_),
+      kOne_(new Terminal<Ite>(true)),
+      function_id_(2) {
+  Timer<DEBUG3> timer("Restricting BDD");
+  std::unordered_map<int, Function> results;
+  root_ = Restrict(source, source.root_.vertex, constants, &results);
+  root_.complement ^= source.root_.complement;
+  ClearMarks(false);
+  TestStructure(root_.vertex);
+  ClearMarks(false);
+  LOG(DEBUG4) << "# of BDD vertices after restriction: " << function_id_ - 1;
+  statistics_.Add("bdd-vertices", function_id_ - 1);
+  statistics_.Add("bdd-unique-table", unique_table_.size());
+  statistics_.Add("bdd-restricted-variables", constants.size());
+  if (coherent_) {
+    Freeze();
+  } else {
+    ClearTables();
+  }
+  statistics_.Add("bdd-modules", modules_.size());
+  for (const Statistics::Counter& counter : statistics_.counters())
+    timer.Add(counter.first, counter.second);
 }
 
 Bdd::~Bdd() noexcept = default;
 
 void Bdd::Analyze(const Pdag* graph) noexcept {
-  zbdd_ = std::make_unique<Zbdd>(this, kSettings_);
+  zbdd_ = std::make_unique<Zbdd>(this, kSettings_, graph);
   zbdd_->Analyze(graph);
+  statistics_.Merge(zbdd_->statistics());
   if (!coherent_)  // The BDD has been used by the ZBDD.
     Freeze();
 }
@@ -117,49 +162,50 @@ ItePtr Bdd::FindOrAddVertex(const ItePtr& ite, const VertexPtr& high,
   return in_table;
 }
 
-ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                            const VertexPtr& low,
+ItePtr Bdd::FindOrAddVertex(const CompactPdag& graph, int gate,
+                            const VertexPtr& high, const VertexPtr& low,
                             bool complement_edge) noexcept {
-  assert(gate.module() && "Only module gates are expected for proxies.");
+  assert(graph.module(gate) && "Only module gates are expected for proxies.");
   ItePtr in_table =
-      FindOrAddVertex(gate.index(), high, low, complement_edge, gate.order());
+      FindOrAddVertex(gate, high, low, complement_edge, graph.order(gate));
   if (in_table->unique()) {
-    in_table->module(gate.module());
-    in_table->coherent(gate.coherent());
+    in_table->module(true);
+    in_table->coherent(graph.coherent(gate));
   }
-  assert(in_table->module() == gate.module());
-  assert(in_table->coherent() == gate.coherent());
+  assert(in_table->module());
+  assert(in_table->coherent() == graph.coherent(gate));
   return in_table;
 }
 
 Bdd::Function Bdd::ConvertGraph(
-    const Gate& gate,
+    const CompactPdag& graph, int gate,
     std::unordered_map<int, std::pair<Function, int>>* gates) noexcept {
-  assert(!gate.constant() && "Unexpected constant gate!");
+  assert(graph.type(gate) != kNull && "Unexpected constant gate!");
   Function result;  // For the NRVO, due to memoization.
   // Memoization check.
-  if (auto it_entry = ext::find(*gates, gate.index())) {
+  if (auto it_entry = ext::find(*gates, gate)) {
     std::pair<Function, int>& entry = it_entry->second;
     result = entry.first;
-    assert(entry.second < gate.parents().size());  // Processed parents.
-    if (++entry.second == gate.parents().size())
+    assert(entry.second < graph.num_parents(gate));  // Processed parents.
+    if (++entry.second == graph.num_parents(gate))
       gates->erase(it_entry);
     return result;
   }
   std::vector<Function> args;
-  for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
-    args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
-  }
-  for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
-    if (arg.second.module()) {
+  for (int arg : graph.args(gate)) {
+    int index = std::abs(arg);
+    if (!graph.IsGate(index)) {
+      args.push_back({arg < 0, FindOrAddVertex(index, kOne_, kOne_, true,
+                                               graph.order(index))});
+      index_to_order_.emplace(index, graph.order(index));
+      continue;
+    }
+    Function res = ConvertGraph(graph, index, gates);
+    if (graph.module(index)) {
       args.push_back(
-          {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
+          {arg < 0, FindOrAddVertex(graph, index, kOne_, kOne_, true)});
     } else {
-      bool complement = (arg.first < 0) ^ res.complement;
+      bool complement = (arg < 0) ^ res.complement;
       args.push_back({complement, res.vertex});
     }
   }
@@ -172,15 +218,61 @@ Bdd::Function Bdd::ConvertGraph(
   });
   auto it = args.cbegin();
   for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
-                   it->complement);
+    result = Apply(graph.type(gate), result.vertex, it->vertex,
+                   result.complement, it->complement);
   }
   ClearTables();
   assert(result.vertex);
-  if (gate.module())
-    modules_.emplace(gate.index(), result);
-  if (gate.parents().size() > 1)
-    gates->insert({gate.index(), {result, 1}});
+  if (graph.module(gate))
+    modules_.emplace(gate, result);
+  if (graph.num_parents(gate) > 1)
+    gates->insert({gate, {result, 1}});
+  return result;
+}
+
+Bdd::Function Bdd::Restrict(const Bdd& source, const VertexPtr& vertex,
+                            const std::unordered_map<int, bool>& constants,
+                            std::unordered_map<int, Function>* results) noexcept {
+  if (vertex->terminal())
+    return {false, kOne_};
+  if (auto it = ext::find(*results, vertex->id()))
+    return it->second;
+  ItePtr ite = Ite::Ptr(vertex);
+  auto restrict_branch = [&](bool value) {
+    if (value)
+      return Restrict(source, ite->high(), constants, results);
+    Function low = Restrict(source, ite->low(), constants, results);
+    low.complement ^= ite->complement_edge();
+    return low;
+  };
+  std::optional<bool> value;
+  if (ite->module()) {
+    const Function& module = source.modules_.find(ite->index())->second;
+    Function restricted = Restrict(source, module.vertex, constants, results);
+    restricted.complement ^= module.complement;
+    if (restricted.vertex->terminal()) {
+      value = !restricted.complement;
+    } else {
+      modules_.emplace(ite->index(), std::move(restricted));
+    }
+  } else if (auto it = ext::find(constants, ite->index())) {
+    value = it->second;
+  }
+  Function result;
+  if (value) {
+    result = restrict_branch(*value);
+  } else {
+    Function high = restrict_branch(true);
+    Function low = restrict_branch(false);
+    if (high.vertex == low.vertex && high.complement == low.complement) {
+      result = high;
+    } else {  // The high edge is kept regular.
+      result = {high.complement,
+                FindOrAddVertex(ite, high.vertex, low.vertex,
+                                low.complement ^ high.complement)};
+    }
+  }
+  results->emplace(vertex->id(), result);
   return result;
 }
 
@@ -221,8 +313,10 @@ Bdd::Function Bdd::Apply<kAnd>(const VertexPtr& arg_one,
   }
   std::pair<int, int> min_max_id =
       GetMinMaxId(arg_one, arg_two, complement_one, complement_two);
-  if (auto it = ext::find(and_table_, min_max_id))
+  if (auto it = ext::find(and_table_, min_max_id)) {
+    ++num_hits_;
     return it->second;
+  }
   Function result = Apply<kAnd>(Ite::Ptr(arg_one), Ite::Ptr(arg_two),
                                 complement_one, complement_two);
   and_table_.emplace(min_max_id, result);
@@ -252,8 +346,10 @@ Bdd::Function Bdd::Apply<kOr>(const VertexPtr& arg_one,
   }
   std::pair<int, int> min_max_id =
       GetMinMaxId(arg_one, arg_two, complement_one, complement_two);
-  if (auto it = ext::find(or_table_, min_max_id))
+  if (auto it = ext::find(or_table_, min_max_id)) {
+    ++num_hits_;
     return it->second;
+  }
   Function result = Apply<kOr>(Ite::Ptr(arg_one), Ite::Ptr(arg_two),
                                complement_one, complement_two);
   or_table_.emplace(min_max_id, result);
@@ -263,6 +359,8 @@ Bdd::Function Bdd::Apply<kOr>(const VertexPtr& arg_one,
 template <Connective Type>
 Bdd::Function Bdd::Apply(ItePtr ite_one, ItePtr ite_two, bool complement_one,
                          bool complement_two) noexcept {
+  if (kSettings_.cancelled() || exhausted())
+    return {false, kOne_};  // The incomplete BDD is discarded anyway.
   if (ite_one->order() > ite_two->order()) {
     ite_one.swap(ite_two);
     std::swap(complement_one, complement_two);
@@ -308,9 +406,13 @@ Bdd::Function Bdd::Apply(Connective type, const VertexPtr& arg_one,
 
 Bdd::Function Bdd::CalculateConsensus(const ItePtr& ite,
                                       bool complement) noexcept {
-  ClearTables();
-  return Apply<kAnd>(ite->high(), ite->low(), complement,
-                     ite->complement_edge() ^ complement);
+  Function& result = consensus_table_[complement ? -ite->id() : ite->id()];
+  if (!result) {
+    ClearTables();
+    result = Apply<kAnd>(ite->high(), ite->low(), complement,
+                         ite->complement_edge() ^ complement);
+  }
+  return result;
 }
 
 int Bdd::CountIteNodes(const VertexPtr& vertex) noexcept {
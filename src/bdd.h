@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 #include <algorithm>
 #include <forward_list>
@@ -35,6 +36,7 @@
 
 #include "pdag.h"
 #include "settings.h"
+#include "statistics.h"
 
 namespace scram::core {
 
@@ -731,11 +733,33 @@ class Bdd : private boost::noncopyable {
   ///
   /// @param[in] graph  Preprocessed and partially normalized PDAG.
   /// @param[in] settings  The analysis settings.
+  /// @param[in] max_vertices  The budget of vertices for the construction
+  ///                          or 0 for no limit.
   ///
   /// @pre The PDAG has variable ordering.
   ///
   /// @note BDD construction may take considerable time.
-  Bdd(const Pdag* graph, const Settings& settings);
+  ///
+  /// @warning The BDD exceeding the vertex budget is incomplete
+  ///          and must be discarded.
+  Bdd(const Pdag* graph, const Settings& settings,
+      std::int64_t max_vertices = 0);
+
+  /// Constructs the restriction (cofactor) of another BDD
+  /// with some of its variables fixed to constants.
+  /// The result is an independent ROBDD
+  /// with the same variable order and modules as the source.
+  ///
+  /// @param[in] source  The BDD with the variables to restrict.
+  /// @param[in] constants  The values of the restricted variable indices.
+  /// @param[in] settings  The analysis settings.
+  ///
+  /// @pre The restricted variables are not module gates.
+  ///
+  /// @note The restriction is linear in the size of the source BDD,
+  ///       which is much cheaper than the BDD construction from the PDAG.
+  Bdd(const Bdd& source, const std::unordered_map<int, bool>& constants,
+      const Settings& settings);
 
   /// To handle incomplete ZBDD type with unique pointers.
   ~Bdd() noexcept;
@@ -754,6 +778,11 @@ class Bdd : private boost::noncopyable {
   /// @returns true if the BDD has been constructed from a coherent PDAG.
   bool coherent() const { return coherent_; }
 
+  /// @returns true if the construction has exceeded the vertex budget.
+  bool exhausted() const {
+    return max_vertices_ && function_id_ - 1 > max_vertices_;
+  }
+
   /// Helper function to clear and set vertex marks.
   ///
   /// @param[in] mark  Desired mark for BDD vertices.
@@ -778,6 +807,10 @@ class Bdd : private boost::noncopyable {
     return *zbdd_;
   }
 
+  /// @returns Data structure counters of the BDD
+  ///          and the products after the analysis.
+  const Statistics& statistics() const { return statistics_; }
+
  private:
   using IteWeakPtr = WeakIntrusivePtr<Ite>;  ///< Pointer in containers.
   using ComputeTable = CacheTable<Function>;  ///< Computation results.
@@ -815,7 +848,8 @@ class Bdd : private boost::noncopyable {
 
   /// Find or adds a BDD ITE vertex using information from gates.
   ///
-  /// @param[in] gate  Gate with index, order, and other information.
+  /// @param[in] graph  The compact PDAG with the gate.
+  /// @param[in] gate  The index of the gate.
   /// @param[in] high  The new high vertex.
   /// @param[in] low  The new low vertex.
   /// @param[in] complement_edge  Interpretation of the low vertex.
@@ -825,23 +859,38 @@ class Bdd : private boost::noncopyable {
   /// @pre The gate is a module.
   ///
   /// @warning This function is not aware of reduction rules.
-  ItePtr FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                         const VertexPtr& low, bool complement_edge) noexcept;
+  ItePtr FindOrAddVertex(const CompactPdag& graph, int gate,
+                         const VertexPtr& high, const VertexPtr& low,
+                         bool complement_edge) noexcept;
 
   /// Converts all gates in the PDAG
   /// into function BDD graphs.
   /// Registers processed gates.
   ///
-  /// @param[in] gate  The root or current parent gate of the graph.
+  /// @param[in] graph  The compact PDAG.
+  /// @param[in] gate  The index of the root or current parent gate.
   /// @param[in,out] gates  Processed gates with use counts.
   ///
   /// @returns The BDD function representing the gate.
   ///
   /// @pre The memoization container is not used outside of this function.
   Function ConvertGraph(
-      const Gate& gate,
+      const CompactPdag& graph, int gate,
       std::unordered_map<int, std::pair<Function, int>>* gates) noexcept;
 
+  /// Restricts a function graph of the source BDD
+  /// into a function graph of this BDD.
+  ///
+  /// @param[in] source  The source BDD.
+  /// @param[in] vertex  The root vertex of the source function graph.
+  /// @param[in] constants  The values of the restricted variable indices.
+  /// @param[in,out] results  The memoized results by source vertex IDs.
+  ///
+  /// @returns The restricted function in this BDD.
+  Function Restrict(const Bdd& source, const VertexPtr& vertex,
+                    const std::unordered_map<int, bool>& constants,
+                    std::unordered_map<int, Function>* results) noexcept;
+
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
   /// @param[in] arg_one  First argument function graph.
@@ -911,6 +960,8 @@ class Bdd : private boost::noncopyable {
                  bool complement_two) noexcept;
 
   /// Calculates consensus of high and low of an if-then-else BDD vertex.
+  /// The consensus results are kept until the freeze
+  /// for the repeated calculations with different limits on products.
   ///
   /// @param[in] ite  The BDD vertex with the input.
   /// @param[in] complement  Interpretation of the BDD vertex.
@@ -945,6 +996,7 @@ class Bdd : private boost::noncopyable {
 
   /// Clears all memoization tables.
   void ClearTables() noexcept {
+    num_results_ += and_table_.size() + or_table_.size();
     and_table_.clear();
     or_table_.clear();
   }
@@ -958,6 +1010,7 @@ class Bdd : private boost::noncopyable {
     ClearTables();
     and_table_.reserve(0);
     or_table_.reserve(0);
+    consensus_table_ = {};
   }
 
   const Settings kSettings_;  ///< Analysis settings.
@@ -980,10 +1033,18 @@ class Bdd : private boost::noncopyable {
   ComputeTable or_table_;
   /// @}
 
+  /// The consensus of vertices with their IDs as keys.
+  /// Complement vertices have negative IDs.
+  std::unordered_map<int, Function> consensus_table_;
+
   std::unordered_map<int, Function> modules_;  ///< Module graphs.
   std::unordered_map<int, int> index_to_order_;  ///< Indices and orders.
   const TerminalPtr kOne_;  ///< Terminal True.
   int function_id_;  ///< Identification assignment for new function graphs.
+  std::int64_t max_vertices_ = 0;  ///< The construction budget or 0.
+  std::int64_t num_results_ = 0;  ///< The number of memoized computations.
+  std::int64_t num_hits_ = 0;  ///< The number of reused computations.
+  Statistics statistics_;  ///< Counters of the BDD and its products.
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
 };
 
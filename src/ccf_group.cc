@@ -22,10 +22,13 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <iterator>
 #include <utility>
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/algorithm.hpp>
 
 #include "error.h"
 #include "expression/constant.h"
@@ -36,16 +39,18 @@
 
 namespace scram::mef {
 
-CcfEvent::CcfEvent(std::vector<Gate*> members, const CcfGroup* ccf_group)
+CcfEvent::CcfEvent(std::vector<const BasicEvent*> members,
+                   const CcfGroup* ccf_group)
     : BasicEvent(MakeName(members), ccf_group->base_path(), ccf_group->role()),
       ccf_group_(*ccf_group),
       members_(std::move(members)) {}
 
-std::string CcfEvent::MakeName(const std::vector<Gate*>& members) {
+std::string CcfEvent::MakeName(const std::vector<const BasicEvent*>& members) {
   return "[" +
          boost::join(members | boost::adaptors::transformed(
-                                   [](const Gate* gate) -> decltype(auto) {
-                                     return gate->name();
+                                   [](const BasicEvent* member)
+                                       -> decltype(auto) {
+                                     return member->name();
                                    }),
                      " ") +
          "]";
@@ -137,47 +142,49 @@ void CcfGroup::Validate() const {
 }
 
 void CcfGroup::ApplyModel() {
-  // Construct replacement proxy gates for member basic events.
-  std::vector<std::pair<Gate*, Formula::ArgSet>> proxy_gates;
-  for (BasicEvent* member : members_) {
-    auto new_gate = std::make_unique<Gate>(member->name(), member->base_path(),
-                                           member->role());
-    assert(member->id() == new_gate->id());
-    proxy_gates.push_back({new_gate.get(), {}});
-    member->ccf_gate(std::move(new_gate));
-  }
-
-  ExpressionMap probabilities = this->CalculateProbabilities();
-  assert(probabilities.size() > 1);
-
-  // Generate CCF events.
-  for (auto& [level, prob] : probabilities) {
-    using Iterator = decltype(proxy_gates)::iterator;
-    auto combination_visitor = [this, prob](Iterator it_begin,
-                                            Iterator it_end) {
-      std::vector<Gate*> combination;
-      for (auto it = it_begin; it != it_end; ++it)
-        combination.push_back(it->first);
-
-      auto ccf_event = std::make_unique<CcfEvent>(std::move(combination), this);
-
-      for (auto it = it_begin; it != it_end; ++it)
-        it->second.Add(ccf_event.get());
+  probabilities_ = this->CalculateProbabilities();
+  assert(probabilities_.size() > 1);
+  assert(probabilities_.front().first == 1 && "Missing independent failures.");
+  for (BasicEvent* member : members_)
+    member->ccf_group(this);
+}
 
-      ccf_event->expression(prob);
-      ccf_events_.emplace_back(std::move(ccf_event));
+void CcfGroup::CollectEvents(const BasicEvent& member, double cut_off,
+                             std::vector<const CcfEvent*>* events) const {
+  assert(!probabilities_.empty() && "The model is not applied.");
+  int index = std::distance(members_.begin(), boost::find(members_, &member));
+  assert(index < members_.size() && "Not a member of the group.");
+  std::vector<int> others;  // The other members to combine with the member.
+  for (int i = 0; i < members_.size(); ++i) {
+    if (i != index)
+      others.push_back(i);
+  }
 
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [level, prob] : probabilities_) {
+    if (level > 1 && prob->interval().upper() < cut_off)
+      continue;  // The number of combinations grows with 2^n.
+    auto combination_visitor = [this, index, prob = prob, events](
+                                   std::vector<int>::iterator it_begin,
+                                   std::vector<int>::iterator it_end) {
+      std::vector<int> combination(it_begin, it_end);
+      combination.push_back(index);
+      std::sort(combination.begin(), combination.end());
+      std::unique_ptr<CcfEvent>& ccf_event = ccf_events_[combination];
+      if (!ccf_event) {
+        std::vector<const BasicEvent*> combination_members;
+        for (int i : combination)
+          combination_members.push_back(members_[i]);
+        ccf_event =
+            std::make_unique<CcfEvent>(std::move(combination_members), this);
+        ccf_event->expression(prob);
+      }
+      events->push_back(ccf_event.get());
       return false;
     };
-    ext::for_each_combination(proxy_gates.begin(),
-                              std::next(proxy_gates.begin(), level),
-                              proxy_gates.end(), combination_visitor);
-  }
-
-  // Assign formulas to the proxy gates.
-  for (std::pair<Gate*, Formula::ArgSet>& gate : proxy_gates) {
-    assert(gate.second.size() >= 2);
-    gate.first->formula(std::make_unique<Formula>(kOr, std::move(gate.second)));
+    ext::for_each_combination(others.begin(),
+                              std::next(others.begin(), level - 1),
+                              others.end(), combination_visitor);
   }
 }
 
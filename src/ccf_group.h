@@ -24,7 +24,9 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -54,14 +56,13 @@ class CcfEvent : public BasicEvent {
   /// @param[in] members  The members that this CCF event
   ///                     represents as multiple failure.
   /// @param[in] ccf_group  The CCF group that created this event.
-  CcfEvent(std::vector<Gate*> members, const CcfGroup* ccf_group);
+  CcfEvent(std::vector<const BasicEvent*> members, const CcfGroup* ccf_group);
 
   /// @returns The CCF group that created this CCF event.
   const CcfGroup& ccf_group() const { return ccf_group_; }
 
   /// @returns Members of this CCF event.
-  ///          The members also own this CCF event through parentship.
-  const std::vector<Gate*>& members() const { return members_; }
+  const std::vector<const BasicEvent*>& members() const { return members_; }
 
  private:
   /// Creates a mangled name
@@ -70,10 +71,10 @@ class CcfEvent : public BasicEvent {
   /// @param[in] members  The members that this CCF event represents.
   ///
   /// @returns The name string valid only for internal uses.
-  static std::string MakeName(const std::vector<Gate*>& members);
+  static std::string MakeName(const std::vector<const BasicEvent*>& members);
 
   const CcfGroup& ccf_group_;  ///< The originating CCF group.
-  std::vector<Gate*> members_;  ///< Member parent gates of this CCF event.
+  std::vector<const BasicEvent*> members_;  ///< Members of this CCF event.
 };
 
 /// Abstract base class for all common cause failure models.
@@ -139,12 +140,37 @@ class CcfGroup : public Id {
   void Validate() const;
 
   /// Processes the given factors and members
-  /// to create common cause failure probabilities and new events
-  /// that can replace the members in a fault tree.
+  /// to create common cause failure probabilities
+  /// for the combination levels of the members.
+  /// The members are marked for replacement by CCF events;
+  /// however, the events themselves are created on demand
+  /// by CollectEvents.
   ///
   /// @pre The CCF is validated.
   void ApplyModel();
 
+  /// Collects the CCF events that replace a member in analysis.
+  /// The events of member combinations are created on the first request
+  /// and shared by all the requests afterwards,
+  /// so the combinations of the members absent from analyses
+  /// are never created.
+  ///
+  /// Combination levels are negligible
+  /// if the upper bound of their probability is below the cut-off,
+  /// so the bound holds for any sampled value of the expressions as well.
+  /// The independent failure level of the member is always kept.
+  ///
+  /// @param[in] member  The member basic event of this group.
+  /// @param[in] cut_off  The cut-off probability for CCF events.
+  /// @param[out] events  The CCF events of the member combinations.
+  ///
+  /// @pre The model is applied.
+  ///
+  /// @note The events are created under a lock
+  ///       for analyses in different threads.
+  void CollectEvents(const BasicEvent& member, double cut_off,
+                     std::vector<const CcfEvent*>* events) const;
+
  protected:
   /// Mapping expressions and their application levels.
   using ExpressionMap = std::vector<std::pair<int, Expression*>>;
@@ -196,8 +222,10 @@ class CcfGroup : public Id {
   ExpressionMap factors_;  ///< CCF factors for models to get CCF probabilities.
   /// Collection of expressions created specifically for this group.
   std::vector<std::unique_ptr<Expression>> expressions_;
-  /// CCF events created by the group.
-  std::vector<std::unique_ptr<CcfEvent>> ccf_events_;
+  ExpressionMap probabilities_;  ///< The probabilities of combination levels.
+  mutable std::mutex mutex_;  ///< The guard of the CCF event creation.
+  /// CCF events created by the group for member index combinations.
+  mutable std::map<std::vector<int>, std::unique_ptr<CcfEvent>> ccf_events_;
 };
 
 /// Common cause failure model that assumes,
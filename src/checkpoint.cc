@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the analysis checkpoints in files.
+
+#include "checkpoint.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+
+#include <memory>
+#include <utility>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+#include <boost/filesystem.hpp>
+
+#include "env.h"
+#include "error.h"
+#include "logger.h"
+#include "shard_merger.h"
+#include "xml.h"
+#include "xml_stream.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram {
+
+namespace {
+
+/// @returns The text for the exact round trip of the value.
+std::string ToText(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+/// @returns The number of points in the parameter sweep of the settings.
+int NumSweepPoints(const core::Settings& settings) {
+  int num_points = 1;
+  for (const core::SweepAxis& axis : settings.sweep())
+    num_points *= axis.values.size();
+  return num_points;
+}
+
+}  // namespace
+
+CheckpointFile::CheckpointFile(std::string path,
+                               const core::Settings& settings, double interval,
+                               bool resume)
+    : path_(std::move(path)),
+      settings_(settings),
+      interval_(interval),
+      last_save_(std::chrono::steady_clock::now()) {
+  if (!resume)
+    return;
+  if (!fs::exists(path_)) {
+    LOG(INFO) << "No checkpoint to resume from: " << path_;
+    return;
+  }
+  Load();
+}
+
+void CheckpointFile::Load() {
+  static xml::Validator validator(env::checkpoint_schema());
+
+  xml::Document document(path_, &validator);
+  xml::Element root = document.root();
+  std::int64_t num_trials = settings_.num_trials();
+  std::int64_t first = num_trials * settings_.shard() / settings_.num_shards();
+  std::int64_t last =
+      num_trials * (settings_.shard() + 1) / settings_.num_shards();
+  if (root.attribute<int>("seed") != settings_.seed() ||
+      root.attribute<std::int64_t>("trials") != num_trials ||
+      root.attribute<int>("shard") != settings_.shard() ||
+      root.attribute<int>("shards") != settings_.num_shards() ||
+      root.attribute<int>("sweep-points") != NumSweepPoints(settings_) ||
+      root.attribute<bool>("importance") != settings_.importance_analysis()) {
+    SCRAM_THROW(SettingsError("The checkpoint is from a different analysis."))
+        << boost::errinfo_file_name(path_);
+  }
+  for (const xml::Element& element : root.children("target")) {
+    Target& target = targets_[std::string(element.attribute("key"))];
+    if (std::optional<xml::Element> statistics =
+            element.child("sufficient-statistics")) {
+      target.samples = ReadSampleStatistics(*statistics);
+      if (target.samples->count() > last - first) {
+        SCRAM_THROW(SettingsError("The checkpoint has too many trials."))
+            << boost::errinfo_file_name(path_)
+            << boost::errinfo_at_line(statistics->line());
+      }
+    }
+    if (std::optional<xml::Element> sweep = element.child("sweep")) {
+      for (const xml::Element& point_element : sweep->children("point")) {
+        core::SweepAnalysis::Point& point = target.points.emplace_back();
+        std::optional<double> p_total =
+            point_element.attribute<double>("p-total");
+        point.valid = p_total.has_value();
+        point.p_total = p_total.value_or(0);
+        for (const xml::Element& factors :
+             point_element.children("importance")) {
+          point.importance.push_back({*factors.attribute<int>("occurrence"),
+                                      *factors.attribute<double>("mif"),
+                                      *factors.attribute<double>("cif"),
+                                      *factors.attribute<double>("dif"),
+                                      *factors.attribute<double>("raw"),
+                                      *factors.attribute<double>("rrw")});
+        }
+      }
+      if (target.points.size() > NumSweepPoints(settings_)) {
+        SCRAM_THROW(SettingsError("The checkpoint has too many sweep points."))
+            << boost::errinfo_file_name(path_)
+            << boost::errinfo_at_line(sweep->line());
+      }
+    }
+  }
+  LOG(INFO) << "Resuming the analysis of " << targets_.size()
+            << " targets from the checkpoint: " << path_;
+}
+
+core::SampleStatistics CheckpointFile::samples(
+    const core::RiskAnalysis::Result::Id& id) const {
+  auto it = targets_.find(TargetKey(id));
+  if (it == targets_.end() || !it->second.samples)
+    return {};
+  LOG(DEBUG2) << "Resuming the uncertainty analysis after "
+              << it->second.samples->count() << " trials";
+  return *it->second.samples;
+}
+
+std::vector<core::SweepAnalysis::Point> CheckpointFile::points(
+    const core::RiskAnalysis::Result::Id& id) const {
+  auto it = targets_.find(TargetKey(id));
+  if (it == targets_.end())
+    return {};
+  LOG(DEBUG2) << "Resuming the parameter sweep after "
+              << it->second.points.size() << " points";
+  return it->second.points;
+}
+
+void CheckpointFile::Record(const core::RiskAnalysis::Result::Id& id,
+                            const core::SampleStatistics& samples) noexcept {
+  targets_[TargetKey(id)].samples = samples;
+  Update();
+}
+
+void CheckpointFile::Record(
+    const core::RiskAnalysis::Result::Id& id,
+    const std::vector<core::SweepAnalysis::Point>& points,
+    int num_points) noexcept {
+  std::vector<core::SweepAnalysis::Point>& recorded =
+      targets_[TargetKey(id)].points;
+  assert(recorded.size() <= num_points && "Unordered recording of points.");
+  recorded.insert(recorded.end(), points.begin() + recorded.size(),
+                  points.begin() + num_points);
+  Update();
+}
+
+void CheckpointFile::Update() noexcept {
+  if (std::chrono::steady_clock::now() - last_save_ >= interval_)
+    Save();
+}
+
+void CheckpointFile::Save() noexcept {
+  // The complete file replaces the old checkpoint
+  // only after a successful write.
+  std::string temp_file = path_ + ".tmp";
+  try {
+    Write(temp_file);
+    if (std::rename(temp_file.c_str(), path_.c_str())) {
+      SCRAM_THROW(IOError("Cannot replace the checkpoint file."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_name(path_);
+    }
+    LOG(DEBUG2) << "Saved the checkpoint: " << path_;
+  } catch (const std::exception& err) {
+    LOG(ERROR) << "Failed to save the checkpoint " << path_ << ": "
+               << err.what();
+  }
+  last_save_ = std::chrono::steady_clock::now();
+}
+
+void CheckpointFile::Write(const std::string& file) const {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+      std::fopen(file.c_str(), "w"), &std::fclose);
+  if (!fp) {
+    SCRAM_THROW(IOError("Cannot open the checkpoint file."))
+        << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w")
+        << boost::errinfo_file_name(file);
+  }
+  xml::Stream xml_stream(fp.get(), /*indent=*/false);
+  xml::StreamElement root = xml_stream.root("checkpoint");
+  root.SetAttribute("seed", settings_.seed())
+      .SetAttribute("trials", settings_.num_trials())
+      .SetAttribute("shard", settings_.shard())
+      .SetAttribute("shards", settings_.num_shards())
+      .SetAttribute("sweep-points", NumSweepPoints(settings_))
+      .SetAttribute("importance", settings_.importance_analysis());
+  for (const auto& [key, target] : targets_) {
+    xml::StreamElement element = root.AddChild("target");
+    element.SetAttribute("key", key);
+    if (target.samples)
+      WriteSampleStatistics(*target.samples, settings_, &element);
+    if (target.points.empty())
+      continue;
+    xml::StreamElement sweep = element.AddChild("sweep");
+    for (const core::SweepAnalysis::Point& point : target.points) {
+      xml::StreamElement point_element = sweep.AddChild("point");
+      if (point.valid)
+        point_element.SetAttribute("p-total", ToText(point.p_total));
+      for (const core::ImportanceFactors& factors : point.importance) {
+        point_element.AddChild("importance")
+            .SetAttribute("occurrence", factors.occurrence)
+            .SetAttribute("mif", ToText(factors.mif))
+            .SetAttribute("cif", ToText(factors.cif))
+            .SetAttribute("dif", ToText(factors.dif))
+            .SetAttribute("raw", ToText(factors.raw))
+            .SetAttribute("rrw", ToText(factors.rrw));
+      }
+    }
+  }
+}
+
+}  // namespace scram
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Checkpoints of the analysis progress in files.
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "risk_analysis.h"
+#include "settings.h"
+#include "sweep_analysis.h"
+#include "uncertainty_analysis.h"
+
+namespace scram {
+
+/// The analysis checkpoint in an XML file.
+/// The file is replaced atomically with the recorded progress
+/// at most once per the save interval
+/// and upon the completion or cancellation of the analysis.
+class CheckpointFile : public core::RiskAnalysis::Checkpoint {
+ public:
+  /// @param[in] path  The checkpoint file.
+  /// @param[in] settings  The settings of the analysis.
+  /// @param[in] interval  The minimum time in seconds between the saves.
+  /// @param[in] resume  The flag to load the progress from the existing file.
+  ///
+  /// @throws IOError  The existing file is not accessible.
+  /// @throws xml::Error  The existing file is not a valid checkpoint.
+  /// @throws SettingsError  The checkpoint is from different analysis settings.
+  ///
+  /// @note The model is expected to be the same as for the checkpoint.
+  CheckpointFile(std::string path, const core::Settings& settings,
+                 double interval, bool resume);
+
+  core::SampleStatistics samples(
+      const core::RiskAnalysis::Result::Id& id) const override;
+
+  std::vector<core::SweepAnalysis::Point> points(
+      const core::RiskAnalysis::Result::Id& id) const override;
+
+  void Record(const core::RiskAnalysis::Result::Id& id,
+              const core::SampleStatistics& samples) noexcept override;
+
+  void Record(const core::RiskAnalysis::Result::Id& id,
+              const std::vector<core::SweepAnalysis::Point>& points,
+              int num_points) noexcept override;
+
+  /// @note The failures to write the file are only logged,
+  ///       so the analysis continues with the older checkpoint.
+  void Save() noexcept override;
+
+ private:
+  /// The recorded progress of an analysis target.
+  struct Target {
+    std::optional<core::SampleStatistics> samples;  ///< The first trials.
+    std::vector<core::SweepAnalysis::Point> points;  ///< The first points.
+  };
+
+  /// Loads the recorded progress from the file.
+  ///
+  /// @throws IOError  The file is not accessible.
+  /// @throws xml::Error  The file is not a valid checkpoint.
+  /// @throws SettingsError  The checkpoint is from different settings.
+  void Load();
+
+  /// Saves the recorded progress if the save interval has elapsed.
+  void Update() noexcept;
+
+  /// Writes the recorded progress into the file.
+  ///
+  /// @param[in] file  The destination file.
+  ///
+  /// @throws IOError  The file cannot be written.
+  void Write(const std::string& file) const;
+
+  std::string path_;  ///< The checkpoint file.
+  core::Settings settings_;  ///< The analysis settings.
+  std::chrono::duration<double> interval_;  ///< The minimum save period.
+  std::chrono::steady_clock::time_point last_save_;  ///< The last save time.
+  std::map<std::string, Target> targets_;  ///< The progress by target keys.
+};
+
+}  // namespace scram
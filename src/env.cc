@@ -42,6 +42,12 @@ const std::string& report_schema() {
   return schema_path;
 }
 
+const std::string& checkpoint_schema() {
+  static const std::string schema_path =
+      install_dir() + "/share/scram/checkpoint.rng";
+  return schema_path;
+}
+
 const std::string& install_dir() {
   static const std::string install_path =
       boost::dll::program_location()  // executable
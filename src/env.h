@@ -37,6 +37,9 @@ const std::string& input_schema();
 /// @returns The location of the RELAX NG schema for output report files.
 const std::string& report_schema();
 
+/// @returns The location of the RELAX NG schema for analysis checkpoints.
+const std::string& checkpoint_schema();
+
 /// @returns The path to the installation directory.
 const std::string& install_dir();
 
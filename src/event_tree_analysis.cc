@@ -19,6 +19,8 @@
 
 #include "event_tree_analysis.h"
 
+#include <boost/range/algorithm.hpp>
+
 #include "expression/numerical.h"
 #include "ext/find_iterator.h"
 #include "instruction.h"
@@ -35,15 +37,20 @@ EventTreeAnalysis::EventTreeAnalysis(
 namespace {  // The model cloning functions.
 
 /// Clones the formula by applying the set-instructions.
+/// Only the gates with arguments affected by the instructions are cloned;
+/// the rest of the model is shared with the clones.
 ///
-/// @param[in] formula  The formula to be deep-cloned.
+/// @param[in] formula  The formula to be cloned.
 /// @param[in] set_instructions  The set instructions to change arguments.
+/// @param[in,out] events  The memoized clones of events for the instructions.
 /// @param[in] clones  The storage container for newly created clones.
 ///
-/// @returns The deep-copy of the argument formula with new (changed) arguments.
+/// @returns The copy of the argument formula with new (changed) arguments.
+/// @returns nullptr if the formula is not affected by the instructions.
 std::unique_ptr<mef::Formula>
 Clone(const mef::Formula& formula,
-      const std::unordered_map<std::string, bool>& set_instructions,
+      const std::map<std::string, bool>& set_instructions,
+      std::unordered_map<const mef::Event*, mef::Formula::ArgEvent>* events,
       std::vector<std::unique_ptr<mef::Event>>* clones) noexcept {
   struct {
     mef::Formula::ArgEvent operator()(mef::BasicEvent* arg) { return arg; }
@@ -51,47 +58,113 @@ Clone(const mef::Formula& formula,
       if (auto it = ext::find(set_house, arg->id())) {
         if (it->second == arg->state())
           return arg;
+        if (auto it_clone = ext::find(*event_clones, arg))
+          return it_clone->second;
         auto clone = std::make_unique<mef::HouseEvent>(
             arg->name(), "__clone__." + arg->id(),
             mef::RoleSpecifier::kPrivate);
         clone->state(it->second);
         auto* ptr = clone.get();
         event_register->emplace_back(std::move(clone));
+        event_clones->emplace(arg, ptr);
         return ptr;
       }
       return arg;
     }
     mef::Formula::ArgEvent operator()(mef::Gate* arg) {
-      if (set_house.empty())
-        return arg;
-      auto clone = std::make_unique<mef::Gate>(
-          arg->name(), "__clone__." + arg->id(), mef::RoleSpecifier::kPrivate);
-      clone->formula(Clone(arg->formula(), set_house, event_register));
-      auto* ptr = clone.get();
-      event_register->emplace_back(std::move(clone));
-      return ptr;
+      if (auto it_clone = ext::find(*event_clones, arg))
+        return it_clone->second;
+      mef::Formula::ArgEvent result = arg;
+      if (std::unique_ptr<mef::Formula> formula =
+              Clone(arg->formula(), set_house, event_clones, event_register)) {
+        auto clone = std::make_unique<mef::Gate>(
+            arg->name(), "__clone__." + arg->id(),
+            mef::RoleSpecifier::kPrivate);
+        clone->formula(std::move(formula));
+        result = clone.get();
+        event_register->emplace_back(std::move(clone));
+      }
+      event_clones->emplace(arg, result);
+      return result;
     }
 
-    const std::unordered_map<std::string, bool>& set_house;
+    const std::map<std::string, bool>& set_house;
+    std::unordered_map<const mef::Event*, mef::Formula::ArgEvent>* event_clones;
     std::vector<std::unique_ptr<mef::Event>>* event_register;
-  } cloner{set_instructions, clones};
+  } cloner{set_instructions, events, clones};
 
+  bool changed = false;
   mef::Formula::ArgSet arg_set;
-  for (const mef::Formula::Arg& arg : formula.args())
-    arg_set.Add(std::visit(cloner, arg.event), arg.complement);
+  for (const mef::Formula::Arg& arg : formula.args()) {
+    mef::Formula::ArgEvent clone = std::visit(cloner, arg.event);
+    changed |= clone != arg.event;
+    arg_set.Add(clone, arg.complement);
+  }
+  if (!changed)
+    return nullptr;
 
   return std::make_unique<mef::Formula>(
       formula.connective(), std::move(arg_set), formula.min_number(),
       formula.max_number());
 }
 
-}  // namespace
+/// Scans the event tree walk for the instructions
+/// that make equivalent paths into forks collect different sequences.
+class PathScanner : public mef::NullVisitor {
+ public:
+  /// @returns true if the walk collects expressions,
+  ///          which are not merged but summed in sequences.
+  bool has_expressions() const { return has_expressions_; }
 
-EventTreeAnalysis::PathCollector::PathCollector(const PathCollector& other)
-    : expressions(other.expressions), set_instructions(other.set_instructions) {
-  for (const mef::FormulaPtr& formula : other.formulas)
-    formulas.push_back(std::make_unique<mef::Formula>(*formula));
-}
+  /// @returns true if the walk may depend on the functional event states.
+  bool has_tests() const { return has_tests_; }
+
+  /// Scans the branch and its targets only once.
+  void Scan(const mef::Branch& branch) {
+    if (!visited_.insert(&branch).second)
+      return;
+    for (const mef::Instruction* instruction : branch.instructions())
+      instruction->Accept(this);
+    std::visit([this](auto* target) { Scan(target); }, branch.target());
+  }
+
+  void Visit(const mef::CollectExpression*) override {
+    has_expressions_ = true;
+  }
+
+  void Visit(const mef::Link* link) override {
+    Scan(link->event_tree().initial_state());
+  }
+
+  void Visit(const mef::IfThenElse* ite) override {
+    has_tests_ = true;  // Conservative for any condition expression.
+    NullVisitor::Visit(ite);
+  }
+
+ private:
+  /// Scans the sequence instructions.
+  void Scan(const mef::Sequence* sequence) {
+    for (const mef::Instruction* instruction : sequence->instructions())
+      instruction->Accept(this);
+  }
+
+  /// Scans the paths of the fork.
+  void Scan(const mef::Fork* fork) {
+    for (const mef::Path& path : fork->paths())
+      Scan(path);
+  }
+
+  /// Scans the named branch.
+  void Scan(const mef::NamedBranch* branch) {
+    Scan(static_cast<const mef::Branch&>(*branch));
+  }
+
+  bool has_expressions_ = false;  ///< The walk collects expressions.
+  bool has_tests_ = false;  ///< The walk has conditional instructions.
+  std::unordered_set<const mef::Branch*> visited_;  ///< The scanned branches.
+};
+
+}  // namespace
 
 void EventTreeAnalysis::Analyze() noexcept {
   assert(initiating_event_.event_tree());
@@ -106,6 +179,14 @@ void EventTreeAnalysis::Analyze() noexcept {
     events_.emplace_back(std::move(gate));
     return address;
   };
+  // Shared collected formulas are represented by a single gate.
+  std::unordered_map<const mef::Formula*, mef::Gate*> formula_gates;
+  auto get_gate = [&formula_gates, &make_gate](const mef::Formula* formula) {
+    mef::Gate*& gate = formula_gates[formula];
+    if (!gate)
+      gate = make_gate(std::make_unique<mef::Formula>(*formula));
+    return gate;
+  };
 
   SequenceCollector collector{initiating_event_, *context_};
   CollectSequences(initiating_event_.event_tree()->initial_state(), &collector);
@@ -115,11 +196,12 @@ void EventTreeAnalysis::Analyze() noexcept {
     std::vector<mef::Expression*> arg_expressions;
     for (PathCollector& path_collector : sequence.second) {
       if (path_collector.formulas.size() == 1) {
-        gate_formulas.push_back(std::move(path_collector.formulas.front()));
+        gate_formulas.push_back(
+            std::make_unique<mef::Formula>(*path_collector.formulas.front()));
       } else if (path_collector.formulas.size() > 1) {
         mef::Formula::ArgSet arg_set;
-        for (mef::FormulaPtr& arg_formula : path_collector.formulas)
-          arg_set.Add(make_gate(std::move(arg_formula)));
+        for (const mef::Formula* arg_formula : path_collector.formulas)
+          arg_set.Add(get_gate(arg_formula));
 
         gate_formulas.push_back(
             std::make_unique<mef::Formula>(mef::kAnd, std::move(arg_set)));
@@ -186,12 +268,24 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       }
 
       void Visit(const mef::CollectFormula* collect_formula) override {
-        // clang-format off
-        collector_.path_collector_.formulas.push_back(
-            core::Clone(collect_formula->formula(),
-                        collector_.path_collector_.set_instructions,
-                        collector_.clones_));
-        // clang-format on
+        const mef::Formula* formula = &collect_formula->formula();
+        PathCollector& path = collector_.path_collector_;
+        if (!path.set_instructions.empty()) {
+          std::string state;  // The unique key for the instructions.
+          for (const auto& [name, value] : path.set_instructions)
+            state += name + (value ? "=1;" : "=0;");
+          CloneTable& table = collector_.result_->clones[state];
+          mef::FormulaPtr& clone = table.formulas[formula];
+          if (!clone) {
+            clone = core::Clone(*formula, path.set_instructions, &table.events,
+                                collector_.clones_);
+            if (!clone)  // Not affected by the instructions.
+              clone = std::make_unique<mef::Formula>(*formula);
+          }
+          formula = clone.get();
+        }
+        if (boost::find(path.formulas, formula) == path.formulas.end())
+          path.formulas.push_back(formula);
       }
 
       void Visit(const mef::CollectExpression* collect_expression) override {
@@ -210,11 +304,21 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       Visitor visitor(this);
       for (const mef::Instruction* instruction : sequence->instructions())
         instruction->Accept(&visitor);
-      if (!visitor.is_linked())
-        result_->sequences[sequence].push_back(std::move(path_collector_));
+      if (visitor.is_linked())
+        return;
+      if (path_collector_.expressions.empty() &&
+          !result_->formula_paths.emplace(sequence, path_collector_.formulas)
+               .second) {
+        return;  // The same formulas are already collected for the sequence.
+      }
+      result_->sequences[sequence].push_back(std::move(path_collector_));
     }
 
     void operator()(const mef::Fork* fork) const {
+      if (result_->merge_paths &&
+          !result_->fork_paths.emplace(path(fork)).second) {
+        return;  // The equivalent path is already walked into the fork.
+      }
       const std::string& name = fork->functional_event().name();
       assert(result_->context.functional_events.count(name) == false);
       std::string& state = result_->context.functional_events[name];
@@ -236,10 +340,26 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       std::visit(*this, branch->target());
     }
 
+    /// @returns The state of the current path into the fork.
+    ForkPath path(const mef::Fork* fork) const {
+      std::vector<const mef::Formula*> formulas = path_collector_.formulas;
+      boost::sort(formulas, std::less<>());
+      std::map<std::string, std::string> states;
+      if (result_->test_paths)
+        states.insert(result_->context.functional_events.begin(),
+                      result_->context.functional_events.end());
+      return {fork, std::move(formulas), path_collector_.set_instructions,
+              std::move(states)};
+    }
+
     SequenceCollector* result_;
     std::vector<std::unique_ptr<mef::Event>>* clones_;
     PathCollector path_collector_;
   };
+  PathScanner scanner;
+  scanner.Scan(initial_state);
+  result->merge_paths = !scanner.has_expressions();
+  result->test_paths = scanner.has_tests();
   context_->functional_events.clear();
   context_->initiating_event = initiating_event_.name();
   Collector{result, &events_}(&initial_state);  // NOLINT(whitespace/braces)
@@ -19,11 +19,17 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <boost/functional/hash.hpp>
+
 #include "analysis.h"
 #include "event.h"
 #include "event_tree.h"
@@ -68,14 +74,32 @@ class EventTreeAnalysis : public Analysis {
 
  private:
   /// Expressions and formulas collected in an event tree path.
+  /// The formulas are shared among paths and must not be modified.
   struct PathCollector {
-    PathCollector() = default;
-    PathCollector(const PathCollector&);  ///< Must deep copy formulas.
     std::vector<mef::Expression*> expressions;  ///< Multiplication arguments.
-    std::vector<mef::FormulaPtr> formulas;  ///< AND connective formulas.
-    std::unordered_map<std::string, bool> set_instructions;  ///< House events.
+    std::vector<const mef::Formula*> formulas;  ///< AND connective formulas.
+    std::map<std::string, bool> set_instructions;  ///< House events.
+  };
+
+  /// Clones of model constructs
+  /// for a specific state of set-house-event instructions.
+  struct CloneTable {
+    /// The clones of collected formulas.
+    std::unordered_map<const mef::Formula*, mef::FormulaPtr> formulas;
+    /// The clones of events or the original events unaffected by the state.
+    std::unordered_map<const mef::Event*, mef::Formula::ArgEvent> events;
   };
 
+  /// The state of a formula-only path entering a fork:
+  /// the collected formulas in the address order,
+  /// the set-house-event instructions,
+  /// and the functional event states if the walk tests them.
+  /// Equivalent paths into the same fork collect the same sequences.
+  using ForkPath =
+      std::tuple<const mef::Fork*, std::vector<const mef::Formula*>,
+                 std::map<std::string, bool>,
+                 std::map<std::string, std::string>>;
+
   /// Walks the event tree paths and collects sequences.
   struct SequenceCollector {
     const mef::InitiatingEvent& initiating_event;  ///< The analysis initiator.
@@ -83,6 +107,18 @@ class EventTreeAnalysis : public Analysis {
     /// Sequences with collected paths.
     std::unordered_map<const mef::Sequence*, std::vector<PathCollector>>
         sequences;
+    /// Formula-only paths already collected for sequences.
+    std::unordered_set<
+        std::pair<const mef::Sequence*, std::vector<const mef::Formula*>>,
+        boost::hash<
+            std::pair<const mef::Sequence*, std::vector<const mef::Formula*>>>>
+        formula_paths;
+    /// Clone tables mapped by the state of set-house-event instructions.
+    std::unordered_map<std::string, CloneTable> clones;
+    /// Paths already walked into forks.
+    std::unordered_set<ForkPath, boost::hash<ForkPath>> fork_paths;
+    bool merge_paths = false;  ///< Equivalent paths into forks are merged.
+    bool test_paths = false;  ///< The walk tests the functional event states.
   };
 
   /// Walks the branch and collects sequences with expressions if any.
@@ -105,6 +105,13 @@ class Expression : private boost::noncopyable {
   ///          may yield silent failure.
   virtual bool IsDeviate() noexcept;
 
+  /// Determines if the expression value may change between calls
+  /// without any change in the arguments or the model.
+  /// The values of volatile expressions are never cached.
+  ///
+  /// @returns true if the expression must be recomputed on every call.
+  virtual bool IsVolatile() noexcept { return false; }
+
   /// @returns A sampled value of this expression.
   double Sample() noexcept;
 
@@ -20,6 +20,10 @@
 
 #include "extern.h"
 
+#include <algorithm>
+#include <array>
+#include <optional>
+
 #include <boost/filesystem.hpp>
 
 namespace fs = boost::filesystem;
@@ -64,4 +68,66 @@ ExternLibrary::ExternLibrary(std::string name, std::string lib_path,
   }
 }
 
+ExternBatchFunction::ExternBatchFunction(std::string name,
+                                         const std::string& symbol,
+                                         const ExternLibrary& library,
+                                         int num_args, bool pure)
+    : ExternFunctionBase(std::move(name)),
+      fptr_(library.get<void(int, const double*, double*)>(symbol)),
+      num_args_(num_args) {
+  if (num_args_ < 0 || num_args_ > kMaxNumArgs) {
+    SCRAM_THROW(ValidityError("The number of batch function parameters '" +
+                              std::to_string(num_args_) +
+                              "' exceeds the number of allowed parameters '" +
+                              std::to_string(kMaxNumArgs) + "'"))
+        << errinfo_element(Element::name(), kTypeString);
+  }
+  if (pure)
+    memo_ = std::make_unique<ExternMemo<Arguments, double>>();
+}
+
+void ExternBatchFunction::operator()(int count, const double* args,
+                                     double* results) const noexcept {
+  if (!memo_)
+    return fptr_(count, args, results);
+
+  constexpr int kChunkSize = 256;  // Misses to compute without heap storage.
+  std::array<int, kChunkSize> misses;
+  std::array<double, kChunkSize * kMaxNumArgs> miss_args;
+  std::array<double, kChunkSize> miss_results;
+  int num_misses = 0;
+
+  auto get_row = [this, args](int row) {
+    Arguments key{};
+    std::copy_n(args + row * num_args_, num_args_, key.begin());
+    return key;
+  };
+  auto compute_misses = [&] {
+    fptr_(num_misses, miss_args.data(), miss_results.data());
+    for (int i = 0; i < num_misses; ++i) {
+      results[misses[i]] = miss_results[i];
+      memo_->emplace(get_row(misses[i]), miss_results[i]);
+    }
+    num_misses = 0;
+  };
+  for (int row = 0; row < count; ++row) {
+    if (std::optional<double> result = memo_->find(get_row(row))) {
+      results[row] = *result;
+      continue;
+    }
+    misses[num_misses] = row;
+    std::copy_n(args + row * num_args_, num_args_,
+                miss_args.begin() + num_misses * num_args_);
+    if (++num_misses == kChunkSize)
+      compute_misses();
+  }
+  if (num_misses)
+    compute_misses();
+}
+
+std::unique_ptr<Expression>
+ExternBatchFunction::apply(std::vector<Expression*> args) const {
+  return std::make_unique<ExternBatchExpression>(this, std::move(args));
+}
+
 }  // namespace scram::mef
@@ -20,9 +20,16 @@
 
 #pragma once
 
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -30,6 +37,7 @@
 #include <boost/exception/errinfo_nested_exception.hpp>
 #include <boost/exception_ptr.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/system/system_error.hpp>
 
 #include "src/element.h"
@@ -115,6 +123,46 @@ class ExternFunction<void> : public Element, public Usage {
 using ExternFunctionPtr = std::unique_ptr<ExternFunction<void>>;  ///< Base ptr.
 using ExternFunctionBase = ExternFunction<void>;  ///< To help Doxygen.
 
+/// Memoization of pure extern function results.
+/// The memo is shared by all the expressions calling the function,
+/// so the access is synchronized for concurrent evaluations.
+///
+/// @tparam Key  The hashable argument tuple type.
+/// @tparam R  The function result type.
+template <class Key, typename R>
+class ExternMemo {
+ public:
+  /// The upper bound for the number of memoized results.
+  /// The cache starts over after reaching the bound.
+  static constexpr std::size_t kMaxSize = 1 << 16;
+
+  /// @param[in] key  The function arguments.
+  ///
+  /// @returns The memoized result if any.
+  std::optional<R> find(const Key& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find(key);
+    if (it == results_.end())
+      return {};
+    return it->second;
+  }
+
+  /// Memoizes the result of the function with the arguments.
+  ///
+  /// @param[in] key  The function arguments.
+  /// @param[in] result  The function result.
+  void emplace(const Key& key, R result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (results_.size() >= kMaxSize)
+      results_.clear();
+    results_.emplace(key, result);
+  }
+
+ private:
+  std::unordered_map<Key, R, boost::hash<Key>> results_;  ///< The cache.
+  mutable std::mutex mutex_;  ///< The guard of the results.
+};
+
 /// Extern function abstraction to be referenced by expressions.
 ///
 /// @tparam R  Numeric return type.
@@ -134,15 +182,92 @@ class ExternFunction : public ExternFunctionBase {
   ///
   /// @param[in] symbol  The symbol name for the function in the library.
   /// @param[in] library  The dynamic library to lookup the function.
+  /// @param[in] pure  The function results depend only on the arguments,
+  ///                  so the results can be memoized.
   ///
   /// @throws DLError  There is no such symbol in the library.
   ExternFunction(std::string name, const std::string& symbol,
-                 const ExternLibrary& library)
+                 const ExternLibrary& library, bool pure = false)
       : ExternFunctionBase(std::move(name)),
-        fptr_(library.get<R(Args...)>(symbol)) {}
+        fptr_(library.get<R(Args...)>(symbol)) {
+    if (pure)
+      memo_ = std::make_unique<ExternMemo<std::tuple<Args...>, R>>();
+  }
+
+  /// @returns true if the function results are memoized.
+  bool pure() const { return memo_ != nullptr; }
 
   /// Calls the library function with the given numeric arguments.
-  R operator()(Args... args) const noexcept { return fptr_(args...); }
+  R operator()(Args... args) const noexcept {
+    if (!memo_)
+      return fptr_(args...);
+    std::tuple<Args...> key(args...);
+    if (std::optional<R> result = memo_->find(key))
+      return *result;
+    R result = fptr_(args...);
+    memo_->emplace(key, result);
+    return result;
+  }
+
+  /// @copydoc ExternFunction<void>::apply
+  std::unique_ptr<Expression>
+  apply(std::vector<Expression*> args) const override;
+
+ private:
+  const Pointer fptr_;  ///< The pointer to the extern function in a library.
+  /// The optional memoization of the pure function results.
+  std::unique_ptr<ExternMemo<std::tuple<Args...>, R>> memo_;
+};
+
+/// Extern function with the batch calling convention:
+///
+///     void symbol(int count, const double* args, double* results);
+///
+/// The library function computes the results for the count of argument rows
+/// given in the row-major order.
+/// All the parameters and the return value are of double type.
+class ExternBatchFunction : public ExternFunctionBase {
+  /// The library function pointer type.
+  using Pointer = void (*)(int count, const double* args, double* results);
+
+ public:
+  /// The max number of function parameters.
+  static constexpr int kMaxNumArgs = 5;
+
+  /// The fixed-size argument row.
+  using Arguments = std::array<double, kMaxNumArgs>;
+
+  /// @copydoc ExternFunction::ExternFunction
+  ///
+  /// @param[in] num_args  The number of function parameters.
+  ///
+  /// @throws ValidityError  The number of parameters is out of range.
+  ExternBatchFunction(std::string name, const std::string& symbol,
+                      const ExternLibrary& library, int num_args,
+                      bool pure = false);
+
+  /// @returns The number of function parameters.
+  int num_args() const { return num_args_; }
+
+  /// @returns true if the function results are memoized.
+  bool pure() const { return memo_ != nullptr; }
+
+  /// Computes the function for many argument rows in a single library call.
+  /// The memoized rows of pure functions are not passed to the library,
+  /// and the rest of the rows are passed in chunks of limited size.
+  ///
+  /// @param[in] count  The number of argument rows.
+  /// @param[in] args  The row-major arguments of size count * num_args.
+  /// @param[out] results  The destination for the count of results.
+  void operator()(int count, const double* args, double* results) const
+      noexcept;
+
+  /// Computes the function for a single argument row.
+  double operator()(const Arguments& args) const noexcept {
+    double result = 0;
+    (*this)(1, args.data(), &result);
+    return result;
+  }
 
   /// @copydoc ExternFunction<void>::apply
   std::unique_ptr<Expression>
@@ -150,6 +275,9 @@ class ExternFunction : public ExternFunctionBase {
 
  private:
   const Pointer fptr_;  ///< The pointer to the extern function in a library.
+  const int num_args_;  ///< The number of function parameters.
+  /// The optional memoization of the pure function results.
+  std::unique_ptr<ExternMemo<Arguments, double>> memo_;
 };
 
 /// Expression evaluating an extern function with expression arguments.
@@ -173,6 +301,8 @@ class ExternExpression
           ValidityError("The number of function arguments does not match."));
   }
 
+  bool IsVolatile() noexcept override { return !extern_function_.pure(); }
+
   /// Computes the extern function with the given evaluator for arguments.
   template <typename F>
   double Compute(F&& eval) noexcept {
@@ -200,6 +330,79 @@ class ExternExpression
   const ExternFunction<R, Args...>& extern_function_;  ///< The source function.
 };
 
+/// Expression evaluating an extern function with the batch calling convention.
+///
+/// The samples of the expression in many Monte Carlo trials
+/// can be computed with a single library call
+/// by recording the argument rows of the trials first.
+class ExternBatchExpression : public ExpressionFormula<ExternBatchExpression> {
+ public:
+  /// @param[in] extern_function  The library function.
+  /// @param[in] args  The argument expression for the function.
+  ///
+  /// @throws ValidityError  The number of arguments is invalid.
+  explicit ExternBatchExpression(const ExternBatchFunction* extern_function,
+                                 std::vector<Expression*> args)
+      : ExpressionFormula<ExternBatchExpression>(std::move(args)),
+        extern_function_(*extern_function) {
+    if (Expression::args().size() != extern_function_.num_args())
+      SCRAM_THROW(
+          ValidityError("The number of function arguments does not match."));
+  }
+
+  bool IsVolatile() noexcept override { return !extern_function_.pure(); }
+
+  /// Starts recording the argument rows of the next samples
+  /// instead of calling the library function.
+  /// The recorded samples are only placeholders.
+  ///
+  /// @pre The placeholder values do not affect other recorded values.
+  void RecordSamples() noexcept {
+    recording_ = true;
+    rows_.clear();
+    num_rows_ = 0;
+  }
+
+  /// Computes the function for all the recorded rows in one library call
+  /// and stops the recording.
+  void ComputeSamples() noexcept {
+    assert(recording_ && "The samples are not recorded.");
+    recording_ = false;
+    samples_.resize(num_rows_);
+    extern_function_(num_rows_, rows_.data(), samples_.data());
+  }
+
+  /// @param[in] row  The index of the sample in the recording order.
+  ///
+  /// @returns The computed sample of the recorded row.
+  double sample(int row) const {
+    assert(row < samples_.size());
+    return samples_[row];
+  }
+
+  /// Computes the extern function with the given evaluator for arguments.
+  template <typename F>
+  double Compute(F&& eval) noexcept {
+    ExternBatchFunction::Arguments values{};
+    for (int i = 0; i < extern_function_.num_args(); ++i)
+      values[i] = eval(Expression::args()[i]);
+    if (recording_) {
+      rows_.insert(rows_.end(), values.begin(),
+                   values.begin() + extern_function_.num_args());
+      ++num_rows_;
+      return 0;
+    }
+    return extern_function_(values);
+  }
+
+ private:
+  const ExternBatchFunction& extern_function_;  ///< The source function.
+  bool recording_ = false;  ///< The indicator of recording the samples.
+  int num_rows_ = 0;  ///< The number of recorded rows.
+  std::vector<double> rows_;  ///< The recorded row-major arguments.
+  std::vector<double> samples_;  ///< The computed samples of the rows.
+};
+
 template <typename R, typename... Args>
 std::unique_ptr<Expression>
 ExternFunction<R, Args...>::apply(std::vector<Expression*> args) const {
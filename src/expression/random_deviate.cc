@@ -36,7 +36,22 @@
 
 namespace scram::mef {
 
-std::mt19937 RandomDeviate::rng_;
+void RandomEngine::seed(std::uint64_t seed, std::uint64_t stream) noexcept {
+  auto split_mix = [](std::uint64_t* x) {
+    std::uint64_t z = (*x += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+  };
+  // The streams of the same seed start from distinct SplitMix64 states.
+  std::uint64_t x = seed;
+  x = split_mix(&x) ^ stream;
+  for (result_type& word : state_)
+    word = split_mix(&x);
+}
+
+std::uint64_t RandomDeviate::seed_ = RandomEngine::kDefaultSeed;
+RandomEngine RandomDeviate::rng_;
 
 UniformDeviate::UniformDeviate(Expression* min, Expression* max)
     : RandomDeviate({min, max}), min_(*min), max_(*max) {}
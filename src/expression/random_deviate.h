@@ -21,6 +21,9 @@
 
 #pragma once
 
+#include <cstdint>
+
+#include <array>
 #include <memory>
 #include <random>
 #include <vector>
@@ -31,6 +34,59 @@
 
 namespace scram::mef {
 
+/// The xoshiro256** pseudo-random number generator
+/// with the state initialized by SplitMix64.
+/// Unlike the Mersenne Twister,
+/// the generator is cheap to reseed,
+/// so every Monte Carlo trial can draw from its own stream
+/// independent of the other trials.
+class RandomEngine {
+ public:
+  using result_type = std::uint64_t;  ///< UniformRandomBitGenerator.
+
+  static constexpr std::uint64_t kDefaultSeed = 5489;  ///< Unspecified seed.
+
+  /// @returns The smallest generated value.
+  static constexpr result_type min() { return 0; }
+
+  /// @returns The largest generated value.
+  static constexpr result_type max() { return ~result_type(0); }
+
+  /// @param[in] seed  The seed of the stream family.
+  /// @param[in] stream  The index of the stream within the family.
+  explicit RandomEngine(std::uint64_t seed = kDefaultSeed,
+                        std::uint64_t stream = 0) {
+    this->seed(seed, stream);
+  }
+
+  /// Resets the generator to the start of the stream.
+  ///
+  /// @param[in] seed  The seed of the stream family.
+  /// @param[in] stream  The index of the stream within the family.
+  void seed(std::uint64_t seed, std::uint64_t stream = 0) noexcept;
+
+  /// @returns The next value in the stream.
+  result_type operator()() noexcept {
+    result_type result = rotl(state_[1] * 5, 7) * 9;
+    result_type t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+  }
+
+ private:
+  /// @returns The bits rotated to the left.
+  static result_type rotl(result_type x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::array<result_type, 4> state_;  ///< The generator state.
+};
+
 /// Abstract base class for all deviate expressions.
 /// These expressions provide quantification for uncertainty and sensitivity.
 ///
@@ -45,19 +101,31 @@ class RandomDeviate : public Expression {
 
   bool IsDeviate() noexcept override { return true; }
 
-  /// Sets the seed of the underlying random number generator.
+  /// Sets the seed of the underlying random number generator
+  /// and starts its first stream.
   ///
   /// @param[in] seed  The seed for RNGs.
   ///
   /// @note This is static! Used by all the deriving deviates.
-  static void seed(unsigned seed) noexcept { rng_.seed(seed); }
+  static void seed(unsigned seed) noexcept {
+    seed_ = seed;
+    rng_.seed(seed_);
+  }
+
+  /// Restarts the underlying random number generator
+  /// with a stream of the current seed.
+  /// The same stream always produces the same samples.
+  ///
+  /// @param[in] index  The index of the stream, e.g., the Monte Carlo trial.
+  static void stream(std::uint64_t index) noexcept { rng_.seed(seed_, index); }
 
  protected:
   /// @returns RNG to be used by derived classes.
-  std::mt19937& rng() { return rng_; }
+  RandomEngine& rng() { return rng_; }
 
  private:
-  static std::mt19937 rng_;  ///< The random number generator.
+  static std::uint64_t seed_;  ///< The seed of the streams.
+  static RandomEngine rng_;  ///< The random number generator.
 };
 
 /// Uniform distribution.
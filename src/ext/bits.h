@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace ext {
 
 /// Tests the value of a bit.
@@ -64,4 +66,24 @@ constexpr int one_bit_index(std::uint64_t bits) noexcept {
   return count_trailing_zero_bits(bits);
 }
 
+/// Maps an integer into a single bit of a 64-bit Bloom signature.
+/// Consecutive values map into distinct bits modulo 64.
+///
+/// @param[in] value  Any integer value including negative numbers.
+///
+/// @returns The signature with a single bit set for the value.
+constexpr std::uint64_t signature_bit(int value) noexcept {
+  return std::uint64_t(1) << (static_cast<unsigned>(value) % 64);
+}
+
+/// Tests if a set may be a subset of another set with their signatures.
+///
+/// @param[in] sub  The signature of the candidate subset.
+/// @param[in] super  The signature of the candidate superset.
+///
+/// @returns false if the subset relation is impossible.
+constexpr bool may_be_subset(std::uint64_t sub, std::uint64_t super) noexcept {
+  return !(sub & ~super);
+}
+
 }  // namespace ext
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Minimal facilities for concurrent processing of independent work items.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ext {
+
+/// Applies a function to every element of a random access range
+/// with as many worker threads as the hardware supports.
+/// The elements are handed out to the workers one at a time,
+/// so uneven workloads are balanced dynamically.
+///
+/// @tparam RandomAccessRange  Container with random access to elements.
+/// @tparam Function  Non-throwing callable with a range element argument.
+///
+/// @param[in,out] range  The independent work items.
+/// @param[in] fn  The processing function safe for concurrent calls
+///                on distinct elements.
+/// @param[in] max_threads  The maximum number of threads
+///                         (0 for the hardware concurrency).
+///
+/// @note The calling thread participates in the processing.
+template <class RandomAccessRange, class Function>
+void parallel_for_each(RandomAccessRange& range, Function fn,
+                       int max_threads = 0) noexcept {
+  const std::size_t size = range.size();
+  std::size_t num_threads = std::min<std::size_t>(
+      max_threads > 0 ? max_threads : std::thread::hardware_concurrency(),
+      size);
+  if (num_threads < 2) {
+    for (auto& element : range)
+      fn(element);
+    return;
+  }
+  std::atomic<std::size_t> next(0);
+  auto worker = [&range, &fn, &next, size] {
+    for (std::size_t i = next++; i < size; i = next++)
+      fn(range[i]);
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (std::size_t i = 1; i < num_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+}  // namespace ext
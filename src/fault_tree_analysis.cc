@@ -20,13 +20,19 @@
 
 #include "fault_tree_analysis.h"
 
+#include <cstdint>
+
 #include <iostream>
+#include <string>
+#include <unordered_set>
 #include <utility>
+#include <variant>
 
 #include <boost/container/flat_set.hpp>
 #include <boost/range/algorithm.hpp>
 
 #include "event.h"
+#include "ext/find_iterator.h"
 #include "logger.h"
 
 namespace scram::core {
@@ -83,11 +89,34 @@ void Print(const ProductContainer& products) {
   std::cerr << std::endl;
 }
 
+double GetCcfCutOff(const Settings& settings) noexcept {
+  if (!settings.ccf_analysis() || !settings.sweep().empty() ||
+      settings.compile_phases()) {
+    return 0;
+  }
+  return settings.cut_off();
+}
+
 ProductContainer::ProductContainer(const Zbdd& products,
                                    const Pdag& graph) noexcept
-    : products_(products), graph_(graph), size_(0) {
+    : zbdd_(&products), graph_(graph), size_(0) {
+  Collect();
+}
+
+ProductContainer::ProductContainer(std::vector<std::vector<int>> products,
+                                   const Pdag& graph) noexcept
+    : zbdd_(nullptr), list_(std::move(products)), graph_(graph), size_(0) {
+  Collect();
+}
+
+void ProductContainer::Collect() noexcept {
   Pdag::IndexMap<bool> filter(graph_.basic_events().size());
-  for (const std::vector<int>& product : products_) {
+  const_iterator it =
+      zbdd_ ? const_iterator(*zbdd_, false) : const_iterator(list_.begin());
+  const_iterator it_end =
+      zbdd_ ? const_iterator(*zbdd_, true) : const_iterator(list_.end());
+  for (; it != it_end; ++it) {
+    const std::vector<int>& product = *it;
     int order_index = product.empty() ? 0 : product.size() - 1;
     if (distribution_.size() <= order_index)
       distribution_.resize(order_index + 1);
@@ -102,6 +131,7 @@ ProductContainer::ProductContainer(const Zbdd& products,
       product_events_.insert(graph_.basic_events()[i]);
     }
   }
+  num_cut_off_ = it.num_cut_off();
 }
 
 double Product::p() const {
@@ -117,24 +147,43 @@ FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
                                      const mef::Model* model)
     : Analysis(settings), top_event_(root), model_(model) {}
 
+FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
+                                     const Settings& settings,
+                                     std::shared_ptr<Pdag> graph)
+    : Analysis(settings),
+      top_event_(root),
+      model_(nullptr),
+      graph_(std::move(graph)) {}
+
 void FaultTreeAnalysis::Analyze() noexcept {
   CLOCK(analysis_time);
-  graph_ = std::make_unique<Pdag>(top_event_,
-                                  Analysis::settings().ccf_analysis(), model_);
-  this->Preprocess(graph_.get());
+  TRACE("Fault tree analysis");
+  Statistics::Usage usage(&Analysis::statistics());
+  if (!graph_) {
+    graph_ = std::make_shared<Pdag>(
+        top_event_, Analysis::settings().ccf_analysis(), model_,
+        std::vector<const mef::HouseEvent*>(),
+        GetCcfCutOff(Analysis::settings()));
+    this->Preprocess(graph_.get());
+  }
 #ifndef NDEBUG
   if (Analysis::settings().preprocessor)
     return;  // Preprocessor only option.
 #endif
   CLOCK(algo_time);
   LOG(DEBUG2) << "Launching the algorithm...";
+  TraceSpan algo_span("Generating products");
   const Zbdd& products = this->GenerateProducts(graph_.get());
   LOG(DEBUG2) << "The algorithm finished in " << DUR(algo_time);
   LOG(DEBUG2) << "# of products: " << products.size();
+  if (algo_span)
+    algo_span.Add("products", products.size());
 
   Analysis::AddAnalysisTime(DUR(analysis_time));
   CLOCK(store_time);
+  TRACE("Storing products");
   Store(products, *graph_);
+  Analysis::statistics().Add("products", products_->size());
   LOG(DEBUG2) << "Stored the result for reporting in " << DUR(store_time);
 }
 
@@ -146,7 +195,26 @@ void FaultTreeAnalysis::Store(const Zbdd& products,
   } else if (products.base()) {
     Analysis::AddWarning("The set is UNITY/Base.");
   }
-  products_ = std::make_unique<const ProductContainer>(products, graph);
+  if (int num_products = Analysis::settings().top_products()) {
+    Pdag::IndexMap<double> p_vars;
+    p_vars.reserve(graph.basic_events().size());
+    for (const mef::BasicEvent* event : graph.basic_events())
+      p_vars.push_back(event->p());
+    products_ = std::make_unique<const ProductContainer>(
+        products.FindTopProducts(num_products, p_vars), graph);
+  } else {
+    products_ = std::make_unique<const ProductContainer>(products, graph);
+  }
+  if (Analysis::settings().prime_implicants()) {
+    Analysis::statistics().Add("pi-truncated-cut-off",
+                               products_->num_cut_off());
+  }
+  if (std::int64_t num_truncations =
+          Analysis::statistics().counter("pi-truncated-cut-off")) {
+    Analysis::AddWarning("Discarded " + std::to_string(num_truncations) +
+                         " branches of prime implicants"
+                         " below the cut-off probability.");
+  }
 
 #ifndef NDEBUG
   for (const Product& product : *products_)
@@ -158,4 +226,219 @@ void FaultTreeAnalysis::Store(const Zbdd& products,
 #endif
 }
 
+namespace {
+
+/// Gathers the intermediate gates of a fault tree.
+///
+/// @param[in] formula  The formula of the top event or a parent gate.
+/// @param[in,out] gates  The unique gates in the order of the first visit.
+/// @param[in,out] visited  The visited gates.
+void GatherGates(const mef::Formula& formula, std::vector<mef::Gate*>* gates,
+                 std::unordered_set<const mef::Gate*>* visited) noexcept {
+  for (const mef::Formula::Arg& arg : formula.args()) {
+    if (mef::Gate* const* gate = std::get_if<mef::Gate*>(&arg.event)) {
+      if (!visited->insert(*gate).second)
+        continue;
+      gates->push_back(*gate);
+      GatherGates((*gate)->formula(), gates, visited);
+    }
+  }
+}
+
+/// Orders the variables before the other nodes of the preprocessed PDAG.
+/// The orders of the variables are their positions starting from 1.
+///
+/// @param[in] indices  The indices of the variables in the new order.
+/// @param[in,out] graph  The PDAG with the topological order of the nodes.
+void OrderFirst(const std::vector<int>& indices, Pdag* graph) noexcept {
+  std::unordered_map<int, int> first;
+  for (int i = 0; i < indices.size(); ++i)
+    first.emplace(indices[i], i + 1);
+  std::unordered_set<int> ordered;  // The variables are visited per parent.
+  graph->Clear<Pdag::kGateMark>();
+  TraverseNodes(graph->root(), [&](auto&& node) {
+    if (!ordered.insert(node->index()).second)
+      return;
+    if (auto it = ext::find(first, node->index())) {
+      node->order(it->second);
+    } else {
+      node->order(node->order() + indices.size());
+    }
+  });
+}
+
+/// Calculates the probability of a BDD function graph.
+///
+/// @param[in] bdd  The host BDD of the function graph.
+/// @param[in] vertex  The root vertex of the function graph.
+/// @param[in] p_vars  The probabilities of the variables.
+/// @param[in,out] results  The memoized results by vertex IDs.
+///
+/// @returns The probability of the function graph.
+double CalculateProbability(const Bdd& bdd, const Bdd::VertexPtr& vertex,
+                            const Pdag::IndexMap<double>& p_vars,
+                            std::unordered_map<int, double>* results) noexcept {
+  if (vertex->terminal())
+    return 1;
+  if (auto it = ext::find(*results, vertex->id()))
+    return it->second;
+  const Ite& ite = Ite::Ref(vertex);
+  double p_var = 0;
+  if (ite.module()) {
+    const Bdd::Function& res = bdd.modules().find(ite.index())->second;
+    p_var = CalculateProbability(bdd, res.vertex, p_vars, results);
+    if (res.complement)
+      p_var = 1 - p_var;
+  } else {
+    p_var = p_vars[ite.index()];
+  }
+  double high = CalculateProbability(bdd, ite.high(), p_vars, results);
+  double low = CalculateProbability(bdd, ite.low(), p_vars, results);
+  if (ite.complement_edge())
+    low = 1 - low;
+  double p = p_var * high + (1 - p_var) * low;
+  results->emplace(vertex->id(), p);
+  return p;
+}
+
+}  // namespace
+
+FaultTreeCompilation::FaultTreeCompilation(
+    const mef::Gate& root,
+    const std::vector<const mef::HouseEvent*>& house_events,
+    const Settings& settings, const mef::Model* model) noexcept
+    : top_event_(root) {
+  CLOCK(compile_time);
+  TRACE("Fault tree compilation");
+  const mef::Gate& function = SelectGates(settings);
+  std::vector<const mef::HouseEvent*> variables = house_events;
+  for (const std::unique_ptr<mef::HouseEvent>& selector : selectors_)
+    variables.push_back(selector.get());
+  graph_ = std::make_shared<Pdag>(function, settings.ccf_analysis(), model,
+                                  variables, GetCcfCutOff(settings));
+  CustomPreprocessor<Bdd>{graph_.get()}();
+  if (!selectors_.empty()) {
+    std::vector<int> indices;
+    for (const std::unique_ptr<mef::HouseEvent>& selector : selectors_) {
+      auto it = boost::find_if(graph_->house_events(), [&](const auto& entry) {
+        return entry.first == selector.get();
+      });
+      assert(it != graph_->house_events().end() && "Missing selector.");
+      indices.push_back(it->second);
+    }
+    for (std::pair<const mef::Gate*, int>& gate : gates_)
+      gate.second = indices[gate.second];
+    OrderFirst(indices, graph_.get());
+  }
+  bdd_ = std::make_unique<Bdd>(graph_.get(), settings);
+  LOG(DEBUG2) << "Compiled the fault tree with "
+              << graph_->house_events().size() - selectors_.size()
+              << " symbolic house events and " << gates_.size()
+              << " selectable gates in " << DUR(compile_time);
+}
+
+FaultTreeCompilation::~FaultTreeCompilation() noexcept = default;
+
+const mef::Gate& FaultTreeCompilation::SelectGates(
+    const Settings& settings) noexcept {
+  if (!settings.gate_probabilities())
+    return top_event_;
+  std::vector<mef::Gate*> gates;
+  std::unordered_set<const mef::Gate*> visited;
+  GatherGates(top_event_.formula(), &gates, &visited);
+  if (const auto& ids = settings.probability_gates(); !ids.empty()) {
+    // The ids are validated in the model, but not all are in this tree.
+    auto is_unselected = [&ids](const mef::Gate* gate) {
+      return boost::find(ids, gate->id()) == ids.end();
+    };
+    gates.erase(boost::remove_if(gates, is_unselected), gates.end());
+  }
+  if (gates.empty())
+    return top_event_;
+  boost::sort(gates, [](const mef::Gate* lhs, const mef::Gate* rhs) {
+    return lhs->id() < rhs->id();
+  });
+
+  // The auxiliary names are not valid MEF identifiers
+  // to avoid clashes with the ids of the fault tree gates.
+  auto add_gate = [this](std::string name, mef::Formula formula) {
+    auto gate = std::make_unique<mef::Gate>(std::move(name));
+    gate->formula(std::make_unique<mef::Formula>(std::move(formula)));
+    return selections_.emplace_back(std::move(gate)).get();
+  };
+  std::vector<mef::Gate*> functions = {add_gate("top@", top_event_.formula())};
+  functions.insert(functions.end(), gates.begin(), gates.end());
+  for (int i = 0; i < functions.size(); ++i) {
+    selectors_.push_back(
+        std::make_unique<mef::HouseEvent>("selector@" + std::to_string(i)));
+    if (i)
+      gates_.emplace_back(functions[i], i);
+  }
+  selectors_.front()->state(true);
+
+  // The if-then-else chain of the selectors keeps the functions disjoint,
+  // so the compiled BDD is the chain of the selector vertices
+  // over the shared vertices of the functions.
+  using Arg = mef::Formula::Arg;
+  mef::Gate* chain =
+      add_gate("selection@", mef::Formula(mef::kAnd, {selectors_.back().get(),
+                                                       functions.back()}));
+  for (int i = functions.size() - 2; i >= 0; --i) {
+    std::string index = std::to_string(i);
+    mef::HouseEvent* selector = selectors_[i].get();
+    mef::Gate* then = add_gate(
+        "then@" + index, mef::Formula(mef::kAnd, {selector, functions[i]}));
+    mef::Gate* otherwise = add_gate(
+        "else@" + index,
+        mef::Formula(mef::kAnd, {Arg{true, selector}, Arg{false, chain}}));
+    chain = add_gate("selection@" + index,
+                     mef::Formula(mef::kOr, {then, otherwise}));
+  }
+  return *chain;
+}
+
+std::unordered_map<int, bool> FaultTreeCompilation::constants() const {
+  std::unordered_map<int, bool> values;
+  for (const auto& [house_event, index] : graph_->house_events())
+    values.emplace(index, house_event->state());
+  return values;
+}
+
+std::vector<std::pair<const mef::Gate*, double>>
+FaultTreeCompilation::CalculateGateProbabilities() const noexcept {
+  CLOCK(calc_time);
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(graph_->basic_events().size());
+  for (const mef::BasicEvent* event : graph_->basic_events())
+    p_vars.push_back(event->p());
+  for (const auto& [house_event, index] : graph_->house_events())
+    p_vars[index] = house_event->state();
+
+  // The selector vertices are on top of the shared functions of the gates,
+  // so the probabilities of the function vertices are calculated only once.
+  std::unordered_map<int, double> results;
+  std::vector<std::pair<const mef::Gate*, double>> probabilities;
+  for (const auto& [gate, selector] : gates_) {
+    Bdd::Function function = bdd_->root();
+    while (!function.vertex->terminal()) {
+      const Ite& ite = Ite::Ref(function.vertex);
+      if (ite.order() > selectors_.size())
+        break;
+      if (ite.index() == selector) {
+        function.vertex = ite.high();
+      } else {
+        function.vertex = ite.low();
+        function.complement ^= ite.complement_edge();
+      }
+    }
+    double p = 1;
+    if (!function.vertex->terminal())
+      p = CalculateProbability(*bdd_, function.vertex, p_vars, &results);
+    probabilities.emplace_back(gate, function.complement ? 1 - p : p);
+  }
+  LOG(DEBUG3) << "Calculated the probabilities of " << gates_.size()
+              << " gates in " << DUR(calc_time);
+  return probabilities;
+}
+
 }  // namespace scram::core
@@ -20,10 +20,15 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <boost/iterator/iterator_facade.hpp>
@@ -39,6 +44,7 @@ namespace scram::mef {  // Decouple from the analysis code.
 class Model;  // Provider of substitutions.
 class Gate;
 class BasicEvent;
+class HouseEvent;
 }  // namespace scram::mef
 
 namespace scram::core {
@@ -106,7 +112,55 @@ class Product {
 
 /// A container of analysis result products with Literals.
 /// This is a wrapper of the analysis resultant ZBDD to work with Literals.
+/// Alternatively, the container owns an explicit list of products
+/// to preserve their order, e.g., the most probable products.
 class ProductContainer {
+  /// Forward iterator over the products either in the ZBDD or in the list.
+  class const_iterator
+      : public boost::iterator_facade<const_iterator, const std::vector<int>,
+                                      boost::forward_traversal_tag> {
+    friend class boost::iterator_core_access;
+
+   public:
+    /// @param[in] products  The ZBDD with the products.
+    /// @param[in] sentinel  The flag for the end iterator.
+    const_iterator(const Zbdd& products, bool sentinel) {
+      zbdd_it_.emplace(products, sentinel);
+    }
+
+    /// @param[in] it  The position in the explicit list of products.
+    explicit const_iterator(std::vector<std::vector<int>>::const_iterator it)
+        : list_it_(it) {}
+
+    /// @returns The number of branches of products
+    ///          skipped so far for being below the cut-off probability.
+    std::int64_t num_cut_off() const {
+      return zbdd_it_ ? zbdd_it_->num_cut_off() : 0;
+    }
+
+   private:
+    /// Standard forward iterator functionality returning products.
+    /// @{
+    void increment() {
+      if (zbdd_it_)
+        ++*zbdd_it_;
+      else
+        ++list_it_;
+    }
+    bool equal(const const_iterator& other) const {
+      if (zbdd_it_)
+        return other.zbdd_it_ && *zbdd_it_ == *other.zbdd_it_;
+      return !other.zbdd_it_ && list_it_ == other.list_it_;
+    }
+    const std::vector<int>& dereference() const {
+      return zbdd_it_ ? **zbdd_it_ : *list_it_;
+    }
+    /// @}
+
+    std::optional<Zbdd::const_iterator> zbdd_it_;  ///< The ZBDD traversal.
+    std::vector<std::vector<int>>::const_iterator list_it_;  ///< The list.
+  };
+
   /// Converter of analysis products with indices into products with literals.
   struct ProductExtractor {
     /// @param[in] product  The product with indices from analysis results.
@@ -125,6 +179,15 @@ class ProductContainer {
   /// @param[in] graph  PDAG with basic event indices and pointers.
   ProductContainer(const Zbdd& products, const Pdag& graph) noexcept;
 
+  /// Takes the ownership of the ordered products.
+  ///
+  /// @param[in] products  Unique products with indices of events.
+  /// @param[in] graph  PDAG with basic event indices and pointers.
+  ///
+  /// @post The products are iterated in the given order.
+  ProductContainer(std::vector<std::vector<int>> products,
+                   const Pdag& graph) noexcept;
+
   /// @returns Collection of basic events that are in the products.
   const std::unordered_set<const mef::BasicEvent*>& product_events() const {
     return product_events_;
@@ -133,17 +196,19 @@ class ProductContainer {
   /// Begin and end iterators over products in the container.
   /// @{
   auto begin() const {
-    return boost::make_transform_iterator(products_.begin(),
-                                          ProductExtractor{graph_});
+    return boost::make_transform_iterator(
+        zbdd_ ? const_iterator(*zbdd_, false) : const_iterator(list_.begin()),
+        ProductExtractor{graph_});
   }
   auto end() const {
-    return boost::make_transform_iterator(products_.end(),
-                                          ProductExtractor{graph_});
+    return boost::make_transform_iterator(
+        zbdd_ ? const_iterator(*zbdd_, true) : const_iterator(list_.end()),
+        ProductExtractor{graph_});
   }
   /// @}
 
   /// @returns true if no products in the container.
-  bool empty() const { return products_.empty(); }
+  bool empty() const { return zbdd_ ? zbdd_->empty() : list_.empty(); }
 
   /// @returns The number of products in the container.
   int size() const { return size_; }
@@ -151,10 +216,19 @@ class ProductContainer {
   /// @returns The product distribution by order.
   const std::vector<int>& distribution() const { return distribution_; }
 
+  /// @returns The number of branches of products
+  ///          skipped for being below the cut-off probability.
+  std::int64_t num_cut_off() const { return num_cut_off_; }
+
  private:
-  const Zbdd& products_;  ///< Container of analysis results.
+  /// Gathers the size, distribution, and events of the products.
+  void Collect() noexcept;
+
+  const Zbdd* zbdd_;  ///< Container of analysis results if not a list.
+  std::vector<std::vector<int>> list_;  ///< The explicit list of products.
   const Pdag& graph_;  ///< The analysis graph.
   int size_;  ///< The number of products.
+  std::int64_t num_cut_off_;  ///< The skipped branches of products.
   std::vector<int> distribution_;  ///< Product counts by order.
   /// The set of events in the resultant products.
   std::unordered_set<const mef::BasicEvent*> product_events_;
@@ -171,6 +245,21 @@ class ProductContainer {
 /// @param[in] products  Valid, unique collection of analysis results.
 void Print(const ProductContainer& products);
 
+/// Determines the cut-off probability for the CCF group combinations
+/// in the PDAG of an analysis.
+/// The combinations are negligible against the bound of their probabilities
+/// at the construction of the PDAG;
+/// therefore, no combinations are cut off
+/// if the compiled analysis is requantified
+/// for parameter sweeps or alignment phases
+/// with values outside of these bounds.
+///
+/// @param[in] settings  The analysis settings.
+///
+/// @returns The cut-off probability for negligible CCF events,
+///          or 0 if all the combinations are relevant.
+double GetCcfCutOff(const Settings& settings) noexcept;
+
 /// Fault tree analysis functionality.
 /// The analysis must be done on
 /// a validated and fully initialized fault trees.
@@ -239,6 +328,15 @@ class FaultTreeAnalysis : public Analysis {
   }
 
  protected:
+  /// Reuses the preprocessed PDAG of the fault tree
+  /// shared with other analyses.
+  ///
+  /// @param[in] root  The top event of the fault tree to analyze.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] graph  The preprocessed PDAG of the fault tree.
+  FaultTreeAnalysis(const mef::Gate& root, const Settings& settings,
+                    std::shared_ptr<Pdag> graph);
+
   /// @returns Pointer to the PDAG representing the fault tree.
   const Pdag* graph() const { return graph_.get(); }
 
@@ -262,6 +360,9 @@ class FaultTreeAnalysis : public Analysis {
   virtual const Zbdd& GenerateProducts(const Pdag* graph) noexcept = 0;
 
   /// Stores resultant sets of products for future reporting.
+  /// If only the most probable products are requested,
+  /// the stored products are extracted from the analysis results
+  /// without the full enumeration.
   ///
   /// @param[in] products  Sets with indices of events from calculations.
   /// @param[in] graph  PDAG with basic event indices and pointers.
@@ -269,10 +370,86 @@ class FaultTreeAnalysis : public Analysis {
 
   const mef::Gate& top_event_;  ///< The root of the graph under analysis.
   const mef::Model* model_;  ///< The optional Model with substitutions.
-  std::unique_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
+  std::shared_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
   std::unique_ptr<const ProductContainer> products_;  ///< Container of results.
 };
 
+/// The BDD of a fault tree compiled once for multiple analyses.
+/// The house events set by the phases of an alignment
+/// are kept as symbolic variables,
+/// so the BDD of a phase is the restriction of the compiled BDD
+/// to the house event states of the phase
+/// instead of the reconstruction from the PDAG.
+///
+/// If the gate probabilities are requested,
+/// the compiled function selects the top event or an intermediate gate
+/// with the symbolic selector variables ordered before the other variables.
+/// The restriction to the top event selector gives the BDD of the top event,
+/// and the probabilities of the gates are calculated
+/// from the branches of their selectors in a single sweep over the BDD.
+/// Unlike the gates of the preprocessed PDAG,
+/// the selected functions are not lost in the preprocessing.
+class FaultTreeCompilation : private boost::noncopyable {
+ public:
+  /// Constructs, preprocesses, and compiles the PDAG of the fault tree.
+  ///
+  /// @param[in] root  The top event of the fault tree.
+  /// @param[in] house_events  The house events set by the phases.
+  /// @param[in] settings  The analysis settings.
+  /// @param[in] model  The Model containing substitutions if any.
+  FaultTreeCompilation(const mef::Gate& root,
+                       const std::vector<const mef::HouseEvent*>& house_events,
+                       const Settings& settings,
+                       const mef::Model* model = nullptr) noexcept;
+
+  ~FaultTreeCompilation() noexcept;
+
+  /// @returns The top event of the compiled fault tree.
+  const mef::Gate& top_event() const { return top_event_; }
+
+  /// @returns The preprocessed PDAG with the symbolic house events.
+  const std::shared_ptr<Pdag>& graph() const { return graph_; }
+
+  /// @returns The compiled BDD with the symbolic house events.
+  const Bdd& bdd() const { return *bdd_; }
+
+  /// @returns The values of the symbolic house event variables
+  ///          with the current states of the house events
+  ///          and the selection of the top event.
+  std::unordered_map<int, bool> constants() const;
+
+  /// @returns true if the compiled function includes the intermediate gates.
+  bool HasGates() const { return !gates_.empty(); }
+
+  /// Calculates the probabilities of the intermediate gates
+  /// with the current probabilities of the basic events
+  /// and the current states of the house events.
+  ///
+  /// @returns The gates sorted by their ids with their probabilities.
+  std::vector<std::pair<const mef::Gate*, double>> CalculateGateProbabilities()
+      const noexcept;
+
+ private:
+  /// Constructs the root of the compiled function
+  /// with the selectable top event and intermediate gates.
+  ///
+  /// @param[in] settings  The settings with the requested gates.
+  ///
+  /// @returns The root of the compiled function.
+  ///          The top event if there are no intermediate gates to select.
+  const mef::Gate& SelectGates(const Settings& settings) noexcept;
+
+  const mef::Gate& top_event_;  ///< The root of the compiled fault tree.
+  std::shared_ptr<Pdag> graph_;  ///< Shared with the phase analyses.
+  std::unique_ptr<Bdd> bdd_;  ///< The source of the phase restrictions.
+  /// The intermediate gates with the indices of their selector variables.
+  std::vector<std::pair<const mef::Gate*, int>> gates_;
+  /// The selectors of the top event (first) and the intermediate gates.
+  std::vector<std::unique_ptr<mef::HouseEvent>> selectors_;
+  /// The auxiliary gates of the selection.
+  std::vector<std::unique_ptr<mef::Gate>> selections_;
+};
+
 /// Fault tree analysis facility with specific algorithms.
 /// This class is meant to be specialized by fault tree analysis algorithms.
 ///
@@ -283,6 +460,34 @@ class FaultTreeAnalyzer : public FaultTreeAnalysis {
   using FaultTreeAnalysis::FaultTreeAnalysis;
   using FaultTreeAnalysis::graph;  // Provide access to other analyses.
 
+  /// Analyzes the top event by restriction of the compiled fault tree.
+  ///
+  /// @param[in] compilation  The compiled fault tree.
+  /// @param[in] settings  Analysis settings for all calculations.
+  ///
+  /// @pre The house events are in the states of the analysis.
+  /// @pre The compilation is alive until the end of the analysis.
+  FaultTreeAnalyzer(const FaultTreeCompilation& compilation,
+                    const Settings& settings)
+      : FaultTreeAnalysis(compilation.top_event(), settings,
+                          compilation.graph()),
+        compilation_(&compilation) {
+    static_assert(std::is_same_v<Algorithm, Bdd>, "Only BDD is compiled.");
+  }
+
+  /// Analyzes the top event with the BDD constructed beforehand.
+  ///
+  /// @param[in] root  The top event of the fault tree.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] graph  The PDAG preprocessed for BDD.
+  /// @param[in] bdd  The complete BDD of the graph.
+  FaultTreeAnalyzer(const mef::Gate& root, const Settings& settings,
+                    std::shared_ptr<Pdag> graph, std::unique_ptr<Bdd> bdd)
+      : FaultTreeAnalysis(root, settings, std::move(graph)),
+        algorithm_(std::move(bdd)) {
+    static_assert(std::is_same_v<Algorithm, Bdd>, "Only BDD is reused.");
+  }
+
   /// @returns The analysis algorithm for use by other analyses.
   /// @{
   const Algorithm* algorithm() const { return algorithm_.get(); }
@@ -295,12 +500,24 @@ class FaultTreeAnalyzer : public FaultTreeAnalysis {
   }
 
   const Zbdd& GenerateProducts(const Pdag* graph) noexcept override {
-    algorithm_ = std::make_unique<Algorithm>(graph, Analysis::settings());
+    if constexpr (std::is_same_v<Algorithm, Bdd>) {
+      if (compilation_) {
+        algorithm_ = std::make_unique<Bdd>(compilation_->bdd(),
+                                           compilation_->constants(),
+                                           Analysis::settings());
+        compilation_ = nullptr;  // The compilation may be released later.
+      }
+    }
+    if (!algorithm_)
+      algorithm_ = std::make_unique<Algorithm>(graph, Analysis::settings());
     algorithm_->Analyze(graph);
+    Analysis::statistics().Merge(algorithm_->statistics());
     return algorithm_->products();
   }
 
   std::unique_ptr<Algorithm> algorithm_;  ///< Analysis algorithm.
+  /// The optional source of the restricted BDD.
+  const FaultTreeCompilation* compilation_ = nullptr;
 };
 
 }  // namespace scram::core
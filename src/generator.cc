@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the synthetic model generation.
+
+#include "generator.h"
+
+#include <cerrno>
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+
+#include "error.h"
+#include "xml_stream.h"
+
+namespace scram::mef {
+
+namespace {
+
+/// Portable pseudo-random sampling.
+/// The standard distributions are implementation-defined,
+/// so only the raw engine output is used
+/// to produce the same models with any standard library.
+class Random {
+ public:
+  /// @param[in] seed  The seed of the engine.
+  explicit Random(std::uint32_t seed) : engine_(seed) {}
+
+  /// @returns A uniform number in [0, 1).
+  double Uniform() { return engine_() / 4294967296.0; }
+
+  /// @returns A uniform integer in [lower, upper].
+  int Uniform(int lower, int upper) {
+    return lower + static_cast<int>(Uniform() * (upper - lower + 1));
+  }
+
+  /// @returns true with the given chance.
+  bool Bernoulli(double chance) { return Uniform() < chance; }
+
+  /// @returns A number with uniformly distributed logarithm.
+  double LogUniform(double lower, double upper) {
+    return lower * std::pow(upper / lower, Uniform());
+  }
+
+ private:
+  std::mt19937 engine_;  ///< The standard-defined engine.
+};
+
+/// Argument of a synthetic gate.
+struct Arg {
+  bool is_gate;  ///< The argument is a gate or a basic event.
+  int index;  ///< The index of the node.
+
+  /// @returns true for the same nodes.
+  bool operator==(const Arg& other) const {
+    return is_gate == other.is_gate && index == other.index;
+  }
+};
+
+/// Synthetic gate.
+struct Gate {
+  const char* connective = "or";  ///< The MEF name of the connective.
+  int min_number = 0;  ///< The K of K/N gates.
+  std::vector<Arg> args;  ///< Unique arguments.
+};
+
+/// Builder of the synthetic model graph.
+class Generator {
+ public:
+  /// @param[in] settings  Valid parameters of the model.
+  explicit Generator(const GeneratorSettings& settings)
+      : settings_(settings), random_(settings.seed) {}
+
+  /// Generates the whole model.
+  ///
+  /// @throws SettingsError  Not enough basic events for CCF groups.
+  void Run();
+
+  /// Writes the generated model as MEF XML.
+  ///
+  /// @param[in,out] out  The destination stream.
+  ///
+  /// @throws IOError  The write operation has failed.
+  void Write(std::FILE* out) const;
+
+ private:
+  /// Grows a module breadth-first from its root.
+  ///
+  /// @param[in] num_gates  The number of gates in the module.
+  /// @param[in] num_events  The maximum number of module basic events.
+  ///
+  /// @returns The index of the module root gate.
+  int GrowModule(int num_gates, int num_events);
+
+  /// @returns The sampled number of gate arguments.
+  int NumArgs();
+
+  /// Samples an already existing node for the gate.
+  ///
+  /// @param[in] gate  The index of the gate.
+  /// @param[in] args  The current arguments of the gate.
+  /// @param[in] event_begin  The first basic event of the module.
+  /// @param[out] arg  The shared node.
+  ///
+  /// @returns false if the sample is not a new argument for the gate.
+  bool Share(int gate, const std::vector<Arg>& args, int event_begin,
+             Arg* arg);
+
+  /// Assigns basic events of modules to CCF groups.
+  void GroupCcf();
+
+  /// Writes forks of the event tree recursively.
+  ///
+  /// @param[in] level  The index of the functional event.
+  /// @param[in,out] sequence  The counter of sequences.
+  /// @param[in,out] parent  The parent element of the fork.
+  void WriteFork(int level, int* sequence, xml::StreamElement* parent) const;
+
+  const GeneratorSettings& settings_;  ///< The model parameters.
+  Random random_;  ///< The source of randomness.
+  std::vector<Gate> gates_;  ///< The top gate is the first.
+  std::vector<double> events_;  ///< The probabilities of basic events.
+  std::vector<int> modules_;  ///< The module root gates.
+  std::vector<int> module_events_;  ///< The first event of each module.
+  std::vector<std::vector<int>> ccf_groups_;  ///< Members of CCF groups.
+  std::vector<bool> ccf_members_;  ///< The basic events in CCF groups.
+};
+
+void Generator::Run() {
+  int num_modules = settings_.num_modules;
+  int num_gates = settings_.num_gates;
+  if (num_modules > 1) {
+    gates_.emplace_back();  // The top gate over independent modules.
+    --num_gates;
+  }
+  for (int i = 0; i < num_modules; ++i) {
+    int module_gates = num_gates / num_modules + (i < num_gates % num_modules);
+    int module_events = settings_.num_basic_events / num_modules +
+                        (i < settings_.num_basic_events % num_modules);
+    modules_.push_back(GrowModule(module_gates, module_events));
+  }
+  if (num_modules > 1) {
+    for (int root : modules_)
+      gates_.front().args.push_back({true, root});
+  }
+  GroupCcf();
+}
+
+int Generator::GrowModule(int num_gates, int num_events) {
+  int gate_begin = gates_.size();
+  int gate_end = gate_begin + num_gates;
+  int event_begin = events_.size();
+  int event_end = event_begin + num_events;
+  module_events_.push_back(event_begin);
+  gates_.emplace_back();
+  for (int i = gate_begin; i < gates_.size(); ++i) {
+    int num_args = NumArgs();
+    std::vector<Arg> args;
+    // The last pending gate must keep growing the graph until the budget.
+    if (i == gates_.size() - 1 && gates_.size() < gate_end) {
+      args.push_back({true, static_cast<int>(gates_.size())});
+      gates_.emplace_back();
+    }
+    while (args.size() < num_args) {
+      int remaining_gates = gate_end - gates_.size();
+      int remaining_events = event_end - events_.size();
+      Arg arg;
+      if (random_.Bernoulli(settings_.sharing) &&
+          Share(i, args, event_begin, &arg)) {
+        args.push_back(arg);
+      } else if (random_.Uniform() * (remaining_gates + remaining_events) <
+                 remaining_gates) {
+        args.push_back({true, static_cast<int>(gates_.size())});
+        gates_.emplace_back();
+      } else if (remaining_events) {
+        args.push_back({false, static_cast<int>(events_.size())});
+        events_.push_back(
+            random_.LogUniform(settings_.min_prob, settings_.max_prob));
+      } else {  // The event budget is exhausted; reuse the first unused one.
+        for (int j = event_begin; j < event_end; ++j) {
+          if (std::find(args.begin(), args.end(), Arg{false, j}) ==
+              args.end()) {
+            args.push_back({false, j});
+            break;
+          }
+        }
+      }
+    }
+    Gate& gate = gates_[i];
+    gate.args = std::move(args);
+    int num = gate.args.size();
+    if (num > 2 && random_.Bernoulli(settings_.atleast_ratio)) {
+      gate.connective = "atleast";
+      gate.min_number = random_.Uniform(2, num - 1);
+    } else if (random_.Bernoulli(settings_.and_ratio)) {
+      gate.connective = "and";
+    }
+  }
+  return gate_begin;
+}
+
+int Generator::NumArgs() {
+  int min_args = settings_.min_args;
+  int max_args = settings_.max_args;
+  if (settings_.fan_in == FanIn::kUniform)
+    return random_.Uniform(min_args, max_args);
+  // The untruncated mean is in the middle of the range.
+  double chance = 1 / (1 + (max_args - min_args) / 2.0);
+  int num_args = min_args;
+  while (num_args < max_args && !random_.Bernoulli(chance))
+    ++num_args;
+  return num_args;
+}
+
+bool Generator::Share(int gate, const std::vector<Arg>& args, int event_begin,
+                      Arg* arg) {
+  int num_pending = gates_.size() - gate - 1;  // Only these keep it acyclic.
+  int num_events = events_.size() - event_begin;
+  if (num_pending + num_events == 0)
+    return false;
+  int pick = random_.Uniform(0, num_pending + num_events - 1);
+  *arg = pick < num_pending ? Arg{true, gate + 1 + pick}
+                            : Arg{false, event_begin + pick - num_pending};
+  return std::find(args.begin(), args.end(), *arg) == args.end();
+}
+
+void Generator::GroupCcf() {
+  ccf_members_.assign(events_.size(), false);
+  int num_modules = modules_.size();
+  for (int module = 0; module < num_modules; ++module) {
+    int num_groups = settings_.num_ccf_groups / num_modules +
+                     (module < settings_.num_ccf_groups % num_modules);
+    if (!num_groups)
+      continue;
+    int begin = module_events_[module];
+    int end = module + 1 < num_modules ? module_events_[module + 1]
+                                       : static_cast<int>(events_.size());
+    int num_members = num_groups * settings_.ccf_group_size;
+    if (num_members > end - begin)
+      SCRAM_THROW(SettingsError("Not enough basic events for CCF groups."));
+    std::vector<int> events(end - begin);
+    for (int i = 0; i < events.size(); ++i)
+      events[i] = begin + i;
+    for (int i = 0; i < num_members; ++i)  // Partial Fisher-Yates shuffle.
+      std::swap(events[i], events[random_.Uniform(i, events.size() - 1)]);
+    for (int i = 0; i < num_members; i += settings_.ccf_group_size) {
+      ccf_groups_.emplace_back(events.begin() + i,
+                               events.begin() + i + settings_.ccf_group_size);
+      for (int member : ccf_groups_.back())
+        ccf_members_[member] = true;
+    }
+  }
+}
+
+/// @returns The unique name of a gate.
+std::string GateName(int index) {
+  return index ? "G" + std::to_string(index) : "Top";
+}
+
+/// @returns The unique name of a basic event.
+std::string EventName(int index) { return "E" + std::to_string(index + 1); }
+
+void Generator::Write(std::FILE* out) const {
+  xml::Stream xml_stream(out);
+  xml::StreamElement root = xml_stream.root("opsa-mef");
+  if (int depth = settings_.event_tree_depth) {
+    root.AddChild("define-initiating-event")
+        .SetAttribute("name", "Initiator")
+        .SetAttribute("event-tree", "Synthetic");
+    xml::StreamElement event_tree = root.AddChild("define-event-tree");
+    event_tree.SetAttribute("name", "Synthetic");
+    for (int i = 1; i <= depth; ++i)
+      event_tree.AddChild("define-functional-event")
+          .SetAttribute("name", "F" + std::to_string(i));
+    for (int i = 1; i <= (1 << depth); ++i)
+      event_tree.AddChild("define-sequence")
+          .SetAttribute("name", "S" + std::to_string(i));
+    xml::StreamElement initial_state = event_tree.AddChild("initial-state");
+    int sequence = 0;
+    WriteFork(0, &sequence, &initial_state);
+  }
+  {
+    xml::StreamElement fault_tree = root.AddChild("define-fault-tree");
+    fault_tree.SetAttribute("name", "Synthetic");
+    for (int i = 0; i < gates_.size(); ++i) {
+      const Gate& gate = gates_[i];
+      xml::StreamElement xml_gate = fault_tree.AddChild("define-gate");
+      xml_gate.SetAttribute("name", GateName(i));
+      xml::StreamElement formula = xml_gate.AddChild(gate.connective);
+      if (gate.min_number)
+        formula.SetAttribute("min", gate.min_number);
+      for (const Arg& arg : gate.args) {
+        if (arg.is_gate) {
+          formula.AddChild("gate").SetAttribute("name", GateName(arg.index));
+        } else {
+          formula.AddChild("basic-event")
+              .SetAttribute("name", EventName(arg.index));
+        }
+      }
+    }
+    for (int i = 0; i < ccf_groups_.size(); ++i) {
+      const std::vector<int>& group = ccf_groups_[i];
+      xml::StreamElement xml_group = fault_tree.AddChild("define-CCF-group");
+      xml_group.SetAttribute("name", "CCF" + std::to_string(i + 1))
+          .SetAttribute("model", "beta-factor");
+      {
+        xml::StreamElement members = xml_group.AddChild("members");
+        for (int member : group)
+          members.AddChild("basic-event").SetAttribute("name",
+                                                       EventName(member));
+      }
+      xml_group.AddChild("distribution")
+          .AddChild("float")
+          .SetAttribute("value", events_[group.front()]);
+      xml_group.AddChild("factor")
+          .SetAttribute("level", static_cast<int>(group.size()))
+          .AddChild("float")
+          .SetAttribute("value", 0.1);
+    }
+  }
+  xml::StreamElement model_data = root.AddChild("model-data");
+  for (int i = 0; i < events_.size(); ++i) {
+    if (ccf_members_[i])
+      continue;  // Defined by the CCF group.
+    xml::StreamElement basic_event = model_data.AddChild("define-basic-event");
+    basic_event.SetAttribute("name", EventName(i));
+    basic_event.AddChild("float").SetAttribute("value", events_[i]);
+  }
+}
+
+void Generator::WriteFork(int level, int* sequence,
+                          xml::StreamElement* parent) const {
+  if (level == settings_.event_tree_depth) {
+    parent->AddChild("sequence").SetAttribute("name",
+                                              "S" + std::to_string(++*sequence));
+    return;
+  }
+  xml::StreamElement fork = parent->AddChild("fork");
+  fork.SetAttribute("functional-event", "F" + std::to_string(level + 1));
+  {
+    xml::StreamElement path = fork.AddChild("path");
+    path.SetAttribute("state", "success");
+    WriteFork(level + 1, sequence, &path);
+  }
+  xml::StreamElement path = fork.AddChild("path");
+  path.SetAttribute("state", "failure");
+  path.AddChild("collect-formula")
+      .AddChild("gate")
+      .SetAttribute("name", GateName(modules_[level % modules_.size()]));
+  WriteFork(level + 1, sequence, &path);
+}
+
+/// @throws SettingsError  The parameters are invalid or inconsistent.
+void Validate(const GeneratorSettings& settings) {
+  if (settings.num_modules < 1)
+    SCRAM_THROW(SettingsError("The number of modules must be positive."));
+  if (settings.num_gates < settings.num_modules + (settings.num_modules > 1))
+    SCRAM_THROW(SettingsError("Not enough gates for the modules."));
+  if (settings.min_args < 2 || settings.max_args < settings.min_args)
+    SCRAM_THROW(SettingsError("Invalid range of gate arguments."));
+  if (settings.num_basic_events < settings.num_modules * settings.max_args)
+    SCRAM_THROW(SettingsError("Not enough basic events for gate arguments."));
+  for (double ratio :
+       {settings.sharing, settings.and_ratio, settings.atleast_ratio}) {
+    if (ratio < 0 || ratio > 1)
+      SCRAM_THROW(SettingsError("The ratios must be in [0, 1]."));
+  }
+  if (settings.num_ccf_groups < 0 || settings.ccf_group_size < 2)
+    SCRAM_THROW(SettingsError("Invalid CCF group parameters."));
+  if (settings.event_tree_depth < 0 || settings.event_tree_depth > 16)
+    SCRAM_THROW(SettingsError("The event tree depth must be in [0, 16]."));
+  if (settings.min_prob <= 0 || settings.min_prob > settings.max_prob ||
+      settings.max_prob > 1)
+    SCRAM_THROW(SettingsError("Invalid range of probabilities."));
+}
+
+}  // namespace
+
+void Generate(const GeneratorSettings& settings, std::FILE* out) {
+  Validate(settings);
+  Generator generator(settings);
+  generator.Run();
+  generator.Write(out);
+}
+
+void Generate(const GeneratorSettings& settings, const std::string& file) {
+  Validate(settings);  // Before creating the file.
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+      std::fopen(file.c_str(), "w"), &std::fclose);
+  try {
+    if (!fp) {
+      SCRAM_THROW(IOError("Cannot open the output file for generation."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w");
+    }
+    Generate(settings, fp.get());
+  } catch (IOError& err) {
+    err << boost::errinfo_file_name(file);
+    throw;
+  }
+}
+
+}  // namespace scram::mef
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Generation of synthetic MEF models for stress testing and benchmarks.
+///
+/// The generated fault tree is a directed acyclic graph
+/// grown breadth-first from the top gate.
+/// Gates may only share gates grown after them,
+/// so the graph is acyclic by construction
+/// without any checks on the hot path.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+
+namespace scram::mef {
+
+/// The distribution of the number of gate arguments.
+enum class FanIn : std::uint8_t {
+  kUniform = 0,  ///< Uniform in [min_args, max_args].
+  kGeometric  ///< Geometric tail above min_args truncated at max_args.
+};
+
+/// String representations of the fan-in distributions.
+const char* const kFanInToString[] = {"uniform", "geometric"};
+
+/// Parameters of the synthetic model.
+/// The same parameters and seed always produce the same model.
+struct GeneratorSettings {
+  std::uint32_t seed = 123;  ///< The seed of the pseudo-random generator.
+  int num_gates = 100;  ///< The total number of gates including the top.
+  int num_basic_events = 200;  ///< The maximum number of basic events.
+  int min_args = 2;  ///< The minimum number of gate arguments.
+  int max_args = 5;  ///< The maximum number of gate arguments.
+  FanIn fan_in = FanIn::kUniform;  ///< The distribution of gate arguments.
+  double sharing = 0.1;  ///< The chance of an argument to be a shared node.
+  int num_modules = 1;  ///< The number of independent subtrees of the top.
+  double and_ratio = 0.3;  ///< The fraction of AND gates.
+  double atleast_ratio = 0;  ///< The fraction of K/N gates.
+  int num_ccf_groups = 0;  ///< The number of beta-factor CCF groups.
+  int ccf_group_size = 2;  ///< The number of members per CCF group.
+  int event_tree_depth = 0;  ///< The number of functional events.
+  double min_prob = 1e-4;  ///< The lower bound of basic event probabilities.
+  double max_prob = 1e-2;  ///< The upper bound of basic event probabilities.
+};
+
+/// Generates a synthetic model as MEF XML.
+///
+/// The model has a single fault tree with the top gate named "Top".
+/// With multiple modules, the top gate is an OR of independent subtrees
+/// that share neither gates nor basic events.
+/// The optional event tree forks on every functional event,
+/// and the failure branches collect the module top gates in turn.
+///
+/// @param[in] settings  The parameters of the model.
+/// @param[in,out] out  The stream for XML data.
+///
+/// @throws SettingsError  The parameters are invalid or inconsistent.
+/// @throws IOError  The write operation has failed.
+void Generate(const GeneratorSettings& settings, std::FILE* out);
+
+/// Convenience function for generation into a file.
+///
+/// @param[in] settings  The parameters of the model.
+/// @param[out] file  The output destination.
+///
+/// @throws SettingsError  The parameters are invalid or inconsistent.
+/// @throws IOError  The output file is not accessible,
+///                  or the write operation has failed.
+void Generate(const GeneratorSettings& settings, const std::string& file);
+
+}  // namespace scram::mef
@@ -23,18 +23,41 @@
 
 #include <cstdlib>
 
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
 #include "event.h"
 #include "logger.h"
 #include "zbdd.h"
 
 namespace scram::core {
 
+ImportanceFactors DeriveImportanceFactors(int occurrence, double mif,
+                                          double p_var,
+                                          double p_total) noexcept {
+  ImportanceFactors imp{};
+  imp.occurrence = occurrence;
+  imp.mif = mif;
+  if (p_total != 0) {
+    imp.cif = p_var * imp.mif / p_total;
+    imp.raw = 1 + (1 - p_var) * imp.mif / p_total;
+    imp.dif = p_var * imp.raw;
+    if (p_total != p_var * imp.mif)
+      imp.rrw = p_total / (p_total - p_var * imp.mif);
+  }
+  return imp;
+}
+
 ImportanceAnalysis::ImportanceAnalysis(const ProbabilityAnalysis* prob_analysis)
     : Analysis(prob_analysis->settings()) {}
 
 void ImportanceAnalysis::Analyze() noexcept {
   CLOCK(imp_time);
+  TRACE("Importance analysis");
+  Statistics::Usage usage(&Analysis::statistics());
   LOG(DEBUG3) << "Calculating importance factors...";
+  this->Quantify();
   double p_total = this->p_total();
   const std::vector<const mef::BasicEvent*>& basic_events =
       this->basic_events();
@@ -44,18 +67,9 @@ void ImportanceAnalysis::Analyze() noexcept {
     if (occurrences[i] == 0)
       continue;
     const mef::BasicEvent& event = *basic_events[i];
-    double p_var = event.p();
-    ImportanceFactors imp{};
-    imp.occurrence = occurrences[i];
-    imp.mif = this->CalculateMif(i);
-    if (p_total != 0) {
-      imp.cif = p_var * imp.mif / p_total;
-      imp.raw = 1 + (1 - p_var) * imp.mif / p_total;
-      imp.dif = p_var * imp.raw;
-      if (p_total != p_var * imp.mif)
-        imp.rrw = p_total / (p_total - p_var * imp.mif);
-    }
-    importance_.push_back({event, imp});
+    importance_.push_back(
+        {event, DeriveImportanceFactors(occurrences[i], this->CalculateMif(i),
+                                        event.p(), p_total)});
   }
   LOG(DEBUG3) << "Calculated importance factors in " << DUR(imp_time);
   Analysis::AddAnalysisTime(DUR(imp_time));
@@ -70,6 +84,107 @@ std::vector<int> ImportanceAnalyzerBase::occurrences() noexcept {
   return result;
 }
 
+ProductIndex::ProductIndex(const Zbdd& products, int num_variables) noexcept
+    : p_sum_(0),
+      q_product_(1),
+      num_certain_(0),
+      var_offsets_(num_variables + 1) {
+  product_offsets_.push_back(0);
+  for (const std::vector<int>& product : products) {
+    for (int index : product) {
+      assert(index > 0 && "Complements in a product.");
+      literals_.push_back(index);
+      var_offsets_[index + 1]++;
+    }
+    product_offsets_.push_back(literals_.size());
+  }
+  std::partial_sum(var_offsets_.begin(), var_offsets_.end(),
+                   var_offsets_.begin());
+  var_products_.resize(literals_.size());
+  std::vector<int> positions(var_offsets_.begin(), var_offsets_.end() - 1);
+  for (int i = 0; i < product_offsets_.size() - 1; ++i) {
+    for (int j = product_offsets_[i]; j < product_offsets_[i + 1]; ++j)
+      var_products_[positions[literals_[j] - Pdag::kVariableStartIndex]++] = i;
+  }
+}
+
+void ProductIndex::Quantify(const Pdag::IndexMap<double>& p_vars) noexcept {
+  p_products_.clear();
+  p_products_.reserve(product_offsets_.size() - 1);
+  p_sum_ = 0;
+  q_product_ = 1;
+  num_certain_ = 0;
+  for (int i = 0; i < product_offsets_.size() - 1; ++i) {
+    double p_product = 1;
+    for (int j = product_offsets_[i]; j < product_offsets_[i + 1]; ++j)
+      p_product *= p_vars[literals_[j]];
+    p_products_.push_back(p_product);
+    p_sum_ += p_product;
+    if (certain(i)) {
+      ++num_certain_;  // Excluded from the product to avoid division by 0.
+    } else {
+      q_product_ *= 1 - p_product;
+    }
+  }
+}
+
+std::vector<int> ProductIndex::occurrences() const {
+  std::vector<int> result;
+  result.reserve(var_offsets_.size() - 1);
+  for (auto it = var_offsets_.begin(), it_next = std::next(it);
+       it_next != var_offsets_.end(); it = it_next++) {
+    result.push_back(*it_next - *it);
+  }
+  return result;
+}
+
+double ProductIndex::p_product(
+    int product, int index,
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
+  double p = 1;
+  for (int i = product_offsets_[product]; i < product_offsets_[product + 1];
+       ++i) {
+    if (literals_[i] != index)
+      p *= p_vars[literals_[i]];
+  }
+  return p;
+}
+
+template <>
+double ImportanceAnalyzer<RareEventCalculator>::CalculateMif(
+    int index) noexcept {
+  index += Pdag::kVariableStartIndex;
+  double p_rest = index_.p_sum();  // The products without the variable.
+  double p_conditional = 0;  // The products with the true variable.
+  const Pdag::IndexMap<double>& p_vars = prob_analyzer()->p_vars();
+  for (int product : index_.products(index)) {
+    p_rest -= index_.p_products()[product];
+    p_conditional += index_.p_product(product, index, p_vars);
+  }
+  p_rest = std::max(p_rest, 0.0);  // Numerical cancellation errors.
+  return std::min(p_rest + p_conditional, 1.0) - std::min(p_rest, 1.0);
+}
+
+template <>
+double ImportanceAnalyzer<McubCalculator>::CalculateMif(int index) noexcept {
+  index += Pdag::kVariableStartIndex;
+  double q_rest = index_.q_product();  // The products without the variable.
+  int num_certain = index_.num_certain();
+  double q_conditional = 1;  // The products with the true variable.
+  const Pdag::IndexMap<double>& p_vars = prob_analyzer()->p_vars();
+  for (int product : index_.products(index)) {
+    if (index_.certain(product)) {
+      --num_certain;  // Not a factor of the complement product.
+    } else {
+      q_rest /= 1 - index_.p_products()[product];
+    }
+    q_conditional *= 1 - index_.p_product(product, index, p_vars);
+  }
+  if (num_certain)
+    return 0;  // The top event is certain regardless of the variable.
+  return q_rest * (1 - q_conditional);
+}
+
 double ImportanceAnalyzer<Bdd>::CalculateMif(int index) noexcept {
   index += Pdag::kVariableStartIndex;
   const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
@@ -23,6 +23,8 @@
 
 #include <vector>
 
+#include <boost/range/iterator_range.hpp>
+
 #include "bdd.h"
 #include "probability_analysis.h"
 #include "settings.h"
@@ -43,6 +45,19 @@ struct ImportanceFactors {
   double rrw;  ///< Risk reduction worth factor.
 };
 
+/// Derives the importance factors of a variable from its MIF.
+///
+/// @param[in] occurrence  The number of products with the variable.
+/// @param[in] mif  The marginal importance factor of the variable.
+/// @param[in] p_var  The probability of the variable.
+/// @param[in] p_total  The total probability.
+///
+/// @returns The importance factors of the variable.
+///          Only MIF and the occurrence are set for the zero total probability.
+ImportanceFactors DeriveImportanceFactors(int occurrence, double mif,
+                                          double p_var,
+                                          double p_total) noexcept;
+
 /// Mapping of an event and its importance.
 struct ImportanceRecord {
   const mef::BasicEvent& event;  ///< The event occurring in products.
@@ -82,6 +97,8 @@ class ImportanceAnalysis : public Analysis {
   /// @returns All basic event candidates for importance calculations.
   virtual const std::vector<const mef::BasicEvent*>&
   basic_events() noexcept = 0;
+  /// Prepares the calculations for the current probabilities of events.
+  virtual void Quantify() noexcept {}
   /// @returns Occurrences of basic events in products.
   virtual std::vector<int> occurrences() noexcept = 0;
 
@@ -125,8 +142,81 @@ class ImportanceAnalyzerBase : public ImportanceAnalysis {
   ProbabilityAnalyzerBase* prob_analyzer_;
 };
 
+/// Frozen flat collection of products
+/// with the inverted index from variables to products containing them.
+/// The index replaces the repeated traversal of all the products
+/// for each variable in importance calculations.
+/// The probabilities of the products are not part of the frozen structure
+/// and must be recalculated whenever the variable probabilities change.
+class ProductIndex {
+ public:
+  /// Flattens products and indexes variables in a single pass.
+  ///
+  /// @param[in] products  The analysis products without complements.
+  /// @param[in] num_variables  The number of variables in the products.
+  ProductIndex(const Zbdd& products, int num_variables) noexcept;
+
+  /// Calculates the probabilities of the products.
+  ///
+  /// @param[in] p_vars  The current probabilities of variables.
+  void Quantify(const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// @returns The probabilities of the products.
+  const std::vector<double>& p_products() const { return p_products_; }
+
+  /// @returns The sum of the product probabilities.
+  double p_sum() const { return p_sum_; }
+
+  /// @returns The product of the complement probabilities of the products
+  ///          excluding the products with probability 1.
+  double q_product() const { return q_product_; }
+
+  /// @returns The number of products with probability 1.
+  int num_certain() const { return num_certain_; }
+
+  /// @param[in] product  The position of the product.
+  ///
+  /// @returns true if the product is certain to occur.
+  bool certain(int product) const { return p_products_[product] >= 1; }
+
+  /// @param[in] index  The index of a variable.
+  ///
+  /// @returns The positions of the products containing the variable.
+  auto products(int index) const {
+    return boost::make_iterator_range(
+        var_products_.begin() + var_offsets_[index],
+        var_products_.begin() + var_offsets_[index + 1]);
+  }
+
+  /// @returns The number of products containing each variable.
+  std::vector<int> occurrences() const;
+
+  /// Calculates the probability of a product
+  /// as if the variable were certain to occur.
+  ///
+  /// @param[in] product  The position of the product.
+  /// @param[in] index  The index of the variable in the product.
+  /// @param[in] p_vars  The current probabilities of variables.
+  ///
+  /// @returns The probability of the remaining literals in the product.
+  double p_product(int product, int index,
+                   const Pdag::IndexMap<double>& p_vars) const noexcept;
+
+ private:
+  std::vector<int> literals_;  ///< The flat array of literals of all products.
+  std::vector<int> product_offsets_;  ///< The product positions in literals.
+  std::vector<double> p_products_;  ///< The product probabilities.
+  double p_sum_;  ///< The sum of the product probabilities.
+  double q_product_;  ///< The product of non-zero complement probabilities.
+  int num_certain_;  ///< The number of products with probability 1.
+  /// The positions of variable product lists in the inverted index.
+  Pdag::IndexMap<int> var_offsets_;
+  std::vector<int> var_products_;  ///< The inverted index of variables.
+};
+
 /// Analyzer of importance factors
-/// with the help from probability analyzers.
+/// with the help from probability analyzers
+/// with approximations over products.
 ///
 /// @tparam Calculator  Quantitative calculator of probability values.
 template <class Calculator>
@@ -135,26 +225,31 @@ class ImportanceAnalyzer : public ImportanceAnalyzerBase {
   /// @copydoc ImportanceAnalyzerBase::ImportanceAnalyzerBase
   explicit ImportanceAnalyzer(ProbabilityAnalyzer<Calculator>* prob_analyzer)
       : ImportanceAnalyzerBase(prob_analyzer),
-        p_vars_(prob_analyzer->p_vars()) {}
+        index_(prob_analyzer->products(),
+               prob_analyzer->graph()->basic_events().size()) {}
 
  private:
+  void Quantify() noexcept override {
+    index_.Quantify(prob_analyzer()->p_vars());
+  }
+  std::vector<int> occurrences() noexcept override {
+    return index_.occurrences();
+  }
   double CalculateMif(int index) noexcept override;
-  Pdag::IndexMap<double> p_vars_;  ///< A copy of variable probabilities.
+
+  ProductIndex index_;  ///< The products containing variables.
 };
 
-template <class Calculator>
-double ImportanceAnalyzer<Calculator>::CalculateMif(int index) noexcept {
-  index += Pdag::kVariableStartIndex;
-  auto p_conditional = [index, this](bool state) {
-    p_vars_[index] = state;
-    return static_cast<ProbabilityAnalyzer<Calculator>*>(prob_analyzer())
-        ->CalculateTotalProbability(p_vars_);
-  };
-  double p_store = p_vars_[index];  // Save the original value for restoring.
-  double mif = p_conditional(true) - p_conditional(false);
-  p_vars_[index] = p_store;  // Restore the probability for next calculation.
-  return mif;
-}
+/// Calculates MIF with the Rare-Event approximation
+/// from the products containing the variable.
+template <>
+double ImportanceAnalyzer<RareEventCalculator>::CalculateMif(
+    int index) noexcept;
+
+/// Calculates MIF with the MCUB approximation
+/// from the products containing the variable.
+template <>
+double ImportanceAnalyzer<McubCalculator>::CalculateMif(int index) noexcept;
 
 /// Specialization of importance analyzer with Binary Decision Diagrams.
 template <>
@@ -23,6 +23,7 @@
 #include <functional>  // std::mem_fn
 #include <sstream>
 #include <type_traits>
+#include <unordered_set>
 
 #include <boost/exception/errinfo_at_line.hpp>
 #include <boost/exception/errinfo_file_name.hpp>
@@ -43,6 +44,7 @@
 #include "expression/test_event.h"
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
+#include "ext/scope_guard.h"
 #include "logger.h"
 
 namespace scram::mef {
@@ -192,11 +194,13 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   static xml::Validator validator(env::input_schema());
 
   CLOCK(input_time);
+  TRACE("Processing input files");
   LOG(DEBUG1) << "Processing input files";
   CheckFileExistence(xml_files);
   CheckDuplicateFiles(xml_files);
   for (const auto& xml_file : xml_files) {
     CLOCK(parse_time);
+    TRACE("Parsing " + xml_file);
     LOG(DEBUG3) << "Parsing " << xml_file << " ...";
     xml::Document document(xml_file, &validator);
     if (extra_validator_)
@@ -205,30 +209,39 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
     LOG(DEBUG3) << "Parsed " << xml_file << " in " << DUR(parse_time);
   }
   CLOCK(def_time);
-  for (const xml::Document& document : documents_) {
-    try {
-      ProcessInputFile(document);
-    } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(document.root().filename());
-      throw;
+  {
+    TRACE("Defining elements");
+    for (const xml::Document& document : documents_) {
+      try {
+        ProcessInputFile(document);
+      } catch (ValidityError& err) {
+        err << boost::errinfo_file_name(document.root().filename());
+        throw;
+      }
     }
+    ProcessTbdElements();
   }
-  ProcessTbdElements();
   LOG(DEBUG2) << "Element definition time " << DUR(def_time);
   LOG(DEBUG1) << "Input files are processed in " << DUR(input_time);
 
   CLOCK(valid_time);
   LOG(DEBUG1) << "Validating the initialization";
-  // Check if the initialization is successful.
-  ValidateInitialization();
+  {
+    TRACE("Validating the initialization");
+    // Check if the initialization is successful.
+    ValidateInitialization();
+  }
   LOG(DEBUG1) << "Validation is finished in " << DUR(valid_time);
 
   CLOCK(setup_time);
   LOG(DEBUG1) << "Setting up for the analysis";
-  // Perform setup for analysis using configurations from the input files.
-  SetupForAnalysis();
-  EnsureNoCcfSubstitutions();
-  EnsureSubstitutionsWithApproximations();
+  {
+    TRACE("Setting up for the analysis");
+    // Perform setup for analysis using configurations from the input files.
+    SetupForAnalysis();
+    EnsureNoCcfSubstitutions();
+    EnsureSubstitutionsWithApproximations();
+  }
   LOG(DEBUG1) << "Setup time " << DUR(setup_time);
 }
 
@@ -1461,7 +1474,8 @@ constexpr int Encode(int base_power = 1) noexcept {
 
 using ExternFunctionExtractor = ExternFunctionPtr (*)(std::string,
                                                       const std::string&,
-                                                      const ExternLibrary&);
+                                                      const ExternLibrary&,
+                                                      bool);
 using ExternFunctionExtractorMap =
     std::unordered_map<int, ExternFunctionExtractor>;
 
@@ -1480,9 +1494,9 @@ void GenerateExternFunctionExtractor(ExternFunctionExtractorMap* function_map) {
     function_map->emplace(
         Encode<Ts...>(),
         [](std::string name, const std::string& symbol,
-           const ExternLibrary& library) -> ExternFunctionPtr {
-          return std::make_unique<ExternFunction<Ts...>>(std::move(name),
-                                                         symbol, library);
+           const ExternLibrary& library, bool pure) -> ExternFunctionPtr {
+          return std::make_unique<ExternFunction<Ts...>>(
+              std::move(name), symbol, library, pure);
         });
   } else {
     GenerateExternFunctionExtractor<0, Ts...>(function_map);
@@ -1514,7 +1528,8 @@ void Initializer::DefineExternFunction(const xml::Element& xml_element) {
     }
   }();
 
-  ExternFunctionPtr extern_function = [&xml_element, &library] {
+  ExternFunctionPtr extern_function = [&xml_element,
+                                      &library]() -> ExternFunctionPtr {
     auto args = GetNonAttributeElements(xml_element);
     assert(!args.empty());
     /// @todo Optimize extern-function num args violation detection.
@@ -1526,11 +1541,24 @@ void Initializer::DefineExternFunction(const xml::Element& xml_element) {
                                 std::to_string(kMaxNumParam) + "'"))
           << boost::errinfo_at_line(xml_element.line());
     }
-    int encoding = Encode(args);
+    bool pure = xml_element.attribute<bool>("pure").value_or(false);
+    bool batch = xml_element.attribute<bool>("batch").value_or(false);
     try {
-      return function_extractors.at(encoding)(
+      if (batch) {
+        if (boost::find_if(args, [](const xml::Element& node) {
+              return node.name() != "double";
+            }) != args.end()) {
+          SCRAM_THROW(ValidityError(
+              "Batch extern functions must have double parameters only."));
+        }
+        return std::make_unique<ExternBatchFunction>(
+            std::string(xml_element.attribute("name")),
+            std::string(xml_element.attribute("symbol")), library, num_args,
+            pure);
+      }
+      return function_extractors.at(Encode(args))(
           std::string(xml_element.attribute("name")),
-          std::string(xml_element.attribute("symbol")), library);
+          std::string(xml_element.attribute("symbol")), library, pure);
     } catch (Error& err) {
       err << boost::errinfo_at_line(xml_element.line());
       throw;
@@ -1591,6 +1619,8 @@ void Initializer::ValidateInitialization() {
   EnsureNoSubstitutionConflicts();
 
   ValidateExpressions();
+  ValidateSweep();
+  ValidateProbabilityGates();
 }
 
 void Initializer::CheckFunctionalEventOrder(const Branch& branch) {
@@ -1703,6 +1733,8 @@ void Initializer::EnsureHomogeneousEventTree(const Branch& branch) {
       CheckInstructions(sequence->instructions());
     }
     void operator()(const Branch* arg_branch) {
+      if (!visited.insert(arg_branch).second)
+        return;  // The converging branches are checked once.
       CheckInstructions(arg_branch->instructions());
       std::visit(*this, arg_branch->target());
     }
@@ -1712,6 +1744,7 @@ void Initializer::EnsureHomogeneousEventTree(const Branch& branch) {
     }
 
     Type type = kUnknown;
+    std::unordered_set<const Branch*> visited;
   } homogeneous_checker;
 
   homogeneous_checker(&branch);
@@ -1799,6 +1832,10 @@ void Initializer::ValidateExpressions() {
   // This must be done before expressions.
   cycle::CheckCycle<Parameter>(model_->table<Parameter>(), "parameter");
 
+  ValidateExpressionDomains();
+}
+
+void Initializer::ValidateExpressionDomains() {
   // Validate expressions.
   for (const std::pair<Expression*, xml::Element>& expression : expressions_) {
     try {
@@ -1821,6 +1858,38 @@ void Initializer::ValidateExpressions() {
   }
 }
 
+void Initializer::ValidateSweep() {
+  for (const core::SweepAxis& axis : settings_.sweep()) {
+    auto it = ext::find(model_->table<Parameter>(), axis.parameter);
+    if (!it) {
+      SCRAM_THROW(UndefinedElement())
+          << errinfo_reference(axis.parameter)
+          << errinfo_element_type(Parameter::kTypeString);
+    }
+    Parameter& parameter = *it;
+    SCOPE_EXIT([&parameter] { parameter.override_value({}); });
+    for (double value : axis.values) {
+      parameter.override_value(value);
+      try {
+        ValidateExpressionDomains();
+      } catch (ValidityError& err) {
+        err << errinfo_container(parameter.id() + " = " + std::to_string(value),
+                                 "parameter sweep");
+        throw;
+      }
+    }
+  }
+}
+
+void Initializer::ValidateProbabilityGates() {
+  for (const std::string& id : settings_.probability_gates()) {
+    if (!ext::find(model_->table<Gate>(), id)) {
+      SCRAM_THROW(UndefinedElement())
+          << errinfo_reference(id) << errinfo_element_type(Gate::kTypeString);
+    }
+  }
+}
+
 void Initializer::SetupForAnalysis() {
   {
     TIMER(DEBUG2, "Collecting top events of fault trees");
@@ -465,6 +465,26 @@ class Initializer : private boost::noncopyable {
   /// @throws ValidityError  There are problems detected with expressions.
   void ValidateExpressions();
 
+  /// Validates the domains of expressions
+  /// with the current values of their arguments.
+  ///
+  /// @throws ValidityError  There are problems detected with expressions.
+  void ValidateExpressionDomains();
+
+  /// Validates the parameters of the parameter sweep
+  /// and the expression domains with each parameter value.
+  ///
+  /// @throws UndefinedElement  The swept parameter is not in the model.
+  /// @throws ValidityError  Some values are invalid for the expressions.
+  ///
+  /// @pre Expressions are valid with the original parameter values.
+  void ValidateSweep();
+
+  /// Validates the gates selected for the probability report.
+  ///
+  /// @throws UndefinedElement  The selected gate is not in the model.
+  void ValidateProbabilityGates();
+
   /// Applies the input information to set up for future analysis.
   /// This step is crucial to get
   /// correct fault tree structures
@@ -36,6 +36,8 @@
 #include <boost/noncopyable.hpp>
 #include <boost/preprocessor/cat.hpp>
 
+#include "trace.h"
+
 namespace scram {
 
 /// Takes a current time stamp in nanoseconds.
@@ -129,15 +131,24 @@ class Logger : private boost::noncopyable {
 };
 
 /// Automatic (scoped) timer to log process duration.
+/// The process is also recorded as a span in the trace.
 template <LogLevel Level>
 class Timer {
  public:
   /// @param[in] process_name  The process being logged.
   explicit Timer(const char* process_name)
-      : process_name_(process_name), process_time_(TIME_STAMP()) {
+      : process_name_(process_name),
+        process_time_(TIME_STAMP()),
+        span_(process_name) {
     LOG(Level) << process_name_ << "...";
   }
 
+  /// Attaches a value to the trace record of the process.
+  ///
+  /// @param[in] key  The name of the value.
+  /// @param[in] value  The value to be reported.
+  void Add(const char* key, double value) noexcept { span_.Add(key, value); }
+
   /// Puts the accumulated time into the logs.
   ~Timer() {
     LOG(Level) << "Finished " << process_name_ << " in " << DUR(process_time_);
@@ -146,6 +157,7 @@ class Timer {
  private:
   const char* process_name_;  ///< The process name to be logged.
   std::uint64_t process_time_;  ///< The process start time.
+  TraceSpan span_;  ///< The trace record of the process.
 };
 
 }  // namespace scram
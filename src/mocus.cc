@@ -27,6 +27,8 @@
 
 #include "mocus.h"
 
+#include <string>
+
 #include "logger.h"
 
 namespace scram::core {
@@ -54,6 +56,10 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
   assert(gate.module() && "Expected only module gates.");
   CLOCK(gen_time);
   LOG(DEBUG3) << "Finding cut sets from module: G" << gate.index();
+  TraceSpan span(Trace::enabled()
+                     ? "Finding cut sets from module: G" +
+                           std::to_string(gate.index())
+                     : std::string());
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
   std::unordered_map<int, const Gate*> gates;
   auto add_gates = [&gates](const auto& args) {
@@ -76,7 +82,7 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
         container->ExtractIntermediateCutSets(next_gate_index)));
   }
   container->Minimize();
-  container->Log();
+  container->Log(&span);
   LOG(DEBUG3) << "G" << gate.index()
               << " cut set generation time: " << DUR(gen_time);
   if (!gate.coherent()) {
@@ -89,7 +95,8 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
     int limit = entry.second.second;
     assert(limit >= 0 && "Order cut-off is not strict.");
     bool coherent = entry.second.first;
-    if (limit == 0 && coherent) {  // Unity is impossible.
+    if ((limit == 0 && coherent) || kSettings_.cancelled()) {
+      // Unity is impossible, or the results are going to be discarded.
       auto empty_zbdd = std::make_unique<zbdd::CutSetContainer>(
           kSettings_, index, kMaxVariableIndex);
       container->JoinModule(index, std::move(empty_zbdd));
@@ -61,6 +61,9 @@ class Mocus : private boost::noncopyable {
     return *zbdd_;
   }
 
+  /// @returns Data structure counters of the cut set containers.
+  const Statistics& statistics() const { return products().statistics(); }
+
  private:
   /// Runs analysis on a module gate.
   /// All sub-modules are analyzed and joined recursively.
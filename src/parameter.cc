@@ -29,7 +29,11 @@ MissionTime::MissionTime(double time, Units unit) : unit_(unit) { value(time); }
 void MissionTime::value(double time) {
   if (time < 0)
     SCRAM_THROW(LogicError("Mission time cannot be negative."));
+  if (time == value_)
+    return;
   value_ = time;
+  ++version_;
+  ++num_changes_;
 }
 
 void Parameter::expression(Expression* expression) {
@@ -39,4 +43,65 @@ void Parameter::expression(Expression* expression) {
   Expression::AddArg(expression);
 }
 
+void Parameter::override_value(std::optional<double> value) noexcept {
+  if (value == override_)
+    return;
+  override_ = value;
+  cached_ = false;
+  ++num_overrides_;
+}
+
+double Parameter::value() noexcept {
+  if (!collected_) {
+    collected_ = true;
+    CollectDependencies(expression_);
+  }
+  if (volatile_ && !override_)
+    return expression_->value();
+  if (cached_ && epoch_ == epoch())
+    return value_;
+  epoch_ = epoch();
+
+  bool changed = !cached_;
+  for (auto& [mission_time, version] : mission_times_) {
+    if (mission_time->version() != version) {
+      version = mission_time->version();
+      changed = true;
+    }
+  }
+  for (auto& [parameter, version] : parameters_) {
+    parameter->value();  // Brings the dependency up to date.
+    if (parameter->version_ != version) {
+      version = parameter->version_;
+      changed = true;
+    }
+  }
+  if (changed) {
+    double value = override_ ? *override_ : expression_->value();
+    if (!cached_ || value != value_)
+      ++version_;
+    value_ = value;
+    cached_ = true;
+  }
+  return value_;
+}
+
+void Parameter::CollectDependencies(Expression* expression) noexcept {
+  if (expression->IsVolatile()) {
+    volatile_ = true;
+  } else if (auto* parameter = dynamic_cast<Parameter*>(expression)) {
+    parameter->value();  // Collects the dependencies of the parameter.
+    if (parameter->volatile_) {
+      volatile_ = true;
+    } else {
+      parameters_.emplace_back(parameter, parameter->version_);
+    }
+  } else if (auto* mission_time = dynamic_cast<MissionTime*>(expression)) {
+    mission_times_.emplace_back(mission_time, mission_time->version());
+  } else {
+    for (Expression* arg : expression->args())
+      CollectDependencies(arg);
+  }
+}
+
 }  // namespace scram::mef
@@ -22,6 +22,10 @@
 
 #include <cstdint>
 
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "element.h"
 #include "expression.h"
 
@@ -71,16 +75,33 @@ class MissionTime : public Expression {
   Interval interval() noexcept override { return Interval::closed(0, value_); }
   bool IsDeviate() noexcept override { return false; }
 
+  /// @returns The number of changes in the mission time value.
+  std::uint64_t version() const { return version_; }
+
+  /// @returns The number of changes in all the mission time values.
+  static std::uint64_t num_changes() { return num_changes_; }
+
  private:
   double DoSample() noexcept override { return value_; }
 
+  static inline std::uint64_t num_changes_ = 0;  ///< The global version.
   Units unit_;  ///< Units of this parameter.
-  double value_;  ///< The universal value to represent int, bool, double.
+  double value_ = 0;  ///< The universal value to represent int, bool, double.
+  std::uint64_t version_ = 0;  ///< The version for cached dependent values.
 };
 
 /// This class provides a representation of a variable
 /// in basic event description.
 /// It is both expression and element description.
+///
+/// Parameters are the only shared expressions,
+/// so their values are cached
+/// and recomputed only after changes in the mission time values
+/// or in the cached values of other parameters they depend upon.
+/// Parameters with volatile expressions are never cached.
+///
+/// The value of a parameter can be overridden for what-if studies
+/// without changing its expression.
 class Parameter : public Expression, public Id, public NodeMark, public Usage {
  public:
   /// Type string for errors.
@@ -103,14 +124,58 @@ class Parameter : public Expression, public Id, public NodeMark, public Usage {
   /// @param[in] unit  A valid unit.
   void unit(Units unit) { unit_ = unit; }
 
-  double value() noexcept override { return expression_->value(); }
-  Interval interval() noexcept override { return expression_->interval(); }
+  /// @returns The overriding value of the parameter if any.
+  std::optional<double> override_value() const { return override_; }
+
+  /// Overrides the value of the parameter expression.
+  /// The dependent parameter values are invalidated.
+  ///
+  /// @param[in] value  The value to use instead of the expression,
+  ///                   or nothing to restore the expression value.
+  void override_value(std::optional<double> value) noexcept;
+
+  /// @returns The overriding value
+  ///          or the cached value of the parameter expression.
+  ///
+  /// @pre The parameter expression is set and free of cycles.
+  double value() noexcept override;
+
+  Interval interval() noexcept override {
+    return override_ ? Interval::closed(*override_, *override_)
+                     : expression_->interval();
+  }
 
  private:
-  double DoSample() noexcept override { return expression_->Sample(); }
+  double DoSample() noexcept override {
+    return override_ ? *override_ : expression_->Sample();
+  }
+
+  /// @returns The number of changes in the mission time and override values
+  ///          to detect stale cached values.
+  static std::uint64_t epoch() {
+    return MissionTime::num_changes() + num_overrides_;
+  }
+
+  /// Registers the mission time and parameter dependencies
+  /// found in the expression without going into other parameters.
+  ///
+  /// @param[in] expression  The expression of this parameter or its argument.
+  void CollectDependencies(Expression* expression) noexcept;
 
+  static inline std::uint64_t num_overrides_ = 0;  ///< The override version.
   Units unit_ = kUnitless;  ///< Units of this parameter.
   Expression* expression_ = nullptr;  ///< Expression for this parameter.
+  double value_ = 0;  ///< The cached value of the expression.
+  std::uint64_t version_ = 0;  ///< The number of changes in the cached value.
+  std::uint64_t epoch_ = 0;  ///< The global changes at the last check.
+  std::optional<double> override_;  ///< The value overriding the expression.
+  bool cached_ = false;  ///< The cached value is computed.
+  bool collected_ = false;  ///< The dependencies are collected.
+  bool volatile_ = false;  ///< The value is never cached.
+  /// The mission time dependencies with their versions for the cached value.
+  std::vector<std::pair<MissionTime*, std::uint64_t>> mission_times_;
+  /// The parameter dependencies with their versions for the cached value.
+  std::vector<std::pair<Parameter*, std::uint64_t>> parameters_;
 };
 
 }  // namespace scram::mef
@@ -32,7 +32,9 @@
 #include <boost/math/special_functions/sign.hpp>
 #include <boost/range/algorithm.hpp>
 
+#include "ccf_group.h"
 #include "event.h"
+#include "expression/constant.h"
 #include "ext/algorithm.h"
 #include "logger.h"
 #include "model.h"
@@ -454,10 +456,15 @@ Pdag::Pdag() noexcept
       register_null_gates_(true),
       constant_(new Constant(this)) {}
 
-Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model) noexcept
+Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model,
+           const std::vector<const mef::HouseEvent*>& house_events,
+           double ccf_cut_off) noexcept
     : Pdag() {
   TIMER(DEBUG2, "PDAG Construction");
   ProcessedNodes nodes;
+  nodes.ccf_cut_off = ccf_cut_off;
+  for (const mef::HouseEvent* house_event : house_events)
+    nodes.house_events.emplace(house_event, nullptr);
   GatherVariables(root.formula(), ccf, &nodes);
   if (model) {  // Process substitution variables.
     for (const mef::Substitution& substitution : model->substitutions())
@@ -483,6 +490,8 @@ Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model) noexcept
   }
 }
 
+Pdag::~Pdag() noexcept = default;
+
 void Pdag::Print() {
   Clear<kVisit>();
   std::cerr << "\n" << this << std::endl;
@@ -512,7 +521,9 @@ void Pdag::GatherVariables(const mef::Formula& formula, bool ccf,
         graph->GatherVariables(mef_gate->formula(), ccf, nodes);
       }
     }
-    void operator()(const mef::HouseEvent*) {}
+    void operator()(const mef::HouseEvent* arg) {
+      graph->GatherVariables(*arg, nodes);
+    }
 
     Pdag* graph;
     bool ccf;
@@ -526,8 +537,14 @@ void Pdag::GatherVariables(const mef::Formula& formula, bool ccf,
 void Pdag::GatherVariables(const mef::BasicEvent& basic_event, bool ccf,
                            ProcessedNodes* nodes) noexcept {
   if (ccf && basic_event.HasCcf()) {  // Gather CCF events.
-    if (nodes->gates.emplace(&basic_event.ccf_gate(), nullptr).second)
-      GatherVariables(basic_event.ccf_gate().formula(), ccf, nodes);
+    auto [it, inserted] = nodes->ccf_members.try_emplace(&basic_event);
+    if (inserted) {
+      std::vector<const mef::CcfEvent*>& ccf_events = it->second.first;
+      basic_event.ccf_group().CollectEvents(basic_event, nodes->ccf_cut_off,
+                                            &ccf_events);
+      for (const mef::CcfEvent* ccf_event : ccf_events)
+        GatherVariables(*ccf_event, /*ccf=*/false, nodes);
+    }
   } else {
     VariablePtr& var = nodes->variables[&basic_event];
     if (!var) {
@@ -538,6 +555,22 @@ void Pdag::GatherVariables(const mef::BasicEvent& basic_event, bool ccf,
   }
 }
 
+void Pdag::GatherVariables(const mef::HouseEvent& house_event,
+                           ProcessedNodes* nodes) noexcept {
+  auto it = nodes->house_events.find(&house_event);
+  if (it == nodes->house_events.end() || it->second)
+    return;
+  auto placeholder = std::make_unique<mef::BasicEvent>(house_event.name());
+  placeholder->expression(house_event.state() ? &mef::ConstantExpression::kOne
+                                              : &mef::ConstantExpression::kZero);
+  basic_events_.push_back(placeholder.get());
+  house_placeholders_.push_back(std::move(placeholder));
+  it->second = std::make_shared<Variable>(this);  // Sequential indices.
+  assert((kVariableStartIndex + basic_events_.size() - 1) ==
+         it->second->index());
+  house_events_.emplace_back(&house_event, it->second->index());
+}
+
 void Pdag::GatherVariables(const mef::Substitution& substitution, bool ccf,
                            ProcessedNodes* nodes) noexcept {
   GatherVariables(substitution.hypothesis(), ccf, nodes);
@@ -556,7 +589,11 @@ void Pdag::AddArg(const GatePtr& parent, const T& event, bool complement,
                   bool ccf, ProcessedNodes* nodes) noexcept {
   if constexpr (std::is_same_v<T, mef::HouseEvent>) {
     (void)ccf;
-    (void)nodes;
+    if (auto it = ext::find(nodes->house_events, &event)) {
+      assert(it->second && "Uninitialized variable.");
+      parent->AddArg(it->second, complement);
+      return;
+    }
     // Create unique pass-through gates to hold the construction invariant.
     auto null_gate = std::make_shared<Gate>(kNull, this);
     null_gate->AddArg(constant_, complement ^ !event.state());
@@ -574,7 +611,18 @@ void Pdag::AddArg(const GatePtr& parent, const T& event, bool complement,
     static_assert(std::is_same_v<T, mef::BasicEvent>);
 
     if (ccf && event.HasCcf()) {  // Replace with a CCF gate.
-      AddArg(parent, event.ccf_gate(), complement, ccf, nodes);
+      auto& [ccf_events, ccf_gate] = nodes->ccf_members.find(&event)->second;
+      if (ccf_events.size() == 1) {  // Only independent failures.
+        parent->AddArg(nodes->variables.find(ccf_events.front())->second,
+                       complement);
+        return;
+      }
+      if (!ccf_gate) {
+        ccf_gate = std::make_shared<Gate>(kOr, this);
+        for (const mef::CcfEvent* ccf_event : ccf_events)
+          ccf_gate->AddArg(nodes->variables.find(ccf_event)->second);
+      }
+      parent->AddArg(ccf_gate, complement);
     } else {
       VariablePtr& var = nodes->variables.find(&event)->second;
       assert(var && "Uninitialized variable.");
@@ -888,12 +936,15 @@ struct GraphLogger {
 }  // namespace
 
 void Pdag::Log() noexcept {
-  if (DEBUG4 > scram::Logger::report_level())
+  if (DEBUG4 > scram::Logger::report_level() && !Trace::enabled())
     return;
   Clear<kGateMark>();
   GraphLogger logger(root_);
   logger.GatherInformation(root_);
   Clear<kGateMark>();
+  Trace::Counter("PDAG", {{"gates", logger.Count(logger.gates)},
+                          {"modules", logger.num_modules},
+                          {"variables", logger.Count(logger.variables)}});
   LOG(DEBUG4) << "PDAG with root G" << root_->index();
   LOG(DEBUG4) << "Total # of gates: " << logger.Count(logger.gates);
   LOG(DEBUG4) << "# of modules: " << logger.num_modules;
@@ -929,6 +980,46 @@ void Pdag::Log() noexcept {
       << "Total # of constants: " << constant_->parents().size();
 }
 
+CompactPdag::CompactPdag(const Pdag& graph) noexcept
+    : root_(graph.root().index()),
+      gate_start_(Pdag::kVariableStartIndex + graph.basic_events().size()),
+      var_orders_(graph.basic_events().size()) {
+  std::vector<const Gate*> gates;
+  Register(graph.root(), &gates);
+  arg_offsets_.reserve(gates.size() + 1);
+  arg_offsets_.push_back(0);
+  for (const Gate* gate : gates) {
+    for (const Gate::ConstArg<Variable>& arg : gate->args<Variable>())
+      args_.push_back(arg.first);
+    for (const Gate::ConstArg<Gate>& arg : gate->args<Gate>())
+      args_.push_back(arg.first);
+    arg_offsets_.push_back(args_.size());
+  }
+}
+
+int CompactPdag::Register(const Gate& gate,
+                          std::vector<const Gate*>* gates) noexcept {
+  int offset = gate.index() - gate_start_;
+  assert(offset >= 0 && "Variable indices are not sequential.");
+  if (offset >= positions_.size())
+    positions_.resize(offset + 1, -1);
+  if (positions_[offset] >= 0)
+    return positions_[offset];
+  int position = gates->size();
+  positions_[offset] = position;
+  gates->push_back(&gate);
+  types_.push_back(gate.type());
+  flags_.push_back((gate.module() ? kModule : 0) |
+                   (gate.coherent() ? kCoherent : 0));
+  orders_.push_back(gate.order());
+  num_parents_.push_back(0);
+  for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>())
+    var_orders_[arg.second.index()] = arg.second.order();
+  for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>())
+    ++num_parents_[Register(arg.second, gates)];
+  return position;
+}
+
 std::ostream& operator<<(std::ostream& os, const Constant& constant) {
   os << "s(H" << constant.index()
      << ") = " << (constant.value() ? "true" : "false") << "\n";
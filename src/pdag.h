@@ -44,6 +44,7 @@
 #include <boost/container/flat_set.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "ext/find_iterator.h"
 #include "ext/index_map.h"
@@ -54,6 +55,7 @@ class Model;  // Provider of substitutions.
 class Substitution;
 class Gate;
 class BasicEvent;
+class CcfEvent;
 class HouseEvent;
 class Formula;
 }  // namespace scram::mef
@@ -840,6 +842,10 @@ class Pdag : private boost::noncopyable {
   /// @param[in] root  The top gate of the fault tree.
   /// @param[in] ccf  Incorporation of CCF gates and events for CCF groups.
   /// @param[in] model  The Model containing substitutions if any.
+  /// @param[in] house_events  The house events to keep as symbolic Variables
+  ///                          instead of the constants of their states.
+  /// @param[in] ccf_cut_off  The cut-off probability
+  ///                         for negligible combinations of CCF groups.
   ///
   /// @pre No new Variable nodes are introduced after the construction.
   ///
@@ -859,7 +865,12 @@ class Pdag : private boost::noncopyable {
   ///
   /// @post All Gate indices >= (num of vars + kVariableStartIndex).
   explicit Pdag(const mef::Gate& root, bool ccf = false,
-                const mef::Model* model = nullptr) noexcept;
+                const mef::Model* model = nullptr,
+                const std::vector<const mef::HouseEvent*>& house_events = {},
+                double ccf_cut_off = 0) noexcept;
+
+  /// To handle incomplete MEF basic event type with unique pointers.
+  ~Pdag() noexcept;
 
   /// @returns Non-declarative substitutions to be applied by analysis.
   const std::vector<Substitution>& substitutions() const {
@@ -942,6 +953,15 @@ class Pdag : private boost::noncopyable {
     return basic_events_;
   }
 
+  /// @returns The house events kept as symbolic Variables
+  ///          with the Variable indices.
+  ///          The basic events of these Variables are placeholders
+  ///          with the probabilities of the house event states at construction.
+  const std::vector<std::pair<const mef::HouseEvent*, int>>&
+  house_events() const {
+    return house_events_;
+  }
+
   /// Prints the PDAG in the Aralia format.
   /// This is a helper for logging and debugging.
   /// The output is the standard error.
@@ -1012,6 +1032,14 @@ class Pdag : private boost::noncopyable {
   struct ProcessedNodes {  /// @{
     std::unordered_map<const mef::Gate*, GatePtr> gates;
     std::unordered_map<const mef::BasicEvent*, VariablePtr> variables;
+    /// The symbolic house events with Variables once gathered.
+    std::unordered_map<const mef::HouseEvent*, VariablePtr> house_events;
+    /// The CCF events of the group members
+    /// with the member gates once constructed.
+    std::unordered_map<const mef::BasicEvent*,
+                       std::pair<std::vector<const mef::CcfEvent*>, GatePtr>>
+        ccf_members;
+    double ccf_cut_off = 0;  ///< The probability of negligible CCF events.
   };  /// @}
 
   /// Gathers and initializes Variables from Basic Events.
@@ -1026,8 +1054,7 @@ class Pdag : private boost::noncopyable {
                        ProcessedNodes* nodes) noexcept;
 
   /// Initializes Variable from a Basic Event or
-  /// continues the initialization of CCF Events
-  /// belonging to the corresponding CCF gates.
+  /// the CCF Events of the CCF group member.
   ///
   /// @param[in] basic_event  A Basic Event belonging to a formula.
   /// @param[in] ccf  A flag to gather CCF basic events and gates.
@@ -1035,6 +1062,15 @@ class Pdag : private boost::noncopyable {
   void GatherVariables(const mef::BasicEvent& basic_event, bool ccf,
                        ProcessedNodes* nodes) noexcept;
 
+  /// Initializes Variable from a symbolic House Event.
+  ///
+  /// @param[in] house_event  A House Event belonging to a formula.
+  /// @param[in,out] nodes  The mapping of gathered Variables.
+  ///
+  /// @post The constant House Events are ignored.
+  void GatherVariables(const mef::HouseEvent& house_event,
+                       ProcessedNodes* nodes) noexcept;
+
   /// Gathers Variables from substitutions.
   ///
   /// @param[in] substitution  The substitution rule.
@@ -1133,6 +1169,10 @@ class Pdag : private boost::noncopyable {
   ConstantPtr constant_;  ///< The single constant TRUE for the whole graph.
   /// Mapping for basic events and their Variable indices.
   IndexMap<const mef::BasicEvent*> basic_events_;
+  /// The symbolic house events and their Variable indices.
+  std::vector<std::pair<const mef::HouseEvent*, int>> house_events_;
+  /// The placeholder basic events of the symbolic house events.
+  std::vector<std::unique_ptr<mef::BasicEvent>> house_placeholders_;
   /// Container for NULL type gates to be tracked and cleaned by algorithms.
   /// NULL type gates are created by gates with only one argument.
   std::vector<GateWeakPtr> null_gates_;
@@ -1205,6 +1245,101 @@ void Pdag::Clear(const GatePtr& gate) noexcept {
   }
 }
 
+/// Compact read-only representation of a preprocessed PDAG.
+/// Gates are stored in contiguous arrays
+/// and addressed by the node indices of the original graph.
+/// The arguments of all gates are kept in a single flat array
+/// of signed node indices (negative for complements).
+///
+/// The representation is meant for decision diagram converters,
+/// which only read the graph structure
+/// without the overhead of shared nodes and their bookkeeping.
+class CompactPdag : private boost::noncopyable {
+ public:
+  /// Takes a snapshot of the gates reachable from the root.
+  ///
+  /// @param[in] graph  The preprocessed PDAG.
+  ///
+  /// @pre Gate orders are assigned.
+  ///
+  /// @note Constant arguments are not recorded.
+  explicit CompactPdag(const Pdag& graph) noexcept;
+
+  /// @returns The index of the root gate.
+  int root() const { return root_; }
+
+  /// @param[in] index  Positive index of a node in the graph.
+  ///
+  /// @returns true if the node is a gate.
+  bool IsGate(int index) const { return index >= gate_start_; }
+
+  /// @param[in] index  Positive index of a variable or gate.
+  ///
+  /// @returns The order of the node.
+  int order(int index) const {
+    return IsGate(index) ? orders_[position(index)] : var_orders_[index];
+  }
+
+  /// @param[in] gate  The index of a gate in the graph.
+  ///
+  /// @returns The connective of the gate.
+  Connective type(int gate) const { return types_[position(gate)]; }
+
+  /// @param[in] gate  The index of a gate in the graph.
+  ///
+  /// @returns true if the gate is a module.
+  bool module(int gate) const { return flags_[position(gate)] & kModule; }
+
+  /// @param[in] gate  The index of a gate in the graph.
+  ///
+  /// @returns true if the gate is the root of a coherent sub-graph.
+  bool coherent(int gate) const { return flags_[position(gate)] & kCoherent; }
+
+  /// @param[in] gate  The index of a gate in the graph.
+  ///
+  /// @returns The number of parents of the gate.
+  int num_parents(int gate) const { return num_parents_[position(gate)]; }
+
+  /// @param[in] gate  The index of a gate in the graph.
+  ///
+  /// @returns Signed indices of variable arguments followed by gate arguments.
+  auto args(int gate) const {
+    int pos = position(gate);
+    return boost::make_iterator_range(args_.begin() + arg_offsets_[pos],
+                                      args_.begin() + arg_offsets_[pos + 1]);
+  }
+
+ private:
+  /// Gate property flags.
+  enum Flag : std::uint8_t { kModule = 1 << 0, kCoherent = 1 << 1 };
+
+  /// @returns The position of the gate in the gate arrays.
+  int position(int gate) const {
+    assert(IsGate(gate) && positions_[gate - gate_start_] >= 0);
+    return positions_[gate - gate_start_];
+  }
+
+  /// Assigns positions to the gate and its descendant gates
+  /// in the depth-first order.
+  ///
+  /// @param[in] gate  The gate to be registered.
+  /// @param[in,out] gates  The registered gates in the order of positions.
+  ///
+  /// @returns The position of the gate.
+  int Register(const Gate& gate, std::vector<const Gate*>* gates) noexcept;
+
+  int root_;  ///< The index of the root gate.
+  int gate_start_;  ///< The index of the first non-variable node.
+  Pdag::IndexMap<int> var_orders_;  ///< The orders of variables.
+  std::vector<int> positions_;  ///< Gate positions mapped by indices.
+  std::vector<Connective> types_;  ///< Gate connectives.
+  std::vector<std::uint8_t> flags_;  ///< Gate module and coherence flags.
+  std::vector<int> orders_;  ///< Gate orders.
+  std::vector<int> num_parents_;  ///< The number of parents of gates.
+  std::vector<int> arg_offsets_;  ///< The gate positions in the arguments.
+  std::vector<int> args_;  ///< Signed arguments of all gates.
+};
+
 /// Prints PDAG nodes in the Aralia format.
 /// @{
 std::ostream& operator<<(std::ostream& os, const Constant& constant);
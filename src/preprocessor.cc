@@ -87,6 +87,7 @@
 
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
+#include "ext/parallel.h"
 #include "logger.h"
 
 namespace scram::core {
@@ -127,7 +128,12 @@ void TopologicalOrder(Pdag* graph) noexcept {
 }
 
 void MarkCoherence(Pdag* graph) noexcept {
-  auto mark_coherence = [](auto& self, const GatePtr& gate) {
+  auto constant = [graph](int index) {
+    return ext::any_of(graph->house_events(), [index](const auto& entry) {
+      return entry.second == index;
+    });
+  };
+  auto mark_coherence = [&constant](auto& self, const GatePtr& gate) {
     if (gate->mark())
       return;
     gate->mark(true);
@@ -149,7 +155,7 @@ void MarkCoherence(Pdag* graph) noexcept {
     }
     if (coherent) {
       for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
-        if (arg.first < 0) {
+        if (arg.first < 0 && !constant(-arg.first)) {
           coherent = false;
           break;
         }
@@ -167,7 +173,8 @@ void MarkCoherence(Pdag* graph) noexcept {
 
 }  // namespace pdag
 
-Preprocessor::Preprocessor(Pdag* graph) noexcept : graph_(graph) {}
+Preprocessor::Preprocessor(Pdag* graph, int max_threads) noexcept
+    : graph_(graph), max_threads_(max_threads) {}
 
 void Preprocessor::operator()() noexcept {
   TIMER(DEBUG2, "Preprocessing");
@@ -1121,7 +1128,10 @@ bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
   std::vector<GateWeakPtr> modules = GatherModules();
   graph_->Clear<Pdag::kGateMark>();
   LOG(DEBUG4) << "Working with " << modules.size() << " modules...";
-  bool changed = false;
+  // The candidates are gathered and filtered module-by-module
+  // because the traversal marks and the filtering transformations
+  // are not confined to the module.
+  std::vector<ModuleMergeTables> module_tables;
   for (const auto& module : modules) {
     if (module.expired())
       continue;
@@ -1134,26 +1144,56 @@ bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
     FilterMergeCandidates(&candidates);
     if (candidates.size() < 2)
       continue;
-    std::vector<MergeTable::Candidates> groups;
-    GroupCandidatesByArgs(&candidates, &groups);
-    for (const auto& group : groups) {
-      // Finding common parents for the common arguments.
-      MergeTable::Collection parents;
-      GroupCommonParents(2, group, &parents);
-      if (parents.empty())
+    module_tables.push_back({std::move(candidates), {}, {}});
+  }
+  // Modules share no nodes,
+  // and the groups of candidates share no arguments,
+  // so the merge tables are constructed concurrently
+  // with read-only access to the graph.
+  // The workers do not log;
+  // the results are reported and applied in the sequential order afterwards.
+  LOG(DEBUG4) << "Grouping common arguments in " << module_tables.size()
+              << " modules...";
+  ext::parallel_for_each(
+      module_tables,
+      [this](ModuleMergeTables& module) {
+        GroupCandidatesByArgs(&module.candidates, &module.groups);
+        module.tables.resize(module.groups.size());
+      },
+      max_threads_);
+  using CandidateGroup = std::pair<const MergeTable::Candidates*, MergeTable*>;
+  std::vector<CandidateGroup> groups;
+  for (ModuleMergeTables& module : module_tables) {
+    for (std::size_t i = 0; i < module.groups.size(); ++i)
+      groups.emplace_back(&module.groups[i], &module.tables[i]);
+  }
+  ext::parallel_for_each(
+      groups,
+      [this](const CandidateGroup& group) {
+        // Finding common parents for the common arguments.
+        MergeTable::Collection parents;
+        GroupCommonParents(2, *group.first, &parents);
+        if (!parents.empty())
+          GroupCommonArgs(parents, group.second);
+      },
+      max_threads_);
+  bool changed = false;
+  for (ModuleMergeTables& module : module_tables) {
+    BLOG(DEBUG4, !module.groups.empty()) << "Grouped merge candidates in "
+                                         << module.groups.size()
+                                         << " group(s).";
+    for (MergeTable& table : module.tables) {
+      if (table.groups.empty())
         continue;  // No candidates for merging.
       changed = true;
-      LOG(DEBUG4) << "Merging " << parents.size() << " collection...";
-      MergeTable table;
-      GroupCommonArgs(parents, &table);
       LOG(DEBUG4) << "Transforming " << table.groups.size()
                   << " table groups...";
       for (MergeTable::MergeGroup& member_group : table.groups) {
         TransformCommonArgs(&member_group);
       }
     }
-    graph_->RemoveNullGates();
   }
+  graph_->RemoveNullGates();
   return changed;
 }
 
@@ -1340,8 +1380,6 @@ void Preprocessor::GroupCandidatesByArgs(
         groups->emplace_back(std::move(group));
     }
   }
-  BLOG(DEBUG4, !groups->empty())
-      << "Grouped merge candidates in " << groups->size() << " group(s).";
 }
 
 void Preprocessor::GroupCommonParents(
@@ -1872,6 +1910,7 @@ void Preprocessor::ProcessCommonNode(
   }
   ClearStateMarks(root);
   node->opti_value(0);
+  root.reset();  // The detached constant module must die with its NULL gate.
   graph_->RemoveNullGates();
 }
 
@@ -74,6 +74,8 @@ std::vector<T*> OrderArguments(Gate* gate) noexcept;
 void TopologicalOrder(Pdag* graph) noexcept;
 
 /// Marks coherence of the whole graph.
+/// Complements of the symbolic house event variables are ignored
+/// because the variables are constants in the analyzed functions.
 ///
 /// @param[in,out] graph  The graph to be processed.
 ///
@@ -101,7 +103,12 @@ class Preprocessor : private boost::noncopyable {
   ///          the destructor will not be called
   ///          as expected by the preprocessing algorithms,
   ///          which will mess the new structure of the PDAG.
-  explicit Preprocessor(Pdag* graph) noexcept;
+  ///
+  /// @param[in] max_threads  The maximum number of threads
+  ///                         for the concurrent parts of preprocessing
+  ///                         (0 for the hardware concurrency).
+  ///                         The result does not depend on this number.
+  explicit Preprocessor(Pdag* graph, int max_threads = 0) noexcept;
 
   virtual ~Preprocessor() = default;
 
@@ -453,6 +460,9 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @note The connective or logic of the gates must allow merging.
   ///       OR/AND connectives are expected.
+  /// @note The merge tables of independent candidate groups
+  ///       are constructed concurrently
+  ///       while the graph transformations remain sequential.
   ///
   /// @warning Gate marks are used for traversal.
   /// @warning Node counts are used for common node detection.
@@ -490,6 +500,14 @@ class Preprocessor : private boost::noncopyable {
     std::vector<MergeGroup> groups;  ///< Container of isolated groups.
   };
 
+  /// Merge candidates of a single module
+  /// with the merge tables for their groups.
+  struct ModuleMergeTables {
+    MergeTable::Candidates candidates;  ///< Filtered candidates in the module.
+    std::vector<MergeTable::Candidates> groups;  ///< Groups by common args.
+    std::vector<MergeTable> tables;  ///< The tables for candidate groups.
+  };
+
   /// Gathers common arguments of the gates
   /// in the group of a specific connective.
   /// The common arguments must be marked
@@ -553,6 +571,8 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @param[in] options  Combinations of common args and distributive gates.
   /// @param[out] table  Groups of distributive gates for separate manipulation.
+  ///
+  /// @note The graph is only inspected, not modified.
   void GroupCommonArgs(const MergeTable::Collection& options,
                        MergeTable* table) noexcept;
 
@@ -993,6 +1013,7 @@ class Preprocessor : private boost::noncopyable {
 
   /// @todo Eliminate the protected data.
   Pdag* graph_;  ///< The PDAG to preprocess.
+  int max_threads_;  ///< The maximum number of concurrent threads.
 };
 
 /// Undefined template class for specialization of Preprocessor
@@ -21,6 +21,9 @@
 
 #include "probability_analysis.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
@@ -33,10 +36,15 @@ namespace scram::core {
 
 ProbabilityAnalysis::ProbabilityAnalysis(const FaultTreeAnalysis* fta,
                                          mef::MissionTime* mission_time)
-    : Analysis(fta->settings()), p_total_(0), mission_time_(mission_time) {}
+    : Analysis(fta->settings()), p_total_(0), mission_time_(mission_time) {
+  // The quantification may be repeated with a different mission time.
+  Analysis::settings().mission_time(mission_time->value());
+}
 
 void ProbabilityAnalysis::Analyze() noexcept {
   CLOCK(p_time);
+  TRACE("Probability analysis");
+  Statistics::Usage usage(&Analysis::statistics());
   LOG(DEBUG3) << "Calculating probabilities...";
   // Get the total probability.
   p_total_ = this->CalculateTotalProbability();
@@ -246,6 +254,8 @@ double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
 void ProbabilityAnalyzer<Bdd>::CreateBdd(
     const FaultTreeAnalysis& fta) noexcept {
   CLOCK(total_time);
+  TRACE("Creating BDD for probability analysis");
+  Statistics::Usage usage(&Analysis::statistics());
 
   CLOCK(ft_creation);
   Pdag graph(fta.top_event(), Analysis::settings().ccf_analysis());
@@ -259,6 +269,7 @@ void ProbabilityAnalyzer<Bdd>::CreateBdd(
   CLOCK(bdd_time);  // BDD based calculation time.
   LOG(DEBUG2) << "Creating BDD for Probability Analysis...";
   bdd_graph_ = new Bdd(&graph, Analysis::settings());
+  Analysis::statistics().Merge(bdd_graph_->statistics());
   LOG(DEBUG2) << "BDD is created in " << DUR(bdd_time);
 
   Analysis::AddAnalysisTime(DUR(total_time));
@@ -290,4 +301,168 @@ double ProbabilityAnalyzer<Bdd>::CalculateProbability(
   return ite.p();
 }
 
+double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
+    const Pdag::IndexMap<double>& p_vars,
+    const std::vector<int>& changes) noexcept {
+  CLOCK(calc_time);
+  const Bdd::Function& root = bdd_graph_->root();
+  if (root.vertex->terminal())
+    return root.complement ? 0 : 1;
+  if (!dependency_index_)
+    BuildDependencyIndex();
+  DependencyIndex& index = *dependency_index_;
+  ++index.stamp;
+  int num_vertices = index.vertices.size();
+  int first_rank = num_vertices;
+  for (int variable : changes) {
+    for (int rank : index.variable_vertices[variable]) {
+      index.stamps[rank] = index.stamp;
+      first_rank = std::min(first_rank, rank);
+    }
+  }
+  /// @returns The probability of the vertex as the edge target.
+  auto get_p = [](const Bdd::VertexPtr& vertex) {
+    return vertex->terminal() ? 1 : Ite::Ref(vertex).p();
+  };
+  int num_updates = 0;
+  // The ranks are topological, so the children are always updated first,
+  // and the marked parents are visited later in the same sweep.
+  for (int rank = first_rank; rank < num_vertices; ++rank) {
+    if (index.stamps[rank] != index.stamp)
+      continue;
+    ++num_updates;
+    auto& [ite, module] = index.vertices[rank];
+    double p_var = 0;
+    if (module) {
+      p_var = get_p(module->vertex);
+      if (module->complement)
+        p_var = 1 - p_var;
+    } else {
+      p_var = p_vars[ite->index()];
+    }
+    double high = get_p(ite->high());
+    double low = get_p(ite->low());
+    if (ite->complement_edge())
+      low = 1 - low;
+    double p = p_var * high + (1 - p_var) * low;
+    if (p == ite->p())
+      continue;  // The ancestors are not affected.
+    ite->p(p);
+    for (int i = index.parent_offsets[rank]; i < index.parent_offsets[rank + 1];
+         ++i) {
+      index.stamps[index.parents[i]] = index.stamp;
+    }
+  }
+  double prob = Ite::Ref(root.vertex).p();
+  if (root.complement)
+    prob = 1 - prob;
+  LOG(DEBUG4) << "Updated " << num_updates << " BDD vertices in "
+              << DUR(calc_time);
+  return prob;
+}
+
+double ProbabilityAnalyzer<Bdd>::EvaluateTotalProbability(
+    const Pdag::IndexMap<double>& p_vars,
+    std::vector<double>* workspace) const noexcept {
+  assert(dependency_index_ && "The evaluation is not prepared.");
+  const Bdd::Function& root = bdd_graph_->root();
+  if (root.vertex->terminal())
+    return root.complement ? 0 : 1;
+  const DependencyIndex& index = *dependency_index_;
+  int num_vertices = index.vertices.size();
+  std::vector<double>& p = *workspace;
+  p.resize(num_vertices);
+  auto get_p = [&p](int rank) { return rank < 0 ? 1 : p[rank]; };
+  for (int rank = 0; rank < num_vertices; ++rank) {
+    auto& [ite, module] = index.vertices[rank];
+    auto& [high, low, function] = index.children[rank];
+    double p_var = 0;
+    if (module) {
+      p_var = get_p(function);
+      if (module->complement)
+        p_var = 1 - p_var;
+    } else {
+      p_var = p_vars[ite->index()];
+    }
+    double p_low = get_p(low);
+    if (ite->complement_edge())
+      p_low = 1 - p_low;
+    p[rank] = p_var * get_p(high) + (1 - p_var) * p_low;
+  }
+  double prob = p.back();  // The root has the last rank.
+  if (root.complement)
+    prob = 1 - prob;
+  return prob;
+}
+
+void ProbabilityAnalyzer<Bdd>::BuildDependencyIndex() noexcept {
+  CLOCK(index_time);
+  TRACE("Indexing BDD dependencies");
+  dependency_index_ = std::make_unique<DependencyIndex>();
+  DependencyIndex& index = *dependency_index_;
+  std::unordered_map<int, int> ranks;  // Vertex ids to ranks.
+  // Post-order traversal for the children-first ranks.
+  auto rank_vertices = [this, &index, &ranks](const Bdd::VertexPtr& vertex,
+                                              auto& self) -> void {
+    if (vertex->terminal() || ranks.count(vertex->id()))
+      return;
+    Ite& ite = Ite::Ref(vertex);
+    const Bdd::Function* module = nullptr;
+    if (ite.module()) {
+      module = &bdd_graph_->modules().find(ite.index())->second;
+      self(module->vertex, self);
+    }
+    self(ite.high(), self);
+    self(ite.low(), self);
+    ranks.emplace(ite.id(), index.vertices.size());
+    index.vertices.emplace_back(&ite, module);
+  };
+  rank_vertices(bdd_graph_->root().vertex, rank_vertices);
+
+  int num_vertices = index.vertices.size();
+  index.variable_vertices.resize(ProbabilityAnalyzerBase::p_vars().size());
+  /// @returns The children ranks of a vertex.
+  auto get_children = [&ranks](const Ite& ite, const Bdd::Function* module) {
+    std::vector<int> children;
+    auto add = [&ranks, &children](const Bdd::VertexPtr& vertex) {
+      if (!vertex->terminal())
+        children.push_back(ranks.find(vertex->id())->second);
+    };
+    if (module)
+      add(module->vertex);
+    add(ite.high());
+    add(ite.low());
+    return children;
+  };
+  /// @returns The rank of a vertex or -1 for the terminal.
+  auto get_rank = [&ranks](const Bdd::VertexPtr& vertex) {
+    return vertex->terminal() ? -1 : ranks.find(vertex->id())->second;
+  };
+  index.children.reserve(num_vertices);
+  for (auto& [ite, module] : index.vertices) {
+    index.children.push_back({get_rank(ite->high()), get_rank(ite->low()),
+                              module ? get_rank(module->vertex) : -1});
+  }
+  index.parent_offsets.assign(num_vertices + 1, 0);
+  for (auto& [ite, module] : index.vertices) {
+    for (int child : get_children(*ite, module))
+      ++index.parent_offsets[child + 1];
+  }
+  for (int i = 0; i < num_vertices; ++i)
+    index.parent_offsets[i + 1] += index.parent_offsets[i];
+  index.parents.resize(index.parent_offsets.back());
+  std::vector<int> fill(index.parent_offsets.begin(),
+                        index.parent_offsets.end() - 1);
+  for (int rank = 0; rank < num_vertices; ++rank) {
+    auto& [ite, module] = index.vertices[rank];
+    for (int child : get_children(*ite, module))
+      index.parents[fill[child]++] = rank;
+    if (!module)
+      index.variable_vertices[ite->index()].push_back(rank);
+  }
+  index.stamps.assign(num_vertices, 0);
+  LOG(DEBUG4) << "Indexed " << num_vertices << " BDD vertices in "
+              << DUR(index_time);
+}
+
 }  // namespace scram::core
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -205,6 +207,27 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   /// @returns A mapping for probability values with indices.
   const Pdag::IndexMap<double>& p_vars() const { return p_vars_; }
 
+  /// Prepares the read-only structures
+  /// for concurrent evaluations of the total probability.
+  ///
+  /// @pre The analysis is done.
+  virtual void PrepareEvaluation() noexcept {}
+
+  /// Evaluates the total probability
+  /// with a different set of probability values
+  /// without changing the analyzer or its decision diagrams,
+  /// so the evaluations are safe to run concurrently.
+  ///
+  /// @param[in] p_vars  A map of probabilities of the graph variables.
+  /// @param[in,out] workspace  The scratch memory private to the caller.
+  ///
+  /// @returns The total probability calculated with the given values.
+  ///
+  /// @pre The evaluation is prepared.
+  virtual double EvaluateTotalProbability(
+      const Pdag::IndexMap<double>& p_vars,
+      std::vector<double>* workspace) const noexcept = 0;
+
  protected:
   ~ProbabilityAnalyzerBase() override = default;
 
@@ -257,6 +280,12 @@ class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
     return calc_.Calculate(ProbabilityAnalyzerBase::products(), p_vars);
   }
 
+  double EvaluateTotalProbability(
+      const Pdag::IndexMap<double>& p_vars,
+      std::vector<double>* /*workspace*/) const noexcept final {
+    return Calculator().Calculate(ProbabilityAnalyzerBase::products(), p_vars);
+  }
+
  private:
   Calculator calc_;  ///< Provider of the calculation logic.
 };
@@ -302,7 +331,66 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   double CalculateTotalProbability(
       const Pdag::IndexMap<double>& p_vars) noexcept final;
 
+  /// Updates the total probability
+  /// after changes in the probabilities of some variables.
+  /// Only the vertices of the changed variables and their ancestors
+  /// are recomputed in a single bottom-up sweep over the vertex ranks.
+  /// The propagation stops at vertices with unchanged probabilities.
+  ///
+  /// @param[in] p_vars  The probabilities of the variables
+  ///                    mapped by their indices.
+  /// @param[in] changes  The indices of the variables
+  ///                     with new probabilities in p_vars.
+  ///
+  /// @returns The total probability calculated with the given values.
+  ///
+  /// @pre The BDD vertices hold the probabilities of the last calculation
+  ///      with the same p_vars except for the changed variables.
+  ///
+  /// @note The reverse dependency index is built upon the first call.
+  double CalculateTotalProbability(const Pdag::IndexMap<double>& p_vars,
+                                   const std::vector<int>& changes) noexcept;
+
+  /// Builds the dependency index of the BDD vertices if needed.
+  void PrepareEvaluation() noexcept final {
+    if (!dependency_index_)
+      BuildDependencyIndex();
+  }
+
+  /// Evaluates the BDD vertices in the order of their ranks
+  /// with the vertex probabilities kept in the workspace.
+  double EvaluateTotalProbability(
+      const Pdag::IndexMap<double>& p_vars,
+      std::vector<double>* workspace) const noexcept final;
+
  private:
+  /// The reverse dependencies of the BDD vertices for incremental updates.
+  struct DependencyIndex {
+    /// The vertices in the topological order with children first
+    /// together with their module functions if any.
+    /// The position of a vertex is its rank.
+    std::vector<std::pair<Ite*, const Bdd::Function*>> vertices;
+    /// The ranks of the high, low, and module function vertices
+    /// with -1 for the terminal vertex and no module.
+    std::vector<std::array<int, 3>> children;
+    /// The ranks of the parent vertices (including module proxies)
+    /// in the compressed row format over vertex ranks.
+    /// @{
+    std::vector<int> parent_offsets;
+    std::vector<int> parents;
+    /// @}
+    /// The ranks of the vertices testing the variables.
+    Pdag::IndexMap<std::vector<int>> variable_vertices;
+    /// The update stamps marking the vertices to recompute.
+    std::vector<int> stamps;
+    int stamp = 0;  ///< The current update stamp.
+  };
+
+  /// Builds the reverse dependency index of the BDD vertices.
+  ///
+  /// @post The index is valid as long as the BDD doesn't change.
+  void BuildDependencyIndex() noexcept;
+
   /// Creates a new BDD for use by the analyzer.
   ///
   /// @param[in] fta  The fault tree analysis providing the root gate.
@@ -328,6 +416,8 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   Bdd* bdd_graph_;  ///< The main BDD graph for analysis.
   bool current_mark_;  ///< To keep track of BDD current mark.
   bool owner_;  ///< Indication that pointers are handles.
+  /// The lazy index for incremental probability updates.
+  std::unique_ptr<DependencyIndex> dependency_index_;
 };
 
 }  // namespace scram::core
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of analysis progress reporting.
+
+#include "progress.h"
+
+#include <cassert>
+
+namespace scram::core {
+
+std::string Progress::target() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_;
+}
+
+void Progress::Start(std::string name, double begin, double end) noexcept {
+  assert(0 <= begin && begin <= end && end <= 1 && "Invalid completion.");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    target_ = std::move(name);
+  }
+  begin_ = begin;
+  end_ = end;
+  stage_ = Stage::kProducts;
+  fraction_ = begin;
+}
+
+void Progress::Finish() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    target_.clear();
+  }
+  stage_ = Stage::kIdle;
+  fraction_ = cancelled() ? begin_ : 1;
+}
+
+}  // namespace scram::core
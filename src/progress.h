@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Progress reporting and cooperative cancellation of analyses.
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+namespace scram::core {
+
+/// Observer and controller of a running analysis.
+/// The analysis reports its current target, stage, and completion
+/// while another thread may poll the state or request cancellation.
+///
+/// The cancellation is cooperative:
+/// long-running algorithms check the token
+/// and unwind as soon as possible with incomplete results,
+/// which are discarded by the risk analysis.
+///
+/// @note All member functions are safe to call concurrently.
+///       Cancel() is also safe to call from a signal handler.
+class Progress : private boost::noncopyable {
+ public:
+  /// The stages of analysis per target.
+  enum class Stage : std::uint8_t {
+    kIdle = 0,  ///< No analysis is running.
+    kProducts,  ///< Preprocessing and generation of products.
+    kProbability,  ///< Probability analysis.
+    kImportance,  ///< Importance analysis.
+    kUncertainty,  ///< Monte Carlo uncertainty analysis.
+    kSweep  ///< Parameter sweep.
+  };
+
+  /// Requests the analysis to stop.
+  void Cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+
+  /// @returns true if the cancellation has been requested.
+  bool cancelled() const noexcept {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+  /// @returns The current stage of the analysis.
+  Stage stage() const noexcept { return stage_.load(); }
+
+  /// @returns The name of the current analysis target.
+  std::string target() const;
+
+  /// @returns The completion fraction of the whole analysis in [0, 1].
+  double fraction() const noexcept { return fraction_.load(); }
+
+  /// Starts reporting for a new analysis target.
+  ///
+  /// @param[in] name  The name of the target.
+  /// @param[in] begin  The completion of the whole analysis before the target.
+  /// @param[in] end  The completion of the whole analysis after the target.
+  ///
+  /// @pre 0 <= begin <= end <= 1.
+  void Start(std::string name, double begin, double end) noexcept;
+
+  /// Moves the analysis of the current target to the next stage.
+  ///
+  /// @param[in] value  The new stage.
+  void stage(Stage value) noexcept { stage_ = value; }
+
+  /// Updates the completion within the current target.
+  ///
+  /// @param[in] done  The completed fraction of the current target.
+  void Advance(double done) noexcept {
+    fraction_ = begin_ + (end_ - begin_) * done;
+  }
+
+  /// Finishes the whole analysis.
+  void Finish() noexcept;
+
+ private:
+  std::atomic<bool> cancelled_ = false;  ///< The cancellation request.
+  std::atomic<Stage> stage_ = Stage::kIdle;  ///< The current target stage.
+  std::atomic<double> fraction_ = 0;  ///< The total completion.
+  double begin_ = 0;  ///< The total completion before the current target.
+  double end_ = 0;  ///< The total completion after the current target.
+  mutable std::mutex mutex_;  ///< The guard of the target name.
+  std::string target_;  ///< The current target name.
+};
+
+}  // namespace scram::core
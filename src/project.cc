@@ -25,7 +25,9 @@
 #include <array>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string_view>
+#include <utility>
 
 #include <boost/predef.h>
 
@@ -128,11 +130,23 @@ void Project::GatherOptions(const xml::Element& root) {
       } else if (name == "prime-implicants") {
         settings_.prime_implicants(true);
 
+      } else if (name == "compile-phases") {
+        settings_.compile_phases(true);
+
+      } else if (name == "gate-probabilities") {
+        std::vector<std::string> ids;
+        for (xml::Element gate : option_group.children("gate"))
+          ids.emplace_back(gate.attribute("name"));
+        settings_.probability_gates(std::move(ids));
+
       } else if (name == "approximation") {
         settings_.approximation(option_group.attribute("name"));
 
       } else if (name == "limits") {
         SetLimits(option_group);
+
+      } else if (name == "sweep") {
+        AddSweep(option_group);
       }
     } catch (SettingsError& err) {
       err << boost::errinfo_at_line(option_group.line());
@@ -175,6 +189,9 @@ void Project::SetLimits(const xml::Element& limits) {
     } else if (name == "cut-off") {
       settings_.cut_off(limit.text<double>());
 
+    } else if (name == "top-products") {
+      settings_.top_products(limit.text<int>());
+
     } else if (name == "mission-time") {
       settings_.mission_time(limit.text<double>());
 
@@ -196,4 +213,20 @@ void Project::SetLimits(const xml::Element& limits) {
   }
 }
 
+void Project::AddSweep(const xml::Element& sweep) {
+  std::string parameter(sweep.attribute("parameter"));
+  std::string_view values = sweep.attribute("values");
+  if (values.empty()) {
+    settings_.sweep(std::move(parameter), *sweep.attribute<double>("from"),
+                    *sweep.attribute<double>("to"),
+                    *sweep.attribute<int>("points"));
+    return;
+  }
+  std::istringstream stream{std::string(values)};
+  std::vector<double> numbers;
+  for (double value; stream >> value;)
+    numbers.push_back(value);
+  settings_.sweep(std::move(parameter), std::move(numbers));
+}
+
 }  // namespace scram
@@ -79,6 +79,11 @@ class Project {
   /// @param[in] limits  An XML element containing various limits.
   void SetLimits(const xml::Element& limits);
 
+  /// Extracts a parameter with its values for the parameter sweep.
+  ///
+  /// @param[in] sweep  The sweep element with a list or grid of values.
+  void AddSweep(const xml::Element& sweep);
+
   /// Container for input files for analysis.
   /// These input files contain fault trees, events, etc.
   std::vector<std::string> input_files_;
@@ -23,6 +23,7 @@
 #include <ctime>
 
 #include <memory>
+#include <sstream>
 #include <utility>
 #include <vector>
 
@@ -38,6 +39,7 @@
 #include "error.h"
 #include "logger.h"
 #include "parameter.h"
+#include "shard_merger.h"
 #include "version.h"
 
 namespace scram {
@@ -66,6 +68,31 @@ void PutId(const core::RiskAnalysis::Result::Id& id,
   }
 }
 
+/// @returns The analysis settings with the automatically selected
+///          algorithm and approximation if all the targets agree on them.
+core::Settings SelectedSettings(const core::RiskAnalysis& risk_an) {
+  core::Settings settings = risk_an.settings();
+  if (settings.algorithm() != core::Algorithm::kAuto)
+    return settings;
+  const core::AlgorithmChoice* choice = nullptr;
+  for (const core::RiskAnalysis::Result& result : risk_an.results()) {
+    if (!result.algorithm_choice)
+      continue;
+    if (choice &&
+        (choice->algorithm != result.algorithm_choice->algorithm ||
+         choice->approximation != result.algorithm_choice->approximation)) {
+      return settings;  // Mixed selections.
+    }
+    choice = &*result.algorithm_choice;
+  }
+  if (!choice)
+    return settings;
+  if (choice->algorithm != core::Algorithm::kBdd)
+    settings.compile_phases(false).gate_probabilities(false);  // BDD only.
+  settings.algorithm(choice->algorithm).approximation(choice->approximation);
+  return settings;
+}
+
 }  // namespace
 
 void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
@@ -88,16 +115,25 @@ void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
   for (const core::RiskAnalysis::Result& result : risk_an.results()) {
     if (result.fault_tree_analysis)
       ReportResults(result.id, *result.fault_tree_analysis,
-                    result.probability_analysis.get(), &results);
+                    result.probability_analysis.get(),
+                    result.algorithm_choice ? &*result.algorithm_choice
+                                            : nullptr,
+                    &results);
 
     if (result.probability_analysis)
       ReportResults(result.id, *result.probability_analysis, &results);
 
+    if (!result.gate_probabilities.empty())
+      ReportResults(result.id, result.gate_probabilities, &results);
+
     if (result.importance_analysis)
       ReportResults(result.id, *result.importance_analysis, &results);
 
     if (result.uncertainty_analysis)
       ReportResults(result.id, *result.uncertainty_analysis, &results);
+
+    if (result.sweep_analysis)
+      ReportResults(result.id, *result.sweep_analysis, &results);
   }
 }
 
@@ -138,10 +174,30 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
         break;
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
+        break;
+      case core::Algorithm::kAuto:
+        methods.SetAttribute("name", "Automatic Selection");
     }
-    methods.AddChild("limits")
-        .AddChild("product-order")
-        .AddText(settings.limit_order());
+    xml::StreamElement limits = methods.AddChild("limits");
+    limits.AddChild("product-order").AddText(settings.limit_order());
+    if (settings.top_products())
+      limits.AddChild("top-products").AddText(settings.top_products());
+    if (settings.prime_implicants() && settings.cut_off())
+      limits.AddChild("cut-off").AddText(settings.cut_off());
+  }
+  if (settings.compile_phases()) {
+    information->AddChild("calculated-quantity")
+        .SetAttribute("name", "Phase Compilation")
+        .SetAttribute("definition",
+                      "Restriction of fault trees compiled once per alignment"
+                      " to the house event states of phases");
+  }
+  if (settings.gate_probabilities()) {
+    information->AddChild("calculated-quantity")
+        .SetAttribute("name", "Gate Probabilities")
+        .SetAttribute("definition",
+                      "Probabilities of the intermediate gates"
+                      " from the compiled BDD of the top event");
   }
   if (settings.ccf_analysis()) {
     information->AddChild("calculated-quantity")
@@ -159,21 +215,29 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
   quant.SetAttribute("name", "Probability Analysis")
       .SetAttribute("definition",
                     "Quantitative analysis of"
-                    " failure probability or unavailability")
-      .SetAttribute("approximation",
-                    core::kApproximationToString[static_cast<int>(
-                        settings.approximation())]);
+                    " failure probability or unavailability");
+  // The approximations selected per target are reported with the results.
+  bool selected = settings.algorithm() == core::Algorithm::kAuto;
+  if (!selected) {
+    quant.SetAttribute("approximation",
+                       core::kApproximationToString[static_cast<int>(
+                           settings.approximation())]);
+  }
 
   xml::StreamElement methods = quant.AddChild("calculation-method");
-  switch (settings.approximation()) {
-    case core::Approximation::kNone:
-      methods.SetAttribute("name", "Binary Decision Diagram");
-      break;
-    case core::Approximation::kRareEvent:
-      methods.SetAttribute("name", "Rare-Event Approximation");
-      break;
-    case core::Approximation::kMcub:
-      methods.SetAttribute("name", "MCUB Approximation");
+  if (selected) {
+    methods.SetAttribute("name", "Automatic Selection");
+  } else {
+    switch (settings.approximation()) {
+      case core::Approximation::kNone:
+        methods.SetAttribute("name", "Binary Decision Diagram");
+        break;
+      case core::Approximation::kRareEvent:
+        methods.SetAttribute("name", "Rare-Event Approximation");
+        break;
+      case core::Approximation::kMcub:
+        methods.SetAttribute("name", "MCUB Approximation");
+    }
   }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("mission-time").AddText(settings.mission_time());
@@ -210,6 +274,17 @@ void Reporter::ReportCalculatedQuantity<core::UncertaintyAnalysis>(
   }
 }
 
+/// Describes the parameter sweep.
+template <>
+void Reporter::ReportCalculatedQuantity<core::SweepAnalysis>(
+    const core::Settings& /*settings*/, xml::StreamElement* information) {
+  information->AddChild("calculated-quantity")
+      .SetAttribute("name", "Parameter Sweep")
+      .SetAttribute("definition",
+                    "Quantitative analysis over combinations of "
+                    "parameter values with the same products.");
+}
+
 /// Describes all performed analyses deduced from settings.
 template <>
 void Reporter::ReportCalculatedQuantity<core::RiskAnalysis>(
@@ -230,6 +305,9 @@ void Reporter::ReportCalculatedQuantity<core::RiskAnalysis>(
   if (settings.uncertainty_analysis()) {
     ReportCalculatedQuantity<core::UncertaintyAnalysis>(settings, information);
   }
+  if (!settings.sweep().empty()) {
+    ReportCalculatedQuantity<core::SweepAnalysis>(settings, information);
+  }
 }
 
 void Reporter::ReportInformation(const core::RiskAnalysis& risk_an,
@@ -237,8 +315,10 @@ void Reporter::ReportInformation(const core::RiskAnalysis& risk_an,
   xml::StreamElement information = report->AddChild("information");
   ReportSoftwareInformation(&information);
   ReportPerformance(risk_an, &information);
-  ReportCalculatedQuantity(risk_an.settings(), &information);
+  ReportCalculatedQuantity(SelectedSettings(risk_an), &information);
   ReportModelFeatures(risk_an.model(), &information);
+  if (!risk_an.warnings().empty())
+    information.AddChild("warning").AddText(risk_an.warnings());
   ReportUnusedElements(risk_an.model().basic_events(),
                        "Unused basic events: ", &information);
   ReportUnusedElements(risk_an.model().house_events(),
@@ -333,6 +413,38 @@ void Reporter::ReportPerformance(const core::RiskAnalysis& risk_an,
     if (result.uncertainty_analysis)
       calc_time.AddChild("uncertainty")
           .AddText(result.uncertainty_analysis->analysis_time());
+
+    if (result.sweep_analysis)
+      calc_time.AddChild("sweep").AddText(
+          result.sweep_analysis->analysis_time());
+  }
+  if (!statistics_)
+    return;
+  for (const core::RiskAnalysis::Result& result : risk_an.results()) {
+    xml::StreamElement statistics = performance.AddChild("statistics");
+    scram::PutId(result.id, &statistics);
+    auto report = [&statistics](const char* stage,
+                                const core::Analysis* analysis) {
+      if (!analysis)
+        return;
+      const core::Statistics& stats = analysis->statistics();
+      xml::StreamElement element = statistics.AddChild(stage);
+      if (stats.process_peak_memory())
+        element.SetAttribute("process-peak-memory",
+                             stats.process_peak_memory());
+      if (stats.allocations())
+        element.SetAttribute("allocations", stats.allocations());
+      for (const core::Statistics::Counter& counter : stats.counters()) {
+        element.AddChild("counter")
+            .SetAttribute("name", counter.first)
+            .SetAttribute("value", static_cast<std::size_t>(counter.second));
+      }
+    };
+    report("products", result.fault_tree_analysis.get());
+    report("probability", result.probability_analysis.get());
+    report("importance", result.importance_analysis.get());
+    report("uncertainty", result.uncertainty_analysis.get());
+    report("sweep", result.sweep_analysis.get());
   }
 }
 
@@ -375,6 +487,7 @@ void Reporter::ReportResults(const core::RiskAnalysis::EtaResult& eta_result,
 void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                              const core::FaultTreeAnalysis& fta,
                              const core::ProbabilityAnalysis* prob_analysis,
+                             const core::AlgorithmChoice* algorithm_choice,
                              xml::StreamElement* results) {
   TIMER(DEBUG2, "Reporting products");
   xml::StreamElement sum_of_products = results->AddChild("sum-of-products");
@@ -393,6 +506,16 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   if (prob_analysis)
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
 
+  if (algorithm_choice) {
+    sum_of_products
+        .SetAttribute("algorithm", core::kAlgorithmToString[static_cast<int>(
+                                       algorithm_choice->algorithm)])
+        .SetAttribute("approximation",
+                      core::kApproximationToString[static_cast<int>(
+                          algorithm_choice->approximation)])
+        .SetAttribute("algorithm-rationale", algorithm_choice->rationale);
+  }
+
   if (fta.products().empty() == false) {
     sum_of_products.SetAttribute(
         "distribution",
@@ -404,8 +527,12 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
 
   double sum = 0;  // Sum of probabilities for contribution calculations.
   if (prob_analysis) {
-    for (const core::Product& product_set : fta.products())
-      sum += product_set.p();
+    if (fta.settings().top_products()) {
+      sum = prob_analysis->p_total();  // Only a fraction of products is known.
+    } else {
+      for (const core::Product& product_set : fta.products())
+        sum += product_set.p();
+    }
   }
   for (const core::Product& product_set : fta.products()) {
     xml::StreamElement product = sum_of_products.AddChild("product");
@@ -545,6 +672,62 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
           .SetAttribute("upper-bound", upper);
     }
   }
+  if (uncert_analysis.settings().num_shards() > 1)
+    WriteSampleStatistics(uncert_analysis.samples(), uncert_analysis.settings(),
+                          &measure);
+}
+
+void Reporter::ReportResults(
+    const core::RiskAnalysis::Result::Id& id,
+    const std::vector<std::pair<const mef::Gate*, double>>& gate_probabilities,
+    xml::StreamElement* results) {
+  xml::StreamElement gates = results->AddChild("gate-probabilities");
+  scram::PutId(id, &gates);
+  gates.SetAttribute("gates", gate_probabilities.size());
+  for (const auto& [gate, p] : gate_probabilities) {
+    gates.AddChild("gate")
+        .SetAttribute("name", gate->id())
+        .SetAttribute("probability", p);
+  }
+}
+
+void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
+                             const core::SweepAnalysis& sweep_analysis,
+                             xml::StreamElement* results) {
+  xml::StreamElement sweep = results->AddChild("parameter-sweep");
+  scram::PutId(id, &sweep);
+  if (!sweep_analysis.warnings().empty()) {
+    sweep.SetAttribute("warning", sweep_analysis.warnings());
+  }
+  sweep.SetAttribute("points", sweep_analysis.points().size());
+  for (const mef::Parameter* parameter : sweep_analysis.parameters())
+    sweep.AddChild("parameter").SetAttribute("name", parameter->id());
+
+  const std::vector<const mef::BasicEvent*>& events =
+      sweep_analysis.important_events();
+  std::ostringstream values;
+  values.precision(15);
+  for (const core::SweepAnalysis::Point& point : sweep_analysis.points()) {
+    values.str("");
+    for (int i = 0; i < point.values.size(); ++i)
+      values << (i ? " " : "") << point.values[i];
+    xml::StreamElement element = sweep.AddChild("point");
+    element.SetAttribute("values", values.str());
+    if (!point.valid)
+      continue;
+    element.SetAttribute("probability", point.p_total);
+    for (int i = 0; i < point.importance.size(); ++i) {
+      const core::ImportanceFactors& factors = point.importance[i];
+      auto add_data = [&factors](xml::StreamElement* event) {
+        event->SetAttribute("MIF", factors.mif)
+            .SetAttribute("CIF", factors.cif)
+            .SetAttribute("DIF", factors.dif)
+            .SetAttribute("RAW", factors.raw)
+            .SetAttribute("RRW", factors.rrw);
+      };
+      ReportBasicEvent(*events[i], &element, add_data);
+    }
+  }
 }
 
 void Reporter::ReportLiteral(const core::Literal& literal,
@@ -573,7 +756,7 @@ void Reporter::ReportBasicEvent(const mef::BasicEvent& basic_event,
         .SetAttribute("order", ccf_event->members().size())
         .SetAttribute("group-size", ccf_group.members().size());
     add_data(&element);
-    for (const mef::Gate* member : ccf_event->members()) {
+    for (const mef::BasicEvent* member : ccf_event->members()) {
       element.AddChild("basic-event").SetAttribute("name", member->name());
     }
   }
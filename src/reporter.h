@@ -23,6 +23,8 @@
 #include <cstdio>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "event.h"
 #include "fault_tree_analysis.h"
@@ -39,6 +41,11 @@ namespace scram {
 /// Facilities to report analysis results.
 class Reporter {
  public:
+  /// @param[in] statistics  The flag to report
+  ///                        the resource usage and data structure statistics
+  ///                        of the analyses.
+  explicit Reporter(bool statistics = false) : statistics_(statistics) {}
+
   /// Reports the results of risk analysis on a model.
   /// The XML report is formed as a single document.
   ///
@@ -99,6 +106,7 @@ class Reporter {
                            xml::StreamElement* information);
 
   /// Reports performance metrics of all conducted analyses.
+  /// The statistics of the analyses are reported only upon request.
   ///
   /// @param[in] risk_an  Risk analysis with all the performance information.
   /// @param[in,out] information  The XML element to append the results.
@@ -135,10 +143,13 @@ class Reporter {
   /// @param[in] fta  Fault Tree Analysis with results.
   /// @param[in] prob_analysis  Probability Analysis with results.
   ///                           Null pointer for no probability analysis.
+  /// @param[in] algorithm_choice  The automatically selected algorithm.
+  ///                              Null pointer for no automatic selection.
   /// @param[in,out] results  XML element to for all results.
   void ReportResults(const core::RiskAnalysis::Result::Id& id,
                      const core::FaultTreeAnalysis& fta,
                      const core::ProbabilityAnalysis* prob_analysis,
+                     const core::AlgorithmChoice* algorithm_choice,
                      xml::StreamElement* results);
 
   /// Reports results of probability analysis.
@@ -168,6 +179,26 @@ class Reporter {
                      const core::UncertaintyAnalysis& uncert_analysis,
                      xml::StreamElement* results);
 
+  /// Reports the probabilities of the intermediate gates.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] gate_probabilities  The gates with their probabilities.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(
+      const core::RiskAnalysis::Result::Id& id,
+      const std::vector<std::pair<const mef::Gate*, double>>&
+          gate_probabilities,
+      xml::StreamElement* results);
+
+  /// Reports the results of the parameter sweep.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] sweep_analysis  Parameter sweep with results.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(const core::RiskAnalysis::Result::Id& id,
+                     const core::SweepAnalysis& sweep_analysis,
+                     xml::StreamElement* results);
+
   /// Reports literal in products.
   ///
   /// @param[in] literal  A literal to be reported.
@@ -190,6 +221,8 @@ class Reporter {
   template <class T>
   void ReportBasicEvent(const mef::BasicEvent& basic_event,
                         xml::StreamElement* parent, const T& add_data);
+
+  bool statistics_;  ///< The flag to report the analysis statistics.
 };
 
 }  // namespace scram
@@ -20,6 +20,9 @@
 
 #include "risk_analysis.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "bdd.h"
 #include "expression/random_deviate.h"
 #include "ext/scope_guard.h"
@@ -35,19 +38,79 @@ RiskAnalysis::RiskAnalysis(mef::Model* model, const Settings& settings)
 
 void RiskAnalysis::Analyze() noexcept {
   assert(results_.empty() && "Rerunning the analysis.");
+  TRACE("Risk analysis");
   // Set the seed for the pseudo-random number generator if given explicitly.
   // Otherwise it defaults to the implementation dependent value.
   if (Analysis::settings().seed() >= 0)
     mef::RandomDeviate::seed(Analysis::settings().seed());
 
+  int num_contexts = 1;
+  if (!model_->alignments().empty()) {
+    num_contexts = 0;
+    for (const mef::Alignment& alignment : model_->alignments())
+      num_contexts += alignment.phases().size();
+  }
+  num_targets_ = 0;
+  for (const mef::InitiatingEvent& initiating_event :
+       model_->initiating_events()) {
+    if (initiating_event.event_tree())
+      ++num_targets_;
+  }
+  for (const mef::FaultTree& ft : model_->fault_trees())
+    num_targets_ += ft.top_events().size();
+  num_targets_ *= num_contexts;
+
   if (model_->alignments().empty()) {
     RunAnalysis();
   } else {
     for (const mef::Alignment& alignment : model_->alignments()) {
+      if (Analysis::settings().compile_phases()) {
+        const auto& house_events = model_->table<mef::HouseEvent>();
+        for (const mef::Phase& phase : alignment.phases()) {
+          for (const mef::SetHouseEvent* instruction : phase.instructions()) {
+            auto it = house_events.find(instruction->name());
+            assert(it != house_events.end() && "Invalid instruction.");
+            if (std::find(phase_house_events_.begin(),
+                          phase_house_events_.end(),
+                          &*it) == phase_house_events_.end()) {
+              phase_house_events_.push_back(&*it);
+            }
+          }
+        }
+      }
       for (const mef::Phase& phase : alignment.phases())
         RunAnalysis(Context{alignment, phase});
+      phase_compilations_.clear();
+      phase_house_events_.clear();
     }
   }
+
+  if (checkpoint_)
+    checkpoint_->Save();
+  if (Progress* progress = Analysis::settings().progress())
+    progress->Finish();
+  if (Analysis::settings().cancelled()) {
+    LOG(WARNING) << "The analysis is cancelled.";
+    Analysis::AddWarning("The analysis is cancelled; the results are partial.");
+  }
+}
+
+void RiskAnalysis::ReportStart(std::string name, int part,
+                               int num_parts) noexcept {
+  Progress* progress = Analysis::settings().progress();
+  if (!progress)
+    return;
+  assert(num_targets_ > 0 && num_done_ < num_targets_);
+  assert(part >= 0 && part < num_parts);
+  double begin =
+      (num_done_ + static_cast<double>(part) / num_parts) / num_targets_;
+  double end = begin + 1.0 / (num_targets_ * num_parts);
+  progress->Start(std::move(name), std::min(begin, 1.0), std::min(end, 1.0));
+}
+
+void RiskAnalysis::ReportStage(Progress::Stage stage) noexcept {
+  if (Progress* progress = Analysis::settings().progress())
+    progress->stage(stage);
 }
 
 void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
@@ -62,95 +125,245 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
           entry.first->state(entry.second);
       });
 
-  if (context) {
-    double mission_time =
-        context->phase.time_fraction() * model_->mission_time().value();
-    model_->mission_time().value(mission_time);
-    Analysis::settings().mission_time(mission_time);
-
-    for (const mef::SetHouseEvent* instruction :
-         context->phase.instructions()) {
-      auto it = model_->table<mef::HouseEvent>().find(instruction->name());
-      assert(it != model_->table<mef::HouseEvent>().end() &&
-             "Invalid instruction.");
-      mef::HouseEvent& house_event = *it;
-      if (house_event.state() != instruction->state()) {
-        house_events.emplace_back(&house_event, house_event.state());
-        house_event.state(instruction->state());
-      }
-    }
-  }
+  if (context)
+    ApplyContext(*context, &house_events);
 
   for (const mef::InitiatingEvent& initiating_event :
        model_->initiating_events()) {
     if (initiating_event.event_tree()) {
+      if (Analysis::settings().cancelled())
+        return;
       LOG(INFO) << "Running event tree analysis: " << initiating_event.name();
+      TRACE("Event tree " + initiating_event.name());
+      ReportStart(initiating_event.name());
       auto eta = std::make_unique<EventTreeAnalysis>(
           initiating_event, Analysis::settings(), model_->context());
       eta->Analyze();
+      int num_sequences = eta->sequences().size();
+      int part = 0;
+      // The results of the sequences before the interruption.
+      auto num_results = results_.size();
       for (EventTreeAnalysis::Result& result : eta->sequences()) {
         const mef::Sequence& sequence = result.sequence;
         LOG(INFO) << "Running analysis for sequence: " << sequence.name();
+        TRACE("Sequence " + sequence.name());
+        ReportStart(sequence.name(), part++, num_sequences);
         results_.push_back(
             {{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{
                   initiating_event, sequence},
               context}});
-        RunAnalysis(*result.gate, &results_.back());
+        Quantifier quantifier = RunAnalysis(*result.gate, &results_.back());
+        if (Analysis::settings().cancelled()) {
+          // The event tree results are incomplete as a whole.
+          while (results_.size() > num_results)
+            results_.pop_back();
+          quantifiers_.resize(num_results);
+          return;
+        }
         if (result.is_expression_only) {
-          results_.back().fault_tree_analysis = nullptr;
+          std::shared_ptr<const FaultTreeAnalysis> fta =
+              std::move(results_.back().fault_tree_analysis);
           results_.back().importance_analysis = nullptr;
+          if (quantifier) {  // The quantifier keeps the hidden analysis.
+            quantifier = [fta, quantify = std::move(quantifier)](Result* out) {
+              quantify(out);
+              out->importance_analysis = nullptr;
+            };
+          }
         }
-        if (Analysis::settings().probability_analysis())
+        if (Analysis::settings().probability_analysis()) {
           result.p_sequence = results_.back().probability_analysis->p_total();
+          quantifier = [&result, quantify = std::move(quantifier)](Result* out) {
+            quantify(out);
+            result.p_sequence = out->probability_analysis->p_total();
+          };
+        }
+        quantifiers_.push_back(std::move(quantifier));
         LOG(INFO) << "Finished analysis for sequence: " << sequence.name();
       }
       event_tree_results_.push_back(
           {initiating_event, context, std::move(eta)});
+      ++num_done_;
       LOG(INFO) << "Finished event tree analysis: " << initiating_event.name();
     }
   }
 
   for (const mef::FaultTree& ft : model_->fault_trees()) {
     for (const mef::Gate* target : ft.top_events()) {
+      if (Analysis::settings().cancelled())
+        return;
       LOG(INFO) << "Running analysis for gate: " << target->id();
+      TRACE("Gate " + target->id());
+      ReportStart(target->id());
       results_.push_back({{target, context}});
-      RunAnalysis(*target, &results_.back());
+      Quantifier quantifier = RunAnalysis(*target, &results_.back());
+      if (Analysis::settings().cancelled()) {
+        results_.pop_back();  // Discard the incomplete results.
+        return;
+      }
+      quantifiers_.push_back(std::move(quantifier));
+      ++num_done_;
       LOG(INFO) << "Finished analysis for gate: " << target->id();
     }
   }
 }
 
-void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
-  switch (Analysis::settings().algorithm()) {
+void RiskAnalysis::ApplyContext(
+    const Context& context,
+    std::vector<std::pair<mef::HouseEvent*, bool>>* house_events) noexcept {
+  double mission_time =
+      context.phase.time_fraction() * model_->mission_time().value();
+  model_->mission_time().value(mission_time);
+  Analysis::settings().mission_time(mission_time);
+
+  for (const mef::SetHouseEvent* instruction : context.phase.instructions()) {
+    auto it = model_->table<mef::HouseEvent>().find(instruction->name());
+    assert(it != model_->table<mef::HouseEvent>().end() &&
+           "Invalid instruction.");
+    mef::HouseEvent& house_event = *it;
+    if (house_event.state() != instruction->state()) {
+      house_events->emplace_back(&house_event, house_event.state());
+      house_event.state(instruction->state());
+    }
+  }
+}
+
+void RiskAnalysis::Requantify() noexcept {
+  assert(quantifiers_.size() == results_.size() && "Incomplete analysis.");
+  TRACE("Risk requantification");
+  checkpoint_ = nullptr;  // The record is of the original quantities.
+  double mission_time = model_->mission_time().value();
+  Analysis::settings().mission_time(mission_time);
+  for (int i = 0; i < results_.size(); ++i) {
+    if (!quantifiers_[i])
+      continue;
+    Result& result = results_[i];
+    // The phase is applied in case the quantification rebuilds the PDAG.
+    std::vector<std::pair<mef::HouseEvent*, bool>> house_events;
+    if (result.id.context)
+      ApplyContext(*result.id.context, &house_events);
+    quantifiers_[i](&result);
+    model_->mission_time().value(mission_time);
+    Analysis::settings().mission_time(mission_time);
+    for (const std::pair<mef::HouseEvent*, bool>& entry : house_events)
+      entry.first->state(entry.second);
+  }
+}
+
+RiskAnalysis::Quantifier RiskAnalysis::RunAnalysis(const mef::Gate& target,
+                                                   Result* result) noexcept {
+  Settings settings = Analysis::settings();
+  std::shared_ptr<Pdag> trial_graph;  // The trial BDD of the selection.
+  std::unique_ptr<Bdd> trial_bdd;
+  if (settings.algorithm() == Algorithm::kAuto) {
+    result->algorithm_choice = SelectAlgorithm(target, settings, model_);
+    trial_graph = std::move(result->algorithm_choice->graph);
+    trial_bdd = std::move(result->algorithm_choice->bdd);
+    LOG(INFO) << "Selected algorithm for " << target.id() << ": "
+              << kAlgorithmToString[static_cast<int>(
+                     result->algorithm_choice->algorithm)];
+    if (result->algorithm_choice->algorithm != Algorithm::kBdd)
+      settings.compile_phases(false).gate_probabilities(false);  // BDD only.
+    settings.algorithm(result->algorithm_choice->algorithm)
+        .approximation(result->algorithm_choice->approximation);
+  }
+  switch (settings.algorithm()) {
     case Algorithm::kBdd:
-      return RunAnalysis<Bdd>(target, result);
+      if (std::shared_ptr<const FaultTreeCompilation> compilation =
+              GetCompilation(target, settings, *result)) {
+        Quantifier quantifier = RunAnalysis(
+            std::make_unique<FaultTreeAnalyzer<Bdd>>(*compilation, settings),
+            result);
+        if (!quantifier || !compilation->HasGates())
+          return quantifier;
+        // The compilation is kept alive for the requantification.
+        auto quantify_gates = [compilation](Result* out) {
+          out->gate_probabilities = compilation->CalculateGateProbabilities();
+        };
+        quantify_gates(result);
+        return [quantifier, quantify_gates](Result* out) {
+          quantifier(out);
+          quantify_gates(out);
+        };
+      }
+      if (trial_bdd) {
+        return RunAnalysis(
+            std::make_unique<FaultTreeAnalyzer<Bdd>>(
+                target, settings, std::move(trial_graph), std::move(trial_bdd)),
+            result);
+      }
+      return RunAnalysis<Bdd>(target, settings, result);
     case Algorithm::kZbdd:
-      return RunAnalysis<Zbdd>(target, result);
+      return RunAnalysis<Zbdd>(target, settings, result);
     case Algorithm::kMocus:
-      return RunAnalysis<Mocus>(target, result);
+      return RunAnalysis<Mocus>(target, settings, result);
+    case Algorithm::kAuto:
+      break;
+  }
+  assert(false && "Unexpected analysis algorithm.");
+  return {};
+}
+
+std::shared_ptr<const FaultTreeCompilation> RiskAnalysis::GetCompilation(
+    const mef::Gate& target, const Settings& settings,
+    const Result& result) noexcept {
+  if (!std::holds_alternative<const mef::Gate*>(result.id.target))
+    return nullptr;  // Event tree sequences are unique per phase.
+  if (!settings.compile_phases() || !result.id.context) {
+    if (!settings.gate_probabilities())
+      return nullptr;
+    // The house events are constants of this analysis only.
+    return std::make_shared<const FaultTreeCompilation>(
+        target, std::vector<const mef::HouseEvent*>(), settings, model_);
+  }
+  std::shared_ptr<const FaultTreeCompilation>& compilation =
+      phase_compilations_[&target];
+  if (!compilation) {
+    LOG(INFO) << "Compiling " << target.id() << " for the phases of "
+              << result.id.context->alignment.name();
+    compilation = std::make_shared<const FaultTreeCompilation>(
+        target, phase_house_events_, settings, model_);
   }
+  return compilation;
 }
 
 template <class Algorithm>
-void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
-  auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
-      target, Analysis::settings(), model_);
+RiskAnalysis::Quantifier RiskAnalysis::RunAnalysis(const mef::Gate& target,
+                                                   const Settings& settings,
+                                                   Result* result) noexcept {
+  return RunAnalysis(
+      std::make_unique<FaultTreeAnalyzer<Algorithm>>(target, settings, model_),
+      result);
+}
+
+template <class Algorithm>
+RiskAnalysis::Quantifier RiskAnalysis::RunAnalysis(
+    std::unique_ptr<FaultTreeAnalyzer<Algorithm>> fta,
+    Result* result) noexcept {
   fta->Analyze();
-  if (Analysis::settings().probability_analysis()) {
-    switch (Analysis::settings().approximation()) {
-      case Approximation::kNone:
-        RunAnalysis<Algorithm, Bdd>(fta.get(), result);
-        break;
-      case Approximation::kRareEvent:
-        RunAnalysis<Algorithm, RareEventCalculator>(fta.get(), result);
-        break;
-      case Approximation::kMcub:
-        RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
-    }
+  Quantifier quantifier;
+  if (Analysis::settings().probability_analysis() &&
+      !Analysis::settings().cancelled()) {
+    quantifier = [this, fta = fta.get()](Result* out) { Quantify(fta, out); };
+    quantifier(result);
   }
   result->fault_tree_analysis = std::move(fta);
+  return quantifier;
+}
+
+template <class Algorithm>
+void RiskAnalysis::Quantify(FaultTreeAnalyzer<Algorithm>* fta,
+                            Result* result) noexcept {
+  switch (std::as_const(*fta).settings().approximation()) {
+    case Approximation::kNone:
+      RunAnalysis<Algorithm, Bdd>(fta, result);
+      break;
+    case Approximation::kRareEvent:
+      RunAnalysis<Algorithm, RareEventCalculator>(fta, result);
+      break;
+    case Approximation::kMcub:
+      RunAnalysis<Algorithm, McubCalculator>(fta, result);
+  }
 }
 
 template <class Algorithm, class Calculator>
@@ -158,17 +371,52 @@ void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
                                Result* result) noexcept {
   auto pa = std::make_unique<ProbabilityAnalyzer<Calculator>>(
       fta, &model_->mission_time());
+  ReportStage(Progress::Stage::kProbability);
   pa->Analyze();
-  if (Analysis::settings().importance_analysis()) {
+  if (Analysis::settings().importance_analysis() &&
+      !Analysis::settings().cancelled()) {
+    ReportStage(Progress::Stage::kImportance);
     auto ia = std::make_unique<ImportanceAnalyzer<Calculator>>(pa.get());
     ia->Analyze();
     result->importance_analysis = std::move(ia);
   }
-  if (Analysis::settings().uncertainty_analysis()) {
+  if (Analysis::settings().uncertainty_analysis() &&
+      !Analysis::settings().cancelled()) {
+    ReportStage(Progress::Stage::kUncertainty);
     auto ua = std::make_unique<UncertaintyAnalyzer<Calculator>>(pa.get());
-    ua->Analyze();
+    if (sample_source_) {
+      ua->Analyze(sample_source_(result->id).value_or(SampleStatistics()));
+    } else if (checkpoint_) {
+      ua->Resume(checkpoint_->samples(result->id),
+                 [this, &id = result->id](const SampleStatistics& samples) {
+                   checkpoint_->Record(id, samples);
+                 });
+    } else {
+      ua->Analyze();
+    }
     result->uncertainty_analysis = std::move(ua);
   }
+  if (!Analysis::settings().sweep().empty() &&
+      !Analysis::settings().cancelled()) {
+    ReportStage(Progress::Stage::kSweep);
+    std::vector<mef::Parameter*> parameters;
+    for (const SweepAxis& axis : Analysis::settings().sweep()) {
+      auto it = model_->table<mef::Parameter>().find(axis.parameter);
+      assert(it != model_->table<mef::Parameter>().end() &&
+             "The sweep parameters are not validated.");
+      parameters.push_back(&*it);
+    }
+    auto sa = std::make_unique<SweepAnalysis>(pa.get(), std::move(parameters));
+    if (checkpoint_) {
+      sa->Resume(checkpoint_->points(result->id),
+                 [this, &id = result->id](const auto& points, int num_points) {
+                   checkpoint_->Record(id, points, num_points);
+                 });
+    } else {
+      sa->Analyze();
+    }
+    result->sweep_analysis = std::move(sa);
+  }
   result->probability_analysis = std::move(pa);
 }
 
@@ -20,12 +20,16 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "algorithm_selector.h"
 #include "alignment.h"
 #include "analysis.h"
 #include "event.h"
@@ -34,7 +38,9 @@
 #include "importance_analysis.h"
 #include "model.h"
 #include "probability_analysis.h"
+#include "progress.h"
 #include "settings.h"
+#include "sweep_analysis.h"
 #include "uncertainty_analysis.h"
 
 namespace scram::core {
@@ -66,7 +72,14 @@ class RiskAnalysis : public Analysis {
     std::unique_ptr<const ProbabilityAnalysis> probability_analysis;
     std::unique_ptr<const ImportanceAnalysis> importance_analysis;
     std::unique_ptr<const UncertaintyAnalysis> uncertainty_analysis;
+    std::unique_ptr<const SweepAnalysis> sweep_analysis;
     /// @}
+
+    /// The probabilities of the intermediate gates of the fault tree.
+    std::vector<std::pair<const mef::Gate*, double>> gate_probabilities;
+
+    /// The algorithm selected for the target if the selection is automatic.
+    std::optional<AlgorithmChoice> algorithm_choice;
   };
 
   /// The analysis results grouped by an event-tree.
@@ -99,9 +112,91 @@ class RiskAnalysis : public Analysis {
   ///       only after full initialization of the model
   ///       with or without its probabilities.
   ///
+  /// The analysis reports its progress
+  /// and honors the cancellation requests
+  /// through the optional progress observer in the settings.
+  /// Upon cancellation, the incomplete results are discarded,
+  /// and only the results of the fully analyzed targets are kept.
+  ///
   /// @pre The analysis is performed only once.
   void Analyze() noexcept;
 
+  /// Repeats the quantitative analyses
+  /// with the current probabilities and mission time of the model.
+  /// The products and decision diagrams of the analysis are reused,
+  /// so only the probability, importance, and uncertainty are recomputed.
+  ///
+  /// @pre The analysis is done.
+  /// @pre The model has not changed structurally since the analysis,
+  ///      i.e., only expression values and the mission time have changed.
+  ///
+  /// @note The products cut off by probability are not reconsidered.
+  ///
+  /// @post The checkpoint is detached from the analysis.
+  void Requantify() noexcept;
+
+  /// The provider of the uncertainty analysis samples
+  /// in place of the Monte Carlo simulation, e.g., merged trial shards.
+  using SampleSource =
+      std::function<std::optional<SampleStatistics>(const Result::Id&)>;
+
+  /// Replaces the Monte Carlo simulation of the uncertainty analysis
+  /// with the samples from the source.
+  /// The targets without samples in the source are reported without samples.
+  ///
+  /// @param[in] source  The provider of the samples for analysis targets.
+  void sample_source(SampleSource source) {
+    sample_source_ = std::move(source);
+  }
+
+  /// The record of the analysis progress
+  /// to resume the interrupted analysis.
+  /// The Monte Carlo simulations and parameter sweeps are recorded
+  /// as they progress,
+  /// so only their unfinished part is repeated upon resumption.
+  class Checkpoint {
+   public:
+    virtual ~Checkpoint() = default;
+
+    /// @param[in] id  The analysis target.
+    ///
+    /// @returns The recorded samples of the first trials of the target.
+    virtual SampleStatistics samples(const Result::Id& id) const = 0;
+
+    /// @param[in] id  The analysis target.
+    ///
+    /// @returns The recorded results at the first points of the target sweep.
+    virtual std::vector<SweepAnalysis::Point> points(
+        const Result::Id& id) const = 0;
+
+    /// Records the samples of the trials simulated so far.
+    ///
+    /// @param[in] id  The analysis target.
+    /// @param[in] samples  The samples of the first trials.
+    virtual void Record(const Result::Id& id,
+                        const SampleStatistics& samples) noexcept = 0;
+
+    /// Records the sweep points evaluated so far.
+    ///
+    /// @param[in] id  The analysis target.
+    /// @param[in] points  The sweep points.
+    /// @param[in] num_points  The number of the first evaluated points.
+    virtual void Record(const Result::Id& id,
+                        const std::vector<SweepAnalysis::Point>& points,
+                        int num_points) noexcept = 0;
+
+    /// Stores the recorded progress.
+    virtual void Save() noexcept = 0;
+  };
+
+  /// Records the progress of the analysis
+  /// and resumes it from the previously recorded progress.
+  ///
+  /// @param[in] checkpoint  The record of the analysis progress.
+  ///
+  /// @pre The checkpoint outlives the analysis.
+  void checkpoint(Checkpoint* checkpoint) { checkpoint_ = checkpoint; }
+
   /// @returns The results of the analysis.
   const std::vector<Result>& results() const { return results_; }
 
@@ -120,12 +215,43 @@ class RiskAnalysis : public Analysis {
   /// @post The model is restored to the original state.
   void RunAnalysis(std::optional<Context> context = {}) noexcept;
 
+  /// Reports the start of the analysis of the next target
+  /// to the progress observer if any.
+  ///
+  /// @param[in] name  The name of the target.
+  /// @param[in] part  The index of the part of the current target share.
+  /// @param[in] num_parts  The number of equal parts in the target share.
+  void ReportStart(std::string name, int part = 0, int num_parts = 1) noexcept;
+
+  /// Reports the next analysis stage of the current target.
+  ///
+  /// @param[in] stage  The new stage.
+  void ReportStage(Progress::Stage stage) noexcept;
+
+  /// Applies the phase of the context to the model.
+  ///
+  /// @param[in] context  The analysis context.
+  /// @param[out] house_events  The original states of the changed house events.
+  ///
+  /// @post The mission time of the model and settings is the phase time.
+  void ApplyContext(
+      const Context& context,
+      std::vector<std::pair<mef::HouseEvent*, bool>>* house_events) noexcept;
+
+  /// Repeatable quantitative analysis of a result.
+  using Quantifier = std::function<void(Result*)>;
+
   /// Runs all possible analysis on a given target.
   /// Analysis types are deduced from the settings.
+  /// The automatic algorithm is resolved for the target
+  /// before the analysis.
   ///
   /// @param[in] target  Analysis target.
   /// @param[in,out] result  The result container element.
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  ///
+  /// @returns The quantifier of the result to repeat the quantitative analyses.
+  ///          An empty quantifier if no quantitative analysis is requested.
+  Quantifier RunAnalysis(const mef::Gate& target, Result* result) noexcept;
 
   /// Defines and runs Qualitative analysis on the target.
   /// Calls the Quantitative analysis if requested in settings.
@@ -133,9 +259,49 @@ class RiskAnalysis : public Analysis {
   /// @tparam Algorithm  Qualitative analysis algorithm.
   ///
   /// @param[in] target  Analysis target.
+  /// @param[in] settings  The settings with the concrete algorithm.
+  /// @param[in,out] result  The result container element.
+  ///
+  /// @returns The quantifier of the result.
+  template <class Algorithm>
+  Quantifier RunAnalysis(const mef::Gate& target, const Settings& settings,
+                         Result* result) noexcept;
+
+  /// Runs Qualitative analysis with the given analyzer
+  /// and Quantitative analysis if requested in settings.
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  ///
+  /// @param[in] fta  The qualitative analyzer of the target.
+  /// @param[in,out] result  The result container element.
+  ///
+  /// @returns The quantifier of the result.
+  template <class Algorithm>
+  Quantifier RunAnalysis(std::unique_ptr<FaultTreeAnalyzer<Algorithm>> fta,
+                         Result* result) noexcept;
+
+  /// Finds or compiles the fault tree of the target
+  /// for the phases of the current alignment or the gate probabilities.
+  ///
+  /// @param[in] target  The top event of the fault tree.
+  /// @param[in] settings  The settings with the concrete algorithm.
+  /// @param[in] result  The result with the analysis context.
+  ///
+  /// @returns The compiled fault tree of the target.
+  ///          nullptr if the fault tree is not to be compiled for the result.
+  std::shared_ptr<const FaultTreeCompilation> GetCompilation(
+      const mef::Gate& target, const Settings& settings,
+      const Result& result) noexcept;
+
+  /// Runs Quantitative analysis
+  /// with the approximation from the qualitative analysis settings.
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  ///
+  /// @param[in] fta  The result of Qualitative analysis.
   /// @param[in,out] result  The result container element.
   template <class Algorithm>
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  void Quantify(FaultTreeAnalyzer<Algorithm>* fta, Result* result) noexcept;
 
   /// Defines and runs Quantitative analysis on the target.
   ///
@@ -152,7 +318,18 @@ class RiskAnalysis : public Analysis {
 
   mef::Model* model_;  ///< The model with constructs.
   std::vector<Result> results_;  ///< The analysis result storage.
+  std::vector<Quantifier> quantifiers_;  ///< The quantifiers of the results.
   std::vector<EtaResult> event_tree_results_;  ///< Grouping of sequences.
+  /// The house events set by the phases of the current alignment.
+  std::vector<const mef::HouseEvent*> phase_house_events_;
+  /// The fault trees compiled for the phases of the current alignment.
+  std::unordered_map<const mef::Gate*,
+                     std::shared_ptr<const FaultTreeCompilation>>
+      phase_compilations_;
+  SampleSource sample_source_;  ///< The optional source of the samples.
+  Checkpoint* checkpoint_ = nullptr;  ///< The optional progress record.
+  int num_targets_ = 0;  ///< The number of targets in all contexts.
+  int num_done_ = 0;  ///< The number of fully analyzed targets.
 };
 
 }  // namespace scram::core
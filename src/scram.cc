@@ -18,13 +18,20 @@
 /// @file
 /// Main entrance.
 
+#include <csignal>
 #include <cstdarg>
 #include <cstdio>  // vsnprintf
+#include <cstdlib>  // malloc, free, strtod
 #include <cstring>  // strerror
 
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/core/typeinfo.hpp>
@@ -36,21 +43,71 @@
 #include <libxml/xmlerror.h>  // initGenericErrorDefaultFunc
 #include <libxml/xmlversion.h>  // LIBXML_TEST_VERSION, LIBXML_DOTTED_VERSION
 
+#include "checkpoint.h"
 #include "error.h"
 #include "ext/scope_guard.h"
 #include "initializer.h"
 #include "logger.h"
+#include "progress.h"
 #include "project.h"
 #include "reporter.h"
 #include "risk_analysis.h"
 #include "serialization.h"
+#include "server.h"
 #include "settings.h"
+#include "shard_merger.h"
+#include "statistics.h"
+#include "trace.h"
 #include "version.h"
 
 namespace po = boost::program_options;
 
 namespace {
 
+/// The indication to count heap allocations.
+/// The counting is enabled only for the requested statistics
+/// to keep the contended counter off the allocation path.
+std::atomic<bool> count_allocations = false;
+
+}  // namespace
+
+/// Replacement of the global allocation
+/// to count heap allocations for the analysis statistics.
+///
+/// @param[in] size  The number of bytes to allocate.
+///
+/// @returns The pointer to the allocated storage.
+///
+/// @throws std::bad_alloc  The allocation failure.
+void* operator new(std::size_t size) {
+  if (count_allocations.load(std::memory_order_relaxed))
+    scram::core::CountAllocation();
+  if (size == 0)
+    size = 1;
+  while (true) {
+    if (void* ptr = std::malloc(size))
+      return ptr;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+/// Deallocation of storage from the replacement operator new.
+///
+/// @param[in] ptr  The pointer to the allocated storage or nullptr.
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+/// Sized deallocation of storage from the replacement operator new.
+///
+/// @param[in] ptr  The pointer to the allocated storage or nullptr.
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
 /// Provides an options value type.
 #define OPT_VALUE(type) po::value<type>()->value_name(#type)
 
@@ -66,10 +123,18 @@ po::options_description ConstructOptions() {
       ("project", OPT_VALUE(path), "Project file with analysis configurations")
       ("allow-extern", "**UNSAFE** Allow external libraries")
       ("validate", "Validate input files without analysis")
+      ("server", "Serve what-if analysis requests as JSON lines on stdin")
+      ("socket", OPT_VALUE(path),
+       "Serve what-if analysis requests on a Unix domain socket")
       ("bdd", "Perform qualitative analysis with BDD")
       ("zbdd", "Perform qualitative analysis with ZBDD")
       ("mocus", "Perform qualitative analysis with MOCUS")
+      ("auto", "Select the qualitative analysis algorithm per target")
       ("prime-implicants", "Calculate prime implicants")
+      ("compile-phases", "Compile fault trees once for all alignment phases")
+      ("gate-probabilities", "Report the probabilities of intermediate gates")
+      ("gate", po::value<std::vector<std::string>>()->value_name("id"),
+       "Report the probability of only the selected intermediate gate")
       ("probability", "Perform probability analysis")
       ("importance", "Perform importance analysis")
       ("uncertainty", "Perform uncertainty analysis")
@@ -78,7 +143,10 @@ po::options_description ConstructOptions() {
       ("rare-event", "Use the rare event approximation")
       ("mcub", "Use the MCUB approximation")
       ("limit-order,l", OPT_VALUE(int), "Upper limit for the product order")
-      ("cut-off", OPT_VALUE(double), "Cut-off probability for products")
+      ("cut-off", OPT_VALUE(double),
+       "Cut-off probability for prime implicants and CCF combinations")
+      ("top-products", OPT_VALUE(int),
+       "Report only the given number of the most probable products")
       ("mission-time", OPT_VALUE(double), "System mission time in hours")
       ("time-step", OPT_VALUE(double),
        "Time step in hours for probability analysis")
@@ -87,9 +155,28 @@ po::options_description ConstructOptions() {
       ("num-quantiles", OPT_VALUE(int),
        "Number of quantiles for distributions")
       ("num-bins", OPT_VALUE(int), "Number of bins for histograms")
+      ("sweep",
+       po::value<std::vector<std::string>>()->value_name("name=values"),
+       "Sweep a parameter over a list (name=v1,v2,...)"
+       " or a grid (name=from:to:points)")
       ("seed", OPT_VALUE(int), "Seed for the pseudo-random number generator")
+      ("shard", po::value<std::string>()->value_name("index/count"),
+       "Simulate only a shard of the Monte Carlo trials")
+      ("merge-shards",
+       po::value<std::vector<std::string>>()->multitoken()->value_name(
+           "reports"),
+       "Merge the uncertainty analysis of the shard reports")
+      ("checkpoint", OPT_VALUE(path),
+       "Record the analysis progress into the checkpoint file")
+      ("checkpoint-interval", po::value<double>()->value_name("seconds"),
+       "Minimum time between the checkpoint saves (default 60)")
+      ("resume", "Resume the analysis from the checkpoint file")
       ("output,o", OPT_VALUE(path), "Output file for reports")
       ("no-indent", "Omit indentation whitespace in output XML")
+      ("statistics",
+       "Report resource usage and data structure statistics of analyses")
+      ("trace", OPT_VALUE(path),
+       "Output file for the performance trace in Chrome JSON format")
       ("verbosity", OPT_VALUE(int), "Set log verbosity");
 #ifndef NDEBUG
   po::options_description debug("Debug Options");
@@ -168,9 +255,11 @@ int ParseArguments(int argc, char* argv[], po::variables_map* vm) {
     print_help(std::cerr);
     return 1;
   }
-  if ((vm->count("bdd") + vm->count("zbdd") + vm->count("mocus")) > 1) {
+  if ((vm->count("bdd") + vm->count("zbdd") + vm->count("mocus") +
+       vm->count("auto")) > 1) {
     std::cerr << "Mutually exclusive qualitative analysis algorithms.\n"
-              << "(MOCUS/BDD/ZBDD) cannot be applied at the same time.\n\n";
+              << "(MOCUS/BDD/ZBDD/auto) cannot be applied at the same time."
+              << "\n\n";
     print_help(std::cerr);
     return 1;
   }
@@ -180,9 +269,79 @@ int ParseArguments(int argc, char* argv[], po::variables_map* vm) {
     print_help(std::cerr);
     return 1;
   }
+  if ((vm->count("resume") || vm->count("checkpoint-interval")) &&
+      !vm->count("checkpoint")) {
+    std::cerr << "The checkpoint file is not given.\n\n";
+    print_help(std::cerr);
+    return 1;
+  }
+  if (vm->count("shard") && vm->count("merge-shards")) {
+    std::cerr << "The trial shards cannot be simulated and merged "
+              << "at the same time.\n\n";
+    print_help(std::cerr);
+    return 1;
+  }
   return 0;
 }
 
+/// Sets the shard of the Monte Carlo trials
+/// from its command-line specification.
+///
+/// @param[in] spec  The zero-based shard index and the number of shards,
+///                  e.g., 2/8.
+/// @param[in,out] settings  The settings to set the shard.
+///
+/// @throws SettingsError  The specification is malformed.
+void SetShard(const std::string& spec, scram::core::Settings* settings) {
+  int index = 0;
+  int count = 0;
+  int nchar = 0;
+  if (std::sscanf(spec.c_str(), "%d/%d%n", &index, &count, &nchar) != 2 ||
+      nchar != spec.size()) {
+    SCRAM_THROW(scram::SettingsError("Invalid trial shard"))
+        << scram::errinfo_value(spec);
+  }
+  settings->shard(index, count);
+}
+
+/// Adds a parameter sweep from its command-line specification.
+///
+/// @param[in] spec  The parameter name with a comma-separated list of values
+///                  or a from:to:points grid, e.g., lambda=1e-4:1e-3:10.
+/// @param[in,out] settings  The settings to add the sweep into.
+///
+/// @throws SettingsError  The specification is malformed.
+void AddSweep(const std::string& spec, scram::core::Settings* settings) {
+  std::string::size_type pos = spec.find('=');
+  if (pos == 0 || pos == std::string::npos || pos + 1 == spec.size()) {
+    SCRAM_THROW(scram::SettingsError("Invalid parameter sweep"))
+        << scram::errinfo_value(spec);
+  }
+  std::string values = spec.substr(pos + 1);
+  char delimiter = values.find(':') == std::string::npos ? ',' : ':';
+  std::vector<double> numbers;
+  std::istringstream in(values);
+  for (std::string token; std::getline(in, token, delimiter);) {
+    char* end = nullptr;
+    double number = std::strtod(token.c_str(), &end);
+    if (token.empty() || *end != '\0') {
+      SCRAM_THROW(scram::SettingsError("Invalid parameter sweep value"))
+          << scram::errinfo_value(spec);
+    }
+    numbers.push_back(number);
+  }
+  if (delimiter == ',') {
+    settings->sweep(spec.substr(0, pos), std::move(numbers));
+    return;
+  }
+  if (numbers.size() != 3 || numbers[2] != static_cast<int>(numbers[2])) {
+    SCRAM_THROW(scram::SettingsError("Invalid parameter sweep grid"))
+        << scram::errinfo_value(spec);
+  }
+  settings->sweep(spec.substr(0, pos), numbers[0], numbers[1],
+                  static_cast<int>(numbers[2]));
+}
+
 // clang-format off
 /// Helper macro for ConstructSettings
 /// to set the flag in "settings"
@@ -207,8 +366,17 @@ void ConstructSettings(const po::variables_map& vm,
     settings->algorithm(scram::core::Algorithm::kZbdd);
   } else if (vm.count("mocus")) {
     settings->algorithm(scram::core::Algorithm::kMocus);
+  } else if (vm.count("auto")) {
+    settings->algorithm(scram::core::Algorithm::kAuto);
   }
   settings->prime_implicants(vm.count("prime-implicants"));
+  if (vm.count("compile-phases"))
+    settings->compile_phases(true);
+  if (vm.count("gate")) {
+    settings->probability_gates(vm["gate"].as<std::vector<std::string>>());
+  } else if (vm.count("gate-probabilities")) {
+    settings->gate_probabilities(true);
+  }
   // Determine if the probability approximation is requested.
   if (vm.count("rare-event")) {
     assert(!vm.count("mcub"));
@@ -226,10 +394,21 @@ void ConstructSettings(const po::variables_map& vm,
   SET("seed", int, seed);
   SET("limit-order", int, limit_order);
   SET("cut-off", double, cut_off);
+  SET("top-products", int, top_products);
   SET("mission-time", double, mission_time);
   SET("num-trials", int, num_trials);
   SET("num-quantiles", int, num_quantiles);
   SET("num-bins", int, num_bins);
+  if (vm.count("shard")) {
+    settings->uncertainty_analysis(true);
+    SetShard(vm["shard"].as<std::string>(), settings);
+  }
+  if (vm.count("merge-shards"))
+    settings->uncertainty_analysis(true);
+  if (vm.count("sweep")) {
+    for (const std::string& spec : vm["sweep"].as<std::vector<std::string>>())
+      AddSweep(spec, settings);
+  }
 #ifndef NDEBUG
   settings->preprocessor = vm.count("preprocessor");
   settings->print = vm.count("print");
@@ -237,6 +416,20 @@ void ConstructSettings(const po::variables_map& vm,
 }
 #undef SET
 
+/// The progress of the running analysis to cancel upon interruption.
+std::atomic<scram::core::Progress*> running_analysis = nullptr;
+
+/// Cancels the running analysis upon the interrupt or termination signal.
+/// The analysis stops and reports the results collected so far.
+/// A repeated signal terminates the program with the default behavior.
+///
+/// @param[in] signal  The signal number.
+extern "C" void CancelAnalysis(int signal) noexcept {
+  if (scram::core::Progress* progress = running_analysis.load())
+    progress->Cancel();
+  std::signal(signal, SIG_DFL);
+}
+
 /// Main body of command-line entrance to run the program.
 ///
 /// @param[in] vm  Variables map of program options.
@@ -257,6 +450,8 @@ void RunScram(const po::variables_map& vm) {
   // Command-line settings overwrite
   // the settings from the configurations.
   ConstructSettings(vm, &settings);
+  if (vm.count("statistics"))
+    count_allocations.store(true, std::memory_order_relaxed);
   if (vm.count("input-files")) {
     auto cmd_input = vm["input-files"].as<std::vector<std::string>>();
     input_files.insert(input_files.end(), cmd_input.begin(), cmd_input.end());
@@ -274,14 +469,44 @@ void RunScram(const po::variables_map& vm) {
   if (vm.count("validate"))
     return;  // Stop if only validation is requested.
 
+  if (vm.count("server") || vm.count("socket")) {
+    scram::core::Server server(model.get(), settings);
+    if (vm.count("socket"))
+      return server.Listen(vm["socket"].as<std::string>());
+    return server.Run(std::cin, std::cout);
+  }
+
   // Initiate risk analysis with the given information.
+  scram::core::Progress progress;
+  settings.progress(&progress);
   scram::core::RiskAnalysis analysis(model.get(), settings);
+  if (vm.count("merge-shards")) {
+    analysis.sample_source(scram::ShardMerger(
+        vm["merge-shards"].as<std::vector<std::string>>(), settings));
+  }
+  std::optional<scram::CheckpointFile> checkpoint;
+  if (vm.count("checkpoint")) {
+    double interval = vm.count("checkpoint-interval")
+                          ? vm["checkpoint-interval"].as<double>()
+                          : 60;
+    checkpoint.emplace(vm["checkpoint"].as<std::string>(), settings, interval,
+                       vm.count("resume"));
+    analysis.checkpoint(&*checkpoint);
+  }
+  running_analysis = &progress;
+  // The termination by schedulers, e.g., upon preemption,
+  // is handled as the interruption to report and save the progress.
+  std::signal(SIGINT, CancelAnalysis);
+  std::signal(SIGTERM, CancelAnalysis);
   analysis.Analyze();
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+  running_analysis = nullptr;
 #ifndef NDEBUG
   if (vm.count("no-report") || vm.count("preprocessor") || vm.count("print"))
     return;
 #endif
-  scram::Reporter reporter;
+  scram::Reporter reporter(vm.count("statistics"));
   bool indent = vm.count("no-indent") ? false : true;
   if (vm.count("output")) {
     reporter.Report(analysis, vm["output"].as<std::string>(), indent);
@@ -357,8 +582,15 @@ int main(int argc, char* argv[]) {
           static_cast<scram::LogLevel>(vm["verbosity"].as<int>()));
     }
 
-    if (ret == 0)
+    if (ret == 0) {
+      if (vm.count("trace"))
+        scram::Trace::Start();
       RunScram(vm);
+      if (vm.count("trace")) {
+        scram::Trace::Stop();
+        scram::Trace::Write(vm["trace"].as<std::string>());
+      }
+    }
   } catch (const scram::LogicError& err) {
     LOG(scram::ERROR) << "Logic Error:\n" << boost::diagnostic_information(err);
     return 1;
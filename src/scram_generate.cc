@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Synthetic model generator entrance.
+
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <boost/exception/all.hpp>
+#include <boost/program_options.hpp>
+
+#include "error.h"
+#include "generator.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+/// Provides an options value type.
+#define OPT_VALUE(type) po::value<type>()->value_name(#type)
+
+/// @returns Command-line option descriptions.
+po::options_description ConstructOptions() {
+  using path = std::string;  // To print argument type as path.
+  scram::mef::GeneratorSettings defaults;
+
+  po::options_description desc("Options");
+  // clang-format off
+  desc.add_options()
+      ("help", "Display this help message")
+      ("seed", OPT_VALUE(std::uint32_t)->default_value(defaults.seed),
+       "Seed for the pseudo-random number generator")
+      ("num-gates", OPT_VALUE(int)->default_value(defaults.num_gates),
+       "Number of gates including the top gate")
+      ("num-basic", OPT_VALUE(int)->default_value(defaults.num_basic_events),
+       "Maximum number of basic events")
+      ("min-args", OPT_VALUE(int)->default_value(defaults.min_args),
+       "Minimum number of gate arguments")
+      ("max-args", OPT_VALUE(int)->default_value(defaults.max_args),
+       "Maximum number of gate arguments")
+      ("fan-in", OPT_VALUE(std::string)->default_value("uniform"),
+       "Distribution of gate arguments (uniform, geometric)")
+      ("sharing", OPT_VALUE(double)->default_value(defaults.sharing),
+       "Chance of a gate argument to be an already existing node")
+      ("num-modules", OPT_VALUE(int)->default_value(defaults.num_modules),
+       "Number of independent subtrees of the top gate")
+      ("and-ratio", OPT_VALUE(double)->default_value(defaults.and_ratio),
+       "Fraction of AND gates")
+      ("atleast-ratio", OPT_VALUE(double)->default_value(defaults.atleast_ratio),
+       "Fraction of K/N gates")
+      ("num-ccf", OPT_VALUE(int)->default_value(defaults.num_ccf_groups),
+       "Number of beta-factor CCF groups")
+      ("ccf-size", OPT_VALUE(int)->default_value(defaults.ccf_group_size),
+       "Number of members per CCF group")
+      ("event-tree-depth",
+       OPT_VALUE(int)->default_value(defaults.event_tree_depth),
+       "Number of functional events in the event tree")
+      ("min-prob", OPT_VALUE(double)->default_value(defaults.min_prob),
+       "Lower bound of basic event probabilities")
+      ("max-prob", OPT_VALUE(double)->default_value(defaults.max_prob),
+       "Upper bound of basic event probabilities")
+      ("output,o", OPT_VALUE(path), "Output file for the model");
+  // clang-format on
+  return desc;
+}
+
+#undef OPT_VALUE
+
+/// @returns The generator settings from the command-line options.
+///
+/// @param[in] vm  Parsed command-line arguments.
+///
+/// @throws SettingsError  The fan-in distribution is not recognized.
+scram::mef::GeneratorSettings ConstructSettings(const po::variables_map& vm) {
+  scram::mef::GeneratorSettings settings;
+  settings.seed = vm["seed"].as<std::uint32_t>();
+  settings.num_gates = vm["num-gates"].as<int>();
+  settings.num_basic_events = vm["num-basic"].as<int>();
+  settings.min_args = vm["min-args"].as<int>();
+  settings.max_args = vm["max-args"].as<int>();
+  std::string fan_in = vm["fan-in"].as<std::string>();
+  auto it = std::find(std::begin(scram::mef::kFanInToString),
+                      std::end(scram::mef::kFanInToString), fan_in);
+  if (it == std::end(scram::mef::kFanInToString)) {
+    SCRAM_THROW(
+        scram::SettingsError("The fan-in distribution is not recognized."));
+  }
+  settings.fan_in = static_cast<scram::mef::FanIn>(
+      std::distance(std::begin(scram::mef::kFanInToString), it));
+  settings.sharing = vm["sharing"].as<double>();
+  settings.num_modules = vm["num-modules"].as<int>();
+  settings.and_ratio = vm["and-ratio"].as<double>();
+  settings.atleast_ratio = vm["atleast-ratio"].as<double>();
+  settings.num_ccf_groups = vm["num-ccf"].as<int>();
+  settings.ccf_group_size = vm["ccf-size"].as<int>();
+  settings.event_tree_depth = vm["event-tree-depth"].as<int>();
+  settings.min_prob = vm["min-prob"].as<double>();
+  settings.max_prob = vm["max-prob"].as<double>();
+  return settings;
+}
+
+}  // namespace
+
+/// Command-line generator entrance.
+///
+/// @param[in] argc  Argument count.
+/// @param[in] argv  Argument vector.
+///
+/// @returns 0 for success.
+/// @returns 1 for errored state.
+int main(int argc, char* argv[]) {
+  po::options_description desc = ConstructOptions();
+  try {
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+      std::cout << "Usage:    scram-generate [options]\n\n"
+                << desc << std::endl;
+      return 0;
+    }
+    scram::mef::GeneratorSettings settings = ConstructSettings(vm);
+    if (vm.count("output")) {
+      scram::mef::Generate(settings, vm["output"].as<std::string>());
+    } else {
+      scram::mef::Generate(settings, stdout);
+    }
+  } catch (const po::error& err) {
+    std::cerr << "Option error: " << err.what() << "\n\n" << desc << std::endl;
+    return 1;
+  } catch (const scram::Error& err) {
+    std::cerr << boost::diagnostic_information(err) << std::endl;
+    return 1;
+  }
+  return 0;
+}
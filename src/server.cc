@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the persistent analysis server.
+
+#include "server.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <sstream>
+#include <utility>
+#include <variant>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/predef.h>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "error.h"
+#include "expression/constant.h"
+#include "ext/scope_guard.h"
+#include "fault_tree_analysis.h"
+#include "logger.h"
+#include "probability_analysis.h"
+#include "reporter.h"
+
+namespace pt = boost::property_tree;
+
+namespace scram::core {
+
+namespace {
+
+/// Writes a JSON string literal.
+///
+/// @param[in] value  The raw string value.
+/// @param[out] out  The destination stream.
+void WriteString(const std::string& value, std::ostream& out) {
+  out << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << ' ';
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+/// Writes the request identifier back as it has been given.
+///
+/// @param[in] id  The identifier value without the JSON type information.
+/// @param[out] out  The destination stream.
+void WriteId(const std::string& id, std::ostream& out) {
+  char* end = nullptr;
+  if (!id.empty() && (std::strtod(id.c_str(), &end), *end == '\0')) {
+    out << id;  // Numeric ids are echoed as numbers.
+  } else {
+    WriteString(id, out);
+  }
+}
+
+/// @returns The current house event states in the model table order.
+std::vector<bool> GetHouseStates(const mef::Model& model) {
+  std::vector<bool> states;
+  for (const mef::HouseEvent& house_event : model.house_events())
+    states.push_back(house_event.state());
+  return states;
+}
+
+}  // namespace
+
+Server::Server(mef::Model* model, Settings settings)
+    : model_(model), settings_(std::move(settings)) {
+  settings_.probability_analysis(true);
+  house_states_ = GetHouseStates(*model_);
+  compiled_mission_time_ = model_->mission_time().value();
+  analysis_ = std::make_unique<RiskAnalysis>(model_, settings_);
+  analysis_->Analyze();
+}
+
+std::string Server::Process(const std::string& request) {
+  std::ostringstream response;
+  response.precision(15);
+  response << "{";
+  std::ostringstream body;
+  body.precision(15);
+  try {
+    pt::ptree tree;
+    std::istringstream in(request);
+    pt::read_json(in, tree);
+    if (auto id = tree.get_optional<std::string>("id")) {
+      response << "\"id\":";
+      WriteId(*id, response);
+      response << ",";
+    }
+    std::string command = tree.get<std::string>("command", "analyze");
+    if (command == "exit") {
+      stopped_ = true;
+      body << "\"status\":\"ok\"";
+    } else if (command == "analyze") {
+      Analyze(tree, body);
+    } else {
+      SCRAM_THROW(SettingsError("Unknown server command: " + command));
+    }
+  } catch (const pt::ptree_error& err) {
+    body.str("");
+    body << "\"status\":\"error\",\"message\":";
+    WriteString(err.what(), body);
+  } catch (const Error& err) {
+    body.str("");
+    body << "\"status\":\"error\",\"message\":";
+    WriteString(err.what(), body);
+  }
+  response << body.str() << "}";
+  return response.str();
+}
+
+void Server::Analyze(const pt::ptree& request, std::ostream& out) {
+  CLOCK(request_time);
+  std::vector<std::unique_ptr<mef::ConstantExpression>> values;
+  std::vector<std::pair<mef::BasicEvent*, mef::Expression*>> basic_events;
+  std::vector<std::pair<mef::HouseEvent*, bool>> house_events;
+  double mission_time = model_->mission_time().value();
+  SCOPE_EXIT([&] {  // Restore the original model for the next request.
+    for (auto& [basic_event, expression] : basic_events)
+      basic_event->expression(expression);
+    for (auto& [house_event, state] : house_events)
+      house_event->state(state);
+    model_->mission_time().value(mission_time);
+  });
+
+  if (auto time = request.get_optional<double>("mission-time")) {
+    if (*time < 0)
+      SCRAM_THROW(mef::DomainError("The mission time cannot be negative."));
+    model_->mission_time().value(*time);
+  }
+  if (auto changes = request.get_child_optional("basic-events")) {
+    for (const auto& [name, value] : *changes) {
+      auto it = model_->table<mef::BasicEvent>().find(name);
+      if (it == model_->table<mef::BasicEvent>().end())
+        SCRAM_THROW(mef::ValidityError("Undefined basic event: " + name));
+      double p = value.get_value<double>();
+      if (p < 0 || p > 1)
+        SCRAM_THROW(mef::DomainError("Invalid probability for " + name));
+      mef::BasicEvent& basic_event = *it;
+      assert(basic_event.HasExpression() && "Invalid model.");
+      values.push_back(std::make_unique<mef::ConstantExpression>(p));
+      basic_events.emplace_back(&basic_event, &basic_event.expression());
+      basic_event.expression(values.back().get());
+    }
+  }
+  if (auto changes = request.get_child_optional("house-events")) {
+    for (const auto& [name, value] : *changes) {
+      auto it = model_->table<mef::HouseEvent>().find(name);
+      if (it == model_->table<mef::HouseEvent>().end())
+        SCRAM_THROW(mef::ValidityError("Undefined house event: " + name));
+      bool state = value.get_value<bool>();
+      mef::HouseEvent& house_event = *it;
+      house_events.emplace_back(&house_event, house_event.state());
+      house_event.state(state);
+    }
+  }
+
+  // The products cut off by probability are not reconsidered
+  // unless the analysis is recompiled for another configuration.
+  // The CCF combinations are pruned against the compiled mission time bound.
+  bool recompile = false;
+  std::vector<bool> house_states = GetHouseStates(*model_);
+  if (house_states != house_states_ ||
+      (GetCcfCutOff(settings_) > 0 &&
+       model_->mission_time().value() > compiled_mission_time_)) {
+    LOG(DEBUG2) << "Recompiling the resident analysis...";
+    Settings settings = settings_;
+    settings.mission_time(model_->mission_time().value());
+    analysis_.reset();  // Release the memory before the new analysis.
+    analysis_ = std::make_unique<RiskAnalysis>(model_, settings);
+    analysis_->Analyze();
+    house_states_ = std::move(house_states);
+    compiled_mission_time_ = model_->mission_time().value();
+    recompile = true;
+  } else {
+    analysis_->Requantify();
+  }
+
+  std::string report = request.get<std::string>("report", "");
+  if (!report.empty())
+    Reporter().Report(*analysis_, report);
+
+  out << "\"status\":\"ok\",\"recompiled\":" << std::boolalpha << recompile
+      << ",\"time\":" << DUR(request_time) << ",\"results\":";
+  WriteResults(out);
+  if (!report.empty()) {
+    out << ",\"report\":";
+    WriteString(report, out);
+  }
+}
+
+void Server::WriteResults(std::ostream& out) const {
+  out << "[";
+  bool first = true;
+  for (const RiskAnalysis::Result& result : analysis_->results()) {
+    if (!first)
+      out << ",";
+    first = false;
+    out << "{\"target\":";
+    if (auto* gate = std::get_if<const mef::Gate*>(&result.id.target)) {
+      WriteString((*gate)->id(), out);
+    } else {
+      auto& [initiating_event, sequence] = std::get<
+          std::pair<const mef::InitiatingEvent&, const mef::Sequence&>>(
+          result.id.target);
+      WriteString(initiating_event.name() + "/" + sequence.name(), out);
+    }
+    if (result.id.context) {
+      out << ",\"alignment\":";
+      WriteString(result.id.context->alignment.name(), out);
+      out << ",\"phase\":";
+      WriteString(result.id.context->phase.name(), out);
+    }
+    if (result.fault_tree_analysis)
+      out << ",\"products\":" << result.fault_tree_analysis->products().size();
+    if (result.probability_analysis)
+      out << ",\"probability\":" << result.probability_analysis->p_total();
+    out << "}";
+  }
+  out << "]";
+}
+
+void Server::Run(std::istream& in, std::ostream& out) {
+  std::string line;
+  while (!stopped_ && std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+    out << Process(line) << std::endl;
+  }
+}
+
+void Server::Listen(const std::string& path) {
+#if BOOST_OS_UNIX || BOOST_OS_MACOS
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    SCRAM_THROW(IOError("The socket path is too long."))
+        << boost::errinfo_file_name(path);
+  }
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    SCRAM_THROW(IOError("Cannot create the server socket."))
+        << boost::errinfo_errno(errno) << boost::errinfo_file_name(path);
+  }
+  SCOPE_EXIT([listener] { ::close(listener); });
+  ::unlink(path.c_str());  // Stale socket files from previous servers.
+  if (::bind(listener, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) < 0 ||
+      ::listen(listener, 1) < 0) {
+    SCRAM_THROW(IOError("Cannot listen on the server socket."))
+        << boost::errinfo_errno(errno) << boost::errinfo_file_name(path);
+  }
+  SCOPE_EXIT([&path] { ::unlink(path.c_str()); });
+  LOG(INFO) << "Listening on " << path;
+
+#ifdef MSG_NOSIGNAL
+  const int kSendFlags = MSG_NOSIGNAL;  // Clients may leave early.
+#else
+  const int kSendFlags = 0;
+#endif
+
+  while (!stopped_) {
+    int client = ::accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR)
+        continue;
+      SCRAM_THROW(IOError("Cannot accept a client connection."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_name(path);
+    }
+    SCOPE_EXIT([client] { ::close(client); });
+    std::string buffer;
+    char chunk[4096];
+    bool connected = true;
+    while (connected && !stopped_) {
+      ssize_t num_read = ::read(client, chunk, sizeof(chunk));
+      if (num_read < 0 && errno == EINTR)
+        continue;
+      if (num_read <= 0)
+        break;
+      buffer.append(chunk, num_read);
+      for (std::string::size_type pos = buffer.find('\n');
+           connected && pos != std::string::npos; pos = buffer.find('\n')) {
+        std::string line = buffer.substr(0, pos);
+        buffer.erase(0, pos + 1);
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+          continue;
+        std::string response = Process(line) + "\n";
+        for (std::string::size_type sent = 0; sent < response.size();) {
+          ssize_t num_sent = ::send(client, response.data() + sent,
+                                    response.size() - sent, kSendFlags);
+          if (num_sent < 0 && errno == EINTR)
+            continue;
+          if (num_sent <= 0) {
+            connected = false;
+            break;
+          }
+          sent += num_sent;
+        }
+        if (stopped_)
+          break;
+      }
+    }
+  }
+#else
+  SCRAM_THROW(IOError("Unix domain sockets are not supported on this system."))
+      << boost::errinfo_file_name(path);
+#endif
+}
+
+}  // namespace scram::core
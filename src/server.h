@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Persistent analysis server with a resident model.
+///
+/// The server answers what-if queries on the same model
+/// with a line-delimited JSON protocol.
+/// Each request is a single-line JSON object:
+///
+///     {"id": 1, "mission-time": 8760,
+///      "basic-events": {"PumpOne": 0.01},
+///      "house-events": {"Maintenance": true},
+///      "report": "/path/to/report.xml"}
+///
+/// All members are optional.
+/// The changes apply to the request only;
+/// the model is restored to its original state afterwards.
+/// The response is a single-line JSON object
+/// with the probabilities of the analysis targets:
+///
+///     {"id": 1, "status": "ok", "recompiled": false, "time": 0.002,
+///      "results": [{"target": "TopEvent", "products": 4,
+///                   "probability": 0.0012}],
+///      "report": "/path/to/report.xml"}
+///
+/// Failed requests get {"id": 1, "status": "error", "message": "..."}.
+/// The {"command": "exit"} request stops the server.
+///
+/// The products and decision diagrams stay resident between requests.
+/// Changes in probabilities and the mission time
+/// only repeat the quantitative analyses,
+/// while changes in house events recompile the analysis
+/// for the new configuration.
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include "model.h"
+#include "risk_analysis.h"
+#include "settings.h"
+
+namespace scram::core {
+
+/// Analysis server over a resident model.
+class Server : private boost::noncopyable {
+ public:
+  /// Analyzes the model to keep the results resident.
+  /// The probability analysis is always requested.
+  ///
+  /// @param[in] model  Fully initialized and valid model.
+  /// @param[in] settings  Analysis settings.
+  Server(mef::Model* model, Settings settings);
+
+  /// Processes a single request.
+  ///
+  /// @param[in] request  The JSON object on a single line.
+  ///
+  /// @returns The JSON response on a single line without the line break.
+  std::string Process(const std::string& request);
+
+  /// @returns true if the exit command has been received.
+  bool stopped() const { return stopped_; }
+
+  /// Serves requests line by line until the end of input or exit command.
+  ///
+  /// @param[in] in  The request stream.
+  /// @param[out] out  The response stream.
+  void Run(std::istream& in, std::ostream& out);
+
+  /// Serves clients on a local Unix domain socket
+  /// one connection at a time until the exit command.
+  ///
+  /// @param[in] path  The socket file path to create.
+  ///
+  /// @throws IOError  The socket cannot be created or used.
+  void Listen(const std::string& path);
+
+ private:
+  /// Processes an analysis request.
+  ///
+  /// @param[in] request  The parsed JSON request.
+  /// @param[out] out  The destination for the response members.
+  ///
+  /// @throws Error  The request is invalid.
+  /// @throws boost::property_tree::ptree_error  Invalid request values.
+  void Analyze(const boost::property_tree::ptree& request, std::ostream& out);
+
+  /// Writes the results of the current analysis.
+  ///
+  /// @param[out] out  The destination for the JSON array.
+  void WriteResults(std::ostream& out) const;
+
+  mef::Model* model_;  ///< The resident model.
+  Settings settings_;  ///< The analysis settings.
+  std::unique_ptr<RiskAnalysis> analysis_;  ///< The resident analysis.
+  /// The house event states of the resident analysis.
+  /// Only the analysis of the last configuration is kept.
+  std::vector<bool> house_states_;
+  double compiled_mission_time_ = 0;  ///< The mission time of the analysis.
+  bool stopped_ = false;  ///< The indication of the exit command.
+};
+
+}  // namespace scram::core
@@ -21,6 +21,7 @@
 #include "settings.h"
 
 #include <string>
+#include <utility>
 
 #include <boost/range/algorithm.hpp>
 
@@ -28,12 +29,22 @@
 
 namespace scram::core {
 
-Settings& Settings::algorithm(Algorithm value) noexcept {
+Settings& Settings::algorithm(Algorithm value) {
+  if (value != Algorithm::kBdd && value != Algorithm::kAuto) {
+    if (compile_phases_)
+      SCRAM_THROW(SettingsError("Phases can only be compiled with BDD"));
+    if (gate_probabilities_)
+      SCRAM_THROW(
+          SettingsError("Gate probabilities can only be calculated with BDD"));
+  }
+
   algorithm_ = value;
   switch (algorithm_) {
     case Algorithm::kBdd:
       approximation(Approximation::kNone);
       break;
+    case Algorithm::kAuto:
+      break;
     default:
       if (approximation_ == Approximation::kNone)
         approximation(Approximation::kRareEvent);
@@ -74,7 +85,7 @@ Settings& Settings::approximation(std::string_view value) {
 }
 
 Settings& Settings::prime_implicants(bool flag) {
-  if (flag && algorithm_ != Algorithm::kBdd)
+  if (flag && algorithm_ != Algorithm::kBdd && algorithm_ != Algorithm::kAuto)
     SCRAM_THROW(
         SettingsError("Prime implicants can only be calculated with BDD"));
 
@@ -84,6 +95,31 @@ Settings& Settings::prime_implicants(bool flag) {
   return *this;
 }
 
+Settings& Settings::compile_phases(bool flag) {
+  if (flag && algorithm_ != Algorithm::kBdd && algorithm_ != Algorithm::kAuto)
+    SCRAM_THROW(SettingsError("Phases can only be compiled with BDD"));
+
+  compile_phases_ = flag;
+  return *this;
+}
+
+Settings& Settings::gate_probabilities(bool flag) {
+  if (flag && algorithm_ != Algorithm::kBdd && algorithm_ != Algorithm::kAuto)
+    SCRAM_THROW(
+        SettingsError("Gate probabilities can only be calculated with BDD"));
+
+  gate_probabilities_ = flag;
+  if (gate_probabilities_)
+    probability_analysis_ = true;
+  return *this;
+}
+
+Settings& Settings::probability_gates(std::vector<std::string> ids) {
+  gate_probabilities(true);
+  probability_gates_ = std::move(ids);
+  return *this;
+}
+
 Settings& Settings::limit_order(int order) {
   if (order < 0)
     SCRAM_THROW(SettingsError(
@@ -104,6 +140,18 @@ Settings& Settings::cut_off(double prob) {
   return *this;
 }
 
+Settings& Settings::top_products(int n) {
+  if (n < 0)
+    SCRAM_THROW(SettingsError(
+        "The number of the most probable products cannot be negative."))
+        << errinfo_value(std::to_string(n));
+
+  top_products_ = n;
+  if (top_products_)
+    probability_analysis_ = true;
+  return *this;
+}
+
 Settings& Settings::num_trials(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of trials cannot be less than 1."))
@@ -140,6 +188,19 @@ Settings& Settings::seed(int s) {
   return *this;
 }
 
+Settings& Settings::shard(int index, int count) {
+  if (count < 1)
+    SCRAM_THROW(SettingsError("The number of shards cannot be less than 1."))
+        << errinfo_value(std::to_string(count));
+  if (index < 0 || index >= count)
+    SCRAM_THROW(SettingsError("The shard index is out of range."))
+        << errinfo_value(std::to_string(index));
+
+  shard_ = index;
+  num_shards_ = count;
+  return *this;
+}
+
 Settings& Settings::mission_time(double time) {
   if (time < 0)
     SCRAM_THROW(SettingsError("The mission time cannot be negative."))
@@ -161,6 +222,34 @@ Settings& Settings::time_step(double time) {
   return *this;
 }
 
+Settings& Settings::sweep(std::string parameter, std::vector<double> values) {
+  if (values.empty())
+    SCRAM_THROW(SettingsError("The parameter sweep requires values."))
+        << errinfo_value(parameter);
+  for (const SweepAxis& axis : sweep_) {
+    if (axis.parameter == parameter)
+      SCRAM_THROW(SettingsError("The parameter is already in the sweep."))
+          << errinfo_value(parameter);
+  }
+  sweep_.push_back({std::move(parameter), std::move(values)});
+  probability_analysis_ = true;
+  return *this;
+}
+
+Settings& Settings::sweep(std::string parameter, double from, double to,
+                          int num_points) {
+  if (num_points < 1)
+    SCRAM_THROW(SettingsError("The sweep grid requires at least one point."))
+        << errinfo_value(std::to_string(num_points));
+  std::vector<double> values;
+  values.reserve(num_points);
+  for (int i = 0; i < num_points; ++i)
+    values.push_back(num_points == 1
+                         ? from
+                         : from + (to - from) * i / (num_points - 1));
+  return sweep(std::move(parameter), std::move(values));
+}
+
 Settings& Settings::safety_integrity_levels(bool flag) {
   if (flag && !time_step_)
     SCRAM_THROW(
@@ -22,15 +22,20 @@
 
 #include <cstdint>
 
+#include <string>
 #include <string_view>
+#include <vector>
+
+#include "progress.h"
 
 namespace scram::core {
 
 /// Qualitative analysis algorithms.
-enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus };
+/// The automatic algorithm is resolved into a concrete one per target.
+enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus, kAuto };
 
 /// String representations for algorithms.
-const char* const kAlgorithmToString[] = {"bdd", "zbdd", "mocus"};
+const char* const kAlgorithmToString[] = {"bdd", "zbdd", "mocus", "auto"};
 
 /// Quantitative analysis approximations.
 enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
@@ -38,6 +43,12 @@ enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
 /// String representations for approximations.
 const char* const kApproximationToString[] = {"none", "rare-event", "mcub"};
 
+/// The values of a model parameter varied in a parameter sweep.
+struct SweepAxis {
+  std::string parameter;  ///< The name of the model parameter.
+  std::vector<double> values;  ///< The values in the order of analysis.
+};
+
 /// Builder for analysis settings.
 /// Analysis facilities are guaranteed not to throw or fail
 /// with an instance of this class.
@@ -58,17 +69,23 @@ class Settings {
   /// MOCUS and ZBDD based analyses run
   /// with the Rare-Event approximation by default.
   /// Whereas, BDD based analyses run with exact quantitative analysis.
+  /// The automatic selection keeps the approximation
+  /// to let the selection decide unless the approximation is requested.
   ///
   /// @param[in] value  The algorithm kind.
   ///
   /// @returns Reference to this object.
-  Settings& algorithm(Algorithm value) noexcept;
+  ///
+  /// @throws SettingsError  The phase compilation or gate probabilities
+  ///                        require BDD.
+  Settings& algorithm(Algorithm value);
 
   /// Provides a convenient wrapper for algorithm setting from a string.
   ///
   /// @param[in] value  The string representation of the algorithm.
   ///
-  /// @throws SettingsError  The algorithm is not recognized.
+  /// @throws SettingsError  The algorithm is not recognized
+  ///                        or not applicable to the other settings.
   ///
   /// @returns Reference to this object.
   Settings& algorithm(std::string_view value);
@@ -94,7 +111,8 @@ class Settings {
   bool prime_implicants() const { return prime_implicants_; }
 
   /// Sets a flag to calculate prime implicants instead of minimal cut sets.
-  /// Prime implicants can only be calculated with BDD-based algorithms.
+  /// Prime implicants can only be calculated with BDD-based algorithms
+  /// or the automatic algorithm selection.
   ///
   /// The request for prime implicants cancels
   /// the request for inapplicable quantitative analysis approximations.
@@ -106,6 +124,61 @@ class Settings {
   /// @throws SettingsError  The request is not relevant to the algorithm.
   Settings& prime_implicants(bool flag);
 
+  /// @returns true if the fault trees are compiled once per alignment
+  ///               instead of the recompilation for every phase.
+  bool compile_phases() const { return compile_phases_; }
+
+  /// Sets a flag to compile the fault trees once for all phases of alignments.
+  /// The house events set by the phases are kept as BDD variables,
+  /// and the BDD of each phase is the restriction of the compiled BDD.
+  /// The phase compilation is only applicable to BDD-based analyses;
+  /// the targets with other (automatically selected) algorithms
+  /// and the event tree sequences are analyzed per phase.
+  ///
+  /// @param[in] flag  True for the request.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The request is not relevant to the algorithm.
+  Settings& compile_phases(bool flag);
+
+  /// @returns true if the probabilities of the intermediate gates
+  ///               of the fault trees are to be reported.
+  bool gate_probabilities() const { return gate_probabilities_; }
+
+  /// Sets a flag to report the probabilities of the intermediate gates.
+  /// The gates are kept as selectable functions
+  /// in the single compiled BDD of the top event,
+  /// so the probability of each gate is a sweep over the BDD
+  /// instead of a separate analysis of the gate.
+  /// The gate probabilities are only calculated for BDD-based analyses;
+  /// the targets with other (automatically selected) algorithms
+  /// are reported without the gate probabilities.
+  /// Probability analysis is turned on implicitly.
+  ///
+  /// @param[in] flag  True for the request.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The request is not relevant to the algorithm.
+  Settings& gate_probabilities(bool flag);
+
+  /// @returns The ids of the gates to report the probabilities of.
+  ///          Empty for all the intermediate gates.
+  const std::vector<std::string>& probability_gates() const {
+    return probability_gates_;
+  }
+
+  /// Selects the intermediate gates to report the probabilities of.
+  /// The gate probabilities are requested implicitly.
+  ///
+  /// @param[in] ids  The ids of the gates or empty for all gates.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The request is not relevant to the algorithm.
+  Settings& probability_gates(std::vector<std::string> ids);
+
   /// @returns The limit on the size of products.
   int limit_order() const { return limit_order_; }
 
@@ -119,10 +192,15 @@ class Settings {
   Settings& limit_order(int order);
 
   /// @returns The minimum required probability for products.
+  ///          0 if no products are discarded.
   double cut_off() const { return cut_off_; }
 
   /// Sets the cut-off probability for products
   /// to be considered for analysis.
+  /// The cut-off is applied to prime implicants
+  /// during their calculation
+  /// and to the combination levels of common cause failure groups
+  /// with probabilities bounded below the cut-off.
   ///
   /// @param[in] prob  The minimum probability for products.
   ///
@@ -131,6 +209,21 @@ class Settings {
   /// @throws SettingsError  The probability is not in the [0, 1] range.
   Settings& cut_off(double prob);
 
+  /// @returns The number of the most probable products to report.
+  ///          0 if all products are reported.
+  int top_products() const { return top_products_; }
+
+  /// Limits the reported products to the most probable ones.
+  /// The products are ranked by their probabilities,
+  /// so probability analysis is turned on implicitly.
+  ///
+  /// @param[in] n  A non-negative number of products (0 to report all).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 0.
+  Settings& top_products(int n);
+
   /// @returns The number of trials for Monte-Carlo simulations.
   int num_trials() const { return num_trials_; }
 
@@ -179,6 +272,24 @@ class Settings {
   /// @throws SettingsError  The number is negative.
   Settings& seed(int s);
 
+  /// @returns The index of the shard of Monte Carlo trials to simulate.
+  int shard() const { return shard_; }
+
+  /// @returns The number of shards of Monte Carlo trials.
+  int num_shards() const { return num_shards_; }
+
+  /// Restricts Monte Carlo simulations to a contiguous shard of the trials.
+  /// The shards of all the indices together cover all the trials,
+  /// and their sample statistics merge into the results of a single run.
+  ///
+  /// @param[in] index  The index of the shard in [0, count).
+  /// @param[in] count  The number of shards to split the trials into.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The index or count is out of range.
+  Settings& shard(int index, int count);
+
   /// @returns The length time of the system under risk.
   double mission_time() const { return mission_time_; }
 
@@ -191,6 +302,38 @@ class Settings {
   /// @throws SettingsError  The time value is negative.
   Settings& mission_time(double time);
 
+  /// @returns The parameters varied in the parameter sweep.
+  ///          The sweep points are all the combinations of their values
+  ///          with the values of the last parameter changing fastest.
+  const std::vector<SweepAxis>& sweep() const { return sweep_; }
+
+  /// Adds a parameter to vary in the parameter sweep.
+  /// The sweep is quantified on the products of the analysis,
+  /// so probability analysis is turned on implicitly.
+  ///
+  /// @param[in] parameter  The name of the model parameter.
+  /// @param[in] values  The values of the parameter.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The values are missing
+  ///                          or the parameter is already in the sweep.
+  Settings& sweep(std::string parameter, std::vector<double> values);
+
+  /// Adds a parameter to vary over a uniform grid of values.
+  ///
+  /// @param[in] parameter  The name of the model parameter.
+  /// @param[in] from  The first value of the grid.
+  /// @param[in] to  The last value of the grid.
+  /// @param[in] num_points  The number of grid points including the ends.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number of points is less than 1
+  ///                          or the parameter is already in the sweep.
+  Settings& sweep(std::string parameter, double from, double to,
+                  int num_points);
+
   /// @returns The time step in hours for probability analyses.
   ///          0 if the time step doesn't apply.
   double time_step() const { return time_step_; }
@@ -220,7 +363,8 @@ class Settings {
   /// @returns Reference to this object.
   Settings& probability_analysis(bool flag) {
     if (!importance_analysis_ && !uncertainty_analysis_ &&
-        !safety_integrity_levels_) {
+        !safety_integrity_levels_ && !top_products_ && sweep_.empty() &&
+        !gate_probabilities_) {
       probability_analysis_ = flag;
     }
     return *this;
@@ -287,6 +431,24 @@ class Settings {
     return *this;
   }
 
+  /// @returns The observer of the analysis progress if any.
+  Progress* progress() const { return progress_; }
+
+  /// Sets the progress observer and cancellation token for analyses.
+  ///
+  /// @param[in] value  The progress observer or nullptr.
+  ///                   The caller retains the ownership
+  ///                   and keeps it alive while the analyses run.
+  ///
+  /// @returns Reference to this object.
+  Settings& progress(Progress* value) {
+    progress_ = value;
+    return *this;
+  }
+
+  /// @returns true if the analysis cancellation has been requested.
+  bool cancelled() const { return progress_ && progress_->cancelled(); }
+
 #ifndef NDEBUG
   bool preprocessor = false;  ///< Stop analysis after preprocessor.
   bool print = false;  ///< Print analysis results in a terminal friendly way.
@@ -299,18 +461,27 @@ class Settings {
   bool uncertainty_analysis_ = false;  ///< A flag for uncertainty analysis.
   bool ccf_analysis_ = false;  ///< A flag for common-cause analysis.
   bool prime_implicants_ = false;  ///< Calculation of prime implicants.
+  bool compile_phases_ = false;  ///< Compilation of fault trees per alignment.
+  bool gate_probabilities_ = false;  ///< Reporting of the gate probabilities.
   /// Qualitative analysis algorithm.
   Algorithm algorithm_ = Algorithm::kBdd;
   /// The approximations for calculations.
   Approximation approximation_ = Approximation::kNone;
   int limit_order_ = 20;  ///< Limit on the order of products.
+  int top_products_ = 0;  ///< The number of the most probable products.
   int seed_ = 0;  ///< The seed for the pseudo-random number generator.
   int num_trials_ = 1e3;  ///< The number of trials for Monte Carlo simulations.
+  int shard_ = 0;  ///< The shard of the trials to simulate.
+  int num_shards_ = 1;  ///< The number of the trial shards.
   int num_quantiles_ = 20;  ///< The number of quantiles for distributions.
   int num_bins_ = 20;  ///< The number of bins for histograms.
   double mission_time_ = 8760;  ///< System mission time.
   double time_step_ = 0;  ///< The time step for probability analyses.
-  double cut_off_ = 1e-8;  ///< The cut-off probability for products.
+  double cut_off_ = 0;  ///< The cut-off probability for products.
+  std::vector<SweepAxis> sweep_;  ///< The parameters of the parameter sweep.
+  /// The selected gates for the probabilities or empty for all.
+  std::vector<std::string> probability_gates_;
+  Progress* progress_ = nullptr;  ///< The optional progress observer.
 };
 
 }  // namespace scram::core
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the merging of uncertainty analysis shards.
+
+#include "shard_merger.h"
+
+#include <cstdio>
+
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <boost/exception/errinfo_file_name.hpp>
+
+#include "alignment.h"
+#include "env.h"
+#include "error.h"
+#include "event_tree.h"
+#include "logger.h"
+
+namespace scram {
+
+namespace {
+
+/// @returns The text for the exact round trip of the value.
+std::string ToText(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+/// @returns The unique key of the target from its id attributes.
+std::string TargetKey(std::string_view name, std::string_view initiating_event,
+                      std::string_view alignment, std::string_view phase) {
+  std::string key(initiating_event);
+  key.append("/").append(name).append("@").append(alignment);
+  key.append("/").append(phase);
+  return key;
+}
+
+/// The sample statistics of a shard with its origin.
+struct Shard {
+  int index;  ///< The index of the shard.
+  core::SampleStatistics samples;  ///< The statistics of the shard trials.
+};
+
+}  // namespace
+
+void WriteSampleStatistics(const core::SampleStatistics& samples,
+                           const core::Settings& settings,
+                           xml::StreamElement* parent) {
+  std::int64_t first_trial = static_cast<std::int64_t>(settings.num_trials()) *
+                             settings.shard() / settings.num_shards();
+  xml::StreamElement statistics = parent->AddChild("sufficient-statistics");
+  statistics.SetAttribute("shard", settings.shard())
+      .SetAttribute("shards", settings.num_shards())
+      .SetAttribute("seed", settings.seed())
+      .SetAttribute("first-trial", first_trial)
+      .SetAttribute("trials", samples.count())
+      .SetAttribute("min", ToText(samples.min()))
+      .SetAttribute("max", ToText(samples.max()))
+      .SetAttribute("sum", samples.sum().str())
+      .SetAttribute("sum-of-squares", samples.sum_of_squares().str())
+      .SetAttribute("zeros", samples.zeros());
+  for (const auto& [index, count] : samples.sketch()) {
+    statistics.AddChild("bucket")
+        .SetAttribute("index", index)
+        .SetAttribute("count", count);
+  }
+}
+
+core::SampleStatistics ReadSampleStatistics(const xml::Element& element) {
+  std::map<int, std::int64_t> sketch;
+  for (const xml::Element& bucket : element.children("bucket"))
+    sketch.emplace(*bucket.attribute<int>("index"),
+                   *bucket.attribute<std::int64_t>("count"));
+  core::SampleStatistics samples;
+  try {
+    samples.Assign(*element.attribute<std::int64_t>("trials"),
+                   *element.attribute<double>("min"),
+                   *element.attribute<double>("max"),
+                   element.attribute("sum"),
+                   element.attribute("sum-of-squares"),
+                   *element.attribute<std::int64_t>("zeros"),
+                   std::move(sketch));
+  } catch (const std::runtime_error& err) {
+    SCRAM_THROW(xml::ValidityError(err.what()))
+        << xml::errinfo_element(std::string(element.name()))
+        << boost::errinfo_at_line(element.line())
+        << boost::errinfo_file_name(element.filename());
+  }
+  return samples;
+}
+
+ShardMerger::ShardMerger(const std::vector<std::string>& reports,
+                         const core::Settings& settings) {
+  static xml::Validator validator(env::report_schema());
+
+  std::map<std::string, std::vector<Shard>> shards;
+  int num_shards = 0;  // Taken from the first shard.
+  for (const std::string& report : reports) {
+    xml::Document document(report, &validator);
+    std::optional<xml::Element> results = document.root().child("results");
+    if (!results)
+      continue;
+    for (const xml::Element& measure : results->children("measure")) {
+      std::optional<xml::Element> statistics =
+          measure.child("sufficient-statistics");
+      if (!statistics)
+        continue;
+      int index = *statistics->attribute<int>("shard");
+      if (!num_shards)
+        num_shards = *statistics->attribute<int>("shards");
+      std::int64_t first = *statistics->attribute<std::int64_t>("first-trial");
+      std::int64_t num_trials = *statistics->attribute<std::int64_t>("trials");
+      std::int64_t total = settings.num_trials();
+      if (statistics->attribute<int>("shards") != num_shards ||
+          index >= num_shards ||
+          statistics->attribute<int>("seed") != settings.seed() ||
+          first != total * index / num_shards ||
+          first + num_trials != total * (index + 1) / num_shards) {
+        SCRAM_THROW(SettingsError("The shard is from a different analysis."))
+            << boost::errinfo_file_name(report)
+            << boost::errinfo_at_line(statistics->line());
+      }
+      shards[TargetKey(measure)].push_back(
+          {index, ReadSampleStatistics(*statistics)});
+    }
+  }
+
+  for (auto& [key, measure_shards] : shards) {
+    std::vector<bool> merged(num_shards);
+    core::SampleStatistics& samples = measures_[key];
+    for (const Shard& shard : measure_shards) {
+      if (merged[shard.index]) {
+        SCRAM_THROW(xml::ValidityError("Duplicate shard " +
+                                       std::to_string(shard.index) +
+                                       " of measure " + key));
+      }
+      merged[shard.index] = true;
+      samples.Merge(shard.samples);
+    }
+    if (measure_shards.size() != num_shards) {
+      SCRAM_THROW(xml::ValidityError(
+          "Missing shards of measure " + key + ": " +
+          std::to_string(measure_shards.size()) + " out of " +
+          std::to_string(num_shards)));
+    }
+    LOG(DEBUG2) << "Merged " << measure_shards.size() << " shards of " << key;
+  }
+}
+
+std::string TargetKey(const core::RiskAnalysis::Result::Id& id) {
+  std::string_view name;
+  std::string_view initiating_event;
+  if (auto* gate = std::get_if<const mef::Gate*>(&id.target)) {
+    name = (*gate)->id();
+  } else {
+    const auto& sequence = std::get<1>(id.target);
+    initiating_event = sequence.first.name();
+    name = sequence.second.name();
+  }
+  std::string_view alignment;
+  std::string_view phase;
+  if (id.context) {
+    alignment = id.context->alignment.name();
+    phase = id.context->phase.name();
+  }
+  return TargetKey(name, initiating_event, alignment, phase);
+}
+
+std::string TargetKey(const xml::Element& element) {
+  return TargetKey(element.attribute("name"),
+                   element.attribute("initiating-event"),
+                   element.attribute("alignment"), element.attribute("phase"));
+}
+
+std::optional<core::SampleStatistics> ShardMerger::operator()(
+    const core::RiskAnalysis::Result::Id& id) const {
+  auto it = measures_.find(TargetKey(id));
+  if (it == measures_.end())
+    return {};
+  return it->second;
+}
+
+}  // namespace scram
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Merging of the uncertainty analysis shards
+/// from the sufficient statistics in the shard reports.
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "risk_analysis.h"
+#include "settings.h"
+#include "uncertainty_analysis.h"
+#include "xml.h"
+#include "xml_stream.h"
+
+namespace scram {
+
+/// Writes the sufficient statistics of the uncertainty analysis samples.
+///
+/// @param[in] samples  The samples of the first trials of the shard.
+/// @param[in] settings  The analysis settings with the trial shard.
+/// @param[in,out] parent  The XML element to contain the statistics.
+void WriteSampleStatistics(const core::SampleStatistics& samples,
+                           const core::Settings& settings,
+                           xml::StreamElement* parent);
+
+/// Reads the sufficient statistics of the uncertainty analysis samples.
+///
+/// @param[in] element  The XML element written by WriteSampleStatistics.
+///
+/// @returns The sample statistics.
+///
+/// @throws xml::ValidityError  The statistics are malformed.
+core::SampleStatistics ReadSampleStatistics(const xml::Element& element);
+
+/// @param[in] id  The analysis target.
+///
+/// @returns The unique key of the target.
+std::string TargetKey(const core::RiskAnalysis::Result::Id& id);
+
+/// @param[in] element  The XML element with the analysis target id.
+///
+/// @returns The unique key of the target.
+std::string TargetKey(const xml::Element& element);
+
+/// Merges the sample statistics of the uncertainty measures
+/// from the reports of all the trial shards.
+class ShardMerger {
+ public:
+  /// Loads and checks the shard reports.
+  ///
+  /// @param[in] reports  The report files of the shard runs.
+  /// @param[in] settings  The settings of the analysis with all the trials.
+  ///                      The number of shards is taken from the reports.
+  ///
+  /// @throws IOError  A report file is not accessible.
+  /// @throws xml::Error  A report file is not a valid report.
+  /// @throws xml::ValidityError  The shards of a measure are incomplete.
+  /// @throws SettingsError  The shards are from different analysis settings.
+  ShardMerger(const std::vector<std::string>& reports,
+              const core::Settings& settings);
+
+  /// @param[in] id  The analysis target.
+  ///
+  /// @returns The merged sample statistics of all the trials of the target.
+  ///          None if the target has no shards.
+  std::optional<core::SampleStatistics> operator()(
+      const core::RiskAnalysis::Result::Id& id) const;
+
+ private:
+  std::map<std::string, core::SampleStatistics> measures_;  ///< By measure id.
+};
+
+}  // namespace scram
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of resource usage measurements.
+
+#include "statistics.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+
+#include <boost/predef.h>
+
+#if !BOOST_OS_WINDOWS
+#include <sys/resource.h>
+#endif
+
+namespace scram::core {
+
+namespace {
+
+/// The allocations by all threads.
+/// The counter is only a tally without ordering of other memory operations.
+std::atomic<std::size_t> num_allocations = 0;
+
+}  // namespace
+
+std::size_t PeakMemory() noexcept {
+#if BOOST_OS_WINDOWS
+  return 0;
+#else
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage))
+    return 0;
+#if BOOST_OS_MACOS
+  return usage.ru_maxrss;  // Bytes.
+#else
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // Kilobytes.
+#endif
+#endif
+}
+
+std::size_t NumAllocations() noexcept {
+  return num_allocations.load(std::memory_order_relaxed);
+}
+
+void CountAllocation() noexcept {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+Statistics::Usage::~Usage() noexcept {
+  statistics_->allocations_ += NumAllocations() - allocations_;
+  statistics_->process_peak_memory_ =
+      std::max(statistics_->process_peak_memory_, PeakMemory());
+}
+
+std::int64_t Statistics::counter(const char* name) const {
+  auto it = std::find_if(counters_.begin(), counters_.end(),
+                         [name](const Counter& counter) {
+                           return std::strcmp(counter.first, name) == 0;
+                         });
+  return it == counters_.end() ? 0 : it->second;
+}
+
+void Statistics::Add(const char* name, std::int64_t value) {
+  auto it = std::find_if(counters_.begin(), counters_.end(),
+                         [name](const Counter& counter) {
+                           return std::strcmp(counter.first, name) == 0;
+                         });
+  if (it == counters_.end()) {
+    counters_.emplace_back(name, value);
+  } else {
+    it->second += value;
+  }
+}
+
+void Statistics::Merge(const Statistics& other) {
+  for (const Counter& counter : other.counters_)
+    Add(counter.first, counter.second);
+  process_peak_memory_ =
+      std::max(process_peak_memory_, other.process_peak_memory_);
+  allocations_ += other.allocations_;
+}
+
+}  // namespace scram::core
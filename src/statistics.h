@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Resource usage and data structure statistics of analyses.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace scram::core {
+
+/// @returns The peak resident memory of the process in bytes,
+///          or 0 if the platform does not provide the information.
+std::size_t PeakMemory() noexcept;
+
+/// @returns The number of heap allocations by all threads of the process,
+///          or 0 if the allocations are not tracked.
+std::size_t NumAllocations() noexcept;
+
+/// Registers a heap allocation by any thread.
+/// The library does not track allocations by itself;
+/// executables may call this function
+/// from their replacement of the global operator new.
+void CountAllocation() noexcept;
+
+/// Counters collected over analysis stages.
+class Statistics {
+ public:
+  /// The counter with a static name and a value.
+  using Counter = std::pair<const char*, std::int64_t>;
+
+  /// Automatic (scoped) measurement of resource usage by a stage.
+  class Usage : private boost::noncopyable {
+   public:
+    /// @param[in,out] statistics  The destination of the measurement.
+    explicit Usage(Statistics* statistics) noexcept
+        : statistics_(statistics), allocations_(NumAllocations()) {}
+
+    /// Records the resource usage into the statistics.
+    ~Usage() noexcept;
+
+   private:
+    Statistics* statistics_;  ///< The destination of the measurement.
+    std::size_t allocations_;  ///< The allocations before the stage.
+  };
+
+  /// @returns The data structure counters in the order of addition.
+  const std::vector<Counter>& counters() const { return counters_; }
+
+  /// @returns The peak resident memory of the whole process in bytes
+  ///          by the end of the stage.
+  ///          This high-water mark includes the earlier stages and analyses.
+  std::size_t process_peak_memory() const { return process_peak_memory_; }
+
+  /// @returns The number of heap allocations during the stage
+  ///          including the allocations by its worker threads.
+  std::size_t allocations() const { return allocations_; }
+
+  /// @returns The value of a counter or 0 if it is not recorded.
+  ///
+  /// @param[in] name  The counter name.
+  std::int64_t counter(const char* name) const;
+
+  /// Adds a value to a counter.
+  ///
+  /// @param[in] name  The static name of the counter.
+  /// @param[in] value  The value to be accumulated.
+  void Add(const char* name, std::int64_t value);
+
+  /// Accumulates all the counters and usage of other statistics.
+  ///
+  /// @param[in] other  The statistics of a sub-stage or sub-analysis.
+  void Merge(const Statistics& other);
+
+ private:
+  std::vector<Counter> counters_;  ///< The data structure counters.
+  std::size_t process_peak_memory_ = 0;  ///< The process peak in bytes.
+  std::size_t allocations_ = 0;  ///< The number of heap allocations.
+};
+
+}  // namespace scram::core
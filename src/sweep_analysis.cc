@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of parameter sweeps.
+
+#include "sweep_analysis.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "event.h"
+#include "ext/parallel.h"
+#include "ext/scope_guard.h"
+#include "logger.h"
+#include "parameter.h"
+#include "zbdd.h"
+
+namespace scram::core {
+
+namespace {
+
+/// The number of points with variable probabilities in memory at once.
+const int kBlockSize = 1024;
+
+}  // namespace
+
+SweepAnalysis::SweepAnalysis(ProbabilityAnalyzerBase* prob_analyzer,
+                             std::vector<mef::Parameter*> parameters)
+    : Analysis(std::as_const(*prob_analyzer).settings()),
+      prob_analyzer_(prob_analyzer),
+      parameters_(std::move(parameters)) {
+  assert(parameters_.size() == Analysis::settings().sweep().size());
+}
+
+void SweepAnalysis::Resume(std::vector<Point> points,
+                           Recorder recorder) noexcept {
+  CLOCK(sweep_time);
+  TRACE("Parameter sweep");
+  Statistics::Usage usage(&Analysis::statistics());
+  const std::vector<SweepAxis>& axes = Analysis::settings().sweep();
+  const auto& basic_events = prob_analyzer_->graph()->basic_events();
+  prob_analyzer_->PrepareEvaluation();
+
+  if (Analysis::settings().importance_analysis()) {
+    Pdag::IndexMap<int> occurrences(basic_events.size());
+    for (const std::vector<int>& product : prob_analyzer_->products()) {
+      for (int index : product)
+        occurrences[std::abs(index)]++;
+    }
+    for (int i = Pdag::kVariableStartIndex;
+         i < Pdag::kVariableStartIndex + basic_events.size(); ++i) {
+      if (occurrences[i] == 0)
+        continue;
+      important_variables_.emplace_back(i, occurrences[i]);
+      important_events_.push_back(basic_events[i]);
+    }
+  }
+
+  int num_points = 1;
+  for (const SweepAxis& axis : axes)
+    num_points *= axis.values.size();
+  assert(points.size() <= num_points && "Points of another sweep.");
+  int num_done = points.size();
+  points_ = std::move(points);
+  points_.resize(num_points);
+  for (int i = 0; i < num_points; ++i) {
+    Point& point = points_[i];
+    point.values.resize(axes.size());
+    for (int j = axes.size() - 1, rest = i; j >= 0; --j) {
+      const std::vector<double>& values = axes[j].values;
+      point.values[j] = values[rest % values.size()];
+      rest /= values.size();
+    }
+  }
+  LOG(DEBUG3) << "Sweeping " << num_points - num_done << " out of "
+              << num_points << " points of " << axes.size() << " parameters...";
+
+  std::vector<std::optional<double>> originals;
+  for (const mef::Parameter* parameter : parameters_)
+    originals.push_back(parameter->override_value());
+  SCOPE_EXIT([&] {
+    for (int i = 0; i < parameters_.size(); ++i)
+      parameters_[i]->override_value(originals[i]);
+  });
+
+  int num_invalid = std::count_if(points_.begin(), points_.begin() + num_done,
+                                  [](const Point& point) {
+                                    return !point.valid;
+                                  });
+  std::vector<std::pair<Pdag::IndexMap<double>, Point*>> block;
+  for (int start = num_done; start < num_points; start += kBlockSize) {
+    if (Analysis::settings().cancelled())
+      return;
+    block.resize(std::min(kBlockSize, num_points - start));
+    // The expression values are cached in the model,
+    // so only the evaluation on the compiled analysis is concurrent.
+    for (int k = 0; k < block.size(); ++k) {
+      auto& [p_vars, point] = block[k];
+      point = &points_[start + k];
+      for (int j = 0; j < parameters_.size(); ++j)
+        parameters_[j]->override_value(point->values[j]);
+      p_vars.resize(basic_events.size());
+      auto it_p = p_vars.begin();
+      for (const mef::BasicEvent* event : basic_events) {
+        double p = event->p();
+        if (p < 0 || p > 1)
+          point->valid = false;
+        *it_p++ = p;
+      }
+      num_invalid += !point->valid;
+    }
+    ext::parallel_for_each(block, [this](auto& task) {
+      if (task.second->valid)
+        Evaluate(&task.first, task.second);
+    });
+    if (recorder)
+      recorder(points_, start + block.size());
+  }
+  if (num_invalid) {
+    Analysis::AddWarning("Invalid basic event probabilities at " +
+                         std::to_string(num_invalid) + " sweep points");
+  }
+  statistics().Add("sweep-points", num_points);
+  LOG(DEBUG3) << "Finished the parameter sweep in " << DUR(sweep_time);
+  Analysis::AddAnalysisTime(DUR(sweep_time));
+}
+
+void SweepAnalysis::Evaluate(Pdag::IndexMap<double>* p_vars,
+                             Point* point) const noexcept {
+  std::vector<double> workspace;
+  point->p_total =
+      prob_analyzer_->EvaluateTotalProbability(*p_vars, &workspace);
+  point->importance.reserve(important_variables_.size());
+  for (auto [index, occurrence] : important_variables_) {
+    double p_var = (*p_vars)[index];
+    (*p_vars)[index] = 1;
+    double p_high =
+        prob_analyzer_->EvaluateTotalProbability(*p_vars, &workspace);
+    (*p_vars)[index] = 0;
+    double p_low =
+        prob_analyzer_->EvaluateTotalProbability(*p_vars, &workspace);
+    (*p_vars)[index] = p_var;
+    point->importance.push_back(DeriveImportanceFactors(
+        occurrence, p_high - p_low, p_var, point->p_total));
+  }
+}
+
+}  // namespace scram::core
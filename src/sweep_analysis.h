@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Parameter sweeps over the compiled analysis of a target.
+
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "analysis.h"
+#include "importance_analysis.h"
+#include "probability_analysis.h"
+
+namespace scram::mef {  // Decouple from the model code header.
+class BasicEvent;
+class Parameter;
+}  // namespace scram::mef
+
+namespace scram::core {
+
+/// Sensitivity analysis of the total probability
+/// over the combinations of model parameter values.
+/// The products and decision diagrams of the probability analysis
+/// are reused for all the sweep points,
+/// so only the variable probabilities are recomputed per point.
+class SweepAnalysis : public Analysis {
+ public:
+  /// The results at a single sweep point.
+  struct Point {
+    std::vector<double> values;  ///< The parameter values in the sweep order.
+    bool valid = true;  ///< The basic event probabilities are in [0, 1].
+    double p_total = 0;  ///< The total probability at the valid point.
+    /// The importance factors in the order of the important events.
+    std::vector<ImportanceFactors> importance;
+  };
+
+  /// The callback to record the points evaluated so far.
+  /// The first points of the sweep are evaluated
+  /// up to the given number of points.
+  using Recorder =
+      std::function<void(const std::vector<Point>& points, int num_points)>;
+
+  /// @param[in] prob_analyzer  Completed probability analyzer.
+  /// @param[in] parameters  The model parameters
+  ///                        in the order of the sweep settings.
+  SweepAnalysis(ProbabilityAnalyzerBase* prob_analyzer,
+                std::vector<mef::Parameter*> parameters);
+
+  /// Evaluates the total probability
+  /// and the importance factors if requested at all sweep points.
+  /// The variable probabilities are collected sequentially,
+  /// and the points are evaluated concurrently.
+  ///
+  /// @pre Analysis is called only once.
+  ///
+  /// @post The parameters have their original values.
+  void Analyze() noexcept { Resume({}, nullptr); }
+
+  /// Continues the interrupted sweep after the evaluated points.
+  ///
+  /// @param[in] points  The results at the first points of the sweep.
+  ///                    The parameter values are ignored.
+  /// @param[in] recorder  The optional recorder of the evaluated points
+  ///                      called after every block of points.
+  ///
+  /// @pre The points are of the same sweep and importance analysis settings.
+  ///
+  /// @copydetails Analyze
+  void Resume(std::vector<Point> points, Recorder recorder) noexcept;
+
+  /// @returns The swept parameters in the sweep order.
+  const std::vector<mef::Parameter*>& parameters() const {
+    return parameters_;
+  }
+
+  /// @returns The basic events with importance factors at the points.
+  ///          Empty unless importance analysis is requested.
+  const std::vector<const mef::BasicEvent*>& important_events() const {
+    return important_events_;
+  }
+
+  /// @returns The sweep points with the last parameter changing fastest.
+  const std::vector<Point>& points() const { return points_; }
+
+ private:
+  /// Evaluates a single sweep point.
+  ///
+  /// @param[in,out] p_vars  The variable probabilities at the point.
+  ///                        The values are restored after the evaluation.
+  /// @param[in,out] point  The destination for the point results.
+  void Evaluate(Pdag::IndexMap<double>* p_vars, Point* point) const noexcept;
+
+  ProbabilityAnalyzerBase* prob_analyzer_;  ///< The compiled analysis.
+  std::vector<mef::Parameter*> parameters_;  ///< The swept parameters.
+  /// The variable indices and occurrences of the important events.
+  std::vector<std::pair<int, int>> important_variables_;
+  std::vector<const mef::BasicEvent*> important_events_;  ///< For reporting.
+  std::vector<Point> points_;  ///< The results of the sweep.
+};
+
+}  // namespace scram::core
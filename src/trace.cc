@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the trace event recording and output.
+
+#include "trace.h"
+
+#include <cerrno>
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+
+#include "error.h"
+
+namespace scram {
+
+namespace {
+
+std::mutex trace_mutex;  ///< The guard of the recorded events.
+std::vector<std::string> trace_events;  ///< The serialized events.
+
+/// @returns The steady clock time stamp in nanoseconds.
+std::uint64_t TimeStamp() noexcept {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+/// Writes a JSON string literal.
+///
+/// @param[in] value  The raw string value.
+/// @param[out] out  The destination stream.
+void WriteString(const std::string& value, std::ostream& out) {
+  out << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << ' ';
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+}  // namespace
+
+std::atomic<bool> Trace::enabled_ = false;
+std::atomic<std::uint64_t> Trace::origin_ = 0;
+
+void Trace::Start() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.clear();
+  }
+  origin_ = TimeStamp();
+  enabled_ = true;
+}
+
+void Trace::Stop() noexcept { enabled_ = false; }
+
+double Trace::Now() noexcept { return (TimeStamp() - origin_) * 1e-3; }
+
+void Trace::Complete(std::string name, double begin, Counters counters) {
+  double now = Now();
+  Add({std::move(name), 'X', begin, now - begin, ThreadNumber(),
+       std::move(counters)});
+}
+
+void Trace::Counter(const char* name, Counters counters) {
+  Add({name, 'C', Now(), 0, ThreadNumber(), std::move(counters)});
+}
+
+void Trace::Add(Event event) {
+  if (!enabled())
+    return;
+  std::ostringstream out;
+  out.precision(15);
+  out << "{\"name\":";
+  WriteString(event.name, out);
+  out << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.ts;
+  if (event.phase == 'X')
+    out << ",\"dur\":" << event.dur;
+  out << ",\"pid\":1,\"tid\":" << event.tid;
+  if (!event.args.empty()) {
+    out << ",\"args\":{";
+    bool first = true;
+    for (const auto& [key, value] : event.args) {
+      if (!first)
+        out << ",";
+      first = false;
+      WriteString(key, out);
+      out << ":" << value;
+    }
+    out << "}";
+  }
+  out << "}";
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  trace_events.push_back(out.str());
+}
+
+int Trace::ThreadNumber() noexcept {
+  static std::atomic<int> num_threads = 0;
+  thread_local int number = ++num_threads;
+  return number;
+}
+
+void Trace::Write(std::ostream& out) {
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  out << "{\"traceEvents\":[\n"
+      << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"scram"}})";
+  for (const std::string& event : trace_events)
+    out << ",\n" << event;
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Trace::Write(const std::string& path) {
+  std::ofstream out(path);
+  if (out)
+    Write(out);
+  if (!out) {
+    SCRAM_THROW(IOError("Cannot write the trace file."))
+        << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w")
+        << boost::errinfo_file_name(path);
+  }
+}
+
+TraceSpan::~TraceSpan() noexcept {
+  if (begin_ < 0)
+    return;
+  try {
+    Trace::Complete(name_ ? name_ : std::move(dynamic_name_), begin_,
+                    std::move(counters_));
+  } catch (const std::bad_alloc&) {  // The trace is only diagnostics.
+  }
+}
+
+void TraceSpan::Add(const char* key, double value) noexcept {
+  if (begin_ < 0)
+    return;
+  try {
+    counters_.emplace_back(key, value);
+  } catch (const std::bad_alloc&) {
+  }
+}
+
+}  // namespace scram
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Structured performance tracing of analysis stages.
+/// The trace is recorded in memory
+/// and written in the Chrome trace-event JSON format,
+/// which is viewable with chrome://tracing or Perfetto.
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/preprocessor/cat.hpp>
+
+namespace scram {
+
+/// Creates an automatic unique trace span for a scope.
+#define TRACE(...) scram::TraceSpan BOOST_PP_CAT(trace_, __LINE__)(__VA_ARGS__)
+
+/// Process-wide recorder of trace events.
+/// The recording is off by default,
+/// so that the instrumentation costs only a flag check.
+///
+/// @note All member functions are safe to call concurrently.
+class Trace : private boost::noncopyable {
+ public:
+  /// Named numeric values attached to trace events.
+  using Counters = std::vector<std::pair<const char*, double>>;
+
+  /// @returns true if the events are being recorded.
+  static bool enabled() noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// Discards previous events and starts the recording.
+  static void Start() noexcept;
+
+  /// Stops the recording without discarding events.
+  static void Stop() noexcept;
+
+  /// @returns The current time in microseconds since the start of recording.
+  static double Now() noexcept;
+
+  /// Records a span of work with known duration.
+  ///
+  /// @param[in] name  The name of the work.
+  /// @param[in] begin  The start time in microseconds (Now).
+  /// @param[in] counters  Values describing the work.
+  static void Complete(std::string name, double begin, Counters counters);
+
+  /// Records a sample of counters plotted over time.
+  ///
+  /// @param[in] name  The name of the counter group.
+  /// @param[in] counters  The current values.
+  static void Counter(const char* name, Counters counters);
+
+  /// Writes the recorded events in the Chrome trace-event format.
+  ///
+  /// @param[out] out  The destination stream.
+  static void Write(std::ostream& out);
+
+  /// Writes the recorded events into a file.
+  ///
+  /// @param[in] path  The destination file path.
+  ///
+  /// @throws IOError  The file cannot be written.
+  static void Write(const std::string& path);
+
+ private:
+  /// Trace event of the Chrome format.
+  struct Event {
+    std::string name;  ///< The event name.
+    char phase;  ///< 'X' for complete events, 'C' for counters.
+    double ts;  ///< The time stamp in microseconds.
+    double dur;  ///< The duration in microseconds.
+    int tid;  ///< The small thread number.
+    Counters args;  ///< The event arguments.
+  };
+
+  /// Records an event if the recording is on.
+  static void Add(Event event);
+
+  /// @returns The small number of the calling thread.
+  static int ThreadNumber() noexcept;
+
+  static std::atomic<bool> enabled_;  ///< The recording flag.
+  static std::atomic<std::uint64_t> origin_;  ///< The start time stamp.
+};
+
+/// Automatic (scoped) span of work in the trace.
+/// The span is recorded upon destruction
+/// only if the tracing is enabled at construction.
+class TraceSpan : private boost::noncopyable {
+ public:
+  /// @param[in] name  The name of the work.
+  explicit TraceSpan(const char* name) noexcept
+      : name_(name), begin_(Trace::enabled() ? Trace::Now() : -1) {}
+
+  /// @param[in] name  The dynamic name of the work.
+  explicit TraceSpan(std::string name) noexcept
+      : name_(nullptr), begin_(Trace::enabled() ? Trace::Now() : -1) {
+    if (begin_ >= 0)
+      dynamic_name_ = std::move(name);
+  }
+
+  /// Records the span with its counters.
+  ~TraceSpan() noexcept;
+
+  /// @returns true if the span is recorded.
+  explicit operator bool() const { return begin_ >= 0; }
+
+  /// Attaches a value to the span.
+  ///
+  /// @param[in] key  The name of the value.
+  /// @param[in] value  The value to be reported.
+  void Add(const char* key, double value) noexcept;
+
+ private:
+  const char* name_;  ///< The static name of the work or nullptr.
+  std::string dynamic_name_;  ///< The optional owned name.
+  double begin_;  ///< The start time, or negative if not recorded.
+  Trace::Counters counters_;  ///< Values describing the work.
+};
+
+}  // namespace scram
@@ -20,21 +20,271 @@
 
 #include "uncertainty_analysis.h"
 
+#include <cassert>
 #include <cmath>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/density.hpp>
-#include <boost/accumulators/statistics/extended_p_square_quantile.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/variance.hpp>
+#include <unordered_set>
+
+#include <boost/multiprecision/cpp_bin_float.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
 
 #include "event.h"
 #include "expression.h"
+#include "expression/extern.h"
 #include "logger.h"
+#include "parameter.h"
 
 namespace scram::core {
 
+namespace {
+
+using boost::multiprecision::cpp_bin_float_50;
+using boost::multiprecision::cpp_int;
+
+/// The number of fixed-point digits of exact sums
+/// up to the carries of 2^63 samples.
+const int kNumDigits = -SampleStatistics::ExactSum::kMinExponent + 128;
+const int kDigitBits = 53;  ///< The span of normalized digits.
+const std::uint64_t kCarryLimit = std::uint64_t(1) << 62;  ///< Digit bound.
+
+/// The growth factor of the quantile sketch buckets.
+const double kGamma = (1 + SampleStatistics::kSketchAccuracy) /
+                      (1 - SampleStatistics::kSketchAccuracy);
+const double kLogGamma = std::log(kGamma);  ///< The sketch bucket width.
+
+/// @returns The value representing the sketch bucket
+///          within the relative accuracy.
+double BucketValue(int index) {
+  return 2 * std::pow(kGamma, index) / (kGamma + 1);
+}
+
+/// @returns The sampled value clipped into the probability range.
+double ClipProbability(double value) {
+  return value > 1 ? 1 : value < 0 ? 0 : value;
+}
+
+/// @returns The expression sampled for the value of the given expression,
+///          skipping the parameters without overrides.
+mef::Expression* SkipParameters(mef::Expression* expression) {
+  while (auto* parameter = dynamic_cast<mef::Parameter*>(expression)) {
+    if (parameter->override_value())
+      break;
+    expression = parameter->args().front();
+  }
+  return expression;
+}
+
+/// Collects the batch extern expressions
+/// sampled for other than the values of deviate expressions.
+///
+/// @param[in] expression  The sampled expression to traverse.
+/// @param[in] direct  True if the expression value is a deviate value.
+/// @param[in,out] batches  The batch expressions with indirect uses.
+/// @param[in,out] visited  The expressions traversed as indirect uses.
+void CollectIndirectBatches(mef::Expression* expression, bool direct,
+                            std::unordered_set<mef::Expression*>* batches,
+                            std::unordered_set<mef::Expression*>* visited) {
+  if (!direct) {
+    if (!visited->insert(expression).second)
+      return;
+    if (dynamic_cast<mef::ExternBatchExpression*>(expression))
+      batches->insert(expression);
+  }
+  auto* parameter = dynamic_cast<mef::Parameter*>(expression);
+  if (parameter && parameter->override_value())
+    return;  // The overridden parameters do not sample their expressions.
+  for (mef::Expression* arg : expression->args())
+    CollectIndirectBatches(arg, direct && parameter, batches, visited);
+}
+
+/// Splits a positive number into an integer mantissa and binary exponent.
+///
+/// @param[in] value  The positive finite number.
+///
+/// @returns The mantissa below 2^53 and the exponent of its unit.
+std::pair<std::uint64_t, int> Split(double value) {
+  int exponent = 0;
+  double fraction = std::frexp(value, &exponent);
+  return {static_cast<std::uint64_t>(std::ldexp(fraction, kDigitBits)),
+          exponent - kDigitBits};
+}
+
+}  // namespace
+
+void SampleStatistics::ExactSum::Add(double value) noexcept {
+  assert(value >= 0 && std::isfinite(value));
+  if (value == 0)
+    return;
+  auto [mantissa, exponent] = Split(value);
+  Add(mantissa, exponent);
+}
+
+void SampleStatistics::ExactSum::Add(std::uint64_t mantissa,
+                                     int exponent) noexcept {
+  assert(mantissa < kCarryLimit);
+  assert(exponent >= kMinExponent);
+  if (digits_.empty())
+    digits_.resize(kNumDigits);
+  for (int i = exponent - kMinExponent; mantissa; i += kDigitBits) {
+    assert(i < digits_.size() && "Sum out of range.");
+    std::uint64_t& digit = digits_[i];
+    digit += mantissa;
+    mantissa = 0;
+    if (digit >= kCarryLimit) {
+      mantissa = digit >> kDigitBits;
+      digit &= (std::uint64_t(1) << kDigitBits) - 1;
+    }
+  }
+}
+
+void SampleStatistics::ExactSum::Merge(const ExactSum& other) noexcept {
+  for (int i = 0; i < other.digits_.size(); ++i) {
+    if (other.digits_[i])
+      Add(other.digits_[i], i + kMinExponent);
+  }
+}
+
+template <>
+cpp_int SampleStatistics::ExactSum::value() const {
+  cpp_int result = 0;
+  for (int i = digits_.size() - 1; i >= 0; --i) {
+    if (digits_[i])
+      result += cpp_int(digits_[i]) << i;
+  }
+  return result;
+}
+
+std::string SampleStatistics::ExactSum::str() const {
+  cpp_int sum = value<cpp_int>();
+  if (sum == 0)
+    return "0x0";  // The base is not shown for zero.
+  return sum.str(0, std::ios_base::hex | std::ios_base::showbase);
+}
+
+void SampleStatistics::ExactSum::Add(std::string_view hex) {
+  if (hex.size() < 3 || hex.substr(0, 2) != "0x")
+    throw std::runtime_error("Malformed exact sum: " + std::string(hex));
+  cpp_int value(std::string{hex});
+  const cpp_int mask = (cpp_int(1) << kDigitBits) - 1;
+  for (int i = 0; value != 0; i += kDigitBits) {
+    if (i >= kNumDigits - kDigitBits)
+      throw std::runtime_error("Exact sum out of range: " + std::string(hex));
+    Add(static_cast<std::uint64_t>(value & mask), i + kMinExponent);
+    value >>= kDigitBits;
+  }
+}
+
+void SampleStatistics::Add(double sample) noexcept {
+  assert(sample >= 0 && sample <= 1);
+  ++count_;
+  min_ = count_ == 1 ? sample : std::min(min_, sample);
+  max_ = count_ == 1 ? sample : std::max(max_, sample);
+  if (sample == 0) {
+    ++zeros_;
+    return;
+  }
+  sketch_[static_cast<int>(std::ceil(std::log(sample) / kLogGamma))]++;
+  // The square of the mantissa is split to stay within the digit limits.
+  auto [mantissa, exponent] = Split(sample);
+  sum_.Add(mantissa, exponent);
+  std::uint64_t high = mantissa >> 26;
+  std::uint64_t low = mantissa & ((std::uint64_t(1) << 26) - 1);
+  sum_of_squares_.Add(high * high, 2 * exponent + 52);
+  sum_of_squares_.Add(2 * high * low, 2 * exponent + 26);
+  sum_of_squares_.Add(low * low, 2 * exponent);
+}
+
+void SampleStatistics::Merge(const SampleStatistics& other) noexcept {
+  if (!other.count_)
+    return;
+  min_ = count_ ? std::min(min_, other.min_) : other.min_;
+  max_ = count_ ? std::max(max_, other.max_) : other.max_;
+  count_ += other.count_;
+  sum_.Merge(other.sum_);
+  sum_of_squares_.Merge(other.sum_of_squares_);
+  zeros_ += other.zeros_;
+  for (const auto& [index, num_samples] : other.sketch_)
+    sketch_[index] += num_samples;
+}
+
+void SampleStatistics::Assign(std::int64_t count, double min, double max,
+                              std::string_view sum,
+                              std::string_view sum_of_squares,
+                              std::int64_t zeros,
+                              std::map<int, std::int64_t> sketch) {
+  SampleStatistics result;
+  result.count_ = count;
+  result.min_ = min;
+  result.max_ = max;
+  result.sum_.Add(sum);
+  result.sum_of_squares_.Add(sum_of_squares);
+  result.zeros_ = zeros;
+  result.sketch_ = std::move(sketch);
+  *this = std::move(result);
+}
+
+double SampleStatistics::mean() const noexcept {
+  if (!count_)
+    return 0;
+  cpp_bin_float_50 sum(sum_.value<cpp_int>());
+  sum = ldexp(sum, ExactSum::kMinExponent) / count_;
+  return sum.convert_to<double>();
+}
+
+double SampleStatistics::sigma() const noexcept {
+  if (count_ < 2)
+    return 0;
+  // The exact integer numerator of the variance
+  // with the shared scaling of the fixed-point sums.
+  cpp_int sum = sum_.value<cpp_int>();
+  cpp_int deviation = ((sum_of_squares_.value<cpp_int>() * count_)
+                       << -ExactSum::kMinExponent) -
+                      sum * sum;
+  cpp_bin_float_50 variance(deviation);
+  variance = ldexp(variance, 2 * ExactSum::kMinExponent) / count_ /
+             (count_ - 1);
+  return std::sqrt(variance.convert_to<double>());
+}
+
+double SampleStatistics::quantile(double probability) const noexcept {
+  assert(probability >= 0 && probability <= 1);
+  if (!count_)
+    return 0;
+  double rank = probability * (count_ - 1);
+  std::int64_t cumulative = zeros_;
+  if (rank < cumulative)
+    return 0;
+  for (const auto& [index, num_samples] : sketch_) {
+    cumulative += num_samples;
+    if (rank < cumulative)
+      return std::clamp(BucketValue(index), min_, max_);
+  }
+  return max_;
+}
+
+std::vector<std::pair<double, double>> SampleStatistics::histogram(
+    int num_bins) const noexcept {
+  assert(num_bins > 0);
+  double lower = count_ ? min_ : 0;
+  double upper = count_ ? max_ : 0;
+  double width = (upper - lower) / num_bins;
+  std::vector<std::pair<double, double>> bins;
+  for (int i = 0; i < num_bins; ++i)
+    bins.emplace_back(lower + i * width, 0);
+  bins.emplace_back(upper, 0);
+  auto add = [&](double value, std::int64_t num_samples) {
+    int bin = 0;
+    if (width > 0)
+      bin = std::min<int>(num_bins - 1, (value - lower) / width);
+    bins[bin].second += static_cast<double>(num_samples) / count_;
+  };
+  if (zeros_)
+    add(0, zeros_);
+  for (const auto& [index, num_samples] : sketch_)
+    add(std::clamp(BucketValue(index), lower, upper), num_samples);
+  return bins;
+}
+
 UncertaintyAnalysis::UncertaintyAnalysis(
     const ProbabilityAnalysis* prob_analysis)
     : Analysis(prob_analysis->settings()),
@@ -42,22 +292,58 @@ UncertaintyAnalysis::UncertaintyAnalysis(
       sigma_(0),
       error_factor_(1) {}
 
-void UncertaintyAnalysis::Analyze() noexcept {
+void UncertaintyAnalysis::Resume(SampleStatistics samples,
+                                 Recorder recorder) noexcept {
   CLOCK(analysis_time);
+  TRACE("Uncertainty analysis");
+  Statistics::Usage usage(&Analysis::statistics());
   CLOCK(sample_time);
-  LOG(DEBUG3) << "Sampling probabilities...";
+  samples_ = std::move(samples);
+  recorder_ = std::move(recorder);
+  auto [first, last] = trials();
+  assert(samples_.count() <= last - first && "Samples from another shard.");
+  first += samples_.count();
+  LOG(DEBUG3) << "Sampling probabilities in trials [" << first << ", " << last
+              << ")...";
   // Sample probabilities and generate data.
-  std::vector<double> samples = this->Sample();
+  {
+    TraceSpan span("Sampling probabilities");
+    this->Sample(first, last, &samples_);
+    span.Add("trials", samples_.count());
+  }
+  Record(samples_);
   LOG(DEBUG3) << "Finished sampling probabilities in " << DUR(sample_time);
+  if (Analysis::settings().cancelled())
+    return;  // Not enough samples for the statistics.
 
   {
     TIMER(DEBUG3, "Calculating statistics");
-    CalculateStatistics(samples);  // Perform statistical analysis.
+    CalculateStatistics();  // Perform statistical analysis.
   }
 
   Analysis::AddAnalysisTime(DUR(analysis_time));
 }
 
+void UncertaintyAnalysis::Analyze(SampleStatistics samples) noexcept {
+  CLOCK(analysis_time);
+  TRACE("Uncertainty analysis");
+  samples_ = std::move(samples);
+  if (!samples_.count())
+    Analysis::AddWarning("No samples for the uncertainty analysis");
+  LOG(DEBUG3) << "Calculating statistics of " << samples_.count()
+              << " gathered samples...";
+  CalculateStatistics();
+  Analysis::AddAnalysisTime(DUR(analysis_time));
+}
+
+std::pair<std::int64_t, std::int64_t> UncertaintyAnalysis::trials() const {
+  std::int64_t num_trials = Analysis::settings().num_trials();
+  int shard = Analysis::settings().shard();
+  int num_shards = Analysis::settings().num_shards();
+  return {num_trials * shard / num_shards,
+          num_trials * (shard + 1) / num_shards};
+}
+
 std::vector<std::pair<int, mef::Expression&>>
 UncertaintyAnalysis::GatherDeviateExpressions(const Pdag* graph) noexcept {
   std::vector<std::pair<int, mef::Expression&>> deviate_expressions;
@@ -79,45 +365,77 @@ void UncertaintyAnalysis::SampleExpressions(
 
   // Sample all expressions with distributions.
   for (const auto& expression : deviate_expressions) {
-    double prob = expression.second.Sample();
-    (*p_vars)[expression.first] = prob > 1 ? 1 : prob < 0 ? 0 : prob;
+    (*p_vars)[expression.first] =
+        ClipProbability(expression.second.Sample());
   }
 }
 
-void UncertaintyAnalysis::CalculateStatistics(
-    const std::vector<double>& samples) noexcept {
-  using namespace boost;  // NOLINT
-  using namespace boost::accumulators;  // NOLINT
-  using histogram_type =
-      iterator_range<std::vector<std::pair<double, double>>::iterator>;
-  quantiles_.clear();
-  int num_quantiles = Analysis::settings().num_quantiles();
-  double delta = 1.0 / num_quantiles;
-  for (int i = 0; i < num_quantiles; ++i) {
-    quantiles_.push_back(delta * (i + 1));
-  }
-  int num_trials = Analysis::settings().num_trials();
-  accumulator_set<double, stats<tag::mean, tag::variance, tag::density,
-                                tag::extended_p_square_quantile>>
-      acc(tag::density::num_bins = Analysis::settings().num_bins(),
-          tag::density::cache_size = num_trials,
-          extended_p_square_probabilities = quantiles_);
-  for (double sample : samples) {
-    acc(sample);
+UncertaintyAnalysis::BatchSamples UncertaintyAnalysis::GatherBatchExpressions(
+    const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions)
+    noexcept {
+  std::unordered_set<mef::Expression*> indirect;
+  std::unordered_set<mef::Expression*> visited;
+  for (const auto& expression : deviate_expressions)
+    CollectIndirectBatches(&expression.second, true, &indirect, &visited);
+
+  BatchSamples batches;
+  std::unordered_set<mef::ExternBatchExpression*> unique;
+  for (int i = 0; i < deviate_expressions.size(); ++i) {
+    auto* batch = dynamic_cast<mef::ExternBatchExpression*>(
+        SkipParameters(&deviate_expressions[i].second));
+    if (!batch || indirect.count(batch))
+      continue;
+    batches.uses.emplace_back(i, batch);
+    if (unique.insert(batch).second)
+      batches.expressions.push_back(batch);
   }
-  histogram_type hist = density(acc);
-  for (int i = 1; i < hist.size(); i++) {
-    distribution_.push_back(hist[i]);
+  return batches;
+}
+
+void UncertaintyAnalysis::SampleExpressions(
+    const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
+    std::int64_t trial, std::int64_t first, std::int64_t last,
+    BatchSamples* batches, Pdag::IndexMap<double>* p_vars) noexcept {
+  const int num_expressions = deviate_expressions.size();
+  const int row = (trial - first) % kBatchSize;
+  if (row == 0) {  // The arguments of the whole block are recorded at once.
+    std::int64_t block_last = std::min(last, trial + kBatchSize);
+    for (mef::ExternBatchExpression* batch : batches->expressions)
+      batch->RecordSamples();
+    batches->block.clear();
+    for (std::int64_t i = trial; i < block_last; ++i) {
+      mef::RandomDeviate::stream(i);
+      SampleExpressions(deviate_expressions, p_vars);
+      for (const auto& expression : deviate_expressions)
+        batches->block.push_back((*p_vars)[expression.first]);
+    }
+    for (mef::ExternBatchExpression* batch : batches->expressions)
+      batch->ComputeSamples();
+    for (int i = 0; i < block_last - trial; ++i) {
+      for (const auto& [position, batch] : batches->uses)
+        batches->block[i * num_expressions + position] =
+            ClipProbability(batch->sample(i));
+    }
   }
-  mean_ = boost::accumulators::mean(acc);
-  sigma_ = std::sqrt(num_trials * variance(acc) / (num_trials - 1));
+  for (int i = 0; i < num_expressions; ++i)
+    (*p_vars)[deviate_expressions[i].first] =
+        batches->block[row * num_expressions + i];
+}
+
+void UncertaintyAnalysis::CalculateStatistics() noexcept {
+  std::int64_t num_trials = samples_.count();
+  mean_ = samples_.mean();
+  sigma_ = samples_.sigma();
   error_factor_ = std::exp(1.96 * sigma_);
-  confidence_interval_.first = mean_ - sigma_ * 1.96 / std::sqrt(num_trials);
-  confidence_interval_.second = mean_ + sigma_ * 1.96 / std::sqrt(num_trials);
+  double margin = num_trials ? sigma_ * 1.96 / std::sqrt(num_trials) : 0;
+  confidence_interval_ = {mean_ - margin, mean_ + margin};
 
-  for (int i = 0; i < num_quantiles; ++i) {
-    quantiles_[i] = quantile(acc, quantile_probability = quantiles_[i]);
-  }
+  quantiles_.clear();
+  int num_quantiles = Analysis::settings().num_quantiles();
+  double delta = 1.0 / num_quantiles;
+  for (int i = 0; i < num_quantiles; ++i)
+    quantiles_.push_back(samples_.quantile(delta * (i + 1)));
+  distribution_ = samples_.histogram(Analysis::settings().num_bins());
 }
 
 }  // namespace scram::core
@@ -21,24 +21,175 @@
 
 #pragma once
 
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "analysis.h"
+#include "expression/random_deviate.h"
 #include "probability_analysis.h"
 #include "settings.h"
 
 namespace scram::mef {  // Decouple from the implementation dependence.
 class Expression;
+class ExternBatchExpression;
 }  // namespace scram::mef
 
 namespace scram::core {
 
+/// Sufficient statistics of Monte Carlo samples in [0, 1].
+/// The statistics are exact and independent of the sample order,
+/// so the statistics of disjoint sets of samples, e.g., shards of trials,
+/// merge into the same statistics as gathered over all the samples at once.
+class SampleStatistics {
+ public:
+  /// The relative accuracy of the quantile sketch values.
+  static constexpr double kSketchAccuracy = 0.005;
+
+  /// Exact sum of non-negative floating-point numbers.
+  /// The sum is kept as a binary fixed-point number
+  /// with integer digits per exponent of the summands.
+  class ExactSum {
+   public:
+    /// The exponent of the least significant bit of the fixed-point number.
+    /// Squares of subnormal numbers are representable.
+    static constexpr int kMinExponent = -2252;
+
+    /// Adds a value into the sum.
+    ///
+    /// @param[in] value  A non-negative finite number.
+    void Add(double value) noexcept;
+
+    /// Adds another sum into this sum.
+    ///
+    /// @param[in] other  The sum to merge.
+    void Merge(const ExactSum& other) noexcept;
+
+    /// @returns The hexadecimal integer representation of the sum
+    ///          in the units of the least significant bit.
+    std::string str() const;
+
+    /// Adds a sum from its hexadecimal integer representation.
+    ///
+    /// @param[in] hex  The representation from str().
+    ///
+    /// @throws std::runtime_error  The representation is malformed.
+    void Add(std::string_view hex);
+
+   private:
+    friend class SampleStatistics;
+
+    /// Adds an integer multiple of the power of 2.
+    ///
+    /// @param[in] mantissa  The integer less than 2^62.
+    /// @param[in] exponent  The exponent of the least significant bit.
+    void Add(std::uint64_t mantissa, int exponent) noexcept;
+
+    /// @tparam Integer  The arbitrary precision integer type.
+    ///
+    /// @returns The sum in the units of the least significant bit.
+    template <class Integer>
+    Integer value() const;
+
+    /// The integer digits with carries for the exponents above the minimum.
+    std::vector<std::uint64_t> digits_;
+  };
+
+  /// Adds a sample into the statistics.
+  ///
+  /// @param[in] sample  The sampled value in [0, 1].
+  void Add(double sample) noexcept;
+
+  /// Merges the statistics of a disjoint set of samples.
+  ///
+  /// @param[in] other  The statistics to merge.
+  void Merge(const SampleStatistics& other) noexcept;
+
+  /// @returns The number of samples.
+  std::int64_t count() const { return count_; }
+
+  /// @returns The smallest sample.
+  double min() const { return min_; }
+
+  /// @returns The largest sample.
+  double max() const { return max_; }
+
+  /// @returns The exact sum of the samples.
+  const ExactSum& sum() const { return sum_; }
+
+  /// @returns The exact sum of the squares of the samples.
+  const ExactSum& sum_of_squares() const { return sum_of_squares_; }
+
+  /// @returns The number of samples equal to 0.
+  std::int64_t zeros() const { return zeros_; }
+
+  /// @returns The sample counts in the logarithmic buckets of the sketch.
+  ///          The bucket with index i holds the samples in (g^(i-1), g^i].
+  const std::map<int, std::int64_t>& sketch() const { return sketch_; }
+
+  /// Sets the statistics from their serialized components.
+  ///
+  /// @param[in] count  The number of samples.
+  /// @param[in] min  The smallest sample.
+  /// @param[in] max  The largest sample.
+  /// @param[in] sum  The hexadecimal representation of the sum.
+  /// @param[in] sum_of_squares  The hexadecimal representation.
+  /// @param[in] zeros  The number of zero samples.
+  /// @param[in] sketch  The bucket counts of the sketch.
+  ///
+  /// @throws std::runtime_error  The sums are malformed.
+  void Assign(std::int64_t count, double min, double max, std::string_view sum,
+              std::string_view sum_of_squares, std::int64_t zeros,
+              std::map<int, std::int64_t> sketch);
+
+  /// @returns The mean of the samples.
+  double mean() const noexcept;
+
+  /// @returns The sample standard deviation.
+  double sigma() const noexcept;
+
+  /// @param[in] probability  The cumulative probability in [0, 1].
+  ///
+  /// @returns The quantile value within the sketch accuracy.
+  double quantile(double probability) const noexcept;
+
+  /// @param[in] num_bins  The number of equal width bins over [min, max].
+  ///
+  /// @returns The lower bounds of the bins with the fractions of samples
+  ///          plus the upper bound of the last bin with no samples.
+  std::vector<std::pair<double, double>> histogram(int num_bins) const
+      noexcept;
+
+ private:
+  std::int64_t count_ = 0;  ///< The number of samples.
+  double min_ = 1;  ///< The smallest sample.
+  double max_ = 0;  ///< The largest sample.
+  ExactSum sum_;  ///< The sum of samples.
+  ExactSum sum_of_squares_;  ///< The sum of squared samples.
+  std::int64_t zeros_ = 0;  ///< The zero samples out of the sketch.
+  std::map<int, std::int64_t> sketch_;  ///< The logarithmic bucket counts.
+};
+
 /// Uncertainty analysis and statistics
 /// for top event or gate probabilities
 /// with probability distributions of basic events.
 class UncertaintyAnalysis : public Analysis {
  public:
+  /// The callback to record the samples of the trials simulated so far.
+  using Recorder = std::function<void(const SampleStatistics&)>;
+
+  /// The number of trials between the recordings of the samples.
+  static constexpr int kRecordStep = 1 << 12;
+
+  /// The number of trials sampled with a single call of batch extern functions.
+  static constexpr int kBatchSize = 1 << 8;
+
   /// Uncertainty analysis
   /// on the fault tree processed
   /// by probability analysis.
@@ -49,9 +200,38 @@ class UncertaintyAnalysis : public Analysis {
   virtual ~UncertaintyAnalysis() = default;
 
   /// Performs quantitative analysis on the total probability.
+  /// Only the shard of the trials from the settings is simulated.
+  ///
+  /// @note  Undefined behavior if analysis called two or more times.
+  void Analyze() noexcept { Resume(SampleStatistics(), nullptr); }
+
+  /// Continues the interrupted analysis after the recorded trials.
+  /// Every trial samples its own random number stream,
+  /// so the results are identical to the uninterrupted analysis.
+  ///
+  /// @param[in] samples  The statistics of the first trials of the shard.
+  /// @param[in] recorder  The optional recorder of the samples
+  ///                      called every kRecordStep trials
+  ///                      and at the end of the simulation or its cancellation.
+  ///
+  /// @pre The samples are of the first trials of the shard in the settings.
+  ///
+  /// @note  Undefined behavior if analysis called two or more times.
+  void Resume(SampleStatistics samples, Recorder recorder) noexcept;
+
+  /// Calculates the statistics from samples gathered elsewhere,
+  /// e.g., the merged shards of the trials.
+  ///
+  /// @param[in] samples  The sample statistics of all the trials.
   ///
   /// @note  Undefined behavior if analysis called two or more times.
-  void Analyze() noexcept;
+  void Analyze(SampleStatistics samples) noexcept;
+
+  /// @returns The trial range [first, last) of the shard in the settings.
+  std::pair<std::int64_t, std::int64_t> trials() const;
+
+  /// @returns The sufficient statistics of the samples.
+  const SampleStatistics& samples() const { return samples_; }
 
   /// @returns Mean of the final distribution.
   double mean() const { return mean_; }
@@ -76,6 +256,17 @@ class UncertaintyAnalysis : public Analysis {
   const std::vector<double>& quantiles() const { return quantiles_; }
 
  protected:
+  /// Batch extern functions sampled for blocks of trials.
+  struct BatchSamples {
+    /// The batch expressions sampled only as values of deviate expressions.
+    std::vector<mef::ExternBatchExpression*> expressions;
+    /// The positions of the deviate expressions with batch values.
+    std::vector<std::pair<int, mef::ExternBatchExpression*>> uses;
+    /// The sampled probabilities of the deviate expressions
+    /// in the trials of the current block.
+    std::vector<double> block;
+  };
+
   /// Gathers deviate expressions of variables.
   ///
   /// @param[in] graph  PDAG with the variables.
@@ -92,19 +283,59 @@ class UncertaintyAnalysis : public Analysis {
       const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
       Pdag::IndexMap<double>* p_vars) noexcept;
 
+  /// Gathers the batch extern expressions
+  /// whose values are the values of deviate expressions
+  /// directly or through parameters.
+  /// The expressions with any other use are sampled one trial at a time.
+  ///
+  /// @param[in] deviate_expressions  A collection of deviate expressions.
+  ///
+  /// @returns The batch expressions to sample for blocks of trials.
+  BatchSamples GatherBatchExpressions(
+      const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions)
+      noexcept;
+
+  /// Samples uncertain probabilities with batch extern functions.
+  /// The whole block of trials is sampled at its first trial
+  /// with a single call per batch function.
+  ///
+  /// @param[in] deviate_expressions  A collection of deviate expressions.
+  /// @param[in] trial  The current trial.
+  /// @param[in] first  The first trial of the simulation.
+  /// @param[in] last  The trial after the last one of the simulation.
+  /// @param[in,out] batches  The batch expressions with the block samples.
+  /// @param[in,out] p_vars  Indices to probabilities mapping with values.
+  void SampleExpressions(
+      const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
+      std::int64_t trial, std::int64_t first, std::int64_t last,
+      BatchSamples* batches, Pdag::IndexMap<double>* p_vars) noexcept;
+
+  /// Records the samples if requested.
+  ///
+  /// @param[in] samples  The samples of the trials simulated so far.
+  void Record(const SampleStatistics& samples) noexcept {
+    if (recorder_)
+      recorder_(samples);
+  }
+
  private:
   /// Performs Monte Carlo Simulation
   /// by sampling the probability distributions
-  /// and providing the final sampled values of the final probability.
+  /// and gathering the sampled values of the final probability.
+  /// Every trial samples its own stream of random numbers,
+  /// so the samples are independent of the trial range.
   ///
-  /// @returns Sampled values.
-  virtual std::vector<double> Sample() noexcept = 0;
+  /// @param[in] first  The first trial to simulate.
+  /// @param[in] last  The trial after the last one to simulate.
+  /// @param[in,out] samples  The statistics to add the samples into.
+  virtual void Sample(std::int64_t first, std::int64_t last,
+                      SampleStatistics* samples) noexcept = 0;
 
   /// Calculates statistical values from the final distribution.
-  ///
-  /// @param[in] samples  Gathered samples for statistical analysis.
-  void CalculateStatistics(const std::vector<double>& samples) noexcept;
+  void CalculateStatistics() noexcept;
 
+  SampleStatistics samples_;  ///< The statistics of the samples.
+  Recorder recorder_;  ///< The optional recorder of the samples.
   double mean_;  ///< The mean of the final distribution.
   double sigma_;  ///< The standard deviation of the final distribution.
   double error_factor_;  ///< Error factor for 95% confidence level.
@@ -131,29 +362,47 @@ class UncertaintyAnalyzer : public UncertaintyAnalysis {
       : UncertaintyAnalysis(prob_analyzer), prob_analyzer_(prob_analyzer) {}
 
  private:
-  /// @returns Samples of the total probability.
-  std::vector<double> Sample() noexcept override;
+  /// Samples the total probability.
+  void Sample(std::int64_t first, std::int64_t last,
+              SampleStatistics* samples) noexcept override;
 
   /// Calculator of the total probability.
   ProbabilityAnalyzer<Calculator>* prob_analyzer_;
 };
 
 template <class Calculator>
-std::vector<double> UncertaintyAnalyzer<Calculator>::Sample() noexcept {
+void UncertaintyAnalyzer<Calculator>::Sample(
+    std::int64_t first, std::int64_t last,
+    SampleStatistics* samples) noexcept {
   std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
       UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph());
+  BatchSamples batches =
+      UncertaintyAnalysis::GatherBatchExpressions(deviate_expressions);
   Pdag::IndexMap<double> p_vars = prob_analyzer_->p_vars();  // Private copy!
-  std::vector<double> samples;
-  samples.reserve(Analysis::settings().num_trials());
+  const std::int64_t num_trials = last - first;
+  Progress* progress = Analysis::settings().progress();
+  const std::int64_t report_step = std::max<std::int64_t>(num_trials / 100, 1);
 
-  for (int i = 0; i < Analysis::settings().num_trials(); ++i) {
-    UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
+  for (std::int64_t i = first; i < last; ++i) {
+    if (progress) {
+      if (progress->cancelled())
+        break;
+      if ((i - first) % report_step == 0)
+        progress->Advance(static_cast<double>(i - first) / num_trials);
+    }
+    if (batches.expressions.empty()) {
+      mef::RandomDeviate::stream(i);
+      UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
+    } else {
+      UncertaintyAnalysis::SampleExpressions(deviate_expressions, i, first,
+                                             last, &batches, &p_vars);
+    }
     double result = prob_analyzer_->CalculateTotalProbability(p_vars);
     assert(result >= 0 && result <= 1);
-    samples.push_back(result);
+    samples->Add(result);
+    if ((i + 1 - first) % kRecordStep == 0)
+      UncertaintyAnalysis::Record(*samples);
   }
-
-  return samples;
 }
 
 }  // namespace scram::core
@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -71,13 +72,15 @@ namespace detail {  // Internal XML helper functions.
 /// @throws ValidityError  The interpretation is unsuccessful.
 template <typename T>
 std::enable_if_t<std::is_arithmetic_v<T>, T> to(const std::string_view& value) {
-  if constexpr (std::is_same_v<T, int>) {
+  if constexpr (std::is_same_v<T, int> || std::is_same_v<T, std::int64_t>) {
     char* end_char = nullptr;
+    errno = 0;
     std::int64_t ret = std::strtoll(value.data(), &end_char, 10);
     int len = end_char - value.data();
-    if (len != value.size() || ret > std::numeric_limits<int>::max() ||
-        ret < std::numeric_limits<int>::min()) {
-      SCRAM_THROW(ValidityError("Failed to interpret value to int"))
+    if (len != value.size() || errno == ERANGE ||
+        ret > std::numeric_limits<T>::max() ||
+        ret < std::numeric_limits<T>::min()) {
+      SCRAM_THROW(ValidityError("Failed to interpret value to integer"))
           << errinfo_value(std::string(value));
     }
     return ret;
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 
 #include <algorithm>
@@ -124,6 +125,14 @@ class FileStream {
     }
     write(static_cast<std::size_t>(value));
   }
+  void write(std::int64_t value) {
+    std::size_t magnitude = value;
+    if (value < 0) {
+      std::fputc('-', file_);
+      magnitude = -magnitude;  // Modular negation is safe for the minimum.
+    }
+    write(magnitude);
+  }
   void write(std::size_t value) {
     char temp[20];
     char* p = temp;
@@ -347,6 +356,7 @@ class StreamElement {
   /// Puts the value as text escaping the required XML special characters.
   /// @{
   void PutValue(int value) { out_ << value; }
+  void PutValue(std::int64_t value) { out_ << value; }
   void PutValue(double value) { out_ << value; }
   void PutValue(std::size_t value) { out_ << value; }
   void PutValue(bool value) { out_ << (value ? "true" : "false"); }
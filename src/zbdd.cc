@@ -20,13 +20,20 @@
 
 #include "zbdd.h"
 
+#include <cmath>
 #include <cstdlib>
 
 #include <algorithm>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
 
 #include <boost/range/algorithm.hpp>
 
+#include "event.h"
 #include "ext/algorithm.h"
+#include "ext/bits.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
 
@@ -44,8 +51,18 @@ namespace scram::core {
 #define CHECK_ZBDD(full)  ///< No checks on release.
 #endif
 
-void Zbdd::Log() noexcept {
+void Zbdd::Log(TraceSpan* span) noexcept {
   CHECK_ZBDD(false);
+  if (span && *span) {
+    span->Add("nodes", set_id_ - 1);
+    span->Add("unique_table", unique_table_.size());
+    span->Add("and_table", and_table_.size());
+    span->Add("or_table", or_table_.size());
+    span->Add("subsume_table", subsume_table_.size());
+    span->Add("minimal_table", minimal_results_.size());
+  }
+  if (DEBUG4 > scram::Logger::report_level())
+    return;
   LOG(DEBUG4) << "# of ZBDD nodes created: " << set_id_ - 1;
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
@@ -59,13 +76,39 @@ void Zbdd::Log() noexcept {
   ClearMarks(root_, false);
 }
 
-Zbdd::Zbdd(Bdd* bdd, const Settings& settings) noexcept
-    : Zbdd(bdd->root(), bdd->coherent(), bdd, settings) {
+Zbdd::CutOff::CutOff(const Pdag& graph, double cut_off) noexcept
+    : p(cut_off), limit(std::floor(-std::log2(cut_off) * kScale)) {
+  assert(cut_off > 0 && cut_off <= 1);
+  auto get_cost = [this](double p_literal) {
+    if (p_literal <= 0)
+      return limit + 1;  // Impossible literals are always cut off.
+    return std::min<int>(limit + 1,
+                         std::floor(-std::log2(p_literal) * kScale));
+  };
+  probabilities.reserve(graph.basic_events().size());
+  costs.reserve(graph.basic_events().size());
+  for (const mef::BasicEvent* event : graph.basic_events()) {
+    if (!event->HasExpression()) {
+      probabilities.push_back({1, 1});
+      costs.push_back({0, 0});
+      continue;
+    }
+    double p_event = event->p();
+    probabilities.push_back({1 - p_event, p_event});
+    costs.push_back({get_cost(1 - p_event), get_cost(p_event)});
+  }
+}
+
+Zbdd::Zbdd(Bdd* bdd, const Settings& settings, const Pdag* graph) noexcept
+    : Zbdd(bdd->root(), bdd->coherent(), bdd, settings,
+           graph && settings.prime_implicants() && settings.cut_off() > 0
+               ? std::make_shared<const CutOff>(*graph, settings.cut_off())
+               : nullptr) {
   CHECK_ZBDD(true);
 }
 
 Zbdd::Zbdd(const Pdag* graph, const Settings& settings) noexcept
-    : Zbdd(graph->root(), settings) {
+    : Zbdd(CompactPdag(*graph), graph->root().index(), settings) {
   assert(!graph->complement() && "Complements must be propagated.");
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
@@ -86,18 +129,30 @@ Zbdd::Zbdd(const Pdag* graph, const Settings& settings) noexcept
 
 void Zbdd::Analyze(const Pdag* graph) noexcept {
   CLOCK(zbdd_time);
+  TraceSpan span(Trace::enabled()
+                     ? "Analyzing ZBDD: G" + std::to_string(module_index_)
+                     : std::string());
   assert(root_->terminal() ||
          SetNode::Ref(root_).max_set_order() <= kSettings_.limit_order());
   root_ = Minimize(root_);  // Likely to be minimal by now.
   assert(root_->terminal() || SetNode::Ref(root_).minimal());
-  for (const auto& entry : modules_)
+  for (const auto& entry : modules_) {
     entry.second->Analyze();
+    statistics_.Merge(entry.second->statistics_);
+  }
 
   Prune(root_, kSettings_.limit_order());
   if (graph)
     ApplySubstitutions(graph->substitutions());
 
+  statistics_.Add("zbdd-nodes", set_id_ - 1);
+  statistics_.Add("zbdd-unique-table", unique_table_.size());
   Freeze();  // Complete cleanup of the memory.
+  statistics_.Add("zbdd-computed-results", num_results_);
+  if (span) {
+    for (const Statistics::Counter& counter : statistics_.counters())
+      span.Add(counter.first, counter.second);
+  }
   LOG(DEBUG3) << "G" << module_index_ << " analysis time: " << DUR(zbdd_time);
 }
 
@@ -111,16 +166,26 @@ Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index) noexcept
       set_id_(2) {}
 
 Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
-           const Settings& settings, int module_index) noexcept
+           const Settings& settings, std::shared_ptr<const CutOff> cut_off,
+           int module_index) noexcept
     : Zbdd(settings, coherent, module_index) {
   CLOCK(init_time);
   LOG(DEBUG2) << "Creating ZBDD from BDD: G" << module_index;
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
-  PairTable<VertexPtr> ites;
+  TraceSpan span(Trace::enabled() ? "Converting BDD into ZBDD: G" +
+                                        std::to_string(module_index)
+                                  : std::string());
+  cut_off_ = std::move(cut_off);
+  IteTable ites;
   root_ = Minimize(ConvertBdd(module.vertex, module.complement, bdd,
-                              kSettings_.limit_order(), &ites));
+                              kSettings_.limit_order(),
+                              cut_off_ ? cut_off_->limit : 0, &ites));
   assert(root_->terminal() || SetNode::Ref(root_).minimal());
-  Log();
+  if (kSettings_.prime_implicants()) {
+    statistics_.Add("pi-truncated-order", num_order_truncations_);
+    statistics_.Add("pi-truncated-cut-off", num_cut_off_truncations_);
+  }
+  Log(&span);
   LOG(DEBUG2) << "Created ZBDD from BDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
@@ -139,8 +204,11 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
     Settings adjusted(settings);
     adjusted.limit_order(limit);
     sub.complement ^= index < 0;
+    // The module products are cut off as if the module were the top
+    // because the module occurrences may have different costs.
     JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(sub, module_coherence, bdd,
-                                                     adjusted, index)));
+                                                     adjusted, cut_off_,
+                                                     index)));
   }
   if (ext::any_of(modules_, [](const ModuleEntry& member) {
         return member.second->root_->terminal();
@@ -151,18 +219,22 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
   }
 }
 
-Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
-    : Zbdd(settings, gate.coherent(), gate.index()) {
-  if (gate.constant() || gate.type() == kNull)
-    return;
+Zbdd::Zbdd(const CompactPdag& graph, int module_index,
+           const Settings& settings) noexcept
+    : Zbdd(settings, graph.coherent(module_index), module_index) {
+  if (graph.type(module_index) == kNull)
+    return;  // Constant or single variable graphs.
   assert(!settings.prime_implicants() && "Not implemented.");
   CLOCK(init_time);
-  assert(gate.module() && "The constructor is meant for module gates.");
-  LOG(DEBUG3) << "Converting module to ZBDD: G" << gate.index();
+  assert(graph.module(module_index) &&
+         "The constructor is meant for module gates.");
+  LOG(DEBUG3) << "Converting module to ZBDD: G" << module_index;
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
+  TraceSpan span(Trace::enabled() ? "Converting module to ZBDD: G" +
+                                        std::to_string(module_index)
+                                  : std::string());
   std::unordered_map<int, std::pair<VertexPtr, int>> gates;
-  std::unordered_map<int, const Gate*> module_gates;
-  root_ = ConvertGraph(gate, &gates, &module_gates);
+  root_ = ConvertGraph(graph, module_index, &gates);
   if (!coherent_) {
     LOG(DEBUG4) << "Eliminating complements from ZBDD...";
     std::unordered_map<int, VertexPtr> results;
@@ -170,7 +242,7 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
   }
   LOG(DEBUG4) << "Minimizing ZBDD...";
   root_ = Minimize(root_);
-  Log();
+  Log(&span);
   LOG(DEBUG3) << "Finished module conversion to ZBDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
@@ -185,10 +257,9 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
       JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(settings)));
       continue;
     }
-    const Gate* module_gate = module_gates.find(index)->second;
     Settings adjusted(settings);
     adjusted.limit_order(limit);
-    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(*module_gate, adjusted)));
+    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(graph, index, adjusted)));
   }
   EliminateConstantModules();
 }
@@ -212,6 +283,11 @@ SetNodePtr Zbdd::FindOrAddVertex(int index, const VertexPtr& high,
   high_order += !MayBeUnity(*node);
   int low_order = low->terminal() ? 0 : SetNode::Ref(low).max_set_order();
   node->max_set_order(std::max(high_order, low_order));
+  auto [high_common, high_support] = GetSignatures(high);
+  auto [low_common, low_support] = GetSignatures(low);
+  std::uint64_t var_bit = ext::signature_bit(index);
+  node->signatures((var_bit | high_common) & low_common,
+                   var_bit | high_support | low_support);
 
   in_table = node;
   return node;
@@ -261,92 +337,111 @@ Zbdd::VertexPtr Zbdd::GetReducedVertex(const SetNodePtr& node,
 
 Zbdd::VertexPtr Zbdd::ConvertBdd(const Bdd::VertexPtr& vertex, bool complement,
                                  Bdd* bdd_graph, int limit_order,
-                                 PairTable<VertexPtr>* ites) noexcept {
+                                 int limit_cost, IteTable* ites) noexcept {
+  const int kExact = std::numeric_limits<int>::max();
+  if (limit_cost < 0) {  // Cut-off on the product probability.
+    if (!vertex->terminal() || !complement) {
+      ++num_cut_off_truncations_;
+      truncated_ = true;
+    }
+    return kEmpty_;
+  }
   if (vertex->terminal())
     return complement ? kEmpty_ : kBase_;
-  VertexPtr& result =
+  std::pair<VertexPtr, int>& entry =
       (*ites)[{complement ? -vertex->id() : vertex->id(), limit_order}];
-  if (result)
-    return result;
+  if (entry.first && entry.second >= limit_cost) {
+    truncated_ |= entry.second != kExact;
+    return entry.first;
+  }
+  bool truncated = std::exchange(truncated_, false);
+  VertexPtr result;
   if (!coherent_ && kSettings_.prime_implicants()) {
     result = ConvertBddPrimeImplicants(Ite::Ptr(vertex), complement, bdd_graph,
-                                       limit_order, ites);
+                                       limit_order, limit_cost, ites);
   } else {
-    result =
-        ConvertBdd(Ite::Ptr(vertex), complement, bdd_graph, limit_order, ites);
+    result = ConvertBdd(Ite::Ptr(vertex), complement, bdd_graph, limit_order,
+                        limit_cost, ites);
   }
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
+  entry = {result, truncated_ ? limit_cost : kExact};
+  truncated_ |= truncated;
   return result;
 }
 
 Zbdd::VertexPtr Zbdd::ConvertBdd(const ItePtr& ite, bool complement,
                                  Bdd* bdd_graph, int limit_order,
-                                 PairTable<VertexPtr>* ites) noexcept {
+                                 int limit_cost, IteTable* ites) noexcept {
   if (ite->module() && !ite->coherent())
     return ConvertBddPrimeImplicants(ite, complement, bdd_graph, limit_order,
-                                     ites);
+                                     limit_cost, ites);
   VertexPtr low = ConvertBdd(ite->low(), ite->complement_edge() ^ complement,
-                             bdd_graph, limit_order, ites);
+                             bdd_graph, limit_order, limit_cost, ites);
   if (limit_order == 0) {  // Cut-off on the set order.
-    if (low->terminal())
-      return low;
+    if (low == kBase_)
+      return low;  // The high branch is subsumed.
+    ++num_order_truncations_;
     return kEmpty_;
   }
   VertexPtr high =
-      ConvertBdd(ite->high(), complement, bdd_graph, --limit_order, ites);
+      ConvertBdd(ite->high(), complement, bdd_graph, --limit_order,
+                 limit_cost - GetCost(*ite, true), ites);
   return GetReducedVertex(ite, false, high, low);
 }
 
 Zbdd::VertexPtr Zbdd::ConvertBddPrimeImplicants(
     const ItePtr& ite, bool complement, Bdd* bdd_graph, int limit_order,
-    PairTable<VertexPtr>* ites) noexcept {
-  Bdd::Function common = Bdd::Consensus()(bdd_graph, ite, complement);
-  VertexPtr consensus = ConvertBdd(common.vertex, common.complement, bdd_graph,
-                                   limit_order, ites);
-  if (limit_order == 0) {  // Cut-off on the product order.
-    if (consensus->terminal())
-      return consensus;
+    int limit_cost, IteTable* ites) noexcept {
+  // The consensus of a reduced vertex is never constant True,
+  // so no product fits into the zero order.
+  if (limit_order == 0) {
+    ++num_order_truncations_;
     return kEmpty_;
   }
+  Bdd::Function common = Bdd::Consensus()(bdd_graph, ite, complement);
+  VertexPtr consensus = ConvertBdd(common.vertex, common.complement, bdd_graph,
+                                   limit_order, limit_cost, ites);
   int sublimit = limit_order - 1;  // Assumes non-Unity element.
   if (ite->module() && !kSettings_.prime_implicants()) {
     assert(!ite->coherent() && "Only non-coherent modules through PI.");
     sublimit += 1;  // Unity modules may happen with minimal cut sets.
   }
-  VertexPtr high =
-      ConvertBdd(ite->high(), complement, bdd_graph, sublimit, ites);
-  VertexPtr low = ConvertBdd(ite->low(), ite->complement_edge() ^ complement,
-                             bdd_graph, sublimit, ites);
+  VertexPtr high = ConvertBdd(ite->high(), complement, bdd_graph, sublimit,
+                              limit_cost - GetCost(*ite, true), ites);
+  VertexPtr low =
+      ConvertBdd(ite->low(), ite->complement_edge() ^ complement, bdd_graph,
+                 sublimit, limit_cost - GetCost(*ite, false), ites);
   return GetReducedVertex(ite, false, high,
                           GetReducedVertex(ite, true, low, consensus));
 }
 
 Zbdd::VertexPtr Zbdd::ConvertGraph(
-    const Gate& gate, std::unordered_map<int, std::pair<VertexPtr, int>>* gates,
-    std::unordered_map<int, const Gate*>* module_gates) noexcept {
-  assert(!gate.constant() && "Unexpected constant gate!");
+    const CompactPdag& graph, int gate,
+    std::unordered_map<int, std::pair<VertexPtr, int>>* gates) noexcept {
+  assert(graph.type(gate) != kNull && "Unexpected constant gate!");
   VertexPtr result;
-  if (auto it_entry = ext::find(*gates, gate.index())) {
+  if (auto it_entry = ext::find(*gates, gate)) {
     std::pair<VertexPtr, int>& entry = it_entry->second;
     result = entry.first;
-    assert(entry.second < gate.parents().size());
-    if (++entry.second == gate.parents().size())
+    assert(entry.second < graph.num_parents(gate));
+    if (++entry.second == graph.num_parents(gate))
       gates->erase(it_entry);
     return result;
   }
   std::vector<VertexPtr> args;
-  for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
-    args.push_back(
-        FindOrAddVertex(arg.first, kBase_, kEmpty_, arg.second.order()));
-  }
-  for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    assert(arg.first > 0 && "Complements must be pushed down to variables.");
-    if (arg.second.module()) {
-      module_gates->emplace(arg.first, &arg.second);
-      args.push_back(FindOrAddVertex(arg.second, kBase_, kEmpty_));
+  for (int arg : graph.args(gate)) {
+    int index = std::abs(arg);
+    if (!graph.IsGate(index)) {
+      args.push_back(FindOrAddVertex(arg, kBase_, kEmpty_, graph.order(index)));
+      continue;
+    }
+    assert(arg > 0 && "Complements must be pushed down to variables.");
+    if (graph.module(index)) {
+      args.push_back(FindOrAddVertex(index, kBase_, kEmpty_, graph.order(index),
+                                     true, graph.coherent(index)));
     } else {
-      args.push_back(ConvertGraph(arg.second, gates, module_gates));
+      args.push_back(ConvertGraph(graph, index, gates));
     }
   }
   boost::sort(args, [](const VertexPtr& lhs, const VertexPtr& rhs) {
@@ -358,14 +453,14 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   });
   auto it = args.cbegin();
   for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+    result = Apply(graph.type(gate), result, *it, kSettings_.limit_order());
   }
   ClearTables();
   assert(result);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= kSettings_.limit_order());
-  if (gate.parents().size() > 1)
-    gates->insert({gate.index(), {result, 1}});
+  if (graph.num_parents(gate) > 1)
+    gates->insert({gate, {result, 1}});
   return result;
 }
 
@@ -447,6 +542,8 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
   }
   if (arg_one->id() == arg_two->id())
     return Prune(arg_one, limit_order);
+  if (kSettings_.cancelled())
+    return kEmpty_;  // The incomplete result is discarded anyway.
 
   VertexPtr& result = and_table_[GetResultKey(arg_one, arg_two, limit_order)];
   if (result)
@@ -515,6 +612,8 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
   }
   if (arg_one->id() == arg_two->id())
     return Prune(arg_one, limit_order);
+  if (kSettings_.cancelled())
+    return kEmpty_;  // The incomplete result is discarded anyway.
 
   VertexPtr& result = or_table_[GetResultKey(arg_one, arg_two, limit_order)];
   if (result)
@@ -638,6 +737,10 @@ Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
     return Terminal<SetNode>::Ref(low).value() ? kEmpty_ : high;
   if (high->terminal())
     return high;  // No need to reduce terminal sets.
+  // Every set in the low ZBDD has a variable missing from all the high sets.
+  if (!ext::may_be_subset(SetNode::Ref(low).common_signature(),
+                          SetNode::Ref(high).support_signature()))
+    return high;
   VertexPtr& computed = subsume_table_[{high->id(), low->id()}];
   if (computed)
     return computed;
@@ -698,6 +801,15 @@ Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order) noexcept {
   return result;
 }
 
+std::pair<std::uint64_t, std::uint64_t> Zbdd::GetSignatures(
+    const VertexPtr& vertex) noexcept {
+  if (vertex->terminal()) {
+    return {Terminal<SetNode>::Ref(vertex).value() ? 0 : ~std::uint64_t(0), 0};
+  }
+  const SetNode& node = SetNode::Ref(vertex);
+  return {node.common_signature(), node.support_signature()};
+}
+
 bool Zbdd::MayBeUnity(const SetNode& node) noexcept {
   if (kSettings_.prime_implicants())
     return false;
@@ -781,6 +893,138 @@ void Zbdd::ApplySubstitutions(
   root_ = Minimize(root_);
 }
 
+std::vector<std::vector<int>> Zbdd::FindTopProducts(
+    int num_products, const Pdag::IndexMap<double>& p_vars) const noexcept {
+  assert(num_products > 0 && "Meaningless request for products.");
+  /// Persistent stack of vertices pending for traversal
+  /// together with their host (module) ZBDDs.
+  struct Pending {
+    VertexPtr vertex;  ///< The root of the sub-graph to traverse.
+    const Zbdd* zbdd;  ///< The host ZBDD of the vertex.
+    int next;  ///< The rest of the stack (-1 for the bottom).
+    double bound;  ///< The upper bound for the whole stack.
+  };
+  /// Persistent list of literals in partial products.
+  struct Step {
+    int literal;  ///< The latest literal in the product.
+    int next;  ///< The rest of the product (-1 for the empty product).
+  };
+  /// Partial product with its pending continuation.
+  struct State {
+    double priority;  ///< The upper bound on the final product probability.
+    double p;  ///< The probability of the partial product.
+    int product;  ///< The partial product in the list of steps.
+    int size;  ///< The number of literals in the partial product.
+    int pending;  ///< The top of the pending stack.
+    std::int64_t order;  ///< The creation order to break ties.
+  };
+  struct Compare {
+    bool operator()(const State& lhs, const State& rhs) const {
+      if (lhs.priority == rhs.priority)
+        return lhs.order > rhs.order;
+      return lhs.priority < rhs.priority;
+    }
+  };
+
+  std::unordered_map<const Vertex<SetNode>*, double> bounds;
+  std::vector<Pending> pending_stacks;
+  std::vector<Step> steps;
+  std::int64_t num_states = 0;
+  std::priority_queue<State, std::vector<State>, Compare> queue;
+
+  auto push = [&](const VertexPtr& vertex, const Zbdd* zbdd, int next) {
+    double bound = zbdd->CalculateProductBound(vertex, p_vars, &bounds);
+    if (next >= 0)
+      bound *= pending_stacks[next].bound;
+    pending_stacks.push_back({vertex, zbdd, next, bound});
+    return static_cast<int>(pending_stacks.size()) - 1;
+  };
+  auto is_empty = [](const VertexPtr& vertex) {
+    return vertex->terminal() && !Terminal<SetNode>::Ref(vertex).value();
+  };
+
+  std::vector<std::vector<int>> products;
+  if (is_empty(root_))
+    return products;
+  int root = push(root_, this, -1);
+  queue.push({pending_stacks[root].bound, 1, -1, 0, root, num_states++});
+  while (!queue.empty() &&
+         static_cast<int>(products.size()) < num_products) {
+    State state = queue.top();
+    queue.pop();
+    while (state.pending >= 0 &&
+           pending_stacks[state.pending].vertex->terminal()) {
+      assert(!is_empty(pending_stacks[state.pending].vertex));
+      state.pending = pending_stacks[state.pending].next;
+    }
+    if (state.pending < 0) {  // The bound is exact for complete products.
+      std::vector<int> product(state.size);
+      for (int step = state.product, i = state.size; step >= 0;
+           step = steps[step].next) {
+        product[--i] = steps[step].literal;
+      }
+      products.push_back(std::move(product));
+      continue;
+    }
+    const Pending& top = pending_stacks[state.pending];
+    const Zbdd* zbdd = top.zbdd;
+    int rest = top.next;
+    SetNodePtr node = SetNode::Ptr(top.vertex);
+    // Only the high branch grows the product beyond the limit order;
+    // the low branch may still lead to complete products.
+    if (state.size < kSettings_.limit_order() && !is_empty(node->high())) {
+      int high = push(node->high(), zbdd, rest);
+      if (node->module()) {
+        const Zbdd& module = *zbdd->modules_.find(node->index())->second;
+        if (!is_empty(module.root_)) {
+          int sub = push(module.root_, &module, high);
+          queue.push({state.p * pending_stacks[sub].bound, state.p,
+                      state.product, state.size, sub, num_states++});
+        }
+      } else {
+        int index = node->index();
+        double p_var = index > 0 ? p_vars[index] : 1 - p_vars[-index];
+        steps.push_back({index, state.product});
+        double p = state.p * p_var;
+        queue.push({p * pending_stacks[high].bound, p,
+                    static_cast<int>(steps.size()) - 1, state.size + 1, high,
+                    num_states++});
+      }
+    }
+    if (!is_empty(node->low())) {
+      int low = push(node->low(), zbdd, rest);
+      queue.push({state.p * pending_stacks[low].bound, state.p, state.product,
+                  state.size, low, num_states++});
+    }
+  }
+  LOG(DEBUG4) << "Explored " << num_states << " partial products for "
+              << products.size() << " most probable products.";
+  return products;
+}
+
+double Zbdd::CalculateProductBound(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const Vertex<SetNode>*, double>* bounds) const
+    noexcept {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value();
+  if (auto it = bounds->find(vertex.get()); it != bounds->end())
+    return it->second;
+  const SetNode& node = SetNode::Ref(vertex);
+  double high = CalculateProductBound(node.high(), p_vars, bounds);
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    high *= module.CalculateProductBound(module.root_, p_vars, bounds);
+  } else {
+    int index = node.index();
+    high *= index > 0 ? p_vars[index] : 1 - p_vars[-index];
+  }
+  double bound =
+      std::max(high, CalculateProductBound(node.low(), p_vars, bounds));
+  bounds->emplace(vertex.get(), bound);
+  return bound;
+}
+
 int Zbdd::CountSetNodes(const VertexPtr& vertex) noexcept {
   if (vertex->terminal())
     return 0;
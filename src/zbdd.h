@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdlib>
 
 #include <array>
 #include <map>
@@ -35,6 +36,7 @@
 
 #include "bdd.h"
 #include "pdag.h"
+#include "trace.h"
 
 namespace scram::core {
 
@@ -80,10 +82,29 @@ class SetNode : public NonTerminal<SetNode> {
   ///       this general-purpose field saves space and time.
   void count(std::int64_t number) { count_ = number; }
 
+  /// @returns The Bloom signature of the variables common to all the sets
+  ///          in the ZBDD.
+  std::uint64_t common_signature() const { return common_signature_; }
+
+  /// @returns The Bloom signature of the variables in any set of the ZBDD.
+  std::uint64_t support_signature() const { return support_signature_; }
+
+  /// Registers the signatures of the sets in the ZBDD
+  /// for fast rejection of the subset tests.
+  ///
+  /// @param[in] common  The signature of the variables in every set.
+  /// @param[in] support  The signature of the variables in any set.
+  void signatures(std::uint64_t common, std::uint64_t support) {
+    common_signature_ = common;
+    support_signature_ = support;
+  }
+
  private:
   bool minimal_ = false;  ///< A flag for minimized collection of sets.
   int max_set_order_ = 0;  ///< The order of the largest set in the ZBDD.
   std::int64_t count_ = 0;  ///< The number of products, nodes, or anything.
+  std::uint64_t common_signature_ = 0;  ///< The intersection of set signatures.
+  std::uint64_t support_signature_ = 0;  ///< The union of set signatures.
 };
 
 using SetNodePtr = IntrusivePtr<SetNode>;  ///< Shared ZBDD set nodes.
@@ -229,7 +250,12 @@ class Zbdd : private boost::noncopyable {
 
         } else {
           Push(&node);
-          return GenerateProduct(node.high()) || GenerateProduct(Pop()->low());
+          if (it_.p_product() < it_.cut_off_) {
+            ++it_.num_cut_off_;  // The whole high branch is below the cut-off.
+          } else if (GenerateProduct(node.high())) {
+            return true;
+          }
+          return GenerateProduct(Pop()->low());
         }
       }
 
@@ -241,6 +267,8 @@ class Zbdd : private boost::noncopyable {
         const SetNode* leaf = it_.node_stack_.back();
         it_.node_stack_.pop_back();
         it_.product_.pop_back();
+        if (it_.cut_off_)
+          it_.p_stack_.pop_back();
         return leaf;
       }
 
@@ -250,6 +278,10 @@ class Zbdd : private boost::noncopyable {
       void Push(const SetNode* set_node) noexcept {
         it_.node_stack_.push_back(set_node);
         it_.product_.push_back(set_node->index());
+        if (it_.cut_off_) {
+          it_.p_stack_.push_back(it_.p_product() *
+                                 it_.GetProbability(set_node->index()));
+        }
       }
 
       bool sentinel_;  ///< The signal to end the iteration.
@@ -268,7 +300,10 @@ class Zbdd : private boost::noncopyable {
     ///
     /// @pre The ZBDD container is not modified during the iteration.
     explicit const_iterator(const Zbdd& zbdd, bool sentinel = false)
-        : sentinel_(sentinel), zbdd_(zbdd), it_(nullptr, zbdd, this, sentinel) {
+        : sentinel_(sentinel),
+          zbdd_(zbdd),
+          cut_off_(zbdd.cut_off_ ? zbdd.cut_off_->p : 0),
+          it_(nullptr, zbdd, this, sentinel) {
       sentinel_ = !it_;
     }
 
@@ -278,10 +313,15 @@ class Zbdd : private boost::noncopyable {
     const_iterator(const const_iterator& other) noexcept
         : sentinel_(other.sentinel_),
           zbdd_(other.zbdd_),
+          cut_off_(other.cut_off_),
           it_(nullptr, zbdd_, this, sentinel_) {
       assert(*this == other && "Copy ctor is only for begin/end iterators.");
     }
 
+    /// @returns The number of branches of products
+    ///          skipped so far for being below the cut-off probability.
+    std::int64_t num_cut_off() const { return num_cut_off_; }
+
    private:
     /// Standard forward iterator functionality returning products.
     /// @{
@@ -301,10 +341,23 @@ class Zbdd : private boost::noncopyable {
     }
     /// @}
 
+    /// @returns The probability of the current product for the cut-off.
+    double p_product() const { return p_stack_.empty() ? 1 : p_stack_.back(); }
+
+    /// @param[in] literal  The literal index in the product.
+    ///
+    /// @returns The probability of the literal for the cut-off.
+    double GetProbability(int literal) const {
+      return zbdd_.cut_off_->probabilities[std::abs(literal)][literal > 0];
+    }
+
     bool sentinel_;  ///< The marker for the end of traversal.
     const Zbdd& zbdd_;  ///< The source container for the products.
     std::vector<int> product_;  ///< The current product.
     std::vector<const SetNode*> node_stack_;  ///< The traversal stack.
+    const double cut_off_;  ///< The cut-off probability for products.
+    std::vector<double> p_stack_;  ///< The probabilities of the products.
+    std::int64_t num_cut_off_ = 0;  ///< The skipped branches of products.
     module_iterator it_;  ///< The root module iterator for the whole ZBDD.
   };
 
@@ -321,7 +374,13 @@ class Zbdd : private boost::noncopyable {
   /// @note The input BDD is not passed as a constant
   ///       because ZBDD needs BDD facilities to calculate prime implicants.
   ///       However, ZBDD guarantees to preserve the original BDD structure.
-  Zbdd(Bdd* bdd, const Settings& settings) noexcept;
+  ///
+  /// @note If the PDAG with the variable probabilities is given,
+  ///       prime implicants below the cut-off probability of the settings
+  ///       are discarded during the conversion
+  ///       and skipped by the iteration over the products.
+  Zbdd(Bdd* bdd, const Settings& settings,
+       const Pdag* graph = nullptr) noexcept;
 
   /// Constructor with the analysis target.
   /// ZBDD is directly produced from a PDAG.
@@ -346,6 +405,10 @@ class Zbdd : private boost::noncopyable {
   /// @returns Products generated by the analysis.
   const Zbdd& products() const { return *this; }
 
+  /// @returns Data structure counters of the ZBDD and its modules
+  ///          after the analysis.
+  const Statistics& statistics() const { return statistics_; }
+
   /// @returns Iterators over sets in the ZBDD.
   /// @{
   auto begin() const { return const_iterator(*this); }
@@ -364,6 +427,24 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// Finds the most probable products
+  /// with the best-first search over ZBDD paths.
+  /// The search is guided by the upper bound
+  /// on the product probability in each sub-graph;
+  /// therefore, only a fraction of products is ever generated,
+  /// and the complexity depends on the requested number of products
+  /// rather than the total number of products in the ZBDD.
+  ///
+  /// @param[in] num_products  The number of products to find.
+  /// @param[in] p_vars  Probabilities of variables indexed as in products.
+  ///
+  /// @returns At most the requested number of products
+  ///          sorted by non-increasing probabilities.
+  ///
+  /// @pre No constant ZBDD modules resulting in the Base set.
+  std::vector<std::vector<int>> FindTopProducts(
+      int num_products, const Pdag::IndexMap<double>& p_vars) const noexcept;
+
  protected:
   /// The common constructor to initialize member variables.
   ///
@@ -390,7 +471,9 @@ class Zbdd : private boost::noncopyable {
   }
 
   /// Logs properties of the Zbdd.
-  void Log() noexcept;
+  ///
+  /// @param[in,out] span  The optional trace record to attach the properties.
+  void Log(TraceSpan* span = nullptr) noexcept;
 
   /// Finds or adds a unique SetNode in the ZBDD.
   /// All vertices in the ZBDD must be created with this function.
@@ -525,6 +608,9 @@ class Zbdd : private boost::noncopyable {
 
   /// Clears all memoization tables.
   void ClearTables() noexcept {
+    num_results_ += and_table_.size() + or_table_.size() +
+                    minimal_results_.size() + subsume_table_.size() +
+                    prune_results_.size();
     and_table_.clear();
     or_table_.clear();
     minimal_results_.clear();
@@ -571,6 +657,40 @@ class Zbdd : private boost::noncopyable {
   /// Module entry in the tables with its original gate index.
   using ModuleEntry = std::pair<const int, std::unique_ptr<Zbdd>>;
 
+  /// The probability cut-off for products of prime implicants.
+  /// The conversion works with the costs of literals,
+  /// i.e., the negative binary logarithms of probabilities
+  /// in the fixed-point units of kScale.
+  /// The costs are rounded down
+  /// not to discard products with the probability above the cut-off,
+  /// so the exact cut-off is left to the iteration over the products.
+  struct CutOff {
+    static const int kScale = 8;  ///< The units in the halving of probability.
+
+    /// Computes the probabilities and costs of the variable literals.
+    ///
+    /// @param[in] graph  The PDAG with the variable probabilities.
+    /// @param[in] cut_off  The positive cut-off probability.
+    ///
+    /// @note Variables without probability expressions are never cut off.
+    CutOff(const Pdag& graph, double cut_off) noexcept;
+
+    double p;  ///< The cut-off probability.
+    int limit;  ///< The maximum total cost of products.
+    /// The probabilities of the {negative, positive} literals of variables.
+    Pdag::IndexMap<std::array<double, 2>> probabilities;
+    /// The costs of the {negative, positive} literals of variables.
+    Pdag::IndexMap<std::array<int, 2>> costs;
+  };
+
+  /// Processed BDD function graphs with their ids and limit order
+  /// as keys and the converted ZBDD with the limit cost as values.
+  /// The limit cost is the maximum for exact results without any cut-off,
+  /// which are reused for any limit cost.
+  /// Otherwise, the result is only reused for lower limit costs
+  /// since it is a superset of the result with the lower limit.
+  using IteTable = PairTable<std::pair<VertexPtr, int>>;
+
   /// Converts a modular BDD function
   /// into Zero-Suppressed BDD.
   ///
@@ -578,6 +698,7 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] coherent  A flag for coherent modular functions.
   /// @param[in] bdd  ROBDD with the ITE vertices.
   /// @param[in] settings  Settings for analysis.
+  /// @param[in] cut_off  The optional probability cut-off for products.
   /// @param[in] module_index  The of a module if known.
   ///
   /// @pre BDD has attributed edges with only one terminal (1/True).
@@ -588,7 +709,8 @@ class Zbdd : private boost::noncopyable {
   ///       because ZBDD needs BDD facilities to calculate prime implicants.
   ///       However, ZBDD guarantees to preserve the original BDD structure.
   Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
-       const Settings& settings, int module_index = 0) noexcept;
+       const Settings& settings, std::shared_ptr<const CutOff> cut_off,
+       int module_index = 0) noexcept;
 
   /// Constructs ZBDD from modular PDAGs.
   /// This constructor does not handle constant or single variable graphs.
@@ -598,12 +720,14 @@ class Zbdd : private boost::noncopyable {
   /// this constructor guarantees
   /// all initialization except for the root.
   ///
-  /// @param[in] gate  The root gate of a module.
+  /// @param[in] graph  The compact PDAG with the module.
+  /// @param[in] module_index  The index of the root gate of the module.
   /// @param[in] settings  Analysis settings.
   ///
   /// @post The root vertex pointer is uninitialized
   ///       if the PDAG is constant or single variable.
-  Zbdd(const Gate& gate, const Settings& settings) noexcept;
+  Zbdd(const CompactPdag& graph, int module_index,
+       const Settings& settings) noexcept;
 
   /// Finds a replacement for an existing node
   /// or adds a new node based on an existing node.
@@ -664,14 +788,16 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] complement  Interpretation of the vertex as complement.
   /// @param[in] bdd_graph  The main ROBDD as helper database.
   /// @param[in] limit_order  The maximum size of requested sets.
-  /// @param[in,out] ites  Processed function graphs with ids and limit order.
+  /// @param[in] limit_cost  The maximum cost of requested sets
+  ///                        for the probability cut-off.
+  /// @param[in,out] ites  Processed function graphs.
   ///
   /// @returns Pointer to the root vertex of the ZBDD graph.
   ///
   /// @post The input BDD structure is not changed.
   VertexPtr ConvertBdd(const Bdd::VertexPtr& vertex, bool complement,
-                       Bdd* bdd_graph, int limit_order,
-                       PairTable<VertexPtr>* ites) noexcept;
+                       Bdd* bdd_graph, int limit_order, int limit_cost,
+                       IteTable* ites) noexcept;
 
   /// Converts BDD if-then-else vertex into ZBDD graph.
   /// This overload differs in that
@@ -683,11 +809,12 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] complement  Interpretation of the vertex as complement.
   /// @param[in] bdd_graph  The main ROBDD as helper database.
   /// @param[in] limit_order  The maximum size of requested sets.
-  /// @param[in,out] ites  Processed function graphs with ids and limit order.
+  /// @param[in] limit_cost  The maximum cost of requested sets.
+  /// @param[in,out] ites  Processed function graphs.
   ///
   /// @returns Pointer to the root vertex of the ZBDD graph.
   VertexPtr ConvertBdd(const ItePtr& ite, bool complement, Bdd* bdd_graph,
-                       int limit_order, PairTable<VertexPtr>* ites) noexcept;
+                       int limit_order, int limit_cost, IteTable* ites) noexcept;
 
   /// Converts BDD if-then-else vertex into ZBDD graph for prime implicants.
   /// This is used by the BDD vertex to ZBDD converter,
@@ -697,28 +824,41 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] complement  Interpretation of the vertex as complement.
   /// @param[in] bdd_graph  The main ROBDD as helper database.
   /// @param[in] limit_order  The maximum size of requested sets.
-  /// @param[in,out] ites  Processed function graphs with ids and limit order.
+  /// @param[in] limit_cost  The maximum cost of requested sets.
+  /// @param[in,out] ites  Processed function graphs.
   ///
   /// @returns Pointer to the root vertex of the ZBDD graph.
+  ///
+  /// @note The consensus is not computed
+  ///       if the limit order leaves no room for products.
   VertexPtr ConvertBddPrimeImplicants(const ItePtr& ite, bool complement,
                                       Bdd* bdd_graph, int limit_order,
-                                      PairTable<VertexPtr>* ites) noexcept;
+                                      int limit_cost, IteTable* ites) noexcept;
+
+  /// @param[in] ite  ITE vertex of the ROBDD graph.
+  /// @param[in] positive  The polarity of the literal.
+  ///
+  /// @returns The cost of the literal of the vertex for the cut-off.
+  int GetCost(const Ite& ite, bool positive) const noexcept {
+    if (!cut_off_ || ite.module())
+      return 0;
+    return cut_off_->costs[ite.index()][positive];
+  }
 
   /// Transforms a PDAG gate into a Zbdd set graph.
   ///
-  /// @param[in] gate  The root gate of the PDAG.
+  /// @param[in] graph  The compact PDAG.
+  /// @param[in] gate  The index of the root gate of the PDAG.
   /// @param[in,out] gates  Processed gates with use counts.
-  /// @param[out] module_gates  Sub-module gates.
   ///
   /// @returns The top vertex of the Zbdd graph.
   ///
   /// @pre The memoization container is not used outside of this function.
   ///
   /// @post Sub-module gates are not processed.
-  VertexPtr
-  ConvertGraph(const Gate& gate,
-               std::unordered_map<int, std::pair<VertexPtr, int>>* gates,
-               std::unordered_map<int, const Gate*>* module_gates) noexcept;
+  VertexPtr ConvertGraph(
+      const CompactPdag& graph, int gate,
+      std::unordered_map<int, std::pair<VertexPtr, int>>* gates) noexcept;
 
   /// Processes complements in a SetNode with processed high/low edges.
   ///
@@ -796,6 +936,16 @@ class Zbdd : private boost::noncopyable {
   /// @returns false if the passed node can never be Unity.
   bool MayBeUnity(const SetNode& node) noexcept;
 
+  /// Retrieves the Bloom signatures of the sets represented by a vertex.
+  /// The Base set has no variables,
+  /// and the Empty set is the identity for the intersection of signatures.
+  ///
+  /// @param[in] vertex  Any ZBDD vertex.
+  ///
+  /// @returns The common and support signatures of the sets.
+  static std::pair<std::uint64_t, std::uint64_t> GetSignatures(
+      const VertexPtr& vertex) noexcept;
+
   /// Counts the number of SetNodes
   /// excluding the nodes in the modules.
   ///
@@ -807,6 +957,20 @@ class Zbdd : private boost::noncopyable {
   /// @pre SetNode marks are clear (false).
   int CountSetNodes(const VertexPtr& vertex) noexcept;
 
+  /// Calculates the upper bound on the probability of products
+  /// in the ZBDD sub-graph (the probability of the most probable product).
+  /// The bound disregards the limit on the product order.
+  ///
+  /// @param[in] vertex  The root vertex of the sub-graph.
+  /// @param[in] p_vars  Probabilities of variables.
+  /// @param[in,out] bounds  Memoized bounds of vertices in all modules.
+  ///
+  /// @returns The maximum probability of a product in the sub-graph.
+  double CalculateProductBound(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const Vertex<SetNode>*, double>* bounds) const
+      noexcept;
+
   /// Counts the total number of sets in ZBDD.
   ///
   /// @param[in] vertex  The root vertex of ZBDD.
@@ -850,6 +1014,8 @@ class Zbdd : private boost::noncopyable {
   VertexPtr root_;  ///< The root vertex of ZBDD.
   bool coherent_;  ///< Inherited coherence from BDD.
   int module_index_;  ///< Identifier for a module if any.
+  /// The probability cut-off for prime implicants shared with modules.
+  std::shared_ptr<const CutOff> cut_off_;
 
   /// Table of unique SetNodes denoting sets.
   /// The key consists of (index, id_high, id_low) triplet.
@@ -874,6 +1040,14 @@ class Zbdd : private boost::noncopyable {
 
   std::map<int, std::unique_ptr<Zbdd>> modules_;  ///< Module graphs.
   int set_id_;  ///< Identification assignment for new set graphs.
+  std::int64_t num_results_ = 0;  ///< The number of memoized computations.
+  /// The number of branches truncated by the limit order.
+  std::int64_t num_order_truncations_ = 0;
+  /// The number of branches truncated by the cut-off probability.
+  std::int64_t num_cut_off_truncations_ = 0;
+  /// The indication of the cut-off in the current conversion result.
+  bool truncated_ = false;
+  Statistics statistics_;  ///< Counters of the ZBDD and its modules.
 };
 
 namespace zbdd {
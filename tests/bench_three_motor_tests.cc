@@ -17,6 +17,8 @@
 
 #include "risk_analysis_tests.h"
 
+#include <functional>
+
 namespace scram::core::test {
 
 // Benchmark Tests for the ThreeMotor fault tree from OpenFTA.
@@ -71,6 +73,35 @@ TEST_P(RiskAnalysisTest, ThreeMotor) {
   EXPECT_EQ(mcs, products());
 }
 
+// Only the most probable products are extracted.
+TEST_P(RiskAnalysisTest, ThreeMotorTopProducts) {
+  std::string tree_input = "input/ThreeMotor/three_motor.xml";
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  std::vector<double> expected;
+  for (const auto& entry : product_probability())
+    expected.push_back(entry.second);
+  boost::sort(expected, std::greater<>());
+  expected.resize(5);
+  double p_all = p_total();
+
+  settings.top_products(5);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_DOUBLE_EQ(p_all, p_total());
+  ASSERT_EQ(5, product_probability().size());
+  std::vector<double> result;  // In the reported order.
+  for (const Product& product :
+       analysis->results().front().fault_tree_analysis->products())
+    result.push_back(product.p());
+  ASSERT_EQ(expected.size(), result.size());
+  for (int i = 0; i < expected.size(); ++i)
+    EXPECT_DOUBLE_EQ(expected[i], result[i]);
+
+  CheckReport({tree_input});
+}
+
 // All permutations of house events.
 TEST_F(RiskAnalysisTest, ThreeMotorEventTree) {
   std::string dir = "input/ThreeMotor/";
@@ -21,6 +21,7 @@
 
 #include "error.h"
 #include "expression/constant.h"
+#include "expression/random_deviate.h"
 
 namespace scram::mef::test {
 
@@ -46,4 +47,51 @@ TEST_CASE("CcfGroupTest.AddMemberAfterDistribution", "[mef::ccf_group]") {
   CHECK_THROWS_AS(ccf_group.AddMember(&member_three), LogicError);
 }
 
+TEST_CASE("CcfGroupTest.CollectEvents", "[mef::ccf_group]") {
+  BetaFactorModel ccf_group("general");
+  BasicEvent member_one("one");
+  BasicEvent member_two("two");
+  BasicEvent member_three("three");
+  REQUIRE_NOTHROW(ccf_group.AddMember(&member_one));
+  REQUIRE_NOTHROW(ccf_group.AddMember(&member_two));
+  REQUIRE_NOTHROW(ccf_group.AddMember(&member_three));
+  ConstantExpression beta_min(0);
+  ConstantExpression beta_max(0.8);
+  UniformDeviate beta(&beta_min, &beta_max);  // The mean is 0.4.
+  REQUIRE_NOTHROW(ccf_group.AddDistribution(&ConstantExpression::kOne));
+  REQUIRE_NOTHROW(ccf_group.AddFactor(&beta));
+  REQUIRE_NOTHROW(ccf_group.Validate());
+  REQUIRE_NOTHROW(ccf_group.ApplyModel());
+  for (BasicEvent* member : {&member_one, &member_two, &member_three})
+    REQUIRE(member->HasCcf());
+
+  SECTION("All combinations") {
+    std::vector<const CcfEvent*> events;
+    ccf_group.CollectEvents(member_one, 0, &events);
+    REQUIRE(events.size() == 2);
+    CHECK(events.front()->members().size() == 1);
+    CHECK(events.back()->members().size() == 3);
+
+    std::vector<const CcfEvent*> other_events;
+    ccf_group.CollectEvents(member_two, 0, &other_events);
+    REQUIRE(other_events.size() == 2);
+    CHECK(other_events.front() != events.front());
+    CHECK(other_events.back() == events.back());  // Shared combination.
+  }
+
+  SECTION("Upper bound of the combination probability") {
+    std::vector<const CcfEvent*> events;
+    ccf_group.CollectEvents(member_one, 0.5, &events);
+    CHECK(events.size() == 2);
+  }
+
+  SECTION("Negligible combinations") {
+    std::vector<const CcfEvent*> events;
+    ccf_group.CollectEvents(member_one, 0.9, &events);
+    REQUIRE(events.size() == 1);
+    CHECK(events.front()->members().size() == 1);
+    CHECK(events.front()->members().front() == &member_one);
+  }
+}
+
 }  // namespace scram::mef::test
@@ -149,6 +149,41 @@ TEST_CASE("ExpressionTest.Parameter", "[mef::expression]") {
   REQUIRE_THROWS_AS(param.expression(&expr), LogicError);
 }
 
+TEST_CASE("ExpressionTest.ParameterCache", "[mef::expression]") {
+  MissionTime time(10);
+  OpenExpression rate(0.1);
+  Parameter lambda("lambda");
+  lambda.expression(&rate);
+  Mul product({&lambda, &time});
+  Parameter exposure("exposure");
+  exposure.expression(&product);
+  CHECK(exposure.value() == Approx(1));
+
+  rate.mean = 0.2;  // The cache is not aware of the mock changes.
+  CHECK(lambda.value() == Approx(0.1));
+  CHECK(exposure.value() == Approx(1));
+
+  time.value(20);  // Only the dependent parameters are recomputed.
+  CHECK(lambda.value() == Approx(0.1));
+  CHECK(exposure.value() == Approx(2));
+  time.value(20);
+  CHECK(exposure.value() == Approx(2));
+}
+
+TEST_CASE("ExpressionTest.VolatileParameter", "[mef::expression]") {
+  struct VolatileExpression : public OpenExpression {
+    bool IsVolatile() noexcept override { return true; }
+  } source;
+  Parameter param("param");
+  param.expression(&source);
+  Parameter user("user");
+  user.expression(&param);
+  CHECK(user.value() == 1);
+  source.mean = 2;
+  CHECK(param.value() == 2);
+  CHECK(user.value() == 2);
+}
+
 TEST_CASE("ExpressionTest.Exponential", "[mef::expression]") {
   OpenExpression lambda(10, 8);
   OpenExpression time(5, 4);
@@ -18,6 +18,7 @@
 #include "expression/extern.h"
 
 #include <memory>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -30,6 +31,7 @@
 #endif
 
 #include "expression/constant.h"
+#include "expression/random_deviate.h"
 
 namespace scram::mef::test {
 
@@ -168,4 +170,120 @@ TEST_CASE("ExternTest.ExternFunctionApply", "[mef::extern_function]") {
   CHECK(identity->apply({&arg_one})->value() == arg_one.value());
 }
 
+TEST_CASE("ExternTest.PureFunction", "[mef::extern_function]") {
+  const std::string cwd_dir = boost::filesystem::current_path().string();
+  ExternLibrary library("dummy", kLibRelPath, cwd_dir, false, true);
+  auto calls = library.get<int()>("calls");
+  bool pure = GENERATE(false, true);
+  ExternFunction<double, double> identity("dummy_id", "counted_identity",
+                                          library, pure);
+  CHECK(identity.pure() == pure);
+  int init_calls = calls();
+  CHECK(identity(0.5) == 0.5);
+  CHECK(identity(0.5) == 0.5);
+  CHECK(identity(0.25) == 0.25);
+  CHECK(calls() - init_calls == (pure ? 2 : 3));
+}
+
+TEST_CASE("ExternTest.BatchFunction", "[mef::extern_function]") {
+  const std::string cwd_dir = boost::filesystem::current_path().string();
+  ExternLibrary library("dummy", kLibRelPath, cwd_dir, false, true);
+  auto calls = library.get<int()>("calls");
+  auto results = library.get<int()>("results");
+  CHECK_THROWS_AS(ExternBatchFunction("sum", "sum_batch", library, 6),
+                  ValidityError);
+  CHECK_THROWS_AS(ExternBatchFunction("sum", "foobar", library, 3), DLError);
+
+  bool pure = GENERATE(false, true);
+  ExternBatchFunction sum("sum", "sum_batch", library, 3, pure);
+  CHECK(sum.num_args() == 3);
+  CHECK(sum.pure() == pure);
+  int init_calls = calls();
+  int init_results = results();
+  double args[] = {1, 2, 3, 4, 5, 6};
+  double sums[2] = {};
+  sum(2, args, sums);
+  CHECK(sums[0] == 6);
+  CHECK(sums[1] == 15);
+  CHECK(calls() - init_calls == 1);
+  CHECK(results() - init_results == 2);
+
+  double new_args[] = {4, 5, 6, 7, 8, 9};
+  sum(2, new_args, sums);
+  CHECK(sums[0] == 15);
+  CHECK(sums[1] == 24);
+  CHECK(calls() - init_calls == 2);
+  CHECK(results() - init_results == (pure ? 3 : 4));
+
+  sum(1, args, sums);
+  CHECK(sums[0] == 6);
+  CHECK(calls() - init_calls == (pure ? 2 : 3));
+
+  ConstantExpression arg_one(42);
+  ConstantExpression arg_two(13);
+  ConstantExpression arg_three(-1);
+  CHECK_THROWS_AS(sum.apply({&arg_one, &arg_two}), ValidityError);
+  std::unique_ptr<Expression> expr;
+  REQUIRE_NOTHROW(expr = sum.apply({&arg_one, &arg_two, &arg_three}));
+  CHECK(expr->value() == 54);
+  CHECK(expr->Sample() == 54);
+  CHECK_FALSE(expr->IsDeviate());
+}
+
+TEST_CASE("ExternTest.BatchFunctionChunks", "[mef::extern_function]") {
+  const std::string cwd_dir = boost::filesystem::current_path().string();
+  ExternLibrary library("dummy", kLibRelPath, cwd_dir, false, true);
+  auto calls = library.get<int()>("calls");
+  ExternBatchFunction sum("sum", "sum_batch", library, 3, /*pure=*/true);
+  const int num_rows = 600;
+  std::vector<double> args;
+  for (int i = 0; i < num_rows; ++i)
+    args.insert(args.end(), {1.0 * i, 0, 1});
+  std::vector<double> sums(num_rows);
+  int init_calls = calls();
+  sum(num_rows, args.data(), sums.data());
+  CHECK(calls() - init_calls == 3);  // The misses in chunks of 256 rows.
+  for (int i = 0; i < num_rows; ++i)
+    CHECK(sums[i] == i + 1);
+  sum(num_rows, args.data(), sums.data());
+  CHECK(calls() - init_calls == 3);
+}
+
+TEST_CASE("ExternTest.BatchSamples", "[mef::extern_function]") {
+  const std::string cwd_dir = boost::filesystem::current_path().string();
+  ExternLibrary library("dummy", kLibRelPath, cwd_dir, false, true);
+  auto calls = library.get<int()>("calls");
+  ExternBatchFunction sum("sum", "sum_batch", library, 3);
+  ConstantExpression zero(0);
+  ConstantExpression one(1);
+  UniformDeviate deviate(&zero, &one);
+  std::unique_ptr<Expression> expr = sum.apply({&deviate, &one, &deviate});
+  CHECK(expr->IsDeviate());
+  auto& batch = static_cast<ExternBatchExpression&>(*expr);
+
+  const int num_trials = 10;
+  std::vector<double> expected;
+  for (int i = 0; i < num_trials; ++i) {
+    RandomDeviate::stream(i);
+    expr->Reset();
+    expected.push_back(expr->Sample());
+  }
+
+  int init_calls = calls();
+  batch.RecordSamples();
+  for (int i = 0; i < num_trials; ++i) {
+    RandomDeviate::stream(i);
+    expr->Reset();
+    expr->Sample();
+  }
+  CHECK(calls() == init_calls);
+  batch.ComputeSamples();
+  CHECK(calls() - init_calls == 1);
+  for (int i = 0; i < num_trials; ++i)
+    CHECK(batch.sample(i) == expected[i]);
+  expr->Reset();
+  expr->Sample();
+  CHECK(calls() - init_calls == 2);
+}
+
 }  // namespace scram::mef::test
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "generator.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "error.h"
+#include "initializer.h"
+#include "risk_analysis.h"
+#include "settings.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::mef::test {
+
+namespace {
+
+/// @returns The model generated into a temporary file.
+std::unique_ptr<Model> GenerateModel(const GeneratorSettings& settings) {
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  INFO("temp file: " + temp_file.string());
+  Generate(settings, temp_file.string());
+  auto model = Initializer({temp_file.string()}, core::Settings{}).model();
+  fs::remove(temp_file);
+  return model;
+}
+
+/// @returns The generated XML text.
+std::string GenerateText(const GeneratorSettings& settings) {
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  Generate(settings, temp_file.string());
+  std::stringstream text;
+  text << std::ifstream(temp_file.string()).rdbuf();
+  fs::remove(temp_file);
+  return text.str();
+}
+
+}  // namespace
+
+TEST_CASE("GeneratorTest.Deterministic", "[mef::generator]") {
+  GeneratorSettings settings;
+  settings.num_ccf_groups = 5;
+  settings.event_tree_depth = 2;
+  std::string text = GenerateText(settings);
+  CHECK(GenerateText(settings) == text);
+  settings.seed += 1;
+  CHECK(GenerateText(settings) != text);
+}
+
+TEST_CASE("GeneratorTest.ValidModel", "[mef::generator]") {
+  GeneratorSettings settings;
+  settings.num_gates = 300;
+  settings.num_basic_events = 200;
+  settings.fan_in = GENERATE(FanIn::kUniform, FanIn::kGeometric);
+  settings.num_modules = GENERATE(1, 4);
+  settings.atleast_ratio = 0.2;
+  settings.num_ccf_groups = 10;
+  settings.ccf_group_size = 3;
+  settings.event_tree_depth = 3;
+
+  std::unique_ptr<Model> model;
+  REQUIRE_NOTHROW(model = GenerateModel(settings));
+  CHECK(model->gates().size() == settings.num_gates);
+  CHECK(model->basic_events().size() <= settings.num_basic_events);
+  CHECK(model->ccf_groups().size() == settings.num_ccf_groups);
+  CHECK(model->event_trees().size() == 1);
+  CHECK(model->initiating_events().size() == 1);
+  REQUIRE(model->fault_trees().size() == 1);
+  REQUIRE(model->fault_trees().begin()->top_events().size() == 1);
+  CHECK(model->fault_trees().begin()->top_events().front()->name() == "Top");
+}
+
+TEST_CASE("GeneratorTest.Analysis", "[mef::generator]") {
+  GeneratorSettings settings;
+  settings.num_gates = 10;
+  settings.num_basic_events = 10;
+  settings.max_args = 3;
+  settings.atleast_ratio = 0.1;
+  settings.seed = GENERATE(range(1, 65));
+  INFO("seed: " + std::to_string(settings.seed));
+  std::unique_ptr<Model> model;
+  REQUIRE_NOTHROW(model = GenerateModel(settings));
+  core::Settings analysis_settings;
+  analysis_settings.probability_analysis(true);
+  core::RiskAnalysis analysis(model.get(), analysis_settings);
+  REQUIRE_NOTHROW(analysis.Analyze());
+  REQUIRE(analysis.results().size() == 1);
+}
+
+TEST_CASE("GeneratorTest.InvalidSettings", "[mef::generator]") {
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  GeneratorSettings settings;
+  SECTION("No modules") { settings.num_modules = 0; }
+  SECTION("Not enough gates") {
+    settings.num_gates = 4;
+    settings.num_modules = 4;
+  }
+  SECTION("Unary gates") { settings.min_args = 1; }
+  SECTION("Invalid argument range") {
+    settings.min_args = 4;
+    settings.max_args = 3;
+  }
+  SECTION("Not enough events") { settings.num_basic_events = 4; }
+  SECTION("Invalid sharing") { settings.sharing = 1.5; }
+  SECTION("Invalid CCF group size") {
+    settings.num_ccf_groups = 1;
+    settings.ccf_group_size = 1;
+  }
+  SECTION("Not enough events for CCF") {
+    settings.num_ccf_groups = 100;
+    settings.ccf_group_size = 3;
+  }
+  SECTION("Deep event tree") { settings.event_tree_depth = 17; }
+  SECTION("Invalid probabilities") { settings.min_prob = 0; }
+  CHECK_THROWS_AS(Generate(settings, temp_file.string()), SettingsError);
+  fs::remove(temp_file);
+}
+
+}  // namespace scram::mef::test
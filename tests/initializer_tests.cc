@@ -319,6 +319,20 @@ TEST_CASE("InitializerTest.IncorrectProbabilityInputs", "[mef::initializer]") {
   CHECK_THROWS_AS(Initializer({dir + input}, settings), ValidityError);
 }
 
+// Test failures of the parameter values in the sweep.
+TEST_CASE("InitializerTest.IncorrectSweepInputs", "[mef::initializer]") {
+  std::string input = "tests/input/fta/sweep_parameters.xml";
+  core::Settings settings;
+  settings.sweep("ValveFailure", {0.1, 0.5});
+  CHECK_NOTHROW(Initializer({input}, settings));
+  settings.sweep("Undefined", {0.1});
+  CHECK_THROWS_AS(Initializer({input}, settings), UndefinedElement);
+
+  core::Settings invalid_settings;
+  invalid_settings.sweep("ValveFailure", {0.1, 0.9});  // 0.9 * 1.25 > 1
+  CHECK_THROWS_AS(Initializer({input}, invalid_settings), ValidityError);
+}
+
 // Test the case when a top event is not orphan.
 // The top event of one fault tree
 // can be a child of a gate of another fault tree.
@@ -337,6 +351,7 @@ TEST_CASE("InitializerTest.CorrectModelInputs", "[mef::initializer]") {
       "extern_library.xml",
       "extern_function.xml",
       "extern_expression.xml",
+      "extern_batch_function.xml",
       "valid_alignment.xml",
       "valid_sum_alignment.xml",
       "private_phases.xml",
@@ -364,6 +379,7 @@ TEST_CASE("InitializerTest.IncorrectModelInputs", "[mef::initializer]") {
       "duplicate_extern_functions.xml",
       "undefined_extern_library.xml",
       "invalid_num_param_extern_function.xml",
+      "invalid_batch_extern_function.xml",
       "undefined_extern_function.xml",
       "invalid_num_args_extern_expression.xml",
       "extern_library_invalid_path_format.xml",
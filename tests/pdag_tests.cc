@@ -17,11 +17,14 @@
 
 #include "pdag.h"
 
+#include <sstream>
+
 #include <catch2/catch.hpp>
 
 #include "fault_tree.h"
 #include "initializer.h"
 #include "model.h"
+#include "preprocessor.h"
 #include "settings.h"
 
 /// @todo: Replace w/ proper Catch macros.
@@ -41,6 +44,31 @@ TEST_CASE("PdagTest.Print", "[mef::pdag]") {
   graph.Print();
 }
 
+// The concurrent preprocessing must produce the same graph as sequential.
+TEST_CASE("PdagTest.ConcurrentPreprocessing", "[mef::pdag]") {
+  std::vector<std::string> input_files = GENERATE(
+      std::vector<std::string>{"input/Baobab/baobab1.xml",
+                               "input/Baobab/baobab1-basic-events.xml"},
+      std::vector<std::string>{"input/Chinese/chinese.xml",
+                               "input/Chinese/chinese-basic-events.xml"},
+      std::vector<std::string>{"input/CEA9601/CEA9601.xml",
+                               "input/CEA9601/CEA9601-basic-events.xml"});
+  INFO("input: " + input_files.front());
+  std::unique_ptr<mef::Model> model =
+      mef::Initializer(input_files, Settings()).model();
+  const mef::Gate& top = *model->fault_trees().begin()->top_events().front();
+  auto preprocess = [&top](int max_threads) {
+    Pdag graph(top);
+    CustomPreprocessor<Bdd>{&graph, max_threads}();
+    std::ostringstream out;
+    out << &graph;
+    return out.str();
+  };
+  std::string sequential = preprocess(1);
+  CHECK(preprocess(4) == sequential);
+  CHECK(preprocess(4) == sequential);
+}
+
 TEST_CASE("PdagTest.Cardinality", "[mef::pdag]") {
   mef::BasicEvent one("one"), two("two");
   mef::Formula::ArgSet arg_set = {&one, &two};
@@ -103,6 +131,39 @@ TEST_CASE("PdagTest.Cardinality", "[mef::pdag]") {
   }
 }
 
+TEST_CASE("PdagTest.Compact", "[mef::pdag]") {
+  std::unique_ptr<mef::Model> model =
+      mef::Initializer({"tests/input/fta/correct_formulas.xml"}, Settings())
+          .model();
+  const mef::FaultTree& ft = *model->fault_trees().begin();
+  Pdag graph(*ft.top_events().front());
+  CompactPdag compact(graph);
+  REQUIRE(compact.root() == graph.root()->index());
+
+  std::unordered_map<int, int> num_parents;
+  auto check = [&compact, &num_parents](const Gate& gate, auto& self) -> void {
+    REQUIRE(compact.IsGate(gate.index()));
+    CHECK(compact.type(gate.index()) == gate.type());
+    CHECK(compact.module(gate.index()) == gate.module());
+    CHECK(compact.coherent(gate.index()) == gate.coherent());
+    std::vector<int> args;
+    for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
+      CHECK_FALSE(compact.IsGate(arg.second.index()));
+      args.push_back(arg.first);
+    }
+    for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
+      args.push_back(arg.first);
+      if (num_parents[arg.second.index()]++ == 0)
+        self(arg.second, self);
+    }
+    CHECK(std::vector<int>(compact.args(gate.index()).begin(),
+                           compact.args(gate.index()).end()) == args);
+  };
+  check(*graph.root(), check);
+  for (const auto& entry : num_parents)
+    CHECK(compact.num_parents(entry.first) == entry.second);
+}
+
 static_assert(kNumConnectives == 8, "New gate types are not considered!");
 
 class GateTest {
@@ -44,6 +44,7 @@
 #include "performance_tests.h"
 
 #include "bdd.h"
+#include "logger.h"
 #include "zbdd.h"
 
 namespace scram::core::test {
@@ -59,7 +60,7 @@ TEST_CASE("regression test BDD/ZBDD", "[object_size]") {
   CHECK(sizeof(Vertex<Ite>) == 16);
   CHECK(sizeof(NonTerminal<Ite>) == 48);
   CHECK(sizeof(Ite) == 64);
-  CHECK(sizeof(SetNode) == 56);
+  CHECK(sizeof(SetNode) == 72);
 }
 #endif
 
@@ -137,6 +138,40 @@ TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L3_ZBDD", "[.perf]") {
 }
 #endif
 
+// Single-variable updates recompute only the ancestors of the variable.
+TEST_CASE_METHOD(PerformanceTest, "perf CEA9601 incremental probability",
+                 "[.perf]") {
+  std::vector<std::string> input_files{
+      "input/CEA9601/CEA9601.xml", "input/CEA9601/CEA9601-basic-events.xml"};
+  settings.limit_order(4);
+  model = mef::Initializer(input_files, settings).model();
+  const mef::Gate& top_event =
+      *model->fault_trees().begin()->top_events().front();
+  FaultTreeAnalyzer<Bdd> fta(top_event, settings, model.get());
+  fta.Analyze();
+  ProbabilityAnalyzer<Bdd> analyzer(&fta, &model->mission_time());
+  analyzer.Analyze();
+  Pdag::IndexMap<double> p_vars = analyzer.p_vars();
+  analyzer.CalculateTotalProbability(p_vars, {});  // Build the index.
+
+  CLOCK(full_time);
+  double p_total = analyzer.CalculateTotalProbability(p_vars);
+  double full_duration = DUR(full_time);
+
+  int num_updates = 0;
+  CLOCK(update_time);
+  for (int i = Pdag::kVariableStartIndex;
+       i < Pdag::kVariableStartIndex + p_vars.size(); i += 10, ++num_updates) {
+    p_vars[i] /= 2;
+    analyzer.CalculateTotalProbability(p_vars, {i});
+    p_vars[i] *= 2;
+    CHECK(analyzer.CalculateTotalProbability(p_vars, {i}) == Approx(p_total));
+  }
+  double update_duration = DUR(update_time) / (2 * num_updates);
+  INFO("full: " << full_duration << " update: " << update_duration);
+  CHECK(update_duration < full_duration / 2);
+}
+
 TEST_CASE_METHOD(PerformanceTest, "perf Baobab2", "[.perf]") {
   double mcs_time = 0.1;
   std::vector<std::string> input_files{"input/Baobab/baobab2.xml",
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "probability_analysis.h"
+
+#include <random>
+
+#include <catch2/catch.hpp>
+
+#include "initializer.h"
+
+namespace scram::core::test {
+
+TEST_CASE("ProbabilityAnalyzerTest.IncrementalUpdate", "[probability]") {
+  std::vector<std::string> input_files = GENERATE(
+      std::vector<std::string>{"input/TwoTrain/two_train.xml"},
+      std::vector<std::string>{"input/ThreeMotor/three_motor.xml"},
+      std::vector<std::string>{"input/Autogenerated/200_event.xml"},
+      std::vector<std::string>{"input/Baobab/baobab1.xml",
+                               "input/Baobab/baobab1-basic-events.xml"});
+  INFO("input: " + input_files.front());
+  Settings settings;
+  auto model = mef::Initializer(input_files, settings).model();
+  const mef::Gate& top_event =
+      *model->fault_trees().begin()->top_events().front();
+  FaultTreeAnalyzer<Bdd> fta(top_event, settings, model.get());
+  fta.Analyze();
+  ProbabilityAnalyzer<Bdd> analyzer(&fta, &model->mission_time());
+  analyzer.Analyze();
+
+  Pdag::IndexMap<double> p_vars = analyzer.p_vars();
+  CHECK(analyzer.CalculateTotalProbability(p_vars, {}) ==
+        Approx(analyzer.p_total()));
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pick_var(
+      Pdag::kVariableStartIndex, Pdag::kVariableStartIndex + p_vars.size() - 1);
+  std::uniform_real_distribution<double> pick_p(0, 1);
+  for (int round = 0; round < 10; ++round) {
+    double incremental = 0;
+    for (int step = 0; step < 5; ++step) {  // Accumulated updates.
+      std::vector<int> changes;
+      for (int i = 0, num_changes = step % 3 + 1; i < num_changes; ++i) {
+        changes.push_back(pick_var(rng));
+        p_vars[changes.back()] = pick_p(rng);
+      }
+      incremental = analyzer.CalculateTotalProbability(p_vars, changes);
+    }
+    CHECK(incremental == Approx(analyzer.CalculateTotalProbability(p_vars)));
+  }
+}
+
+}  // namespace scram::core::test
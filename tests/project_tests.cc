@@ -75,6 +75,7 @@ TEST_CASE("ProjectTest.FullSettings", "[config]") {
   CHECK(settings.mission_time() == 48);
   CHECK(settings.time_step() == 1);
   CHECK(settings.cut_off() == 0.009);
+  CHECK(settings.top_products() == 7);
   CHECK(settings.num_trials() == 777);
   CHECK(settings.num_quantiles() == 13);
   CHECK(settings.num_bins() == 31);
@@ -97,6 +98,44 @@ TEST_CASE("ProjectTest.PrimeImplicantsSettings", "[config]") {
   CHECK(settings.prime_implicants());
 }
 
+TEST_CASE("ProjectTest.CompilePhasesSettings", "[config]") {
+  std::string config_file = "tests/input/fta/compile_phases_configuration.xml";
+  Project config(config_file);
+  CHECK(config.input_files().size() == 1);
+
+  const core::Settings& settings = config.settings();
+  CHECK(settings.algorithm() == core::Algorithm::kBdd);
+  CHECK_FALSE(settings.prime_implicants());
+  CHECK(settings.compile_phases());
+}
+
+TEST_CASE("ProjectTest.GateProbabilitiesSettings", "[config]") {
+  std::string config_file =
+      "tests/input/fta/gate_probabilities_configuration.xml";
+  Project config(config_file);
+  CHECK(config.input_files().size() == 1);
+
+  const core::Settings& settings = config.settings();
+  CHECK(settings.algorithm() == core::Algorithm::kBdd);
+  CHECK(settings.probability_analysis());
+  CHECK(settings.gate_probabilities());
+  CHECK(settings.probability_gates() == std::vector<std::string>{"TrainOne"});
+}
+
+TEST_CASE("ProjectTest.SweepSettings", "[config]") {
+  std::string config_file = "tests/input/fta/sweep_configuration.xml";
+  Project config(config_file);
+  CHECK(config.input_files().size() == 1);
+
+  const core::Settings& settings = config.settings();
+  CHECK(settings.probability_analysis());
+  REQUIRE(settings.sweep().size() == 2);
+  CHECK(settings.sweep()[0].parameter == "ValveFailure");
+  CHECK(settings.sweep()[0].values == std::vector<double>{0.1, 0.4});
+  CHECK(settings.sweep()[1].parameter == "PumpFailure");
+  CHECK(settings.sweep()[1].values == std::vector<double>{0, 0.5, 1});
+}
+
 TEST_CASE("ProjectTest.CanonicalPath", "[config]") {
   std::string config_file = "tests/input/win_path_in_config.xml";
   std::string cwd = boost::filesystem::current_path().generic_string();
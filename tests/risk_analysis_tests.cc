@@ -17,14 +17,24 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cmath>
+
+#include <algorithm>
+#include <optional>
+#include <sstream>
 #include <utility>
 
 #include <boost/filesystem.hpp>
+#include <boost/predef.h>
 
+#include "checkpoint.h"
 #include "env.h"
 #include "error.h"
+#include "expression/extern.h"
 #include "initializer.h"
 #include "reporter.h"
+#include "shard_merger.h"
+#include "trace.h"
 #include "xml.h"
 
 namespace fs = boost::filesystem;
@@ -64,7 +74,7 @@ void RiskAnalysisTest::CheckReport(const std::vector<std::string>& tree_input) {
   fs::path temp_file = fs::temp_directory_path() / unique_name;
   INFO("input: " + tree_input.front());
   INFO("output: " + temp_file.string());
-  REQUIRE_NOTHROW(Reporter().Report(*analysis, temp_file.string()));
+  REQUIRE_NOTHROW(Reporter(true).Report(*analysis, temp_file.string()));
   REQUIRE_NOTHROW(xml::Document(temp_file.string(), &validator));
   fs::remove(temp_file);
 }
@@ -247,6 +257,311 @@ TEST_P(RiskAnalysisTest, EnforceExactProbability) {
   CHECK(p_total() == Approx(0.646));
 }
 
+TEST_P(RiskAnalysisTest, ReportProgress) {
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  Progress progress;
+  settings.probability_analysis(true).progress(&progress);
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(analysis->results().size() == 1);
+  CHECK(analysis->warnings().empty());
+  CHECK_FALSE(progress.cancelled());
+  CHECK(progress.fraction() == 1);
+  CHECK(progress.stage() == Progress::Stage::kIdle);
+  CHECK(progress.target().empty());
+}
+
+TEST_P(RiskAnalysisTest, CancelAnalysis) {
+  std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
+  Progress progress;
+  progress.Cancel();
+  settings.probability_analysis(true).progress(&progress);
+  CheckReport({tree_input});  // The partial report must be valid.
+  CHECK(analysis->results().empty());
+  CHECK_FALSE(analysis->warnings().empty());
+  CHECK(progress.fraction() == 0);
+}
+
+namespace {
+
+/// Cancels the analysis upon the completed simulation of the first target.
+class CancellingCheckpoint : public RiskAnalysis::Checkpoint {
+ public:
+  explicit CancellingCheckpoint(Progress* progress) : progress_(progress) {}
+
+  SampleStatistics samples(const RiskAnalysis::Result::Id&) const override {
+    return {};
+  }
+
+  std::vector<SweepAnalysis::Point> points(
+      const RiskAnalysis::Result::Id&) const override {
+    return {};
+  }
+
+  void Record(const RiskAnalysis::Result::Id&,
+              const SampleStatistics&) noexcept override {
+    progress_->Cancel();
+  }
+
+  void Record(const RiskAnalysis::Result::Id&,
+              const std::vector<SweepAnalysis::Point>&,
+              int) noexcept override {}
+
+  void Save() noexcept override {}
+
+ private:
+  Progress* progress_;
+};
+
+}  // namespace
+
+// The sequences of the interrupted event tree are discarded together.
+TEST_F(RiskAnalysisTest, CancelEventTreeAnalysis) {
+  std::string dir = "input/ThreeMotor/";
+  Progress progress;
+  settings.uncertainty_analysis(true).num_trials(100).progress(&progress);
+  REQUIRE_NOTHROW(
+      ProcessInputFiles({dir + "three_motor.xml", dir + "event_tree.xml"}));
+  CancellingCheckpoint checkpoint(&progress);
+  analysis->checkpoint(&checkpoint);
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(progress.cancelled());
+  CHECK(analysis->results().empty());
+  CHECK(analysis->event_tree_results().empty());
+  CHECK_FALSE(analysis->warnings().empty());
+}
+
+TEST_P(RiskAnalysisTest, TraceAnalysis) {
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.probability_analysis(true).importance_analysis(true);
+  Trace::Start();
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  Trace::Stop();
+  std::ostringstream out;
+  Trace::Write(out);
+  std::string trace = out.str();
+  CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+  for (const char* span :
+       {"Parsing", "PDAG Construction", "Preprocessing Phase I",
+        "Generating products", "Probability analysis", "Importance analysis"}) {
+    INFO(span);
+    CHECK(trace.find(span) != std::string::npos);
+  }
+  CHECK(trace.find("Uncertainty analysis") == std::string::npos);
+}
+
+TEST_P(RiskAnalysisTest, CollectStatistics) {
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.probability_analysis(true);
+  CheckReport({with_prob});
+  REQUIRE(analysis->results().size() == 1);
+  const RiskAnalysis::Result& result = analysis->results().front();
+  const Statistics& products = result.fault_tree_analysis->statistics();
+  CHECK(products.counter("products") ==
+        result.fault_tree_analysis->products().size());
+  CHECK(products.counter("zbdd-nodes") > 0);
+  CHECK(products.counter("unknown") == 0);
+  if (settings.algorithm() == Algorithm::kBdd)
+    CHECK(products.counter("bdd-vertices") > 0);
+  CHECK(products.allocations() == 0);  // Not tracked by the test driver.
+#if !BOOST_OS_WINDOWS
+  CHECK(products.process_peak_memory() > 0);
+  CHECK(result.probability_analysis->statistics().process_peak_memory() >=
+        products.process_peak_memory());
+#endif
+}
+
+TEST_F(RiskAnalysisTest, SelectAlgorithm) {
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.algorithm("auto").probability_analysis(true);
+  CheckReport({with_prob});
+  REQUIRE(analysis->results().size() == 1);
+  const RiskAnalysis::Result& result = analysis->results().front();
+  REQUIRE(result.algorithm_choice);
+  CHECK(result.algorithm_choice->algorithm == Algorithm::kBdd);
+  CHECK(result.algorithm_choice->approximation == Approximation::kNone);
+  CHECK(result.algorithm_choice->features.num_variables == 4);
+  CHECK(result.algorithm_choice->features.max_probability == Approx(0.7));
+  CHECK(result.algorithm_choice->rationale.find("vertices") !=
+        std::string::npos);
+  CHECK_FALSE(result.algorithm_choice->bdd);  // The trial BDD is reused.
+  CHECK(result.fault_tree_analysis->statistics().counter("bdd-vertices") > 0);
+  CHECK(p_total() == Approx(0.646));
+  CHECK(settings.algorithm() == Algorithm::kAuto);  // Per-target choice only.
+
+  // The report header states the selected method.
+  fs::path unique_name = "scram_select_test-" + fs::unique_path().string();
+  std::string report = (fs::temp_directory_path() / unique_name).string();
+  REQUIRE_NOTHROW(Reporter().Report(*analysis, report));
+  xml::Document document(report);
+  fs::remove(report);
+  xml::Element information = *document.root().child("information");
+  for (xml::Element quantity : information.children("calculated-quantity")) {
+    if (quantity.attribute("name") == "Probability Analysis")
+      CHECK(quantity.attribute("approximation") == "none");
+    CHECK(quantity.child("calculation-method")->attribute("name") ==
+          "Binary Decision Diagram");
+  }
+}
+
+TEST_F(RiskAnalysisTest, ParameterSweep) {
+  std::string tree_input = "tests/input/fta/sweep_parameters.xml";
+  auto algorithm = GENERATE(as<const char*>(), "bdd", "zbdd", "mocus");
+  bool exact = algorithm == std::string_view("bdd");
+  settings.algorithm(algorithm).approximation(exact ? "none" : "rare-event");
+  settings.sweep("ValveFailure", {0.1, 0.4}).sweep("PumpFailure", 0, 1, 3);
+  settings.importance_analysis(true);
+  CheckReport({tree_input});
+  CAPTURE(algorithm);
+  // The parameters are restored after the sweep.
+  CHECK(p_total() == Approx(exact ? 0.646 : 1));
+  REQUIRE(analysis->results().size() == 1);
+  const auto& sweep = analysis->results().front().sweep_analysis;
+  REQUIRE(sweep);
+  REQUIRE(sweep->parameters().size() == 2);
+  REQUIRE(sweep->points().size() == 6);
+  CHECK(sweep->statistics().counter("sweep-points") == 6);
+  CHECK(sweep->important_events().size() == 4);
+  for (const SweepAnalysis::Point& point : sweep->points()) {
+    double valve = point.values[0];
+    double pump = point.values[1];
+    double train_one = exact ? 1 - (1 - valve) * (1 - pump) : valve + pump;
+    double train_two =
+        exact ? 1 - (1 - 1.25 * valve) * 0.3 : 1.25 * valve + 0.7;
+    INFO("ValveFailure = " << valve << ", PumpFailure = " << pump);
+    REQUIRE(point.valid);
+    CHECK(point.p_total == Approx(std::min(1.0, train_one * train_two)));
+    REQUIRE(point.importance.size() == 4);
+    if (!exact)
+      continue;  // The rare-event MIF is distorted by the adjustment to 1.
+    auto it = boost::find_if(sweep->important_events(), [](auto* event) {
+      return event->id() == "PumpOne";
+    });
+    REQUIRE(it != sweep->important_events().end());
+    CHECK(point.importance[it - sweep->important_events().begin()].mif ==
+          Approx((1 - valve) * train_two));
+  }
+  CHECK(sweep->points().front().values == std::vector<double>{0.1, 0});
+  CHECK(sweep->points().back().values == std::vector<double>{0.4, 1});
+}
+
+TEST_F(RiskAnalysisTest, CompilePhases) {
+  std::string tree_input = "input/TwoTrain/two_train_alignment.xml";
+  settings.algorithm("bdd").probability_analysis(true);
+  auto collect = [this] {
+    std::map<std::string, std::pair<std::set<std::set<std::string>>, double>>
+        phases;
+    for (const RiskAnalysis::Result& result : analysis->results()) {
+      REQUIRE(result.id.context);
+      auto& [sets, p_total] = phases[result.id.context->phase.name()];
+      for (const Product& product : result.fault_tree_analysis->products()) {
+        std::set<std::string> literals;
+        for (const Literal& literal : product) {
+          literals.insert((literal.complement ? "not " : "") +
+                          literal.event.id());
+        }
+        sets.insert(std::move(literals));
+      }
+      p_total = result.probability_analysis->p_total();
+    }
+    return phases;
+  };
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  auto expected = collect();
+  REQUIRE(expected.size() == 3);
+
+  settings.compile_phases(true);
+  CheckReport({tree_input});
+  auto phases = collect();
+  REQUIRE(phases.size() == expected.size());
+  for (const auto& [phase, phase_result] : phases) {
+    INFO("phase: " + phase);
+    REQUIRE(expected.count(phase));
+    CHECK(phase_result.first == expected[phase].first);
+    CHECK(phase_result.second == Approx(expected[phase].second));
+  }
+  CHECK(phases["PumpOne"].first != phases["Normal"].first);
+  // The house events of the model are intact after the phases.
+  for (const mef::HouseEvent& house_event : model->house_events())
+    CHECK_FALSE(house_event.state());
+}
+
+TEST_F(RiskAnalysisTest, GateProbabilities) {
+  std::vector<std::string> input_files = {
+      "input/Chinese/chinese.xml", "input/Chinese/chinese-basic-events.xml"};
+  settings.algorithm("bdd").gate_probabilities(true);
+  CheckReport(input_files);
+  REQUIRE(analysis->results().size() == 1);
+  const RiskAnalysis::Result& result = analysis->results().front();
+  // All the intermediate gates except for the top event.
+  CHECK(result.gate_probabilities.size() == model->gates().size() - 1);
+  CHECK(std::is_sorted(result.gate_probabilities.begin(),
+                       result.gate_probabilities.end(),
+                       [](const auto& lhs, const auto& rhs) {
+                         return lhs.first->id() < rhs.first->id();
+                       }));
+  for (const auto& [gate, p] : result.gate_probabilities) {
+    INFO("gate: " + gate->id());
+    FaultTreeAnalyzer<Bdd> fta(*gate, settings, model.get());
+    fta.Analyze();
+    ProbabilityAnalyzer<Bdd> analyzer(&fta, &model->mission_time());
+    analyzer.Analyze();
+    CHECK(p == Approx(analyzer.p_total()));
+  }
+  // The top event analysis is intact.
+  double p_top = p_total();
+  settings.gate_probabilities(false);
+  REQUIRE_NOTHROW(ProcessInputFiles(input_files));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(p_total() == Approx(p_top));
+  CHECK(analysis->results().front().gate_probabilities.empty());
+
+  settings.probability_gates({"g1", "g2", "NotInModel"});
+  CHECK_THROWS_AS(ProcessInputFiles(input_files), mef::UndefinedElement);
+  settings.probability_gates({"g1", "g2"});
+  REQUIRE_NOTHROW(ProcessInputFiles(input_files));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const auto& selected = analysis->results().front().gate_probabilities;
+  REQUIRE(selected.size() == 2);
+  CHECK(selected.front().first->id() == "g1");
+  CHECK(selected.back().first->id() == "g2");
+}
+
+TEST_F(RiskAnalysisTest, GateProbabilitiesOfCompiledPhases) {
+  std::string tree_input = "input/TwoTrain/two_train_alignment.xml";
+  settings.algorithm("bdd").gate_probabilities(true);
+  auto collect = [this] {
+    std::map<std::string, std::map<std::string, double>> phases;
+    for (const RiskAnalysis::Result& result : analysis->results()) {
+      REQUIRE(result.id.context);
+      auto& gates = phases[result.id.context->phase.name()];
+      for (const auto& [gate, p] : result.gate_probabilities)
+        gates.emplace(gate->id(), p);
+    }
+    return phases;
+  };
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  auto expected = collect();
+  REQUIRE(expected.size() == 3);
+
+  settings.compile_phases(true);
+  CheckReport({tree_input});
+  auto phases = collect();
+  REQUIRE(phases.size() == expected.size());
+  for (const auto& [phase, gates] : phases) {
+    INFO("phase: " + phase);
+    REQUIRE(gates.size() == expected[phase].size());
+    for (const auto& [gate, p] : gates) {
+      INFO("gate: " + gate);
+      CHECK(p == Approx(expected[phase][gate]));
+    }
+  }
+  CHECK(phases["PumpOne"]["TrainOne"] != Approx(phases["Normal"]["TrainOne"]));
+}
+
 TEST_P(RiskAnalysisTest, AnalyzeNestedFormula) {
   std::string nested_input = "tests/input/fta/nested_not.xml";
   REQUIRE_NOTHROW(ProcessInputFiles({nested_input}));
@@ -284,6 +599,95 @@ TEST_F(RiskAnalysisTest, ImportanceNeg) {
                   {"ValveTwo", {2, 0.0558, 0.06257, 0.1094, 2.189, 1.067}}});
 }
 
+TEST_F(RiskAnalysisTest, PrimeImplicantsCutOff) {
+  std::string tree_input = "tests/input/fta/importance_neg_test.xml";
+  settings.prime_implicants(true).cut_off(0.0025);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  std::set<std::set<std::string>> pi = {{"not PumpOne", "ValveOne"},
+                                        {"PumpOne", "PumpTwo"},
+                                        {"PumpOne", "ValveTwo"},
+                                        {"PumpTwo", "ValveOne"}};
+  CHECK(products() == pi);  // ValveOne * ValveTwo = 0.002 is cut off.
+  REQUIRE(analysis->results().size() == 1);
+  const FaultTreeAnalysis& fta =
+      *analysis->results().front().fault_tree_analysis;
+  CHECK(fta.statistics().counter("pi-truncated-cut-off") > 0);
+  CHECK_FALSE(fta.warnings().empty());
+}
+
+// Coherent graphs convert through the minimal cut set path.
+TEST_F(RiskAnalysisTest, PrimeImplicantsLimitOrder) {
+  std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.prime_implicants(true).limit_order(1);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(products().empty());  // All the products are of the second order.
+  REQUIRE(analysis->results().size() == 1);
+  const FaultTreeAnalysis& fta =
+      *analysis->results().front().fault_tree_analysis;
+  CHECK(fta.statistics().counter("pi-truncated-order") > 0);
+  CHECK(fta.statistics().counter("pi-truncated-cut-off") == 0);
+}
+
+// The CCF combinations are pruned only if negligible for any sample.
+TEST_F(RiskAnalysisTest, CcfCutOffUncertainty) {
+  std::string tree_input = "tests/input/fta/ccf_cut_off.xml";
+  settings.algorithm("bdd").ccf_analysis(true).uncertainty_analysis(true);
+  settings.num_trials(1000).seed(42);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  double expected_p_total = p_total();
+  double expected_mean = mean();
+  double expected_sigma = sigma();
+
+  settings.cut_off(0.0075);  // Above the mean, below the upper bound.
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(p_total() == expected_p_total);
+  CHECK(mean() == expected_mean);
+  CHECK(sigma() == expected_sigma);
+}
+
+// The negligible CCF combinations are pruned from the analysis.
+TEST_F(RiskAnalysisTest, CcfCutOff) {
+  std::string tree_input = "tests/input/fta/ccf_cut_off.xml";
+  std::set<std::string> independent = {"[PumpOne]", "[PumpTwo]",
+                                       "[PumpThree]"};
+  std::set<std::string> ccf = {"[PumpOne PumpTwo PumpThree]"};
+  settings.algorithm("bdd").ccf_analysis(true).probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(products() == std::set<std::set<std::string>>{independent, ccf});
+
+  settings.cut_off(0.05);  // Above the upper bound of the CCF event.
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(products() == std::set<std::set<std::string>>{independent});
+  CHECK(p_total() == Approx(std::pow(0.5 * (1 - 0.01), 3)));
+}
+
+// The CCF combinations are not pruned for the parameter sweep values.
+TEST_F(RiskAnalysisTest, CcfCutOffSweep) {
+  std::string tree_input = "tests/input/fta/ccf_cut_off.xml";
+  settings.algorithm("bdd").ccf_analysis(true).cut_off(0.05);
+  settings.sweep("PumpFailure", {0.5, 1});
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  REQUIRE(analysis->results().size() == 1);
+  const auto& sweep = analysis->results().front().sweep_analysis;
+  REQUIRE(sweep);
+  REQUIRE(sweep->points().size() == 2);
+  for (const SweepAnalysis::Point& point : sweep->points()) {
+    double q = point.values.front();
+    INFO("PumpFailure = " << q);
+    double independent = std::pow(q * (1 - 0.01), 3);
+    double ccf = 0.01 * q;
+    REQUIRE(point.valid);
+    CHECK(point.p_total == Approx(1 - (1 - independent) * (1 - ccf)));
+  }
+}
+
 TEST_P(RiskAnalysisTest, ImportanceSingleEvent) {
   std::string tree_input = "tests/input/core/null_a.xml";
   settings.importance_analysis(true);
@@ -332,6 +736,28 @@ TEST_F(RiskAnalysisTest, Mcub) {
   CHECK(p_total() == Approx(0.766144));
 }
 
+// Importance factors from the products of each variable with MCUB.
+TEST_F(RiskAnalysisTest, ImportanceMcub) {
+  std::string with_prob = "tests/input/fta/importance_test.xml";
+  settings.approximation("mcub").importance_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(p_total() == Approx(0.0119473));
+  TestImportance({{"PumpOne", {2, 0.11594, 0.5823, 0.6073, 10.122, 2.394}},
+                  {"PumpTwo", {2, 0.09711, 0.569, 0.5992, 8.559, 2.32}},
+                  {"ValveOne", {2, 0.11566, 0.3872, 0.4118, 10.294, 1.632}},
+                  {"ValveTwo", {2, 0.09692, 0.4056, 0.4353, 8.707, 1.682}}});
+}
+
+// The certain products are excluded from the MCUB complement product.
+TEST_F(RiskAnalysisTest, ImportanceMcubOneProbability) {
+  std::string tree_input = "tests/input/core/one_prob.xml";
+  settings.approximation("mcub").importance_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  TestImportance({{"A", {1, 1, 1, 1, 1, 0}}});
+}
+
 // Apply the minimal cut set upper bound approximation for non-coherent tree.
 // This should be a warning.
 TEST_F(RiskAnalysisTest, McubNonCoherent) {
@@ -481,6 +907,36 @@ TEST_P(RiskAnalysisTest, AnalyzeTestFunctionalEvent) {
   }
 }
 
+// The equivalent paths into the converging branches are walked once.
+TEST_P(RiskAnalysisTest, AnalyzeConvergingBranches) {
+  const char* tree_input = "tests/input/eta/converging_branches.xml";
+  settings.probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());  // 2^24 paths without the merging.
+  CHECK(analysis->event_tree_results().size() == 1);
+  const auto& results = sequences();
+  REQUIRE(results.size() == 2);
+  CHECK(results.at("Success") == Approx(0.2));
+  CHECK(results.at("Failure") == Approx(0.1));
+}
+
+// The paths converging from different functional event states
+// are not merged if the walk tests the states.
+TEST_P(RiskAnalysisTest, AnalyzeConvergingBranchesWithTests) {
+  const char* tree_input = "tests/input/eta/converging_branches_test.xml";
+  settings.probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(analysis->event_tree_results().size() == 1);
+  const auto& results = sequences();
+  REQUIRE(results.size() == 1);
+  if (settings.approximation() == Approximation::kRareEvent) {
+    CHECK(results.at("S") == Approx(0.75));
+  } else {
+    CHECK(results.at("S") == Approx(0.625));
+  }
+}
+
 // Test Reporting capabilities
 // Tests the output against the schema. However the contents of the
 // output are not verified or validated.
@@ -536,6 +992,178 @@ TEST_F(RiskAnalysisTest, ReportUncertaintyResults) {
   CheckReport({tree_input});
 }
 
+// Shards of the Monte Carlo trials merge into the single-run statistics.
+TEST_F(RiskAnalysisTest, MergeTrialShards) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.algorithm("bdd").uncertainty_analysis(true).num_trials(1000);
+  settings.seed(42);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const UncertaintyAnalysis& expected =
+      *analysis->results().front().uncertainty_analysis;
+  double expected_mean = expected.mean();
+  double expected_sigma = expected.sigma();
+  std::vector<double> expected_quantiles = expected.quantiles();
+  auto expected_distribution = expected.distribution();
+
+  std::vector<std::string> reports;
+  for (int i = 0; i < 3; ++i) {
+    settings.shard(i, 3);
+    fs::path unique_name = "scram_shard_test-" + fs::unique_path().string();
+    reports.push_back((fs::temp_directory_path() / unique_name).string());
+    CheckReport({tree_input});
+    REQUIRE_NOTHROW(Reporter().Report(*analysis, reports.back()));
+  }
+  settings.shard(0, 1);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  std::optional<ShardMerger> merger;
+  REQUIRE_NOTHROW(merger.emplace(reports, settings));
+  CHECK_THROWS_AS(ShardMerger({reports[0], reports[0], reports[2]}, settings),
+                  xml::ValidityError);
+  core::Settings seeded = settings;
+  seeded.seed(7);
+  CHECK_THROWS_AS(ShardMerger(reports, seeded), SettingsError);
+  for (const std::string& report : reports)
+    fs::remove(report);
+  analysis->sample_source(*merger);
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const UncertaintyAnalysis& merged =
+      *analysis->results().front().uncertainty_analysis;
+  CHECK(merged.samples().count() == 1000);
+  CHECK(merged.mean() == expected_mean);
+  CHECK(merged.sigma() == expected_sigma);
+  CHECK(merged.quantiles() == expected_quantiles);
+  CHECK(merged.distribution() == expected_distribution);
+}
+
+namespace {
+
+/// Interrupts the analysis after a number of the progress recordings.
+class InterruptingCheckpoint : public CheckpointFile {
+ public:
+  InterruptingCheckpoint(const std::string& path, const Settings& settings,
+                         Progress* progress, int num_records)
+      : CheckpointFile(path, settings, 0, false),
+        progress_(progress),
+        num_records_(num_records) {}
+
+  void Record(const RiskAnalysis::Result::Id& id,
+              const SampleStatistics& samples) noexcept override {
+    CheckpointFile::Record(id, samples);
+    Count();
+  }
+
+  void Record(const RiskAnalysis::Result::Id& id,
+              const std::vector<SweepAnalysis::Point>& points,
+              int num_points) noexcept override {
+    CheckpointFile::Record(id, points, num_points);
+    Count();
+  }
+
+ private:
+  void Count() {
+    if (--num_records_ == 0)
+      progress_->Cancel();
+  }
+
+  Progress* progress_;
+  int num_records_;
+};
+
+}  // namespace
+
+// The interrupted Monte Carlo simulation resumes with identical statistics.
+TEST_F(RiskAnalysisTest, ResumeUncertaintyFromCheckpoint) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.algorithm("bdd").uncertainty_analysis(true).num_trials(20000);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const UncertaintyAnalysis& expected =
+      *analysis->results().front().uncertainty_analysis;
+  double expected_mean = expected.mean();
+  double expected_sigma = expected.sigma();
+  std::vector<double> expected_quantiles = expected.quantiles();
+  auto expected_distribution = expected.distribution();
+
+  fs::path unique_name = "scram_checkpoint_test-" + fs::unique_path().string();
+  std::string file = (fs::temp_directory_path() / unique_name).string();
+  Progress progress;
+  settings.progress(&progress);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  InterruptingCheckpoint interrupter(file, settings, &progress, 2);
+  analysis->checkpoint(&interrupter);
+  analysis->Analyze();
+  CHECK(analysis->results().empty());
+
+  settings.progress(nullptr);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  core::Settings seeded = settings;
+  seeded.seed(7);
+  CHECK_THROWS_AS(CheckpointFile(file, seeded, 0, true), SettingsError);
+  std::optional<CheckpointFile> checkpoint;
+  REQUIRE_NOTHROW(checkpoint.emplace(file, settings, 0, true));
+  RiskAnalysis::Result::Id id{fault_tree().top_events().front(), {}};
+  CHECK(checkpoint->samples(id).count() ==
+        2 * UncertaintyAnalysis::kRecordStep);
+  analysis->checkpoint(&*checkpoint);
+  REQUIRE_NOTHROW(analysis->Analyze());
+  fs::remove(file);
+  REQUIRE(analysis->results().size() == 1);
+  const UncertaintyAnalysis& resumed =
+      *analysis->results().front().uncertainty_analysis;
+  CHECK(resumed.samples().count() == 20000);
+  CHECK(resumed.mean() == expected_mean);
+  CHECK(resumed.sigma() == expected_sigma);
+  CHECK(resumed.quantiles() == expected_quantiles);
+  CHECK(resumed.distribution() == expected_distribution);
+}
+
+// The interrupted parameter sweep resumes after the evaluated points.
+TEST_F(RiskAnalysisTest, ResumeSweepFromCheckpoint) {
+  std::string tree_input = "tests/input/fta/sweep_parameters.xml";
+  settings.sweep("ValveFailure", {0.1, 0.4}).sweep("PumpFailure", 0, 1, 3000);
+  settings.importance_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  std::vector<SweepAnalysis::Point> expected =
+      analysis->results().front().sweep_analysis->points();
+
+  fs::path unique_name = "scram_checkpoint_test-" + fs::unique_path().string();
+  std::string file = (fs::temp_directory_path() / unique_name).string();
+  Progress progress;
+  settings.progress(&progress);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  InterruptingCheckpoint interrupter(file, settings, &progress, 2);
+  analysis->checkpoint(&interrupter);
+  analysis->Analyze();
+  CHECK(analysis->results().empty());
+
+  settings.progress(nullptr);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  std::optional<CheckpointFile> checkpoint;
+  REQUIRE_NOTHROW(checkpoint.emplace(file, settings, 0, true));
+  RiskAnalysis::Result::Id id{fault_tree().top_events().front(), {}};
+  CHECK(checkpoint->points(id).size() == 2048);
+  analysis->checkpoint(&*checkpoint);
+  REQUIRE_NOTHROW(analysis->Analyze());
+  fs::remove(file);
+  REQUIRE(analysis->results().size() == 1);
+  const std::vector<SweepAnalysis::Point>& points =
+      analysis->results().front().sweep_analysis->points();
+  REQUIRE(points.size() == expected.size());
+  for (int i = 0; i < points.size(); ++i) {
+    INFO("point: " << i);
+    CHECK(points[i].values == expected[i].values);
+    CHECK(points[i].valid == expected[i].valid);
+    CHECK(points[i].p_total == expected[i].p_total);
+    REQUIRE(points[i].importance.size() == expected[i].importance.size());
+    for (int j = 0; j < points[i].importance.size(); ++j) {
+      CHECK(points[i].importance[j].mif == expected[i].importance[j].mif);
+      CHECK(points[i].importance[j].rrw == expected[i].importance[j].rrw);
+    }
+  }
+}
+
 // Reporting event tree analysis with an initiating event.
 TEST_F(RiskAnalysisTest, ReportInitiatingEventAnalysis) {
   const char* tree_input = "input/EventTrees/bcd.xml";
@@ -631,6 +1259,15 @@ TEST_P(RiskAnalysisTest, ConstantGates) {
   CHECK(products() == kUnity);
 }
 
+// Constant module of a common node in Boolean optimization.
+TEST_P(RiskAnalysisTest, ConstantModule) {
+  std::string tree_input = "tests/input/fta/constant_module.xml";
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  std::set<std::set<std::string>> mcs = {{"E1"}};
+  CHECK(products() == mcs);
+}
+
 // Mixed roles with undefined event types
 TEST_F(RiskAnalysisTest, UndefinedEventsMixedRoles) {
   std::string tree_input = "tests/input/fta/ambiguous_events_with_roles.xml";
@@ -653,4 +1290,34 @@ TEST_P(RiskAnalysisTest, ExternFunctionProbability) {
   CHECK(p_total() == Approx(0.1));
 }
 
+// The batch extern functions are sampled over many trials at once
+// with the same results as the per-trial calls.
+TEST_F(RiskAnalysisTest, ExternBatchUncertainty) {
+  settings.uncertainty_analysis(true).num_trials(1000);
+  REQUIRE_NOTHROW(
+      ProcessInputFiles({"tests/input/model/extern_uncertainty.xml"}, true));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const UncertaintyAnalysis& expected =
+      *analysis->results().front().uncertainty_analysis;
+  double expected_mean = expected.mean();
+  double expected_sigma = expected.sigma();
+  std::vector<double> expected_quantiles = expected.quantiles();
+
+  REQUIRE_NOTHROW(ProcessInputFiles(
+      {"tests/input/model/extern_batch_uncertainty.xml"}, true));
+  mef::ExternLibrary library("dummy", "build/lib/scram/scram_dummy_extern",
+                             fs::current_path(), false, true);
+  auto calls = library.get<int()>("calls");
+  int init_calls = calls();
+  REQUIRE_NOTHROW(analysis->Analyze());
+  // Only the function under the multiplication is called per trial.
+  CHECK(calls() - init_calls < 1100);
+  const UncertaintyAnalysis& batched =
+      *analysis->results().front().uncertainty_analysis;
+  CHECK(batched.samples().count() == 1000);
+  CHECK(batched.mean() == expected_mean);
+  CHECK(batched.sigma() == expected_sigma);
+  CHECK(batched.quantiles() == expected_quantiles);
+}
+
 }  // namespace scram::core::test
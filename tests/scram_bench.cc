@@ -0,0 +1,522 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Benchmark driver over the bundled PSA model corpus.
+///
+/// The benchmark runs a matrix of models, algorithms, approximations,
+/// and analysis types with warmup and repeated runs,
+/// and emits the summary in JSON.
+/// Two result files can be compared to flag regressions.
+/// Synthetic models of growing size measure the scaling of the algorithms.
+
+#include <cmath>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/exception/all.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/predef.h>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "env.h"
+#include "error.h"
+#include "ext/scope_guard.h"
+#include "generator.h"
+#include "initializer.h"
+#include "model.h"
+#include "risk_analysis.h"
+#include "settings.h"
+#include "statistics.h"
+
+#if BOOST_LIB_C_GNU
+#include <malloc.h>
+#endif
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace {
+
+/// A model of the benchmark corpus.
+struct Model {
+  std::string name;  ///< The unique name of the model.
+  std::vector<std::string> files;  ///< The input files relative to the corpus.
+  int limit_order;  ///< The limit on the product order for tractability.
+  int num_gates = 0;  ///< The size of the synthetic model to be generated.
+};
+
+/// The bundled models in the order of growing difficulty.
+const Model kCorpus[] = {
+    {"SmallTree", {"SmallTree/SmallTree.xml"}, 20},
+    {"ThreeMotor", {"ThreeMotor/three_motor.xml"}, 20},
+    {"TwoTrain", {"TwoTrain/two_train.xml"}, 20},
+    {"Theatre", {"Theatre/theatre.xml"}, 20},
+    {"Lift", {"Lift/lift.xml"}, 20},
+    {"BSCU", {"BSCU/BSCU.xml"}, 20},
+    {"ne574", {"ne574/ne574.xml"}, 20},
+    {"HIPPS", {"HIPPS/HIPPS.xml"}, 20},
+    {"Chinese", {"Chinese/chinese.xml", "Chinese/chinese-basic-events.xml"}, 20},
+    {"200_event", {"Autogenerated/200_event.xml"}, 20},
+    {"Baobab2", {"Baobab/baobab2.xml", "Baobab/baobab2-basic-events.xml"}, 20},
+    {"Baobab1", {"Baobab/baobab1.xml", "Baobab/baobab1-basic-events.xml"}, 7},
+    {"CEA9601", {"CEA9601/CEA9601.xml", "CEA9601/CEA9601-basic-events.xml"}, 4},
+    {"Telecom", {"Autogenerated/telecom.xml.gz"}, 4},
+};
+
+/// A single configuration of the benchmark matrix.
+struct Case {
+  const Model* model;  ///< The model under analysis.
+  std::string algorithm;  ///< The qualitative analysis algorithm.
+  std::string approximation;  ///< The quantitative approximation or default.
+  std::string analysis;  ///< The analysis type.
+
+  /// @returns The unique name of the case.
+  std::string name() const {
+    return model->name + "/" + algorithm + "/" + approximation + "/" +
+           analysis;
+  }
+};
+
+/// Summary of repeated measurements.
+struct Summary {
+  /// @param[in] values  Non-empty measurements.
+  explicit Summary(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    int n = values.size();
+    min = values.front();
+    max = values.back();
+    median = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    for (double value : values)
+      mean += value;
+    mean /= n;
+    for (double value : values)
+      variance += (value - mean) * (value - mean);
+    if (n > 1)
+      variance /= n - 1;
+  }
+
+  double median = 0;  ///< The median value.
+  double mean = 0;  ///< The arithmetic mean.
+  double variance = 0;  ///< The unbiased sample variance.
+  double min = 0;  ///< The minimum value.
+  double max = 0;  ///< The maximum value.
+};
+
+/// Resets the peak resident memory of the process
+/// so that the following measurement is per run.
+///
+/// @returns false if the platform does not support the reset.
+bool ResetPeakMemory() noexcept {
+#if BOOST_OS_LINUX
+#if BOOST_LIB_C_GNU
+  malloc_trim(0);  // The freed heap of the previous run stays resident.
+#endif
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  return static_cast<bool>(clear_refs << "5" << std::flush);
+#else
+  return false;
+#endif
+}
+
+/// @returns The peak resident memory in bytes since the last reset.
+///          0 if the platform does not track the reset peak.
+///
+/// @note The resource usage of the process (getrusage)
+///       keeps the lifetime peak regardless of the reset.
+std::size_t PeakMemorySinceReset() noexcept {
+#if BOOST_OS_LINUX
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:"))
+      continue;
+    std::size_t kilobytes = 0;
+    std::istringstream(line.substr(6)) >> kilobytes;
+    return kilobytes * 1024;
+  }
+#endif
+  return 0;
+}
+
+/// @returns The settings for the benchmark case.
+///
+/// @param[in] test  The benchmark case.
+/// @param[in] num_trials  The number of Monte Carlo trials.
+///
+/// @throws SettingsError  The configuration is invalid.
+scram::core::Settings MakeSettings(const Case& test, int num_trials) {
+  scram::core::Settings settings;
+  settings.algorithm(test.algorithm).limit_order(test.model->limit_order);
+  if (test.approximation != "default")
+    settings.approximation(test.approximation);
+  if (test.analysis != "products")
+    settings.probability_analysis(true);
+  if (test.analysis == "importance")
+    settings.importance_analysis(true);
+  if (test.analysis == "uncertainty")
+    settings.uncertainty_analysis(true).num_trials(num_trials).seed(42);
+  return settings;
+}
+
+/// Writes a JSON string literal without escaping.
+///
+/// @param[in] key  The member name.
+/// @param[in] value  The member value with no special characters.
+/// @param[out] out  The destination stream.
+void Member(const std::string& key, const std::string& value,
+            std::ostream& out) {
+  out << '"' << key << "\": \"" << value << '"';
+}
+
+/// Runs a benchmark case and writes its JSON summary.
+///
+/// @param[in] test  The benchmark case.
+/// @param[in] model  The parsed model of the case.
+/// @param[in] vm  The benchmark options.
+/// @param[out] out  The destination for the JSON object.
+///
+/// @throws SettingsError  The case configuration is invalid.
+void Run(const Case& test, scram::mef::Model* model,
+         const po::variables_map& vm, std::ostream& out) {
+  scram::core::Settings settings =
+      MakeSettings(test, vm["num-trials"].as<int>());
+  int warmup = vm["warmup"].as<int>();
+  int repeat = vm["repeat"].as<int>();
+  std::vector<double> times;
+  std::size_t peak_memory = 0;
+  std::unique_ptr<scram::core::RiskAnalysis> analysis;
+  for (int i = -warmup; i < repeat; ++i) {
+    analysis.reset();  // Release the memory of the previous run.
+    bool reset = ResetPeakMemory();
+    analysis = std::make_unique<scram::core::RiskAnalysis>(model, settings);
+    auto start = std::chrono::steady_clock::now();
+    analysis->Analyze();
+    std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - start;
+    if (i < 0)
+      continue;  // Warmup.
+    times.push_back(time.count());
+    if (std::size_t peak = reset ? PeakMemorySinceReset() : 0) {
+      peak_memory = std::max(peak_memory, peak);
+    } else if (i == 0) {
+      peak_memory = scram::core::PeakMemory();  // Cumulative w/o the reset.
+    }
+  }
+  Summary summary(times);
+  std::cerr << test.name() << ": " << summary.median << " s" << std::endl;
+
+  std::map<std::string, std::int64_t> counters;
+  std::int64_t num_products = 0;
+  double p_total = 0;
+  for (const scram::core::RiskAnalysis::Result& result : analysis->results()) {
+    if (result.fault_tree_analysis) {
+      num_products += result.fault_tree_analysis->products().size();
+      for (const auto& [name, value] :
+           result.fault_tree_analysis->statistics().counters())
+        counters[name] += value;
+    }
+    if (result.probability_analysis)
+      p_total += result.probability_analysis->p_total();
+  }
+
+  out << "    {";
+  Member("name", test.name(), out);
+  out << ", ";
+  Member("model", test.model->name, out);
+  out << ", ";
+  Member("algorithm", test.algorithm, out);
+  out << ", ";
+  Member("approximation", test.approximation, out);
+  out << ", ";
+  Member("analysis", test.analysis, out);
+  out << ",\n     \"time\": {\"median\": " << summary.median
+      << ", \"mean\": " << summary.mean
+      << ", \"variance\": " << summary.variance
+      << ", \"min\": " << summary.min << ", \"max\": " << summary.max << "},\n"
+      << "     \"peak_memory\": " << peak_memory
+      << ", \"products\": " << num_products;
+  if (settings.probability_analysis())
+    out << ", \"probability\": " << p_total;
+  out << ",\n     \"counters\": {";
+  bool first = true;
+  for (const auto& [name, value] : counters) {
+    out << (first ? "" : ", ") << '"' << name << "\": " << value;
+    first = false;
+  }
+  out << "}}";
+}
+
+/// Runs the benchmark matrix.
+///
+/// @param[in] vm  The benchmark options.
+///
+/// @returns 0 for success.
+int RunMatrix(const po::variables_map& vm) {
+  fs::path input_dir = vm.count("input-dir")
+                           ? fs::path(vm["input-dir"].as<std::string>())
+                           : fs::path("input");
+  if (!vm.count("input-dir") && !fs::exists(input_dir))
+    input_dir = fs::path(scram::env::install_dir()) / "share/scram/input";
+
+  auto models = vm["model"].as<std::vector<std::string>>();
+  auto sizes = vm["synthetic"].as<std::vector<int>>();
+  std::vector<Model> selection;
+  for (const Model& model : kCorpus) {
+    if ((models.empty() && sizes.empty()) ||
+        std::find(models.begin(), models.end(), model.name) != models.end())
+      selection.push_back(model);
+  }
+  for (int num_gates : sizes)
+    selection.push_back(
+        {"Synthetic-" + std::to_string(num_gates), {}, 6, num_gates});
+
+  std::ofstream file;
+  if (vm.count("output")) {
+    file.open(vm["output"].as<std::string>());
+    if (!file) {
+      std::cerr << "Cannot open the output file." << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = vm.count("output") ? file : std::cout;
+  out.precision(9);
+  out << "{\n  \"debug\": "
+#ifdef NDEBUG
+      << "false"
+#else
+      << "true"
+#endif
+      << ", \"warmup\": " << vm["warmup"].as<int>()
+      << ", \"repeat\": " << vm["repeat"].as<int>()
+      << ",\n  \"benchmarks\": [\n";
+  bool first = true;
+  for (const Model& model : selection) {
+    std::vector<std::string> files;
+    for (const std::string& file_name : model.files)
+      files.push_back((input_dir / file_name).string());
+    if (std::any_of(files.begin(), files.end(), [](const std::string& path) {
+          return !fs::exists(path);
+        })) {
+      std::cerr << model.name << ": missing input files, skipped."
+                << std::endl;
+      continue;
+    }
+    std::unique_ptr<scram::mef::Model> parsed;
+    try {
+      if (model.num_gates) {
+        fs::path model_file = fs::temp_directory_path() /
+                              fs::unique_path("scram-synthetic-%%%%-%%%%.xml");
+        SCOPE_EXIT([&model_file] { fs::remove(model_file); });
+        scram::mef::GeneratorSettings generator;
+        generator.num_gates = model.num_gates;
+        generator.num_basic_events = model.num_gates;
+        generator.sharing = vm["sharing"].as<double>();
+        // Independent modules keep the growth of the models tractable.
+        generator.num_modules =
+            std::max(1, model.num_gates / vm["module-size"].as<int>());
+        scram::mef::Generate(generator, model_file.string());
+        parsed = scram::mef::Initializer({model_file.string()},
+                                         scram::core::Settings())
+                     .model();
+      } else {
+        parsed =
+            scram::mef::Initializer(files, scram::core::Settings()).model();
+      }
+    } catch (const scram::Error& err) {
+      std::cerr << model.name << ": " << err.what() << std::endl;
+      continue;
+    }
+    std::vector<Case> cases;
+    for (const auto& algorithm : vm["algorithm"].as<std::vector<std::string>>()) {
+      for (const auto& approximation :
+           vm["approximation"].as<std::vector<std::string>>()) {
+        for (const auto& analysis :
+             vm["analysis"].as<std::vector<std::string>>())
+          cases.push_back({&model, algorithm, approximation, analysis});
+      }
+    }
+    for (const Case& test : cases) {
+      std::ostringstream entry;
+      entry.precision(9);
+      try {
+        Run(test, parsed.get(), vm, entry);
+      } catch (const scram::SettingsError& err) {
+        std::cerr << test.name() << ": " << err.what() << std::endl;
+        continue;
+      }
+      out << (first ? "" : ",\n") << entry.str();
+      first = false;
+    }
+  }
+  out << "\n  ]\n}" << std::endl;
+  return 0;
+}
+
+/// Compares two benchmark result files.
+///
+/// @param[in] base  The baseline result file.
+/// @param[in] current  The result file to be checked.
+/// @param[in] threshold  The relative change considered significant.
+///
+/// @returns 0 if no regressions are detected.
+/// @returns 2 if any benchmark has regressed.
+int Compare(const std::string& base, const std::string& current,
+            double threshold) {
+  namespace pt = boost::property_tree;
+  pt::ptree base_tree;
+  pt::ptree current_tree;
+  pt::read_json(base, base_tree);
+  pt::read_json(current, current_tree);
+
+  std::map<std::string, const pt::ptree*> baseline;
+  for (const auto& entry : base_tree.get_child("benchmarks"))
+    baseline.emplace(entry.second.get<std::string>("name"), &entry.second);
+
+  int num_regressions = 0;
+  for (const auto& entry : current_tree.get_child("benchmarks")) {
+    const pt::ptree& now = entry.second;
+    std::string name = now.get<std::string>("name");
+    auto it = baseline.find(name);
+    if (it == baseline.end()) {
+      std::cout << "NEW        " << name << "\n";
+      continue;
+    }
+    const pt::ptree& was = *it->second;
+    double time_was = was.get<double>("time.median");
+    double time_now = now.get<double>("time.median");
+    // Changes within the run-to-run noise are not significant.
+    double noise = 2 * std::sqrt(was.get<double>("time.variance") +
+                                 now.get<double>("time.variance"));
+    double memory_was = was.get<double>("peak_memory");
+    double memory_now = now.get<double>("peak_memory");
+
+    const char* verdict = "OK        ";
+    if (time_now > time_was * (1 + threshold) && time_now - time_was > noise) {
+      verdict = "SLOWER    ";
+      ++num_regressions;
+    } else if (memory_was && memory_now > memory_was * (1 + threshold)) {
+      verdict = "MEMORY    ";
+      ++num_regressions;
+    } else if (time_now < time_was * (1 - threshold) &&
+               time_was - time_now > noise) {
+      verdict = "FASTER    ";
+    }
+    std::cout << verdict << name << ": " << time_was << " s -> " << time_now
+              << " s";
+    if (memory_was && memory_now)
+      std::cout << ", " << memory_was / (1 << 20) << " MiB -> "
+                << memory_now / (1 << 20) << " MiB";
+    std::cout << "\n";
+  }
+  std::cout << num_regressions << " regression(s) detected." << std::endl;
+  return num_regressions ? 2 : 0;
+}
+
+}  // namespace
+
+/// Benchmark entrance.
+///
+/// @param[in] argc  Argument count.
+/// @param[in] argv  Argument vector.
+///
+/// @returns 0 for success.
+/// @returns 1 for errored state.
+/// @returns 2 for detected regressions.
+int main(int argc, char* argv[]) {
+  po::options_description desc("Options");
+  // clang-format off
+  desc.add_options()
+      ("help", "Display this help message")
+      ("input-dir", po::value<std::string>()->value_name("path"),
+       "Directory of the model corpus")
+      ("model", po::value<std::vector<std::string>>()->multitoken()
+                    ->default_value({}, "all"),
+       "Models of the corpus to run")
+      ("synthetic", po::value<std::vector<int>>()->multitoken()
+                        ->default_value({}, "none"),
+       "Numbers of gates of generated models for scaling curves")
+      ("sharing", po::value<double>()->default_value(0.1),
+       "Chance of node sharing in generated models")
+      ("module-size", po::value<int>()->default_value(200),
+       "Number of gates per independent module of generated models")
+      ("algorithm", po::value<std::vector<std::string>>()->multitoken()
+                        ->default_value({"bdd", "zbdd", "mocus"},
+                                        "bdd zbdd mocus"),
+       "Qualitative analysis algorithms")
+      ("approximation", po::value<std::vector<std::string>>()->multitoken()
+                            ->default_value({"default"}, "default"),
+       "Quantitative approximations (default, none, rare-event, mcub)")
+      ("analysis", po::value<std::vector<std::string>>()->multitoken()
+                       ->default_value({"products", "probability"},
+                                       "products probability"),
+       "Analysis types (products, probability, importance, uncertainty)")
+      ("warmup", po::value<int>()->default_value(1), "Number of warmup runs")
+      ("repeat", po::value<int>()->default_value(5), "Number of measured runs")
+      ("num-trials", po::value<int>()->default_value(1000),
+       "Number of trials for uncertainty analysis")
+      ("output,o", po::value<std::string>()->value_name("path"),
+       "Output file for JSON results")
+      ("compare", po::value<std::vector<std::string>>()->multitoken(),
+       "Compare two result files: base current")
+      ("threshold", po::value<double>()->default_value(0.1),
+       "Relative change to flag in comparison");
+  // clang-format on
+  try {
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+      std::cout << "Usage:    scram_bench [options]\n\n" << desc << std::endl;
+      return 0;
+    }
+    if (vm["warmup"].as<int>() < 0 || vm["repeat"].as<int>() < 1) {
+      std::cerr << "Invalid number of runs.\n\n" << desc << std::endl;
+      return 1;
+    }
+    if (vm["module-size"].as<int>() < 1) {
+      std::cerr << "Invalid module size.\n\n" << desc << std::endl;
+      return 1;
+    }
+    if (vm.count("compare")) {
+      auto files = vm["compare"].as<std::vector<std::string>>();
+      if (files.size() != 2) {
+        std::cerr << "Comparison requires two result files.\n\n"
+                  << desc << std::endl;
+        return 1;
+      }
+      return Compare(files[0], files[1], vm["threshold"].as<double>());
+    }
+    return RunMatrix(vm);
+  } catch (const scram::Error& err) {
+    std::cerr << boost::diagnostic_information(err) << std::endl;
+    return 1;
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+}
@@ -28,4 +28,23 @@ double identity(double arg) { return arg; }
 double div(double lhs, double rhs) { return lhs / rhs; }
 double sum(double arg1, double arg2, double arg3) { return arg1 + arg2 + arg3; }
 double sub(double lhs, double rhs) { return lhs - rhs; }
+
+// The number of library calls and computed results to test memoization.
+int num_calls = 0;
+int num_results = 0;
+int calls() { return num_calls; }
+int results() { return num_results; }
+double counted_identity(double arg) {
+  ++num_calls;
+  ++num_results;
+  return arg;
+}
+
+// The batch calling convention with row-major arguments.
+void sum_batch(int count, const double* args, double* results) {
+  ++num_calls;
+  num_results += count;
+  for (int i = 0; i < count; ++i, args += 3)
+    results[i] = args[0] + args[1] + args[2];
+}
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server.h"
+
+#include <cmath>
+
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+#include "expression/constant.h"
+#include "initializer.h"
+#include "probability_analysis.h"
+
+namespace scram::core::test {
+
+namespace {
+
+/// @returns The analysis model from the input files.
+std::unique_ptr<mef::Model> LoadModel(const std::vector<std::string>& files) {
+  return mef::Initializer(files, Settings{}).model();
+}
+
+/// Sets the constant probability of a basic event in the model.
+void SetProbability(mef::Model* model, const std::string& id, double p) {
+  auto expression = std::make_unique<mef::ConstantExpression>(p);
+  mef::BasicEvent& basic_event = *model->table<mef::BasicEvent>().find(id);
+  basic_event.expression(expression.get());
+  model->Add(std::move(expression));
+}
+
+}  // namespace
+
+TEST_CASE("RiskAnalysisTest.Requantify", "[risk]") {
+  std::string dir = "input/TwoTrain/";
+  std::vector<std::string> input_files = {dir + "two_train_alignment.xml"};
+  Settings settings;
+  settings.algorithm(GENERATE(as<std::string>(), "bdd", "zbdd", "mocus"));
+  settings.approximation(GENERATE(as<std::string>(), "none", "rare-event"));
+  settings.probability_analysis(true).importance_analysis(true);
+  INFO("algorithm: " << kAlgorithmToString[static_cast<int>(
+                            settings.algorithm())]);
+
+  auto model = LoadModel(input_files);
+  RiskAnalysis analysis(model.get(), settings);
+  analysis.Analyze();
+  SetProbability(model.get(), "ValveOne", 0.3);
+  analysis.Requantify();
+
+  auto expected_model = LoadModel(input_files);
+  SetProbability(expected_model.get(), "ValveOne", 0.3);
+  RiskAnalysis expected(expected_model.get(), settings);
+  expected.Analyze();
+
+  REQUIRE(analysis.results().size() == expected.results().size());
+  for (int i = 0; i < analysis.results().size(); ++i) {
+    const RiskAnalysis::Result& result = analysis.results()[i];
+    const RiskAnalysis::Result& fresh = expected.results()[i];
+    CHECK(result.probability_analysis->p_total() ==
+          Approx(fresh.probability_analysis->p_total()));
+    REQUIRE(result.importance_analysis);
+    REQUIRE(result.importance_analysis->importance().size() ==
+            fresh.importance_analysis->importance().size());
+    for (int j = 0; j < result.importance_analysis->importance().size(); ++j) {
+      CHECK(result.importance_analysis->importance()[j].factors.dif ==
+            Approx(fresh.importance_analysis->importance()[j].factors.dif));
+    }
+  }
+}
+
+TEST_CASE("ServerTest.Requests", "[server]") {
+  auto model = LoadModel({"tests/input/fta/constant_propagation.xml"});
+  Settings settings;
+  Server server(model.get(), settings);
+
+  std::string base = server.Process(R"({"id": 1})");
+  CHECK(base.find(R"({"id":1,"status":"ok","recompiled":false,)") == 0);
+  CHECK(base.find(R"("target":"Root","products":1,"probability":0.02})") !=
+        std::string::npos);
+
+  std::string what_if = server.Process(R"({"basic-events": {"A": 0.5}})");
+  CHECK(what_if.find(R"("recompiled":false)") != std::string::npos);
+  CHECK(what_if.find(R"("probability":0.1})") != std::string::npos);
+
+  std::string house = server.Process(R"({"house-events": {"h1": false}})");
+  CHECK(house.find(R"("recompiled":true)") != std::string::npos);
+  CHECK(house.find(R"("probability":1})") != std::string::npos);
+
+  std::string restored = server.Process(R"({"id": "again"})");
+  CHECK(restored.find(R"({"id":"again","status":"ok","recompiled":true,)") ==
+        0);
+  CHECK(restored.find(R"("probability":0.02})") != std::string::npos);
+  CHECK(server.Process("{}").find(R"("recompiled":false)") !=
+        std::string::npos);
+
+  CHECK_FALSE(server.stopped());
+  CHECK(server.Process(R"({"command": "exit"})") == R"({"status":"ok"})");
+  CHECK(server.stopped());
+}
+
+TEST_CASE("ServerTest.MissionTime", "[server]") {
+  auto model = LoadModel({"tests/input/core/single_exponential.xml"});
+  Settings settings;
+  settings.mission_time(1000);
+  model->mission_time().value(1000);
+  Server server(model.get(), settings);
+  double p = 1 - std::exp(-1e-5 * 1e5);
+  std::ostringstream expected;
+  expected.precision(15);
+  expected << R"("probability":)" << p << "}";
+  CHECK(server.Process(R"({"mission-time": 1e5})").find(expected.str()) !=
+        std::string::npos);
+  CHECK(model->mission_time().value() == 1000);
+}
+
+TEST_CASE("ServerTest.InvalidRequests", "[server]") {
+  auto model = LoadModel({"tests/input/fta/constant_propagation.xml"});
+  Server server(model.get(), Settings{});
+  std::string request = GENERATE(
+      as<std::string>(), R"({"id": 1, )", R"({"command": "unknown"})",
+      R"({"basic-events": {"Undefined": 0.1}})",
+      R"({"basic-events": {"A": 1.5}})", R"({"basic-events": {"A": "big"}})",
+      R"({"house-events": {"Undefined": true}})", R"({"mission-time": -1})");
+  INFO("request: " + request);
+  std::string response = server.Process(request);
+  CHECK(response.find(R"("status":"error","message":)") != std::string::npos);
+  CHECK(server.Process("{}").find(R"("probability":0.02})") !=
+        std::string::npos);
+}
+
+TEST_CASE("ServerTest.Run", "[server]") {
+  auto model = LoadModel({"tests/input/fta/constant_propagation.xml"});
+  Server server(model.get(), Settings{});
+  std::istringstream in(
+      "{\"id\": 1}\n\n{\"command\": \"exit\"}\n{\"id\": 3}\n");
+  std::ostringstream out;
+  server.Run(in, out);
+  CHECK(server.stopped());
+  std::string response = out.str();
+  CHECK(response.find(R"({"id":1,"status":"ok")") == 0);
+  CHECK(response.find(R"({"status":"ok"})") != std::string::npos);
+  CHECK(response.find(R"("id":3)") == std::string::npos);
+}
+
+}  // namespace scram::core::test
@@ -34,6 +34,8 @@ TEST_CASE("SettingsTest IncorrectSetup", "[settings]") {
   // Incorrect cut-off probability.
   CHECK_THROWS_AS(s.cut_off(-1), SettingsError);
   CHECK_THROWS_AS(s.cut_off(10), SettingsError);
+  // Incorrect number of the most probable products.
+  CHECK_THROWS_AS(s.top_products(-1), SettingsError);
   // Incorrect number of trials.
   CHECK_THROWS_AS(s.num_trials(-10), SettingsError);
   CHECK_THROWS_AS(s.num_trials(0), SettingsError);
@@ -78,6 +80,10 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.cut_off(0));
   CHECK_NOTHROW(s.cut_off(0.5));
 
+  // Correct number of the most probable products.
+  CHECK_NOTHROW(s.top_products(0));
+  CHECK_NOTHROW(s.top_products(10));
+
   // Correct number of trials.
   CHECK_NOTHROW(s.num_trials(1));
   CHECK_NOTHROW(s.num_trials(1e6));
@@ -122,4 +128,99 @@ TEST_CASE("SettingsTest SetupForPrimeImplicants", "[settings]") {
   CHECK_THROWS_AS(s.approximation("mcub"), SettingsError);
 }
 
+TEST_CASE("SettingsTest SetupForAutoAlgorithm", "[settings]") {
+  Settings s;
+  REQUIRE_NOTHROW(s.algorithm("zbdd").approximation("mcub"));
+  REQUIRE_NOTHROW(s.algorithm("auto"));
+  CHECK(s.algorithm() == Algorithm::kAuto);
+  CHECK(s.approximation() == Approximation::kMcub);  // Kept for the choice.
+  CHECK_NOTHROW(s.approximation("none"));
+  CHECK_NOTHROW(s.prime_implicants(true));
+  CHECK(s.algorithm() == Algorithm::kAuto);
+}
+
+TEST_CASE("SettingsTest SetupForPhaseCompilation", "[settings]") {
+  Settings s;
+  REQUIRE_NOTHROW(s.algorithm("zbdd"));
+  CHECK_THROWS_AS(s.compile_phases(true), SettingsError);
+  CHECK_NOTHROW(s.compile_phases(false));
+  REQUIRE_NOTHROW(s.algorithm("auto"));
+  CHECK_NOTHROW(s.compile_phases(true));
+  REQUIRE_NOTHROW(s.algorithm("bdd"));
+  CHECK(s.compile_phases());
+  // Phases are compiled only for BDD.
+  CHECK_THROWS_AS(s.algorithm("mocus"), SettingsError);
+  CHECK(s.algorithm() == Algorithm::kBdd);
+  CHECK(s.compile_phases());
+  REQUIRE_NOTHROW(s.compile_phases(false));
+  CHECK_NOTHROW(s.algorithm("mocus"));
+}
+
+TEST_CASE("SettingsTest SetupForGateProbabilities", "[settings]") {
+  Settings s;
+  REQUIRE_NOTHROW(s.gate_probabilities(true));
+  CHECK(s.probability_analysis());
+  CHECK(s.probability_gates().empty());
+  // Gates can only be quantified with probability analysis.
+  s.probability_analysis(false);
+  CHECK(s.probability_analysis());
+  REQUIRE_NOTHROW(s.probability_gates({"GateOne", "GateTwo"}));
+  CHECK(s.gate_probabilities());
+  CHECK(s.probability_gates().size() == 2);
+  // Gate probabilities are calculated only with BDD.
+  CHECK_THROWS_AS(s.algorithm("zbdd"), SettingsError);
+  CHECK(s.gate_probabilities());
+  REQUIRE_NOTHROW(s.gate_probabilities(false));
+  REQUIRE_NOTHROW(s.algorithm("zbdd"));
+  CHECK_THROWS_AS(s.gate_probabilities(true), SettingsError);
+  CHECK_THROWS_AS(s.probability_gates({"GateOne"}), SettingsError);
+  REQUIRE_NOTHROW(s.algorithm("auto"));
+  CHECK_NOTHROW(s.gate_probabilities(true));
+  REQUIRE_NOTHROW(s.gate_probabilities(false));
+  s.probability_analysis(false);
+  CHECK_FALSE(s.probability_analysis());
+}
+
+TEST_CASE("SettingsTest SetupForTopProducts", "[settings]") {
+  Settings s;
+  REQUIRE_NOTHROW(s.top_products(5));
+  CHECK(s.probability_analysis());
+  // Products can only be ranked with probability analysis.
+  s.probability_analysis(false);
+  CHECK(s.probability_analysis());
+  // Reporting all products.
+  REQUIRE_NOTHROW(s.top_products(0));
+  s.probability_analysis(false);
+  CHECK_FALSE(s.probability_analysis());
+}
+
+TEST_CASE("SettingsTest SetupForSweep", "[settings]") {
+  Settings s;
+  CHECK_THROWS_AS(s.sweep("lambda", std::vector<double>{}), SettingsError);
+  CHECK_THROWS_AS(s.sweep("lambda", 0, 1, 0), SettingsError);
+  REQUIRE_NOTHROW(s.sweep("lambda", {0.1, 0.2}));
+  CHECK_THROWS_AS(s.sweep("lambda", {0.3}), SettingsError);  // Duplicate.
+  REQUIRE_NOTHROW(s.sweep("mu", 0, 1, 5));
+  REQUIRE(s.sweep().size() == 2);
+  CHECK(s.sweep()[1].parameter == "mu");
+  CHECK(s.sweep()[1].values == std::vector<double>{0, 0.25, 0.5, 0.75, 1});
+  CHECK_NOTHROW(s.sweep("nu", 0.5, 1, 1));
+  CHECK(s.sweep()[2].values == std::vector<double>{0.5});
+  // Sweeps are evaluated with probability analysis.
+  CHECK(s.probability_analysis());
+  s.probability_analysis(false);
+  CHECK(s.probability_analysis());
+}
+
+TEST_CASE("SettingsTest SetupForTrialShards", "[settings]") {
+  Settings s;
+  CHECK(s.num_shards() == 1);
+  CHECK_THROWS_AS(s.shard(0, 0), SettingsError);
+  CHECK_THROWS_AS(s.shard(-1, 2), SettingsError);
+  CHECK_THROWS_AS(s.shard(2, 2), SettingsError);
+  REQUIRE_NOTHROW(s.shard(1, 2));
+  CHECK(s.shard() == 1);
+  CHECK(s.num_shards() == 2);
+}
+
 }  // namespace scram::core::test
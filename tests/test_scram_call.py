@@ -66,6 +66,9 @@ def test_fta_no_prob(tmpdir):
         # Test the incorrect cut-off probability
         (["--cut-off", "-1"], False),
         (["--cut-off", "10"], False),
+        # Test the most probable products
+        (["--top-products", "2"], True),
+        (["--top-products", "-1"], False),
         # Test conflicting algorithms
         (["--zbdd", "--bdd"], False),
         # Test the application of the rare event and MCUB at the same time
@@ -17,6 +17,7 @@
 
 #include "xml_stream.h"
 
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -25,6 +26,8 @@
 
 #include <catch2/catch.hpp>
 
+#include "xml.h"
+
 namespace fs = boost::filesystem;
 
 namespace scram::xml::test {
@@ -111,7 +114,8 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
   INFO("XML temp file: " + temp_file.string());
   const char content[] =
       "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
-      "<root name=\"master\" age=\"42\" stamina=\"0.42\" empty=\"\">\n"
+      "<root name=\"master\" age=\"42\" trials=\"1099511627776\""
+      " stamina=\"0.42\" empty=\"\">\n"
       "  <empty/>\n"
       "  <student new=\"true\" old=\"false\">\n"
       "    <label>newbie</label>\n"
@@ -133,6 +137,7 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
     StreamElement root = xml_stream.root("root");
     root.SetAttribute("name", "master")
         .SetAttribute("age", 42)
+        .SetAttribute("trials", std::int64_t{1} << 40)
         .SetAttribute("stamina", "0.42")
         .SetAttribute("empty", "");
     root.AddChild("empty");
@@ -153,6 +158,10 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
   std::stringstream str_stream;
   str_stream << std::fstream(temp_file.string()).rdbuf();
   CHECK(str_stream.str() == content);
+  Document document(temp_file.string());
+  Element root = document.root();
+  CHECK(root.attribute<std::int64_t>("trials") == std::int64_t{1} << 40);
+  CHECK_THROWS_AS(root.attribute<int>("trials"), ValidityError);
   fs::remove(temp_file);
 }
 